@@ -0,0 +1,130 @@
+//
+//  AgentGrid.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import simd
+
+/// Flat uniform XZ grid over agent positions, rebuilt each step by counting sort into
+/// storage that is reused across steps. Cells hash into a power-of-two bucket table sized
+/// from the agent count, so one bucket can hold agents from several cells: candidates are
+/// conservative and callers still run their own distance test. Candidates are visited in
+/// ascending agent index whatever the bucket layout, so resolution order (and therefore the
+/// result) does not depend on which cells happen to collide.
+nonisolated struct AgentGrid {
+    private(set) var cellSize: Float = 1
+    private(set) var count: Int = 0
+    private var mask: Int = 0
+    /// Bucket `b` owns `sorted[bucketStart[b]..<bucketStart[b + 1]]`.
+    private var bucketStart: [Int32] = []
+    private var cursor: [Int32] = []
+    private var agentBucket: [Int32] = []
+    /// Agent indices grouped by bucket, ascending within a bucket (counting sort is stable).
+    private var sorted: [Int32] = []
+
+    /// Ranges covering more cells than this scan every agent instead.
+    private static let maxRangeCells: Int = 32
+
+    mutating func rebuild(count: Int, cellSize: Float, position: (Int) -> SIMD3<Float>) {
+        self.cellSize = max(cellSize, 0.001)
+        self.count = count
+        var buckets = 16
+        while buckets < count * 2 {
+            buckets <<= 1
+        }
+        mask = buckets - 1
+
+        if bucketStart.count != buckets + 1 {
+            bucketStart = [Int32](repeating: 0, count: buckets + 1)
+        } else {
+            for b in bucketStart.indices {
+                bucketStart[b] = 0
+            }
+        }
+        agentBucket.removeAll(keepingCapacity: true)
+        for i in 0..<count {
+            let c = cell(for: position(i))
+            let b = bucket(c.x, c.y)
+            agentBucket.append(Int32(b))
+            bucketStart[b + 1] += 1
+        }
+        for b in 0..<buckets {
+            bucketStart[b + 1] += bucketStart[b]
+        }
+
+        cursor.removeAll(keepingCapacity: true)
+        cursor.append(contentsOf: bucketStart)
+        sorted.removeAll(keepingCapacity: true)
+        sorted.append(contentsOf: repeatElement(0, count: count))
+        for i in 0..<count {
+            let b = Int(agentBucket[i])
+            sorted[Int(cursor[b])] = Int32(i)
+            cursor[b] += 1
+        }
+    }
+
+    @inline(__always)
+    func cell(for p: SIMD3<Float>) -> SIMD2<Int> {
+        SIMD2<Int>(Int(floor(p.x / cellSize)), Int(floor(p.z / cellSize)))
+    }
+
+    /// Visits agents whose cell is within one cell of `p`'s, each once.
+    func forEachNeighbor(of p: SIMD3<Float>, _ body: (Int) -> Void) {
+        let c = cell(for: p)
+        forEachCandidate(cellMin: c &- 1, cellMax: c &+ 1, body)
+    }
+
+    /// Visits agents whose cell overlaps the XZ box `[min, max]`, each once.
+    func forEachCandidate(min lo: SIMD2<Float>, max hi: SIMD2<Float>, _ body: (Int) -> Void) {
+        let cMin = SIMD2<Int>(Int(floor(lo.x / cellSize)), Int(floor(lo.y / cellSize)))
+        let cMax = SIMD2<Int>(Int(floor(hi.x / cellSize)), Int(floor(hi.y / cellSize)))
+        forEachCandidate(cellMin: cMin, cellMax: cMax, body)
+    }
+
+    private func forEachCandidate(cellMin: SIMD2<Int>, cellMax: SIMD2<Int>, _ body: (Int) -> Void) {
+        guard count > 0 else { return }
+        let w = cellMax.x - cellMin.x + 1
+        let h = cellMax.y - cellMin.y + 1
+        let cells = w * h
+        if cells > AgentGrid.maxRangeCells || cells > mask {
+            for i in 0..<count {
+                body(i)
+            }
+            return
+        }
+        withUnsafeTemporaryAllocation(of: (next: Int, end: Int).self, capacity: cells) { runs in
+            var runCount = 0
+            for k in 0..<cells {
+                let b = bucket(cellMin.x + k % w, cellMin.y + k / w)
+                // Cells of one range can share a bucket; take it for the first such cell only.
+                var seen = false
+                for j in 0..<k where bucket(cellMin.x + j % w, cellMin.y + j / w) == b {
+                    seen = true
+                    break
+                }
+                if seen || bucketStart[b] == bucketStart[b + 1] { continue }
+                runs[runCount] = (Int(bucketStart[b]), Int(bucketStart[b + 1]))
+                runCount += 1
+            }
+            // Each bucket run is ascending; merge them by always taking the smallest head.
+            while true {
+                var pick = -1
+                var agent = Int32.max
+                for r in 0..<runCount where runs[r].next < runs[r].end && sorted[runs[r].next] < agent {
+                    pick = r
+                    agent = sorted[runs[r].next]
+                }
+                if pick < 0 { break }
+                runs[pick].next += 1
+                body(Int(agent))
+            }
+        }
+    }
+
+    @inline(__always)
+    private func bucket(_ x: Int, _ z: Int) -> Int {
+        ((x &* 73_856_093) ^ (z &* 19_349_663)) & mask
+    }
+}
@@ -50,15 +50,49 @@ public struct MotionProfile: Decodable {
     public var units: Units?
     public var bones: [String: Bone]
     public var contacts: Contacts?
+    /// Compiled once when decoded (without a LUT); `MotionProfileLoader` replaces it with a
+    /// baked one. Not part of the JSON.
+    public var compiled: CompiledMotionProfile
+
+    private enum CodingKeys: String, CodingKey {
+        case version, name, duration, order, sample_fps, phase, units, bones, contacts
+    }
+
+    public init(from decoder: Decoder) throws {
+        let container = try decoder.container(keyedBy: CodingKeys.self)
+        version = try container.decode(Int.self, forKey: .version)
+        name = try container.decode(String.self, forKey: .name)
+        duration = try container.decode(Float.self, forKey: .duration)
+        order = try container.decode(Int.self, forKey: .order)
+        sample_fps = try container.decode(Int.self, forKey: .sample_fps)
+        phase = try container.decodeIfPresent(Phase.self, forKey: .phase)
+        units = try container.decodeIfPresent(Units.self, forKey: .units)
+        bones = try container.decode([String: Bone].self, forKey: .bones)
+        contacts = try container.decodeIfPresent(Contacts.self, forKey: .contacts)
+        compiled = CompiledMotionProfile(order: order, bones: bones, lutResolution: 0)
+    }
+}
+
+extension MotionProfile {
+    /// The compiled profile; kept on the profile so its slot cache survives across frames.
+    public var evaluator: CompiledMotionProfile {
+        compiled
+    }
 }
 
 public enum MotionProfileLoader {
-    public static func load(path: String) -> MotionProfile? {
+    /// `lutResolution` 0 compiles the profile without baking a phase lookup table.
+    public static func load(path: String,
+                            lutResolution: Int = CompiledMotionProfile.defaultLUTResolution) -> MotionProfile? {
         guard let data = try? Data(contentsOf: URL(fileURLWithPath: path)) else {
             return nil
         }
         let decoder = JSONDecoder()
-        return try? decoder.decode(MotionProfile.self, from: data)
+        guard var profile = try? decoder.decode(MotionProfile.self, from: data) else {
+            return nil
+        }
+        profile.compiled = CompiledMotionProfile(profile, lutResolution: lutResolution)
+        return profile
     }
 }
 
@@ -87,3 +121,129 @@ public enum MotionProfileEvaluator {
         return SIMD3<Float>(x, y, z)
     }
 }
+
+/// A `MotionProfile` compiled for per-frame evaluation. Each bone's six channels
+/// (translation xyz, rotation xyz) are lanes of one SIMD8 per coefficient, harmonics come
+/// from an angle-addition recurrence rather than a cos/sin call each, and with a LUT
+/// resolution the curves are baked at load and sampled by linear interpolation.
+public final class CompiledMotionProfile {
+    public static let defaultLUTResolution = 128
+
+    public let order: Int
+    public let lutResolution: Int
+    /// Coefficients per slot: the constant, then cos and sin per harmonic.
+    private let terms: Int
+    private let slotByName: [String: Int]
+    private let coefficients: [SIMD8<Float>]
+    /// 1 in lanes the profile has no curve for; those take the caller's default.
+    private let absent: [SIMD8<Float>]
+    /// `lutResolution + 1` samples per slot over phase 0...1.
+    private var lut: [SIMD8<Float>] = []
+    private var slotCache: [(names: [String], slots: [Int])] = []
+
+    /// `lutResolution` 0 skips baking and evaluates the series on every sample.
+    public convenience init(_ profile: MotionProfile, lutResolution: Int = CompiledMotionProfile.defaultLUTResolution) {
+        self.init(order: profile.order, bones: profile.bones, lutResolution: lutResolution)
+    }
+
+    public init(order profileOrder: Int, bones: [String: MotionProfile.Bone], lutResolution: Int) {
+        let order = max(profileOrder, 0)
+        let terms = 1 + 2 * order
+        let names = bones.keys.sorted()
+        var slotByName: [String: Int] = [:]
+        var coefficients = Array(repeating: SIMD8<Float>(repeating: 0), count: names.count * terms)
+        var absent = Array(repeating: SIMD8<Float>(repeating: 0), count: names.count)
+
+        for (slot, name) in names.enumerated() {
+            slotByName[name] = slot
+            let bone = bones[name]!
+            let lanes = [bone.translation.x, bone.translation.y, bone.translation.z,
+                         bone.rotation.x, bone.rotation.y, bone.rotation.z]
+            for (lane, coeffs) in lanes.enumerated() {
+                guard let coeffs else {
+                    absent[slot][lane] = 1
+                    continue
+                }
+                // Same truncation as MotionProfileEvaluator.evaluate: only complete pairs count.
+                let pairs = coeffs.isEmpty ? 0 : min(order, (coeffs.count - 1) / 2)
+                if let c0 = coeffs.first {
+                    coefficients[slot * terms][lane] = c0
+                }
+                for k in 0..<pairs {
+                    coefficients[slot * terms + 1 + 2 * k][lane] = coeffs[1 + 2 * k]
+                    coefficients[slot * terms + 2 + 2 * k][lane] = coeffs[2 + 2 * k]
+                }
+            }
+        }
+
+        self.order = order
+        self.terms = terms
+        self.slotByName = slotByName
+        self.coefficients = coefficients
+        self.absent = absent
+        self.lutResolution = max(lutResolution, 0)
+
+        if self.lutResolution > 0 {
+            let samples = self.lutResolution + 1
+            var lut: [SIMD8<Float>] = []
+            lut.reserveCapacity(names.count * samples)
+            for slot in 0..<names.count {
+                for i in 0..<samples {
+                    lut.append(evaluate(slot: slot, phase: Float(i) / Float(self.lutResolution)))
+                }
+            }
+            self.lut = lut
+        }
+    }
+
+    /// Profile slot of each bone in `names`, -1 where the profile has no curves. Cached per
+    /// skeleton; the lookup compares array storage first, so it is cheap for a shared `names`.
+    public func slots(for names: [String]) -> [Int] {
+        if let cached = slotCache.first(where: { $0.names == names }) {
+            return cached.slots
+        }
+        let slots = names.map { slotByName[$0] ?? -1 }
+        slotCache.append((names, slots))
+        return slots
+    }
+
+    /// Raw translation and rotation (degrees) of `slot` at `phase`; channels without a curve
+    /// keep `restTranslation` and zero rotation, like `evaluateChannel` with those defaults.
+    public func sample(slot: Int,
+                       phase: Float,
+                       restTranslation: SIMD3<Float>) -> (translation: SIMD3<Float>, rotation: SIMD3<Float>) {
+        guard slot >= 0 else { return (restTranslation, SIMD3<Float>(0, 0, 0)) }
+        let p = max(0, min(phase, 1))
+        var v: SIMD8<Float>
+        if lutResolution > 0 {
+            let x = p * Float(lutResolution)
+            let i = min(Int(x), lutResolution - 1)
+            let f = x - Float(i)
+            let base = slot * (lutResolution + 1) + i
+            v = lut[base] + (lut[base + 1] - lut[base]) * f
+        } else {
+            v = evaluate(slot: slot, phase: p)
+        }
+        let rest = SIMD8<Float>(restTranslation.x, restTranslation.y, restTranslation.z, 0, 0, 0, 0, 0)
+        v.replace(with: rest, where: absent[slot] .> 0)
+        return (SIMD3<Float>(v[0], v[1], v[2]), SIMD3<Float>(v[3], v[4], v[5]))
+    }
+
+    /// The Fourier series for all six lanes; cos/sin of each harmonic are rotated from the
+    /// previous one, so a sample costs one cos/sin pair whatever the order.
+    private func evaluate(slot: Int, phase: Float) -> SIMD8<Float> {
+        let base = slot * terms
+        var result = coefficients[base]
+        guard order > 0 else { return result }
+        let angle = 2 * Float.pi * phase
+        let c1 = cos(angle)
+        let s1 = sin(angle)
+        var c = c1
+        var s = s1
+        for k in 0..<order {
+            result += coefficients[base + 1 + 2 * k] * c + coefficients[base + 2 + 2 * k] * s
+            (c, s) = (c * c1 - s * s1, s * c1 + c * s1)
+        }
+        return result
+    }
+}
@@ -0,0 +1,99 @@
+//
+//  AnimationLODSystem.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import simd
+
+/// Picks each animated character's `AnimationLOD` from its distance to the camera and
+/// whether its bounds are inside the view frustum. PoseStackSystem throttles pose updates
+/// by the level, and the RT path reskins (and refits the BLAS of) a character only when its
+/// pose changed, with one bone influence at far levels.
+public final class AnimationLODSystem {
+    public var reducedDistance: Float = 12
+    public var farDistance: Float = 30
+    /// Beyond this a character counts as hidden even when inside the frustum.
+    public var cullDistance: Float = 80
+    /// Bounding sphere radius of a character at unit scale.
+    public var boundingRadius: Float = 1.5
+
+    public init() {}
+
+    public func update(world: World, camera: Camera) {
+        let entities = world.query(SkeletonComponent.self, PoseComponent.self)
+        if entities.isEmpty { return }
+
+        let tStore = world.store(TransformComponent.self)
+        let wStore = world.store(WorldPositionComponent.self)
+        let pStore = world.store(PhysicsBodyComponent.self)
+        let followStore = world.store(FollowTargetComponent.self)
+        let lodStore = world.store(AnimationLODComponent.self)
+        let cameraWorld = WorldPosition.toWorld(chunk: camera.worldChunk, local: camera.worldLocal)
+        let planes = AnimationLODSystem.frustumPlanes(simd_mul(camera.projection, camera.view))
+
+        /// Render-space position, resolved like RenderExtractSystem (without interpolation).
+        func renderPosition(_ e: Entity) -> SIMD3<Float>? {
+            let source = followStore[e]?.target ?? e
+            if let w = wStore[source] {
+                let d = WorldPosition.toWorld(chunk: w.chunk, local: w.local) - cameraWorld
+                return SIMD3<Float>(Float(d.x), Float(d.y), Float(d.z))
+            }
+            if let p = pStore[source] {
+                let d = p.position - cameraWorld
+                return SIMD3<Float>(Float(d.x), Float(d.y), Float(d.z))
+            }
+            guard let t = tStore[source] else { return nil }
+            let c = SIMD3<Float>(Float(cameraWorld.x), Float(cameraWorld.y), Float(cameraWorld.z))
+            return t.translation - c
+        }
+
+        for e in entities {
+            guard let center = renderPosition(e) else { continue }
+            let scale = tStore[e].map { max($0.scale.x, $0.scale.y, $0.scale.z) } ?? 1
+            let radius = boundingRadius * scale
+            let distance = simd_length(center - camera.position)
+
+            let level: AnimationLOD
+            if distance > cullDistance || !AnimationLODSystem.sphereVisible(center, radius: radius, planes: planes) {
+                level = .hidden
+            } else if distance > farDistance {
+                level = .far
+            } else if distance > reducedDistance {
+                level = .reduced
+            } else {
+                level = .full
+            }
+
+            let existing = lodStore[e]
+            if existing?.level == level { continue }
+            var lod = existing ?? AnimationLODComponent(level: level)
+            // A character promoted to a finer level is evaluated on its next step.
+            if level.poseInterval < lod.level.poseInterval {
+                lod.pendingSteps = max(lod.pendingSteps, level.poseInterval - 1)
+            }
+            lod.level = level
+            lodStore[e] = lod
+        }
+    }
+
+    /// Left, right, bottom, top, near and far planes of a Metal (0...1 depth) view-projection.
+    private static func frustumPlanes(_ m: matrix_float4x4) -> [SIMD4<Float>] {
+        let r0 = SIMD4<Float>(m.columns.0.x, m.columns.1.x, m.columns.2.x, m.columns.3.x)
+        let r1 = SIMD4<Float>(m.columns.0.y, m.columns.1.y, m.columns.2.y, m.columns.3.y)
+        let r2 = SIMD4<Float>(m.columns.0.z, m.columns.1.z, m.columns.2.z, m.columns.3.z)
+        let r3 = SIMD4<Float>(m.columns.0.w, m.columns.1.w, m.columns.2.w, m.columns.3.w)
+        return [r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2]
+    }
+
+    private static func sphereVisible(_ center: SIMD3<Float>, radius: Float, planes: [SIMD4<Float>]) -> Bool {
+        for p in planes {
+            let n = SIMD3<Float>(p.x, p.y, p.z)
+            if simd_dot(n, center) + p.w < -radius * simd_length(n) {
+                return false
+            }
+        }
+        return true
+    }
+}
@@ -0,0 +1,175 @@
+//
+//  AssetStreaming.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+
+public typealias AssetHandle = Int
+
+/// Loads finished on the load queue, waiting for the next `AssetStreamer.drain`. Separate
+/// from the streamer so a load in flight never keeps the streamer alive or releases it on
+/// the queue; `lock` guards `finished`.
+private nonisolated final class AssetLoadInbox: @unchecked Sendable {
+    private let lock = NSLock()
+    private var finished: [(handle: AssetHandle, payload: (any Sendable)?)] = []
+
+    func post(handle: AssetHandle, payload: (any Sendable)?) {
+        lock.lock()
+        finished.append((handle, payload))
+        lock.unlock()
+    }
+
+    func take() -> [(handle: AssetHandle, payload: (any Sendable)?)] {
+        lock.lock()
+        defer { lock.unlock() }
+        let landed = finished
+        finished.removeAll()
+        return landed
+    }
+}
+
+/// Loads registered assets on a background queue and spawns them into the world once they
+/// land. Decode, texture loads and GPU buffer creation (MTLDevice is thread safe) all run
+/// on the queue through nonisolated loaders, and the payload they produce is Sendable; only
+/// the spawn closure, which adds entities, runs on the simulation thread.
+/// Loads are requested by `AssetStreamingSystem` as anchors come near the active chunks.
+public final class AssetStreamer {
+    private struct Entry {
+        let name: String
+        let load: @Sendable () -> (any Sendable)?
+        let spawn: (World, Entity, Any) -> Void
+    }
+
+    private var entries: [Entry] = []
+    private let loadQueue = DispatchQueue(label: "AssetStreamer.load", qos: .userInitiated)
+    private let inbox = AssetLoadInbox()
+    private var payloads: [AssetHandle: any Sendable] = [:]
+    private var inFlight: Set<AssetHandle> = []
+
+    /// Bumped whenever a spawn adds entities, so the scene can bump its resource revision.
+    public private(set) var generation: UInt64 = 0
+    /// Runs loads inside `request` instead of on the load queue, so every load lands on the
+    /// step after its request (headless runs that must be reproducible).
+    public var synchronousLoads: Bool = false
+
+    public init() {}
+
+    /// Registers an asset. `load` runs on the load queue, so it must be nonisolated (a
+    /// `@Sendable` closure over nonisolated loaders), and returns nil on failure; `spawn`
+    /// receives the anchor entity the asset was requested for and the loaded value.
+    public func register<T: Sendable>(_ name: String,
+                                      load: @escaping @Sendable () -> T?,
+                                      spawn: @escaping (World, Entity, T) -> Void) -> AssetHandle {
+        entries.append(Entry(name: name,
+                             load: { load() },
+                             spawn: { world, anchor, payload in spawn(world, anchor, payload as! T) }))
+        return entries.count - 1
+    }
+
+    public func name(of handle: AssetHandle) -> String {
+        entries[handle].name
+    }
+
+    /// Schedules `handle` unless it is loaded or in flight.
+    public func request(_ handle: AssetHandle) {
+        if payloads[handle] != nil || inFlight.contains(handle) { return }
+        inFlight.insert(handle)
+        let load = entries[handle].load
+        let inbox = self.inbox
+        if synchronousLoads {
+            inbox.post(handle: handle, payload: load())
+            return
+        }
+        loadQueue.async { @Sendable in
+            inbox.post(handle: handle, payload: load())
+        }
+    }
+
+    /// Loaded value of `handle`, once its load has landed.
+    public func payload(_ handle: AssetHandle) -> Any? {
+        payloads[handle]
+    }
+
+    /// Moves landed loads into `payloads`; returns the handles that landed and whether each
+    /// succeeded.
+    public func drain() -> [(handle: AssetHandle, loaded: Bool)] {
+        let landed = inbox.take()
+        var results: [(handle: AssetHandle, loaded: Bool)] = []
+        results.reserveCapacity(landed.count)
+        for load in landed {
+            inFlight.remove(load.handle)
+            if let payload = load.payload {
+                payloads[load.handle] = payload
+            }
+            results.append((load.handle, load.payload != nil))
+        }
+        return results
+    }
+
+    /// Runs the spawn closure of a loaded `handle` for `anchor`.
+    public func spawn(_ handle: AssetHandle, world: World, anchor: Entity) {
+        guard let payload = payloads[handle] else { return }
+        entries[handle].spawn(world, anchor, payload)
+        generation &+= 1
+    }
+}
+
+/// Requests streamed assets whose anchor lies within the active radius plus
+/// `prefetchChunks`, and swaps each anchor's placeholder for the asset once it lands.
+/// Runs after `ActiveChunkSystem`, which supplies the active chunk center. It declares no
+/// access: spawning creates entities, so it runs exclusively.
+public final class AssetStreamingSystem: FixedStepSystem {
+    /// Extra ring of chunks past the active radius that is loaded ahead of arrival.
+    public var prefetchChunks: Int = 1
+    private let streamer: AssetStreamer
+
+    public init(streamer: AssetStreamer) {
+        self.streamer = streamer
+    }
+
+    public func fixedUpdate(world: World, dt: Float) {
+        _ = dt
+        guard let active = world.query(ActiveChunkComponent.self).first.flatMap({ world.store(ActiveChunkComponent.self)[$0] }) else {
+            return
+        }
+        let sStore = world.store(StreamedAssetComponent.self)
+        let wStore = world.store(WorldPositionComponent.self)
+        let anchors = world.query(StreamedAssetComponent.self, WorldPositionComponent.self)
+
+        var failed: Set<AssetHandle> = []
+        for result in streamer.drain() where !result.loaded {
+            print("AssetStreamer: failed to load:", streamer.name(of: result.handle))
+            failed.insert(result.handle)
+        }
+
+        let reach = Int64(max(active.radiusChunks, 0) + max(prefetchChunks, 0))
+        for e in anchors {
+            guard var streamed = sStore[e], let w = wStore[e] else { continue }
+            switch streamed.state {
+            case .unloaded:
+                let d = max(abs(w.chunk.x - active.centerChunk.x),
+                            max(abs(w.chunk.y - active.centerChunk.y), abs(w.chunk.z - active.centerChunk.z)))
+                guard d <= reach else { continue }
+                streamed.state = .loading
+                streamer.request(streamed.handle)
+            case .loading:
+                if failed.contains(streamed.handle) {
+                    streamed.state = .failed
+                    world.remove(e, RenderComponent.self)
+                } else if streamer.payload(streamed.handle) != nil {
+                    world.remove(e, RenderComponent.self)
+                    streamer.spawn(streamed.handle, world: world, anchor: e)
+                    streamed.state = .ready
+                } else {
+                    continue
+                }
+            case .ready, .failed:
+                continue
+            }
+            sStore[e] = streamed
+        }
+    }
+}
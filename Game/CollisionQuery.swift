@@ -5,6 +5,7 @@
 //  Created by 伈佊 on 1/2/26.
 //
 
+import Foundation
 import simd
 
 private func filteredEntities(world: World, activeEntityIDs: Set<UInt32>?) -> [Entity] {
@@ -25,7 +26,7 @@ private func filteredEntities(entities: [Entity],
     return entities.filter { activeEntityIDs.contains($0.id) }
 }
 
-public struct RaycastHit {
+public nonisolated struct RaycastHit: Sendable {
     public var distance: Float
     public var position: SIMD3<Float>
     public var normal: SIMD3<Float>
@@ -33,7 +34,7 @@ public struct RaycastHit {
     public var material: SurfaceMaterial
 }
 
-public struct CapsuleCastHit {
+public nonisolated struct CapsuleCastHit: Sendable {
     public var toi: Float
     public var position: SIMD3<Float>
     public var normal: SIMD3<Float>
@@ -42,7 +43,7 @@ public struct CapsuleCastHit {
     public var material: SurfaceMaterial
 }
 
-public struct CapsuleOverlapHit {
+public nonisolated struct CapsuleOverlapHit: Sendable {
     public var depth: Float
     public var position: SIMD3<Float>
     public var normal: SIMD3<Float>
@@ -51,11 +52,88 @@ public struct CapsuleOverlapHit {
     public var material: SurfaceMaterial
 }
 
-public final class CollisionQuery {
+/// One ray in a batched raycast.
+public nonisolated struct RayQuery: Sendable {
+    public var origin: SIMD3<Float>
+    public var direction: SIMD3<Float>
+    public var maxDistance: Float
+    public var mask: UInt32
+
+    public init(origin: SIMD3<Float>,
+                direction: SIMD3<Float>,
+                maxDistance: Float,
+                mask: UInt32 = CollisionLayer.all) {
+        self.origin = origin
+        self.direction = direction
+        self.maxDistance = maxDistance
+        self.mask = mask
+    }
+}
+
+/// One capsule sweep in a batched capsule cast. `blockingOnly` and `minNormalY`
+/// select the `capsuleCastBlocking` / `capsuleCastGround` filters.
+public nonisolated struct CapsuleSweepQuery: Sendable {
+    public var from: SIMD3<Float>
+    public var delta: SIMD3<Float>
+    public var radius: Float
+    public var halfHeight: Float
+    public var blockingOnly: Bool
+    public var minNormalY: Float?
+    public var mask: UInt32
+
+    public init(from: SIMD3<Float>,
+                delta: SIMD3<Float>,
+                radius: Float,
+                halfHeight: Float,
+                blockingOnly: Bool = false,
+                minNormalY: Float? = nil,
+                mask: UInt32 = CollisionLayer.all) {
+        self.from = from
+        self.delta = delta
+        self.radius = radius
+        self.halfHeight = halfHeight
+        self.blockingOnly = blockingOnly
+        self.minNormalY = minNormalY
+        self.mask = mask
+    }
+}
+
+/// One capsule in a batched overlap query.
+public nonisolated struct CapsuleOverlapQuery: Sendable {
+    public var from: SIMD3<Float>
+    public var radius: Float
+    public var halfHeight: Float
+    public var mask: UInt32
+
+    public init(from: SIMD3<Float>,
+                radius: Float,
+                halfHeight: Float,
+                mask: UInt32 = CollisionLayer.all) {
+        self.from = from
+        self.radius = radius
+        self.halfHeight = halfHeight
+        self.mask = mask
+    }
+}
+
+/// Queries are nonisolated so worker threads can run them; building and updating one reads
+/// the World and stays on the main actor.
+public nonisolated final class CollisionQuery {
     private var snapshot: CollisionWorldSnapshot
 
-    public init(world: World, activeEntityIDs: Set<UInt32>? = nil) {
-        self.snapshot = CollisionWorldSnapshot(world: world, activeEntityIDs: activeEntityIDs)
+    /// Passing the query being replaced reuses its per-mesh BVHs, so a rebuild only
+    /// builds BVHs for meshes that were not already present.
+    @MainActor
+    public init(world: World,
+                activeEntityIDs: Set<UInt32>? = nil,
+                reusingMeshesFrom previous: CollisionQuery? = nil) {
+        self.snapshot = CollisionWorldSnapshot(world: world,
+                                               activeEntityIDs: activeEntityIDs,
+                                               reusing: previous?.snapshot)
+    }
+
+    private init(snapshot: CollisionWorldSnapshot) {
+        self.snapshot = snapshot
     }
 
     public var stats: CollisionQueryStats {
@@ -66,6 +144,23 @@ public final class CollisionQuery {
         snapshot.resetStats()
     }
 
+    /// Query sharing this query's triangle data with its own stats, for one worker thread.
+    /// Keep it only for the duration of a parallel section: while a worker copy is alive,
+    /// transform updates on this query copy the shared arrays.
+    public func makeWorkerQuery() -> CollisionQuery {
+        let worker = CollisionQuery(snapshot: snapshot)
+        worker.resetStats()
+        return worker
+    }
+
+    /// Fold stats gathered by worker queries back into this query.
+    public func mergeStats(from workers: [CollisionQuery]) {
+        for worker in workers {
+            snapshot.mergeStats(from: worker.snapshot)
+        }
+    }
+
+    @MainActor
     public func updateStaticTransforms(world: World,
                                        entities: [Entity],
                                        activeEntityIDs: Set<UInt32>? = nil) {
@@ -74,6 +169,7 @@ public final class CollisionQuery {
                                         activeEntityIDs: activeEntityIDs)
     }
 
+    @MainActor
     public func updateDynamicTransforms(world: World,
                                         entities: [Entity],
                                         activeEntityIDs: Set<UInt32>? = nil) {
@@ -82,6 +178,13 @@ public final class CollisionQuery {
                                          activeEntityIDs: activeEntityIDs)
     }
 
+    /// Queries `chunks` (from a `CollisionChunkCache`) alongside this query's own sets,
+    /// replacing any attached before. `originWorld` is the physics origin.
+    @MainActor
+    public func attachStaticChunks(_ chunks: [CollisionChunk], originWorld: SIMD3<Double>) {
+        snapshot.attachStaticChunks(chunks, originWorld: originWorld)
+    }
+
     public func raycast(origin: SIMD3<Float>,
                         direction: SIMD3<Float>,
                         maxDistance: Float,
@@ -157,13 +260,37 @@ public final class CollisionQuery {
                                            maxHits: max(1, maxHits),
                                            mask: mask)
     }
+
+    /// Batched raycasts; results are index-aligned with `rays`.
+    /// Adjacent rays share BVH traversal, so submit spatially coherent batches.
+    public func raycastBatch(_ rays: [RayQuery]) -> [RaycastHit?] {
+        CollisionQueries.raycastBatch(world: &snapshot, rays: rays)
+    }
+
+    /// Batched capsule casts; results are index-aligned with `sweeps`.
+    public func capsuleCastBatch(_ sweeps: [CapsuleSweepQuery]) -> [CapsuleCastHit?] {
+        CollisionQueries.capsuleCastBatch(world: &snapshot, sweeps: sweeps)
+    }
+
+    /// Batched `capsuleOverlapAll`; results are index-aligned with `queries`.
+    public func capsuleOverlapAllBatch(_ queries: [CapsuleOverlapQuery],
+                                       maxHits: Int = 8) -> [[CapsuleOverlapHit]] {
+        CollisionQueries.capsuleOverlapAllBatch(world: &snapshot,
+                                                queries: queries,
+                                                maxHits: max(1, maxHits))
+    }
 }
 
-public struct CollisionWorldSnapshot {
+public nonisolated struct CollisionWorldSnapshot {
     fileprivate var staticMesh: StaticTriMesh
 
-    public init(world: World, activeEntityIDs: Set<UInt32>? = nil) {
-        self.staticMesh = StaticTriMesh(world: world, activeEntityIDs: activeEntityIDs)
+    @MainActor
+    public init(world: World,
+                activeEntityIDs: Set<UInt32>? = nil,
+                reusing previous: CollisionWorldSnapshot? = nil) {
+        self.staticMesh = StaticTriMesh(world: world,
+                                        activeEntityIDs: activeEntityIDs,
+                                        reusing: previous?.staticMesh)
     }
 
     public var stats: CollisionQueryStats {
@@ -174,14 +301,21 @@ public struct CollisionWorldSnapshot {
         staticMesh.resetStats()
     }
 
+    public mutating func mergeStats(from other: CollisionWorldSnapshot) {
+        staticMesh.mergeStats(from: other.staticMesh)
+    }
+
+    @MainActor
     public mutating func rebuildStatic(world: World, activeEntityIDs: Set<UInt32>? = nil) {
         staticMesh.rebuildStatic(world: world, activeEntityIDs: activeEntityIDs)
     }
 
+    @MainActor
     public mutating func rebuildDynamic(world: World, activeEntityIDs: Set<UInt32>? = nil) {
         staticMesh.rebuildDynamic(world: world, activeEntityIDs: activeEntityIDs)
     }
 
+    @MainActor
     public mutating func updateStaticTransforms(world: World,
                                                 entities: [Entity],
                                                 activeEntityIDs: Set<UInt32>? = nil) {
@@ -190,6 +324,7 @@ public struct CollisionWorldSnapshot {
                                           activeEntityIDs: activeEntityIDs)
     }
 
+    @MainActor
     public mutating func updateDynamicTransforms(world: World,
                                                  entities: [Entity],
                                                  activeEntityIDs: Set<UInt32>? = nil) {
@@ -197,9 +332,14 @@ public struct CollisionWorldSnapshot {
                                            entities: entities,
                                            activeEntityIDs: activeEntityIDs)
     }
+
+    @MainActor
+    public mutating func attachStaticChunks(_ chunks: [CollisionChunk], originWorld: SIMD3<Double>) {
+        staticMesh.attachStaticChunks(chunks, originWorld: originWorld)
+    }
 }
 
-public struct CollisionQueries {
+public nonisolated struct CollisionQueries {
     public static func raycast(world: inout CollisionWorldSnapshot,
                                origin: SIMD3<Float>,
                                direction: SIMD3<Float>,
@@ -275,9 +415,25 @@ public struct CollisionQueries {
                                            maxHits: max(1, maxHits),
                                            mask: mask)
     }
+
+    public static func raycastBatch(world: inout CollisionWorldSnapshot,
+                                    rays: [RayQuery]) -> [RaycastHit?] {
+        world.staticMesh.raycastBatch(rays)
+    }
+
+    public static func capsuleCastBatch(world: inout CollisionWorldSnapshot,
+                                        sweeps: [CapsuleSweepQuery]) -> [CapsuleCastHit?] {
+        world.staticMesh.capsuleCastBatch(sweeps)
+    }
+
+    public static func capsuleOverlapAllBatch(world: inout CollisionWorldSnapshot,
+                                              queries: [CapsuleOverlapQuery],
+                                              maxHits: Int) -> [[CapsuleOverlapHit]] {
+        world.staticMesh.capsuleOverlapAllBatch(queries, maxHits: max(1, maxHits))
+    }
 }
 
-public struct CollisionQueryStats {
+public nonisolated struct CollisionQueryStats: Sendable {
     public var capsuleCandidateCount: Int = 0
     public var capsuleSweepCount: Int = 0
     public var capsuleSweepIterations: Int = 0
@@ -289,7 +445,7 @@ public struct CollisionQueryStats {
     public var capsuleUsedCoarseGrid: Bool = false
 }
 
-private struct QueryStats {
+private nonisolated struct QueryStats {
     var capsuleCandidateCount: Int = 0
     var capsuleSweepCount: Int = 0
     var capsuleSweepIterations: Int = 0
@@ -304,6 +460,16 @@ private struct QueryStats {
         self = QueryStats()
     }
 
+    mutating func merge(_ other: QueryStats) {
+        capsuleCandidateCount += other.capsuleCandidateCount
+        capsuleSweepCount += other.capsuleSweepCount
+        capsuleSweepIterations += other.capsuleSweepIterations
+        capsuleSweepMaxIterations = max(capsuleSweepMaxIterations, other.capsuleSweepMaxIterations)
+        capsuleCellCount += other.capsuleCellCount
+        capsuleCandidatesClamped = capsuleCandidatesClamped || other.capsuleCandidatesClamped
+        capsuleUsedCoarseGrid = capsuleUsedCoarseGrid || other.capsuleUsedCoarseGrid
+    }
+
     var publicStats: CollisionQueryStats {
         CollisionQueryStats(capsuleCandidateCount: capsuleCandidateCount,
                             capsuleSweepCount: capsuleSweepCount,
@@ -317,212 +483,1153 @@ private struct QueryStats {
     }
 }
 
-private struct TriangleMeshSet {
-    var positions: [SIMD3<Float>] = []
-    var indices: [UInt32] = []
-    var triangleAABBs: [StaticTriMesh.AABB] = []
-    var triangleMaterials: [SurfaceMaterial] = []
-    var triangleLayers: [UInt32] = []
-    var slices: [Entity: StaticTriMesh.MeshSlice] = [:]
-    var bvh: StaticTriMesh.BVH? = nil
+/// Up to four triangles in SoA form so one ray or bounds test covers all of them.
+private nonisolated struct TrianglePacket4 {
+    var v0x = SIMD4<Float>()
+    var v0y = SIMD4<Float>()
+    var v0z = SIMD4<Float>()
+    var v1x = SIMD4<Float>()
+    var v1y = SIMD4<Float>()
+    var v1z = SIMD4<Float>()
+    var v2x = SIMD4<Float>()
+    var v2y = SIMD4<Float>()
+    var v2z = SIMD4<Float>()
+    var triangles = SIMD4<Int32>(repeating: -1)
+    var valid = SIMDMask<SIMD4<Int32>>(repeating: false)
+
+    mutating func set(lane: Int,
+                      triangle: Int,
+                      v0: SIMD3<Float>,
+                      v1: SIMD3<Float>,
+                      v2: SIMD3<Float>) {
+        v0x[lane] = v0.x
+        v0y[lane] = v0.y
+        v0z[lane] = v0.z
+        v1x[lane] = v1.x
+        v1y[lane] = v1.y
+        v1z[lane] = v1.z
+        v2x[lane] = v2.x
+        v2y[lane] = v2.y
+        v2z[lane] = v2.z
+        triangles[lane] = Int32(triangle)
+        valid[lane] = true
+    }
+
+    func vertices(lane: Int) -> (SIMD3<Float>, SIMD3<Float>, SIMD3<Float>) {
+        (SIMD3<Float>(v0x[lane], v0y[lane], v0z[lane]),
+         SIMD3<Float>(v1x[lane], v1y[lane], v1z[lane]),
+         SIMD3<Float>(v2x[lane], v2y[lane], v2z[lane]))
+    }
+
+    /// Lanes whose triangle bounds overlap [p, q].
+    func overlapMask(min p: SIMD3<Float>, max q: SIMD3<Float>) -> SIMDMask<SIMD4<Int32>> {
+        let minX = simd_min(v0x, simd_min(v1x, v2x))
+        let minY = simd_min(v0y, simd_min(v1y, v2y))
+        let minZ = simd_min(v0z, simd_min(v1z, v2z))
+        let maxX = simd_max(v0x, simd_max(v1x, v2x))
+        let maxY = simd_max(v0y, simd_max(v1y, v2y))
+        let maxZ = simd_max(v0z, simd_max(v1z, v2z))
+        return (maxX .>= p.x) .& (minX .<= q.x)
+            .& (maxY .>= p.y) .& (minY .<= q.y)
+            .& (maxZ .>= p.z) .& (minZ .<= q.z)
+    }
+
+    /// Four-wide Möller–Trumbore; lanes outside `lanes` or missing return +infinity.
+    func intersect(origin: SIMD3<Float>,
+                   direction d: SIMD3<Float>,
+                   lanes: SIMDMask<SIMD4<Int32>>,
+                   eps: Float) -> SIMD4<Float> {
+        let e1x = v1x - v0x
+        let e1y = v1y - v0y
+        let e1z = v1z - v0z
+        let e2x = v2x - v0x
+        let e2y = v2y - v0y
+        let e2z = v2z - v0z
+        let px = d.y * e2z - d.z * e2y
+        let py = d.z * e2x - d.x * e2z
+        let pz = d.x * e2y - d.y * e2x
+        let det = e1x * px + e1y * py + e1z * pz
+        let invDet = 1 / det
+        let tx = origin.x - v0x
+        let ty = origin.y - v0y
+        let tz = origin.z - v0z
+        let u = (tx * px + ty * py + tz * pz) * invDet
+        let qx = ty * e1z - tz * e1y
+        let qy = tz * e1x - tx * e1z
+        let qz = tx * e1y - ty * e1x
+        let v = (d.x * qx + d.y * qy + d.z * qz) * invDet
+        let t = (e2x * qx + e2y * qy + e2z * qz) * invDet
+        let hit = lanes
+            .& (simd_abs(det) .>= eps)
+            .& (u .>= 0) .& (u .<= 1)
+            .& (v .>= 0) .& ((u + v) .<= 1)
+            .& (t .>= 0)
+        return SIMD4<Float>(repeating: .infinity).replacing(with: t, where: hit)
+    }
+}
 
-    var hasTriangles: Bool { !triangleAABBs.isEmpty }
+/// Identifies a collision mesh by the storage of its position and index arrays, so every
+/// instance spawned from the same descriptor shares one local-space BVH.
+private nonisolated struct CollisionMeshKey: Hashable {
+    let positions: UInt
+    let positionCount: Int
+    let indices: UInt
+    let indexCount: Int
+
+    init(_ mesh: ProceduralMeshDescriptor) {
+        positions = mesh.streams.positions.withUnsafeBufferPointer { UInt(bitPattern: $0.baseAddress) }
+        positionCount = mesh.streams.positions.count
+        if let i16 = mesh.indices16 {
+            indices = i16.withUnsafeBufferPointer { UInt(bitPattern: $0.baseAddress) }
+            indexCount = i16.count
+        } else if let i32 = mesh.indices32 {
+            indices = i32.withUnsafeBufferPointer { UInt(bitPattern: $0.baseAddress) }
+            indexCount = i32.count
+        } else {
+            indices = 0
+            indexCount = 0
+        }
+    }
+}
 
-    mutating func rebuild(entities: [Entity],
-                          tStore: ComponentStore<TransformComponent>,
-                          mStore: ComponentStore<StaticMeshComponent>) {
-        positions.removeAll(keepingCapacity: true)
-        indices.removeAll(keepingCapacity: true)
-        triangleAABBs.removeAll(keepingCapacity: true)
-        triangleMaterials.removeAll(keepingCapacity: true)
-        triangleLayers.removeAll(keepingCapacity: true)
-        slices.removeAll(keepingCapacity: true)
+/// Local-space triangles and BVH of one collision mesh (the BLAS), built once and shared by instances.
+private nonisolated final class CollisionMeshBLAS: Sendable {
+    /// Retained so the storage addresses in `CollisionMeshKey` cannot be reused by another mesh.
+    let source: ProceduralMeshDescriptor
+    let positions: [SIMD3<Float>]
+    let indices: [UInt32]
+    /// Source triangle per kept triangle, for per-triangle materials.
+    let sourceTriangles: [Int32]
+    let sourceTriangleCount: Int
+    let triangleAABBs: [StaticTriMesh.AABB]
+    let bounds: StaticTriMesh.AABB
+    let bvh: StaticTriMesh.BVH?
+
+    var triangleCount: Int { triangleAABBs.count }
+
+    init(mesh: ProceduralMeshDescriptor) {
+        source = mesh
+        positions = mesh.streams.positions
+
+        let localIndices: [UInt32]
+        if let i16 = mesh.indices16 {
+            localIndices = i16.map { UInt32($0) }
+        } else if let i32 = mesh.indices32 {
+            localIndices = i32
+        } else {
+            localIndices = []
+        }
+        sourceTriangleCount = localIndices.count / 3
 
         let areaEps: Float = 1e-10
-        for e in entities {
-            guard let t = tStore[e], let m = mStore[e] else { continue }
-            let collisionMesh = m.collisionMesh ?? m.mesh
-            let baseVertex = positions.count
-            let localPositions = collisionMesh.streams.positions
-            positions.reserveCapacity(positions.count + localPositions.count)
-            for pLocal in localPositions {
-                let p = SIMD4<Float>(pLocal.x, pLocal.y, pLocal.z, 1)
-                let wp = simd_mul(t.modelMatrix, p)
-                positions.append(SIMD3<Float>(wp.x, wp.y, wp.z))
+        var indices: [UInt32] = []
+        var sourceTriangles: [Int32] = []
+        var triangleAABBs: [StaticTriMesh.AABB] = []
+        indices.reserveCapacity(localIndices.count)
+        sourceTriangles.reserveCapacity(sourceTriangleCount)
+        triangleAABBs.reserveCapacity(sourceTriangleCount)
+        var bmin = SIMD3<Float>(repeating: Float.greatestFiniteMagnitude)
+        var bmax = SIMD3<Float>(repeating: -Float.greatestFiniteMagnitude)
+        var tri = 0
+        while tri + 2 < localIndices.count {
+            let i0 = localIndices[tri]
+            let i1 = localIndices[tri + 1]
+            let i2 = localIndices[tri + 2]
+            defer { tri += 3 }
+            guard Int(max(i0, max(i1, i2))) < positions.count else { continue }
+            let p0 = positions[Int(i0)]
+            let p1 = positions[Int(i1)]
+            let p2 = positions[Int(i2)]
+            if simd_length_squared(simd_cross(p1 - p0, p2 - p0)) <= areaEps {
+                continue
             }
+            indices.append(i0)
+            indices.append(i1)
+            indices.append(i2)
+            sourceTriangles.append(Int32(tri / 3))
+            let minP = simd_min(p0, simd_min(p1, p2))
+            let maxP = simd_max(p0, simd_max(p1, p2))
+            triangleAABBs.append(StaticTriMesh.AABB(min: minP, max: maxP))
+            bmin = simd_min(bmin, minP)
+            bmax = simd_max(bmax, maxP)
+        }
+        self.indices = indices
+        self.sourceTriangles = sourceTriangles
+        self.triangleAABBs = triangleAABBs
+        self.bounds = StaticTriMesh.AABB(min: bmin, max: bmax)
+        self.bvh = triangleAABBs.isEmpty ? nil : StaticTriMesh.BVH(triangleAABBs: triangleAABBs)
+    }
+}
 
-            let localIndices: [UInt32]
-            if let i16 = collisionMesh.indices16 {
-                localIndices = i16.map { UInt32($0) }
-            } else if let i32 = collisionMesh.indices32 {
-                localIndices = i32
-            } else {
-                localIndices = []
+/// BLAS cache shared by the static and dynamic sets, the chunk cache, and successive
+/// rebuilds. Entries are weak, so a BLAS lives exactly as long as some instance uses it.
+/// Chunk builds use it from the build queue; `lock` guards `meshes` and `insertsSincePurge`.
+private nonisolated final class CollisionMeshLibrary: @unchecked Sendable {
+    private nonisolated final class Entry {
+        weak var mesh: CollisionMeshBLAS?
+
+        init(_ mesh: CollisionMeshBLAS) {
+            self.mesh = mesh
+        }
+    }
+
+    private var meshes: [CollisionMeshKey: Entry] = [:]
+    private let lock = NSLock()
+    /// Inserts since dead entries were last swept.
+    private var insertsSincePurge: Int = 0
+
+    func mesh(for descriptor: ProceduralMeshDescriptor) -> CollisionMeshBLAS {
+        let key = CollisionMeshKey(descriptor)
+        lock.lock()
+        if let existing = meshes[key]?.mesh {
+            lock.unlock()
+            return existing
+        }
+        lock.unlock()
+
+        // Build outside the lock; a concurrent build of the same mesh just loses the race.
+        let created = CollisionMeshBLAS(mesh: descriptor)
+        lock.lock()
+        defer { lock.unlock() }
+        if let raced = meshes[key]?.mesh {
+            return raced
+        }
+        meshes[key] = Entry(created)
+        insertsSincePurge += 1
+        if insertsSincePurge >= 256 {
+            meshes = meshes.filter { $0.value.mesh != nil }
+            insertsSincePurge = 0
+        }
+        return created
+    }
+}
+
+/// Conservative world/local box transform (center + |M| * extent), padded so rounding
+/// never culls a triangle touching the exact transformed bounds.
+private nonisolated func transformBounds(_ m: simd_float4x4,
+                             min bmin: SIMD3<Float>,
+                             max bmax: SIMD3<Float>) -> StaticTriMesh.AABB {
+    let c = (bmin + bmax) * 0.5
+    let e = (bmax - bmin) * 0.5
+    let c0 = SIMD3<Float>(m.columns.0.x, m.columns.0.y, m.columns.0.z)
+    let c1 = SIMD3<Float>(m.columns.1.x, m.columns.1.y, m.columns.1.z)
+    let c2 = SIMD3<Float>(m.columns.2.x, m.columns.2.y, m.columns.2.z)
+    let t = SIMD3<Float>(m.columns.3.x, m.columns.3.y, m.columns.3.z)
+    let center = c0 * c.x + c1 * c.y + c2 * c.z + t
+    var extent = simd_abs(c0) * e.x + simd_abs(c1) * e.y + simd_abs(c2) * e.z
+    extent += (simd_abs(center) + extent) * 1e-6 + SIMD3<Float>(repeating: 1e-6)
+    return StaticTriMesh.AABB(min: center - extent, max: center + extent)
+}
+
+/// Value inputs for one instance, gathered on the fixed-step thread so a set can be built
+/// from them on any thread.
+private nonisolated struct CollisionInstanceSource {
+    let entity: Entity
+    let component: StaticMeshComponent
+    let transform: simd_float4x4
+}
+
+/// One placed collision mesh in the TLAS.
+private nonisolated struct CollisionInstance {
+    let entity: Entity
+    let mesh: CollisionMeshBLAS
+    /// First global triangle index of this instance within its set.
+    let triangleBase: Int
+    let material: SurfaceMaterial
+    let triangleMaterials: [SurfaceMaterial]?
+    let layer: UInt32
+    private(set) var transform: simd_float4x4 = matrix_identity_float4x4
+    private(set) var inverse: simd_float4x4 = matrix_identity_float4x4
+    private(set) var isIdentity: Bool = true
+    /// Scale of `transform` when it is a rotation, uniform scale and translation, else 0.
+    /// Capsules keep their shape in such an instance's space, so capsule queries move into
+    /// it once instead of transforming every visited triangle out of it.
+    private(set) var uniformScale: Float = 1
+    private(set) var bounds: StaticTriMesh.AABB
+
+    init(entity: Entity,
+         mesh: CollisionMeshBLAS,
+         triangleBase: Int,
+         component: StaticMeshComponent,
+         transform: simd_float4x4) {
+        self.entity = entity
+        self.mesh = mesh
+        self.triangleBase = triangleBase
+        self.material = component.material
+        self.triangleMaterials = component.triangleMaterials
+        self.layer = component.collisionLayer
+        self.bounds = mesh.bounds
+        setTransform(transform)
+    }
+
+    mutating func setTransform(_ m: simd_float4x4) {
+        transform = m
+        inverse = m.inverse
+        isIdentity = m == matrix_identity_float4x4
+        uniformScale = isIdentity ? 1 : CollisionInstance.similarityScale(m)
+        bounds = isIdentity ? mesh.bounds : transformBounds(m, min: mesh.bounds.min, max: mesh.bounds.max)
+    }
+
+    private static func similarityScale(_ m: simd_float4x4) -> Float {
+        let c0 = SIMD3<Float>(m.columns.0.x, m.columns.0.y, m.columns.0.z)
+        let c1 = SIMD3<Float>(m.columns.1.x, m.columns.1.y, m.columns.1.z)
+        let c2 = SIMD3<Float>(m.columns.2.x, m.columns.2.y, m.columns.2.z)
+        let s = simd_length(c0)
+        let tol: Float = 1e-4
+        guard s > 1e-8,
+              abs(simd_length(c1) - s) <= tol * s,
+              abs(simd_length(c2) - s) <= tol * s,
+              abs(simd_dot(c0, c1)) <= tol * s * s,
+              abs(simd_dot(c1, c2)) <= tol * s * s,
+              abs(simd_dot(c2, c0)) <= tol * s * s else {
+            return 0
+        }
+        return s
+    }
+
+    @inline(__always)
+    func worldPoint(_ p: SIMD3<Float>) -> SIMD3<Float> {
+        let wp = simd_mul(transform, SIMD4<Float>(p.x, p.y, p.z, 1))
+        return SIMD3<Float>(wp.x, wp.y, wp.z)
+    }
+
+    @inline(__always)
+    func localPoint(_ p: SIMD3<Float>) -> SIMD3<Float> {
+        let lp = simd_mul(inverse, SIMD4<Float>(p.x, p.y, p.z, 1))
+        return SIMD3<Float>(lp.x, lp.y, lp.z)
+    }
+
+    @inline(__always)
+    func localVector(_ v: SIMD3<Float>) -> SIMD3<Float> {
+        let lv = simd_mul(inverse, SIMD4<Float>(v.x, v.y, v.z, 0))
+        return SIMD3<Float>(lv.x, lv.y, lv.z)
+    }
+
+    /// Local-space normal or direction to world space (inverse transpose), normalized.
+    @inline(__always)
+    func worldNormal(_ n: SIMD3<Float>) -> SIMD3<Float> {
+        if isIdentity { return n }
+        let c0 = inverse.columns.0
+        let c1 = inverse.columns.1
+        let c2 = inverse.columns.2
+        return simd_normalize(SIMD3<Float>(c0.x * n.x + c0.y * n.y + c0.z * n.z,
+                                           c1.x * n.x + c1.y * n.y + c1.z * n.z,
+                                           c2.x * n.x + c2.y * n.y + c2.z * n.z))
+    }
+
+    func localBounds(worldMin: SIMD3<Float>, worldMax: SIMD3<Float>) -> StaticTriMesh.AABB {
+        isIdentity
+            ? StaticTriMesh.AABB(min: worldMin, max: worldMax)
+            : transformBounds(inverse, min: worldMin, max: worldMax)
+    }
+
+    func materialForTriangle(_ localTriangle: Int) -> SurfaceMaterial {
+        if let perTri = triangleMaterials,
+           perTri.count == mesh.sourceTriangleCount,
+           localTriangle >= 0 && localTriangle < mesh.sourceTriangles.count {
+            return perTri[Int(mesh.sourceTriangles[localTriangle])]
+        }
+        return material
+    }
+
+    /// Gathers a BLAS leaf's triangles into SIMD packets: as stored when `local`, else
+    /// transformed to world space, with `offset` placing the owning set (non-zero for
+    /// chunk sets).
+    func gatherPackets(leaf: StaticTriMesh.BVHNode,
+                       bvh: StaticTriMesh.BVH,
+                       offset: SIMD3<Float>,
+                       local: Bool,
+                       into packets: inout [TrianglePacket4]) {
+        let shifted = !local && offset != SIMD3<Float>(repeating: 0)
+        packets.removeAll(keepingCapacity: true)
+        let start = Int(leaf.offset)
+        var packet = TrianglePacket4()
+        var lane = 0
+        for i in start..<(start + Int(leaf.count)) {
+            let local = Int(bvh.triOrder[i])
+            let base = local * 3
+            var v0 = mesh.positions[Int(mesh.indices[base])]
+            var v1 = mesh.positions[Int(mesh.indices[base + 1])]
+            var v2 = mesh.positions[Int(mesh.indices[base + 2])]
+            if !local && !isIdentity {
+                v0 = worldPoint(v0)
+                v1 = worldPoint(v1)
+                v2 = worldPoint(v2)
+            }
+            if shifted {
+                v0 += offset
+                v1 += offset
+                v2 += offset
             }
+            packet.set(lane: lane, triangle: local, v0: v0, v1: v1, v2: v2)
+            lane += 1
+            if lane == 4 {
+                packets.append(packet)
+                packet = TrianglePacket4()
+                lane = 0
+            }
+        }
+        if lane > 0 {
+            packets.append(packet)
+        }
+    }
+}
+
+@inline(__always)
+private nonisolated func laneBits(_ mask: SIMDMask<SIMD8<Int32>>) -> UInt32 {
+    var bits: UInt32 = 0
+    for k in 0..<8 where mask[k] {
+        bits |= 1 << UInt32(k)
+    }
+    return bits
+}
 
-            let triCount = localIndices.count / 3
-            let triSource: [SurfaceMaterial]
-            if let perTri = m.triangleMaterials, perTri.count == triCount {
-                triSource = perTri
+/// Eight query lanes of 3D vectors in SoA form.
+private nonisolated struct Lanes3 {
+    var x = SIMD8<Float>()
+    var y = SIMD8<Float>()
+    var z = SIMD8<Float>()
+
+    subscript(_ k: Int) -> SIMD3<Float> {
+        get { SIMD3<Float>(x[k], y[k], z[k]) }
+        set {
+            x[k] = newValue.x
+            y[k] = newValue.y
+            z[k] = newValue.z
+        }
+    }
+}
+
+/// Node and instance tests for up to eight queries walking a `TriangleMeshSet` together.
+/// Lanes are bits of a UInt32; `entry` only orders traversal (nearer child first).
+/// Non-local tests run in set space: world space minus the set's offset.
+private nonisolated protocol CollisionVisitor {
+    func test(_ node: StaticTriMesh.BVHNode, lanes: UInt32, local: Bool) -> (lanes: UInt32, entry: Float)
+    /// Moves the lanes into the space of a set placed at `offset`.
+    mutating func enterSet(offset: SIMD3<Float>)
+    /// Lanes of a popped stack entry still worth visiting given results so far.
+    func prune(_ lanes: UInt32, entry: Float) -> UInt32
+    /// Moves the lanes into `instance`'s local space; returns lanes that can hit its layer.
+    mutating func enter(_ instance: CollisionInstance, lanes: UInt32) -> UInt32
+    /// Whether leaves of `instance` are tested against its local-space triangles (with the
+    /// query moved by `enter`) rather than world-space copies.
+    func testsLocalTriangles(_ instance: CollisionInstance) -> Bool
+}
+
+private nonisolated struct RayLanes: CollisionVisitor {
+    var origin = Lanes3()
+    var direction = Lanes3()
+    var invDir = Lanes3()
+    var setOrigin = Lanes3()
+    var localOrigin = Lanes3()
+    var localDirection = Lanes3()
+    var localInvDir = Lanes3()
+    var masks = SIMD8<UInt32>()
+    /// Closest hit distance per lane; shrinks as hits are found.
+    var closest = SIMD8<Float>(repeating: 0)
+
+    static func inverse(_ d: SIMD3<Float>) -> SIMD3<Float> {
+        SIMD3<Float>(d.x != 0 ? 1.0 / d.x : Float.greatestFiniteMagnitude,
+                     d.y != 0 ? 1.0 / d.y : Float.greatestFiniteMagnitude,
+                     d.z != 0 ? 1.0 / d.z : Float.greatestFiniteMagnitude)
+    }
+
+    mutating func set(lane k: Int, _ ray: RayQuery) {
+        origin[k] = ray.origin
+        direction[k] = ray.direction
+        invDir[k] = RayLanes.inverse(ray.direction)
+        masks[k] = ray.mask
+        closest[k] = ray.maxDistance
+    }
+
+    func test(_ node: StaticTriMesh.BVHNode, lanes: UInt32, local: Bool) -> (lanes: UInt32, entry: Float) {
+        let o = local ? localOrigin : setOrigin
+        let inv = local ? localInvDir : invDir
+        let t0x = (node.minX - o.x) * inv.x
+        let t1x = (node.maxX - o.x) * inv.x
+        let t0y = (node.minY - o.y) * inv.y
+        let t1y = (node.maxY - o.y) * inv.y
+        let t0z = (node.minZ - o.z) * inv.z
+        let t1z = (node.maxZ - o.z) * inv.z
+        let tmin = pointwiseMax(pointwiseMax(pointwiseMin(t0x, t1x), pointwiseMin(t0y, t1y)), pointwiseMin(t0z, t1z))
+        let tmax = pointwiseMin(pointwiseMin(pointwiseMax(t0x, t1x), pointwiseMax(t0y, t1y)), pointwiseMax(t0z, t1z))
+        let hit = (tmax .>= tmin) .& (tmax .>= 0) .& (tmin .<= closest)
+        let bits = laneBits(hit) & lanes
+        if bits == 0 { return (0, Float.infinity) }
+        return (bits, tmin.replacing(with: Float.infinity, where: .!hit).min())
+    }
+
+    func prune(_ lanes: UInt32, entry: Float) -> UInt32 {
+        laneBits(closest .>= entry) & lanes
+    }
+
+    mutating func enterSet(offset: SIMD3<Float>) {
+        setOrigin.x = origin.x - offset.x
+        setOrigin.y = origin.y - offset.y
+        setOrigin.z = origin.z - offset.z
+    }
+
+    mutating func enter(_ instance: CollisionInstance, lanes: UInt32) -> UInt32 {
+        let live = laneBits((masks & SIMD8<UInt32>(repeating: instance.layer)) .!= 0) & lanes
+        var bits = live
+        while bits != 0 {
+            let k = bits.trailingZeroBitCount
+            bits &= bits - 1
+            if instance.isIdentity {
+                localOrigin[k] = setOrigin[k]
+                localDirection[k] = direction[k]
+                localInvDir[k] = invDir[k]
             } else {
-                triSource = Array(repeating: m.material, count: triCount)
-            }
-            let triLayer = m.collisionLayer
-
-            let indexStart = indices.count
-            let triStart = triangleAABBs.count
-            var tri = 0
-            var triLocal = 0
-            while tri + 2 < localIndices.count {
-                let i0 = Int(UInt32(baseVertex) + localIndices[tri])
-                let i1 = Int(UInt32(baseVertex) + localIndices[tri + 1])
-                let i2 = Int(UInt32(baseVertex) + localIndices[tri + 2])
-                let p0 = positions[i0]
-                let p1 = positions[i1]
-                let p2 = positions[i2]
-                let e1 = p1 - p0
-                let e2 = p2 - p0
-                if simd_length_squared(simd_cross(e1, e2)) <= areaEps {
-                    tri += 3
-                    triLocal += 1
-                    continue
-                }
-                indices.append(UInt32(i0))
-                indices.append(UInt32(i1))
-                indices.append(UInt32(i2))
-                let minP = simd_min(p0, simd_min(p1, p2))
-                let maxP = simd_max(p0, simd_max(p1, p2))
-                triangleAABBs.append(StaticTriMesh.AABB(min: minP, max: maxP))
-                triangleMaterials.append(triSource[triLocal])
-                triangleLayers.append(triLayer)
-                tri += 3
-                triLocal += 1
+                // Affine map with an unnormalized direction keeps t identical in both spaces.
+                localOrigin[k] = instance.localPoint(setOrigin[k])
+                localDirection[k] = instance.localVector(direction[k])
+                localInvDir[k] = RayLanes.inverse(localDirection[k])
             }
+        }
+        return live
+    }
 
-            let indexEnd = indices.count
-            let triEnd = triangleAABBs.count
-            if indexEnd > indexStart && triEnd > triStart {
-                slices[e] = StaticTriMesh.MeshSlice(entity: e,
-                                                    vertexRange: baseVertex..<positions.count,
-                                                    indexRange: indexStart..<indexEnd,
-                                                    triangleRange: triStart..<triEnd)
+    func testsLocalTriangles(_ instance: CollisionInstance) -> Bool {
+        true
+    }
+}
+
+/// Box-vs-tree lanes for capsule sweeps and overlaps (the swept or static capsule bounds).
+/// Entering an instance that keeps the capsule's shape also moves the capsule itself
+/// (center, half segment and sweep) into its space.
+private nonisolated struct BoxLanes: CollisionVisitor {
+    var worldMin = Lanes3()
+    var worldMax = Lanes3()
+    var setMin = Lanes3()
+    var setMax = Lanes3()
+    var localMin = Lanes3()
+    var localMax = Lanes3()
+    var masks = SIMD8<UInt32>()
+    var from = Lanes3()
+    var axis = Lanes3()
+    var delta = Lanes3()
+    var setOffset = SIMD3<Float>(repeating: 0)
+    var localFrom = Lanes3()
+    var localAxis = Lanes3()
+    var localDelta = Lanes3()
+
+    /// `axis` is the capsule's half segment (+y * halfHeight); `delta` is zero for overlaps.
+    mutating func set(lane k: Int,
+                      min: SIMD3<Float>,
+                      max: SIMD3<Float>,
+                      mask: UInt32,
+                      from center: SIMD3<Float>,
+                      axis halfSegment: SIMD3<Float>,
+                      delta sweep: SIMD3<Float>) {
+        worldMin[k] = min
+        worldMax[k] = max
+        masks[k] = mask
+        from[k] = center
+        axis[k] = halfSegment
+        delta[k] = sweep
+    }
+
+    func test(_ node: StaticTriMesh.BVHNode, lanes: UInt32, local: Bool) -> (lanes: UInt32, entry: Float) {
+        let lo = local ? localMin : setMin
+        let hi = local ? localMax : setMax
+        let hit = (hi.x .>= node.minX) .& (lo.x .<= node.maxX)
+            .& (hi.y .>= node.minY) .& (lo.y .<= node.maxY)
+            .& (hi.z .>= node.minZ) .& (lo.z .<= node.maxZ)
+        return (laneBits(hit) & lanes, 0)
+    }
+
+    func prune(_ lanes: UInt32, entry: Float) -> UInt32 {
+        lanes
+    }
+
+    mutating func enterSet(offset: SIMD3<Float>) {
+        setOffset = offset
+        setMin.x = worldMin.x - offset.x
+        setMin.y = worldMin.y - offset.y
+        setMin.z = worldMin.z - offset.z
+        setMax.x = worldMax.x - offset.x
+        setMax.y = worldMax.y - offset.y
+        setMax.z = worldMax.z - offset.z
+    }
+
+    mutating func enter(_ instance: CollisionInstance, lanes: UInt32) -> UInt32 {
+        let live = laneBits((masks & SIMD8<UInt32>(repeating: instance.layer)) .!= 0) & lanes
+        var bits = live
+        while bits != 0 {
+            let k = bits.trailingZeroBitCount
+            bits &= bits - 1
+            let local = instance.localBounds(worldMin: setMin[k], worldMax: setMax[k])
+            localMin[k] = local.min
+            localMax[k] = local.max
+            if instance.isIdentity {
+                localFrom[k] = from[k] - setOffset
+                localAxis[k] = axis[k]
+                localDelta[k] = delta[k]
+            } else if instance.uniformScale > 0 {
+                localFrom[k] = instance.localPoint(from[k] - setOffset)
+                localAxis[k] = instance.localVector(axis[k])
+                localDelta[k] = instance.localVector(delta[k])
             }
         }
+        return live
+    }
 
-        if triangleAABBs.isEmpty {
-            bvh = nil
-        } else {
-            bvh = StaticTriMesh.BVH(triangleAABBs: triangleAABBs)
+    func testsLocalTriangles(_ instance: CollisionInstance) -> Bool {
+        instance.uniformScale > 0
+    }
+}
+
+/// Two-level collision set: a TLAS over instance world bounds, each instance pointing at a
+/// shared local-space BLAS. Moving an instance refits the TLAS only. Building from gathered
+/// sources and walking need no actor, so chunk sets build on the chunk cache's queue.
+private nonisolated struct TriangleMeshSet {
+    var instances: [CollisionInstance] = []
+    var instanceBounds: [StaticTriMesh.AABB] = []
+    var instanceByEntity: [Entity: Int] = [:]
+    var tlas: StaticTriMesh.BVH? = nil
+    private(set) var triangleCount: Int = 0
+
+    var hasTriangles: Bool { triangleCount > 0 }
+
+    private struct StackEntry {
+        var node: Int
+        var lanes: UInt32
+        var entry: Float
+    }
+
+    @MainActor
+    mutating func rebuild(entities: [Entity],
+                          tStore: ComponentStore<TransformComponent>,
+                          mStore: ComponentStore<StaticMeshComponent>,
+                          library: CollisionMeshLibrary) {
+        var sources: [CollisionInstanceSource] = []
+        sources.reserveCapacity(entities.count)
+        for e in entities {
+            guard let t = tStore[e], let m = mStore[e] else { continue }
+            sources.append(CollisionInstanceSource(entity: e, component: m, transform: t.modelMatrix))
         }
+        rebuild(sources: sources, library: library)
+    }
+
+    mutating func rebuild(sources: [CollisionInstanceSource], library: CollisionMeshLibrary) {
+        instances.removeAll(keepingCapacity: true)
+        instanceBounds.removeAll(keepingCapacity: true)
+        instanceByEntity.removeAll(keepingCapacity: true)
+        triangleCount = 0
+
+        for source in sources {
+            let m = source.component
+            let mesh = library.mesh(for: m.collisionMesh ?? m.mesh)
+            guard mesh.triangleCount > 0 else { continue }
+            let instance = CollisionInstance(entity: source.entity,
+                                             mesh: mesh,
+                                             triangleBase: triangleCount,
+                                             component: m,
+                                             transform: source.transform)
+            instanceByEntity[source.entity] = instances.count
+            instances.append(instance)
+            instanceBounds.append(instance.bounds)
+            triangleCount += mesh.triangleCount
+        }
+
+        tlas = instanceBounds.isEmpty ? nil : StaticTriMesh.BVH(triangleAABBs: instanceBounds)
     }
 
+    @MainActor
     mutating func updateTransforms(entities: [Entity],
-                                   tStore: ComponentStore<TransformComponent>,
-                                   mStore: ComponentStore<StaticMeshComponent>) -> [Int] {
-        guard !entities.isEmpty, !triangleAABBs.isEmpty else { return [] }
-        var updatedTriangles: [Int] = []
-        updatedTriangles.reserveCapacity(entities.count * 16)
-
+                                   tStore: ComponentStore<TransformComponent>) {
+        guard !entities.isEmpty, !instances.isEmpty else { return }
+        var updated: [Int] = []
+        updated.reserveCapacity(entities.count)
         for e in entities {
-            guard let slice = slices[e], let t = tStore[e], let m = mStore[e] else { continue }
-            let collisionMesh = m.collisionMesh ?? m.mesh
-            let localPositions = collisionMesh.streams.positions
-            if localPositions.count != slice.vertexRange.count {
+            guard let index = instanceByEntity[e], let t = tStore[e] else { continue }
+            instances[index].setTransform(t.modelMatrix)
+            instanceBounds[index] = instances[index].bounds
+            updated.append(index)
+        }
+        if !updated.isEmpty {
+            tlas?.refit(updatedTriangles: updated, triangleAABBs: instanceBounds)
+        }
+    }
+
+    /// Walks TLAS then each reached instance's BLAS. `leaf` receives the triangle packets of
+    /// one BLAS leaf, in the space `testsLocalTriangles` picks, and returns the lanes that
+    /// still want more triangles.
+    /// `offset` is where the set's origin sits in query space.
+    func walk<V: CollisionVisitor>(_ visitor: inout V,
+                                   lanes: UInt32,
+                                   offset: SIMD3<Float> = SIMD3<Float>(repeating: 0),
+                                   leaf: (inout V, CollisionInstance, [TrianglePacket4], UInt32) -> UInt32) {
+        guard let tlas, tlas.root >= 0, lanes != 0 else { return }
+        visitor.enterSet(offset: offset)
+        var live = lanes
+        let root = visitor.test(tlas.nodes[tlas.root], lanes: live, local: false)
+        if root.lanes == 0 { return }
+        var stack: [StackEntry] = [StackEntry(node: tlas.root, lanes: root.lanes, entry: root.entry)]
+        var blasStack: [StackEntry] = []
+        var packets: [TrianglePacket4] = []
+
+        while let top = stack.popLast() {
+            let topLanes = visitor.prune(top.lanes & live, entry: top.entry)
+            if topLanes == 0 { continue }
+            let node = tlas.nodes[top.node]
+            if !node.isLeaf {
+                TriangleMeshSet.pushChildren(tlas, parent: top.node, lanes: topLanes, local: false,
+                                             visitor: visitor, stack: &stack)
                 continue
             }
-            for i in 0..<localPositions.count {
-                let pLocal = localPositions[i]
-                let p = SIMD4<Float>(pLocal.x, pLocal.y, pLocal.z, 1)
-                let wp = simd_mul(t.modelMatrix, p)
-                positions[slice.vertexRange.lowerBound + i] = SIMD3<Float>(wp.x, wp.y, wp.z)
+
+            let start = Int(node.offset)
+            for slot in start..<(start + Int(node.count)) {
+                let instance = instances[Int(tlas.triOrder[slot])]
+                let bounds = StaticTriMesh.BVHNode(bounds: instance.bounds, offset: 0, count: 0)
+                var instLanes = visitor.test(bounds, lanes: topLanes & live, local: false).lanes
+                if instLanes == 0 { continue }
+                instLanes = visitor.enter(instance, lanes: instLanes)
+                guard instLanes != 0, let blas = instance.mesh.bvh, blas.root >= 0 else { continue }
+                let blasRoot = visitor.test(blas.nodes[blas.root], lanes: instLanes, local: true)
+                if blasRoot.lanes == 0 { continue }
+
+                blasStack.removeAll(keepingCapacity: true)
+                blasStack.append(StackEntry(node: blas.root, lanes: blasRoot.lanes, entry: blasRoot.entry))
+                while let blasTop = blasStack.popLast() {
+                    let blasLanes = visitor.prune(blasTop.lanes & live, entry: blasTop.entry)
+                    if blasLanes == 0 { continue }
+                    let blasNode = blas.nodes[blasTop.node]
+                    if !blasNode.isLeaf {
+                        TriangleMeshSet.pushChildren(blas, parent: blasTop.node, lanes: blasLanes, local: true,
+                                                     visitor: visitor, stack: &blasStack)
+                        continue
+                    }
+                    instance.gatherPackets(leaf: blasNode,
+                                           bvh: blas,
+                                           offset: offset,
+                                           local: visitor.testsLocalTriangles(instance),
+                                           into: &packets)
+                    let remaining = leaf(&visitor, instance, packets, blasLanes)
+                    live &= ~(blasLanes & ~remaining)
+                    if live == 0 { return }
+                }
             }
+        }
+    }
 
-            var triIndex = slice.triangleRange.lowerBound
-            var i = slice.indexRange.lowerBound
-            while i + 2 < slice.indexRange.upperBound {
-                let i0 = Int(indices[i])
-                let i1 = Int(indices[i + 1])
-                let i2 = Int(indices[i + 2])
-                let p0 = positions[i0]
-                let p1 = positions[i1]
-                let p2 = positions[i2]
-                let minP = simd_min(p0, simd_min(p1, p2))
-                let maxP = simd_max(p0, simd_max(p1, p2))
-                triangleAABBs[triIndex] = StaticTriMesh.AABB(min: minP, max: maxP)
-                updatedTriangles.append(triIndex)
-                i += 3
-                triIndex += 1
+    /// Tests both children and pushes the farther one first so the nearer is visited next.
+    private static func pushChildren<V: CollisionVisitor>(_ tree: StaticTriMesh.BVH,
+                                                          parent: Int,
+                                                          lanes: UInt32,
+                                                          local: Bool,
+                                                          visitor: V,
+                                                          stack: inout [StackEntry]) {
+        let left = parent + 1
+        let right = Int(tree.nodes[parent].offset)
+        let l = visitor.test(tree.nodes[left], lanes: lanes, local: local)
+        let r = visitor.test(tree.nodes[right], lanes: lanes, local: local)
+        if l.lanes != 0 && r.lanes != 0 {
+            if l.entry <= r.entry {
+                stack.append(StackEntry(node: right, lanes: r.lanes, entry: r.entry))
+                stack.append(StackEntry(node: left, lanes: l.lanes, entry: l.entry))
+            } else {
+                stack.append(StackEntry(node: left, lanes: l.lanes, entry: l.entry))
+                stack.append(StackEntry(node: right, lanes: r.lanes, entry: r.entry))
             }
+        } else if l.lanes != 0 {
+            stack.append(StackEntry(node: left, lanes: l.lanes, entry: l.entry))
+        } else if r.lanes != 0 {
+            stack.append(StackEntry(node: right, lanes: r.lanes, entry: r.entry))
         }
+    }
+}
+
+// MARK: - Chunk Collision
 
-        if !updatedTriangles.isEmpty {
-            bvh?.refit(updatedTriangles: updatedTriangles, triangleAABBs: triangleAABBs)
+/// One chunked static as it enters its chunk's signature.
+private nonisolated struct CollisionChunkSource {
+    let entity: Entity
+    /// Placement, mesh and layer (`CollisionChunkCache.contentHash`).
+    let content: Int
+    /// The StaticMeshComponent's write stamp, so in-place mesh edits rebuild the chunk.
+    let stamp: UInt64
+}
+
+/// Summary of one chunk's collision content: its sources sorted by entity and folded with
+/// FNV-1a, so it does not depend on view order and, unlike a sum of per-source hashes,
+/// different source sets do not cancel into the same value.
+private nonisolated struct CollisionChunkSignature: Equatable {
+    var count: Int = 0
+    var digest: UInt64 = 0xCBF2_9CE4_8422_2325
+
+    init(sources: inout [CollisionChunkSource]) {
+        sources.sort { $0.entity.id < $1.entity.id }
+        count = sources.count
+        for source in sources {
+            mix(UInt64(source.entity.id))
+            mix(UInt64(bitPattern: Int64(source.content)))
+            mix(source.stamp)
         }
-        return updatedTriangles
     }
 
-    func materialForTriangle(_ triangleIndex: Int) -> SurfaceMaterial {
-        if triangleIndex >= 0 && triangleIndex < triangleMaterials.count {
-            return triangleMaterials[triangleIndex]
+    private mutating func mix(_ value: UInt64) {
+        var v = value
+        for _ in 0..<8 {
+            digest = (digest ^ (v & 0xFF)) &* 0x0000_0100_0000_01B3
+            v >>= 8
         }
-        return .default
     }
 }
 
-public struct StaticTriMesh {
-    private static let leafTriangleLimit: Int = 4
+/// Collision for the chunked statics of one world chunk, built in chunk-local space
+/// (translation = `WorldPositionComponent.local`) so origin rebases never invalidate it.
+/// Queries place it with a per-chunk offset instead. Immutable once built, so it is built on
+/// the chunk cache's queue and handed back to the fixed-step thread as is.
+public nonisolated final class CollisionChunk: Sendable {
+    public let coord: SIMD3<Int64>
+    fileprivate let signature: CollisionChunkSignature
+    fileprivate let set: TriangleMeshSet
+
+    public var triangleCount: Int { set.triangleCount }
+
+    fileprivate init(coord: SIMD3<Int64>,
+                     signature: CollisionChunkSignature,
+                     sources: [CollisionInstanceSource],
+                     library: CollisionMeshLibrary) {
+        self.coord = coord
+        self.signature = signature
+        var set = TriangleMeshSet()
+        set.rebuild(sources: sources, library: library)
+        self.set = set
+    }
+
+    /// Chunk origin relative to the physics origin.
+    @MainActor
+    fileprivate func offset(originWorld: SIMD3<Double>) -> SIMD3<Float> {
+        let o = WorldPosition.toWorld(chunk: coord, local: SIMD3<Double>(0, 0, 0)) - originWorld
+        return SIMD3<Float>(Float(o.x), Float(o.y), Float(o.z))
+    }
+}
+
+/// Chunks finished on the build queue, waiting for the next `CollisionChunkCache.update`.
+/// Separate from the cache so a build in flight never keeps the cache alive or releases it
+/// on the queue; `lock` guards `finished`.
+private nonisolated final class CollisionChunkInbox: @unchecked Sendable {
+    private let lock = NSLock()
+    private var finished: [(ticket: Int, chunk: CollisionChunk)] = []
+
+    func post(ticket: Int, chunk: CollisionChunk) {
+        lock.lock()
+        finished.append((ticket, chunk))
+        lock.unlock()
+    }
+
+    func take() -> [(ticket: Int, chunk: CollisionChunk)] {
+        lock.lock()
+        defer { lock.unlock() }
+        let landed = finished
+        finished.removeAll()
+        return landed
+    }
+}
+
+/// Per-chunk collision streamed with the active chunk set. Chunked statics are grouped by
+/// chunk and a chunk is rebuilt only when its content signature changes, so crossing a
+/// chunk border reuses every chunk already built. Chunks stay cached one ring past the
+/// active radius so walking back and forth over a border does not rebuild either.
+public final class CollisionChunkCache {
+    /// Build chunks beyond `syncRadius` on a background queue. Until a build lands, the
+    /// chunk's previous build (if any) stays in use.
+    public var asyncBuilds: Bool = true
+    /// Chunks this close to the center (Chebyshev distance) are built before they are used.
+    public var syncRadius: Int = 1
+
+    private struct PendingBuild {
+        let signature: CollisionChunkSignature
+        /// Only the latest build scheduled for a chunk is accepted when it lands.
+        let ticket: Int
+    }
+
+    private var chunks: [SIMD3<Int64>: CollisionChunk] = [:]
+    private var pending: [SIMD3<Int64>: PendingBuild] = [:]
+    private var nextTicket: Int = 0
+    private var signatures: [SIMD3<Int64>: CollisionChunkSignature] = [:]
+    private var chunkSources: [SIMD3<Int64>: [CollisionChunkSource]] = [:]
+    private var attached: [ObjectIdentifier] = []
+    private let library = CollisionMeshLibrary()
+    private let buildQueue = DispatchQueue(label: "CollisionChunkCache.build", qos: .userInitiated)
+    private let inbox = CollisionChunkInbox()
+
+    public init() {}
+
+    /// Statics streamed per chunk: placed by a WorldPositionComponent and not moved by physics.
+    public static func isChunked(_ e: Entity,
+                                 wStore: ComponentStore<WorldPositionComponent>,
+                                 pStore: ComponentStore<PhysicsBodyComponent>) -> Bool {
+        guard wStore.contains(e) else { return false }
+        if let body = pStore[e] {
+            return body.bodyType == .static
+        }
+        return true
+    }
 
-    public struct AABB {
+    /// Built chunks within `radius` of `center` that have collision, in coordinate order.
+    /// `changed` is false when the list is identical to the previous call's.
+    public func update(world: World,
+                       center: SIMD3<Int64>,
+                       radius: Int) -> (chunks: [CollisionChunk], changed: Bool) {
+        let tStore = world.store(TransformComponent.self)
+        let mStore = world.store(StaticMeshComponent.self)
+        let wStore = world.store(WorldPositionComponent.self)
+        let pStore = world.store(PhysicsBodyComponent.self)
+        let reach = Int64(max(radius, 0))
+
+        for build in inbox.take() where pending[build.chunk.coord]?.ticket == build.ticket {
+            pending[build.chunk.coord] = nil
+            chunks[build.chunk.coord] = build.chunk
+        }
+
+        chunkSources.removeAll(keepingCapacity: true)
+        for e in world.view(StaticMeshComponent.self, WorldPositionComponent.self, TransformComponent.self) {
+            guard let m = mStore[e], m.collides,
+                  let w = wStore[e], let t = tStore[e],
+                  CollisionChunkCache.isChunked(e, wStore: wStore, pStore: pStore),
+                  CollisionChunkCache.distance(w.chunk, center) <= reach else { continue }
+            chunkSources[w.chunk, default: []].append(CollisionChunkSource(entity: e,
+                                                                           content: CollisionChunkCache.contentHash(e, w, t, m),
+                                                                           stamp: mStore.stamp(e)))
+        }
+        signatures.removeAll(keepingCapacity: true)
+        for (coord, var sources) in chunkSources {
+            signatures[coord] = CollisionChunkSignature(sources: &sources)
+        }
+
+        // Nothing built yet (first update or after a reset): build everything inline.
+        let warm = !chunks.isEmpty || !pending.isEmpty
+        var builds: [SIMD3<Int64>: [CollisionInstanceSource]] = [:]
+        for (coord, signature) in signatures {
+            if chunks[coord]?.signature == signature || pending[coord]?.signature == signature {
+                continue
+            }
+            builds[coord] = []
+        }
+        if !builds.isEmpty {
+            gatherSources(world: world, into: &builds, tStore: tStore, mStore: mStore, wStore: wStore, pStore: pStore)
+        }
+        for (coord, sources) in builds {
+            let signature = signatures[coord]!
+            if !asyncBuilds || !warm || CollisionChunkCache.distance(coord, center) <= Int64(syncRadius) {
+                chunks[coord] = CollisionChunk(coord: coord, signature: signature, sources: sources, library: library)
+                pending[coord] = nil
+            } else {
+                nextTicket += 1
+                pending[coord] = PendingBuild(signature: signature, ticket: nextTicket)
+                schedule(coord: coord, signature: signature, ticket: nextTicket, sources: sources)
+            }
+        }
+
+        chunks = chunks.filter { coord, _ in
+            let d = CollisionChunkCache.distance(coord, center)
+            return d > reach ? d <= reach + 1 : signatures[coord] != nil
+        }
+        pending = pending.filter { coord, _ in signatures[coord] != nil }
+
+        var ready: [CollisionChunk] = []
+        ready.reserveCapacity(signatures.count)
+        for coord in signatures.keys {
+            if let chunk = chunks[coord] {
+                ready.append(chunk)
+            }
+        }
+        ready.sort { ($0.coord.x, $0.coord.y, $0.coord.z) < ($1.coord.x, $1.coord.y, $1.coord.z) }
+        let ids = ready.map { ObjectIdentifier($0) }
+        let changed = ids != attached
+        attached = ids
+        return (ready, changed)
+    }
+
+    /// Drops every cached chunk; builds in flight are discarded when they land.
+    public func removeAll() {
+        chunks.removeAll()
+        pending.removeAll()
+        attached.removeAll()
+    }
+
+    private func gatherSources(world: World,
+                               into builds: inout [SIMD3<Int64>: [CollisionInstanceSource]],
+                               tStore: ComponentStore<TransformComponent>,
+                               mStore: ComponentStore<StaticMeshComponent>,
+                               wStore: ComponentStore<WorldPositionComponent>,
+                               pStore: ComponentStore<PhysicsBodyComponent>) {
+        for e in world.view(StaticMeshComponent.self, WorldPositionComponent.self, TransformComponent.self) {
+            guard let m = mStore[e], m.collides,
+                  let w = wStore[e], var t = tStore[e],
+                  builds[w.chunk] != nil,
+                  CollisionChunkCache.isChunked(e, wStore: wStore, pStore: pStore) else { continue }
+            t.translation = SIMD3<Float>(Float(w.local.x), Float(w.local.y), Float(w.local.z))
+            builds[w.chunk]?.append(CollisionInstanceSource(entity: e, component: m, transform: t.modelMatrix))
+        }
+    }
+
+    private func schedule(coord: SIMD3<Int64>,
+                          signature: CollisionChunkSignature,
+                          ticket: Int,
+                          sources: [CollisionInstanceSource]) {
+        let library = self.library
+        let inbox = self.inbox
+        buildQueue.async { @Sendable in
+            inbox.post(ticket: ticket,
+                       chunk: CollisionChunk(coord: coord, signature: signature, sources: sources, library: library))
+        }
+    }
+
+    private static func contentHash(_ e: Entity,
+                                    _ w: WorldPositionComponent,
+                                    _ t: TransformComponent,
+                                    _ m: StaticMeshComponent) -> Int {
+        var h = Hasher()
+        h.combine(e)
+        h.combine(w.local)
+        h.combine(t.rotation.vector)
+        h.combine(t.scale)
+        h.combine(CollisionMeshKey(m.collisionMesh ?? m.mesh))
+        h.combine(m.collisionLayer)
+        return h.finalize()
+    }
+
+    private static func distance(_ a: SIMD3<Int64>, _ b: SIMD3<Int64>) -> Int64 {
+        max(abs(a.x - b.x), max(abs(a.y - b.y), abs(a.z - b.z)))
+    }
+}
+
+public nonisolated struct StaticTriMesh {
+    /// Nodes at or below this size always become leaves.
+    private static let leafTriangleLimit: Int = 4
+    /// SAH may stop splitting early up to this size when a split doesn't pay off.
+    private static let maxLeafTriangles: Int = 8
+    private static let sahBinCount: Int = 12
+    /// Node visit cost relative to one triangle test.
+    private static let sahTraversalCost: Float = 0.125
+    /// Queries that share one BVH walk in the batched entry points (bits of a UInt32 mask).
+    private static let queryPacketSize: Int = 8
+
+    public nonisolated struct AABB: Sendable {
         public var min: SIMD3<Float>
         public var max: SIMD3<Float>
     }
 
-    fileprivate struct MeshSlice {
-        let entity: Entity
-        let vertexRange: Range<Int>
-        let indexRange: Range<Int>
-        let triangleRange: Range<Int>
-    }
+    /// 32 bytes: two nodes per cache line. Nodes are stored in preorder, so an
+    /// interior node's left child is always the next node. Bounds stay full floats: at
+    /// about half a node per triangle the nodes cost 16 bytes per triangle next to 40 for its
+    /// indices, AABB and source index, so quantizing them would save little memory while
+    /// adding a decode to every visit.
+    fileprivate nonisolated struct BVHNode {
+        var minX: Float
+        var minY: Float
+        var minZ: Float
+        /// Leaf: first slot in `triOrder`. Interior: index of the right child.
+        var offset: Int32
+        var maxX: Float
+        var maxY: Float
+        var maxZ: Float
+        /// Triangle count for leaves, 0 for interior nodes.
+        var count: Int32
+
+        init(bounds: AABB, offset: Int32, count: Int32) {
+            self.minX = bounds.min.x
+            self.minY = bounds.min.y
+            self.minZ = bounds.min.z
+            self.offset = offset
+            self.maxX = bounds.max.x
+            self.maxY = bounds.max.y
+            self.maxZ = bounds.max.z
+            self.count = count
+        }
+
+        var isLeaf: Bool { count > 0 }
+
+        var boundsMin: SIMD3<Float> { SIMD3<Float>(minX, minY, minZ) }
+        var boundsMax: SIMD3<Float> { SIMD3<Float>(maxX, maxY, maxZ) }
+
+        var bounds: AABB {
+            get { AABB(min: boundsMin, max: boundsMax) }
+            set {
+                minX = newValue.min.x
+                minY = newValue.min.y
+                minZ = newValue.min.z
+                maxX = newValue.max.x
+                maxY = newValue.max.y
+                maxZ = newValue.max.z
+            }
+        }
 
-    fileprivate struct BVHNode {
-        var bounds: AABB
-        var left: Int
-        var right: Int
-        var start: Int
-        var count: Int
-        var parent: Int
+        @inline(__always)
+        func overlaps(min p: SIMD3<Float>, max q: SIMD3<Float>) -> Bool {
+            !(maxX < p.x || minX > q.x ||
+              maxY < p.y || minY > q.y ||
+              maxZ < p.z || minZ > q.z)
+        }
     }
 
-    fileprivate struct BVH {
+    fileprivate nonisolated struct BVH {
         var nodes: [BVHNode]
-        var triOrder: [Int]
+        /// Parent per node (-1 for the root); only refit walks it, so it lives outside the node.
+        var parents: [Int32]
+        var triOrder: [Int32]
         var triLeaf: [Int]
         var root: Int
 
+        private nonisolated struct SAHSplit {
+            let axis: Int
+            /// First bin that goes to the right child.
+            let bin: Int
+            let centroidMin: Float
+            let binScale: Float
+            let cost: Float
+        }
+
+        private nonisolated struct BinScratch {
+            var triCount = [Int](repeating: 0, count: StaticTriMesh.sahBinCount)
+            var binMin = [SIMD3<Float>](repeating: SIMD3<Float>(repeating: Float.greatestFiniteMagnitude),
+                                        count: StaticTriMesh.sahBinCount)
+            var binMax = [SIMD3<Float>](repeating: SIMD3<Float>(repeating: -Float.greatestFiniteMagnitude),
+                                        count: StaticTriMesh.sahBinCount)
+            var rightCost = [Float](repeating: 0, count: StaticTriMesh.sahBinCount)
+            var rightCount = [Int](repeating: 0, count: StaticTriMesh.sahBinCount)
+
+            mutating func reset() {
+                for b in 0..<triCount.count {
+                    triCount[b] = 0
+                    binMin[b] = SIMD3<Float>(repeating: Float.greatestFiniteMagnitude)
+                    binMax[b] = SIMD3<Float>(repeating: -Float.greatestFiniteMagnitude)
+                }
+            }
+        }
+
         init(triangleAABBs: [AABB]) {
             self.nodes = []
-            self.triOrder = Array(0..<triangleAABBs.count)
-            self.triLeaf = Array(repeating: -1, count: triangleAABBs.count)
+            self.parents = []
+            self.triOrder = []
+            self.triLeaf = []
             self.root = -1
-            if !triangleAABBs.isEmpty {
-                self.root = build(triangleAABBs: triangleAABBs,
-                                  start: 0,
-                                  count: triangleAABBs.count,
-                                  parent: -1)
-            }
+            rebuild(triangleAABBs: triangleAABBs)
         }
 
         mutating func rebuild(triangleAABBs: [AABB]) {
+            let n = triangleAABBs.count
             nodes.removeAll(keepingCapacity: true)
-            triOrder = Array(0..<triangleAABBs.count)
-            triLeaf = Array(repeating: -1, count: triangleAABBs.count)
+            parents.removeAll(keepingCapacity: true)
+            triOrder = (0..<n).map { Int32($0) }
+            triLeaf = Array(repeating: -1, count: n)
             root = -1
-            if !triangleAABBs.isEmpty {
-                root = build(triangleAABBs: triangleAABBs,
-                             start: 0,
-                             count: triangleAABBs.count,
-                             parent: -1)
-            }
+            guard n > 0 else { return }
+            nodes.reserveCapacity(2 * (n / StaticTriMesh.leafTriangleLimit + 1))
+            parents.reserveCapacity(2 * (n / StaticTriMesh.leafTriangleLimit + 1))
+            let centroids = triangleAABBs.map { ($0.min + $0.max) * 0.5 }
+            var scratch = BinScratch()
+            root = build(triangleAABBs: triangleAABBs,
+                         centroids: centroids,
+                         start: 0,
+                         count: n,
+                         parent: -1,
+                         scratch: &scratch)
         }
 
         mutating func refit(updatedTriangles: [Int], triangleAABBs: [AABB]) {
@@ -536,146 +1643,168 @@ public struct StaticTriMesh {
             }
             for leaf in updatedLeaves {
                 let node = nodes[leaf]
-                let bounds = boundsForRange(triangleAABBs: triangleAABBs,
-                                            start: node.start,
-                                            count: node.count)
-                nodes[leaf].bounds = bounds
+                nodes[leaf].bounds = boundsForRange(triangleAABBs: triangleAABBs,
+                                                    start: Int(node.offset),
+                                                    count: Int(node.count))
             }
-            var dirtyParents: [Int] = []
-            dirtyParents.reserveCapacity(updatedLeaves.count * 2)
             var dirtySet = Set<Int>()
             for leaf in updatedLeaves {
-                var parent = nodes[leaf].parent
-                while parent >= 0 {
-                    if dirtySet.insert(parent).inserted {
-                        dirtyParents.append(parent)
-                    }
-                    parent = nodes[parent].parent
+                var parent = Int(parents[leaf])
+                // Stop at the first ancestor already queued; everything above it is queued too.
+                while parent >= 0 && dirtySet.insert(parent).inserted {
+                    parent = Int(parents[parent])
                 }
             }
-            if !dirtyParents.isEmpty {
-                var depths: [Int] = Array(repeating: 0, count: dirtyParents.count)
-                for i in dirtyParents.indices {
-                    var depth = 0
-                    var node = dirtyParents[i]
-                    while node >= 0 {
-                        depth += 1
-                        node = nodes[node].parent
-                    }
-                    depths[i] = depth
-                }
-                let order = dirtyParents.indices.sorted { depths[$0] > depths[$1] }
-                for i in order {
-                    let parent = dirtyParents[i]
-                    let left = nodes[parent].left
-                    let right = nodes[parent].right
-                    nodes[parent].bounds = merge(nodes[left].bounds, nodes[right].bounds)
-                }
+            // Preorder layout puts children after their parent, so descending index is bottom-up.
+            for parent in dirtySet.sorted(by: >) {
+                let right = Int(nodes[parent].offset)
+                nodes[parent].bounds = merge(nodes[parent + 1].bounds, nodes[right].bounds)
             }
         }
 
         private mutating func build(triangleAABBs: [AABB],
+                                    centroids: [SIMD3<Float>],
                                     start: Int,
                                     count: Int,
-                                    parent: Int) -> Int {
+                                    parent: Int,
+                                    scratch: inout BinScratch) -> Int {
             let nodeIndex = nodes.count
             let bounds = boundsForRange(triangleAABBs: triangleAABBs, start: start, count: count)
-            nodes.append(BVHNode(bounds: bounds,
-                                 left: -1,
-                                 right: -1,
-                                 start: start,
-                                 count: count,
-                                 parent: parent))
+            nodes.append(BVHNode(bounds: bounds, offset: Int32(start), count: Int32(count)))
+            parents.append(Int32(parent))
             if count <= StaticTriMesh.leafTriangleLimit {
-                for i in 0..<count {
-                    let tri = triOrder[start + i]
-                    triLeaf[tri] = nodeIndex
-                }
+                markLeaf(nodeIndex, start: start, count: count)
                 return nodeIndex
             }
 
-            let centroidBounds = centroidBoundsForRange(triangleAABBs: triangleAABBs,
-                                                        start: start,
-                                                        count: count)
-            let extent = centroidBounds.max - centroidBounds.min
-            let axis: Int
-            if extent.x >= extent.y && extent.x >= extent.z {
-                axis = 0
-            } else if extent.y >= extent.z {
-                axis = 1
+            let mid: Int
+            if let split = findSAHSplit(triangleAABBs: triangleAABBs,
+                                        centroids: centroids,
+                                        start: start,
+                                        count: count,
+                                        scratch: &scratch) {
+                let area = surfaceArea(bounds)
+                let splitCost = StaticTriMesh.sahTraversalCost * area + split.cost
+                let leafCost = Float(count) * area
+                if count <= StaticTriMesh.maxLeafTriangles && splitCost >= leafCost {
+                    markLeaf(nodeIndex, start: start, count: count)
+                    return nodeIndex
+                }
+                mid = partition(centroids: centroids, start: start, count: count, split: split)
             } else {
-                axis = 2
+                // All centroids coincide: no split separates them, so halve by count.
+                if count <= StaticTriMesh.maxLeafTriangles {
+                    markLeaf(nodeIndex, start: start, count: count)
+                    return nodeIndex
+                }
+                mid = start + count / 2
             }
 
-            let pivot: Float
-            switch axis {
-            case 0: pivot = (centroidBounds.min.x + centroidBounds.max.x) * 0.5
-            case 1: pivot = (centroidBounds.min.y + centroidBounds.max.y) * 0.5
-            default: pivot = (centroidBounds.min.z + centroidBounds.max.z) * 0.5
+            let left = build(triangleAABBs: triangleAABBs,
+                             centroids: centroids,
+                             start: start,
+                             count: mid - start,
+                             parent: nodeIndex,
+                             scratch: &scratch)
+            let right = build(triangleAABBs: triangleAABBs,
+                              centroids: centroids,
+                              start: mid,
+                              count: start + count - mid,
+                              parent: nodeIndex,
+                              scratch: &scratch)
+            nodes[nodeIndex].offset = Int32(right)
+            nodes[nodeIndex].count = 0
+            nodes[nodeIndex].bounds = merge(nodes[left].bounds, nodes[right].bounds)
+            return nodeIndex
+        }
+
+        private mutating func markLeaf(_ nodeIndex: Int, start: Int, count: Int) {
+            for i in 0..<count {
+                triLeaf[Int(triOrder[start + i])] = nodeIndex
             }
+        }
+
+        /// Binned SAH over centroid bounds on all three axes. Returns nil when no bin boundary
+        /// separates the centroids. `cost` excludes the traversal term.
+        private func findSAHSplit(triangleAABBs: [AABB],
+                                  centroids: [SIMD3<Float>],
+                                  start: Int,
+                                  count: Int,
+                                  scratch: inout BinScratch) -> SAHSplit? {
+            let binCount = StaticTriMesh.sahBinCount
+            let cb = centroidBoundsForRange(centroids: centroids, start: start, count: count)
+            let extent = cb.max - cb.min
+            var best: SAHSplit?
+
+            for axis in 0..<3 where extent[axis] > 0 {
+                let cmin = cb.min[axis]
+                let scale = Float(binCount) / extent[axis]
+                scratch.reset()
+                for i in start..<(start + count) {
+                    let tri = Int(triOrder[i])
+                    let b = min(binCount - 1, Int((centroids[tri][axis] - cmin) * scale))
+                    scratch.triCount[b] += 1
+                    scratch.binMin[b] = simd_min(scratch.binMin[b], triangleAABBs[tri].min)
+                    scratch.binMax[b] = simd_max(scratch.binMax[b], triangleAABBs[tri].max)
+                }
 
+                var rMin = SIMD3<Float>(repeating: Float.greatestFiniteMagnitude)
+                var rMax = SIMD3<Float>(repeating: -Float.greatestFiniteMagnitude)
+                var rCount = 0
+                for b in stride(from: binCount - 1, to: 0, by: -1) {
+                    rCount += scratch.triCount[b]
+                    rMin = simd_min(rMin, scratch.binMin[b])
+                    rMax = simd_max(rMax, scratch.binMax[b])
+                    scratch.rightCount[b] = rCount
+                    scratch.rightCost[b] = rCount > 0 ? surfaceArea(AABB(min: rMin, max: rMax)) * Float(rCount) : 0
+                }
+
+                var lMin = SIMD3<Float>(repeating: Float.greatestFiniteMagnitude)
+                var lMax = SIMD3<Float>(repeating: -Float.greatestFiniteMagnitude)
+                var lCount = 0
+                for b in 0..<(binCount - 1) {
+                    lCount += scratch.triCount[b]
+                    lMin = simd_min(lMin, scratch.binMin[b])
+                    lMax = simd_max(lMax, scratch.binMax[b])
+                    if lCount == 0 || scratch.rightCount[b + 1] == 0 { continue }
+                    let cost = surfaceArea(AABB(min: lMin, max: lMax)) * Float(lCount) + scratch.rightCost[b + 1]
+                    if best == nil || cost < best!.cost {
+                        best = SAHSplit(axis: axis, bin: b + 1, centroidMin: cmin, binScale: scale, cost: cost)
+                    }
+                }
+            }
+            return best
+        }
+
+        /// In-place partition using the exact binning expression of `findSAHSplit`,
+        /// so both sides are non-empty.
+        private mutating func partition(centroids: [SIMD3<Float>],
+                                        start: Int,
+                                        count: Int,
+                                        split: SAHSplit) -> Int {
+            let binCount = StaticTriMesh.sahBinCount
             var i = start
             var j = start + count - 1
             while i <= j {
-                let tri = triOrder[i]
-                let c = centroid(triangleAABBs[tri])
-                let value: Float
-                switch axis {
-                case 0: value = c.x
-                case 1: value = c.y
-                default: value = c.z
-                }
-                if value < pivot {
+                let tri = Int(triOrder[i])
+                let b = min(binCount - 1, Int((centroids[tri][split.axis] - split.centroidMin) * split.binScale))
+                if b < split.bin {
                     i += 1
                 } else {
                     triOrder.swapAt(i, j)
                     j -= 1
                 }
             }
-
-            let end = start + count
-            if i == start || i == end {
-                let sorted = triOrder[start..<end].sorted { a, b in
-                    let ca = centroid(triangleAABBs[a])
-                    let cb = centroid(triangleAABBs[b])
-                    switch axis {
-                    case 0: return ca.x < cb.x
-                    case 1: return ca.y < cb.y
-                    default: return ca.z < cb.z
-                    }
-                }
-                var idx = sorted.startIndex
-                for k in 0..<count {
-                    triOrder[start + k] = sorted[idx]
-                    idx = sorted.index(after: idx)
-                }
-                i = start + count / 2
-            }
-
-            let mid = i
-            let left = build(triangleAABBs: triangleAABBs,
-                             start: start,
-                             count: mid - start,
-                             parent: nodeIndex)
-            let right = build(triangleAABBs: triangleAABBs,
-                              start: mid,
-                              count: start + count - mid,
-                              parent: nodeIndex)
-            nodes[nodeIndex].left = left
-            nodes[nodeIndex].right = right
-            nodes[nodeIndex].start = 0
-            nodes[nodeIndex].count = 0
-            nodes[nodeIndex].bounds = merge(nodes[left].bounds, nodes[right].bounds)
-            return nodeIndex
+            return i
         }
 
         private func boundsForRange(triangleAABBs: [AABB], start: Int, count: Int) -> AABB {
-            let first = triangleAABBs[triOrder[start]]
+            let first = triangleAABBs[Int(triOrder[start])]
             var bmin = first.min
             var bmax = first.max
             if count > 1 {
                 for i in 1..<count {
-                    let bounds = triangleAABBs[triOrder[start + i]]
+                    let bounds = triangleAABBs[Int(triOrder[start + i])]
                     bmin = simd_min(bmin, bounds.min)
                     bmax = simd_max(bmax, bounds.max)
                 }
@@ -683,13 +1812,13 @@ public struct StaticTriMesh {
             return AABB(min: bmin, max: bmax)
         }
 
-        private func centroidBoundsForRange(triangleAABBs: [AABB], start: Int, count: Int) -> AABB {
-            let first = centroid(triangleAABBs[triOrder[start]])
+        private func centroidBoundsForRange(centroids: [SIMD3<Float>], start: Int, count: Int) -> AABB {
+            let first = centroids[Int(triOrder[start])]
             var bmin = first
             var bmax = first
             if count > 1 {
                 for i in 1..<count {
-                    let c = centroid(triangleAABBs[triOrder[start + i]])
+                    let c = centroids[Int(triOrder[start + i])]
                     bmin = simd_min(bmin, c)
                     bmax = simd_max(bmax, c)
                 }
@@ -697,8 +1826,9 @@ public struct StaticTriMesh {
             return AABB(min: bmin, max: bmax)
         }
 
-        private func centroid(_ bounds: AABB) -> SIMD3<Float> {
-            (bounds.min + bounds.max) * 0.5
+        private func surfaceArea(_ bounds: AABB) -> Float {
+            let d = simd_max(bounds.max - bounds.min, SIMD3<Float>(repeating: 0))
+            return 2 * (d.x * d.y + d.y * d.z + d.z * d.x)
         }
 
         private func merge(_ a: AABB, _ b: AABB) -> AABB {
@@ -709,79 +1839,99 @@ public struct StaticTriMesh {
     private var stats: QueryStats = QueryStats()
     private var staticSet: TriangleMeshSet = TriangleMeshSet()
     private var dynamicSet: TriangleMeshSet = TriangleMeshSet()
+    /// Cached chunk sets placed in query space; their triangle indices follow `staticSet`'s.
+    private var staticChunks: [AttachedChunk] = []
+    private var chunkTriangleCount: Int = 0
+    private let library: CollisionMeshLibrary
+
+    private nonisolated struct AttachedChunk {
+        let chunk: CollisionChunk
+        let offset: SIMD3<Float>
+    }
 
     public var statsSnapshot: CollisionQueryStats {
         stats.publicStats
     }
 
-    public init(world: World, activeEntityIDs: Set<UInt32>? = nil) {
+    /// `previous` lends its local-space mesh BVHs to meshes that are still present.
+    @MainActor
+    public init(world: World, activeEntityIDs: Set<UInt32>? = nil, reusing previous: StaticTriMesh? = nil) {
+        self.library = previous?.library ?? CollisionMeshLibrary()
         let tStore = world.store(TransformComponent.self)
         let mStore = world.store(StaticMeshComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
         let entities = filteredEntities(world: world, activeEntityIDs: activeEntityIDs)
         let (staticEntities, dynamicEntities) = StaticTriMesh.partitionEntities(entities: entities,
                                                                                pStore: pStore)
-        staticSet.rebuild(entities: staticEntities, tStore: tStore, mStore: mStore)
-        dynamicSet.rebuild(entities: dynamicEntities, tStore: tStore, mStore: mStore)
+        staticSet.rebuild(entities: staticEntities, tStore: tStore, mStore: mStore, library: library)
+        dynamicSet.rebuild(entities: dynamicEntities, tStore: tStore, mStore: mStore, library: library)
     }
 
     public mutating func resetStats() {
         stats.reset()
     }
 
+    public mutating func mergeStats(from other: StaticTriMesh) {
+        stats.merge(other.stats)
+    }
+
+    @MainActor
     public mutating func rebuildStatic(world: World, activeEntityIDs: Set<UInt32>? = nil) {
         let tStore = world.store(TransformComponent.self)
         let mStore = world.store(StaticMeshComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
         let entities = filteredEntities(world: world, activeEntityIDs: activeEntityIDs)
         let (staticEntities, _) = StaticTriMesh.partitionEntities(entities: entities, pStore: pStore)
-        staticSet.rebuild(entities: staticEntities, tStore: tStore, mStore: mStore)
+        staticSet.rebuild(entities: staticEntities, tStore: tStore, mStore: mStore, library: library)
     }
 
+    @MainActor
     public mutating func rebuildDynamic(world: World, activeEntityIDs: Set<UInt32>? = nil) {
         let tStore = world.store(TransformComponent.self)
         let mStore = world.store(StaticMeshComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
         let entities = filteredEntities(world: world, activeEntityIDs: activeEntityIDs)
         let (_, dynamicEntities) = StaticTriMesh.partitionEntities(entities: entities, pStore: pStore)
-        dynamicSet.rebuild(entities: dynamicEntities, tStore: tStore, mStore: mStore)
+        dynamicSet.rebuild(entities: dynamicEntities, tStore: tStore, mStore: mStore, library: library)
     }
 
+    @MainActor
     public mutating func updateStaticTransforms(world: World,
                                                 entities: [Entity],
                                                 activeEntityIDs: Set<UInt32>? = nil) {
         let tStore = world.store(TransformComponent.self)
-        let mStore = world.store(StaticMeshComponent.self)
         let filtered = filteredEntities(entities: entities, activeEntityIDs: activeEntityIDs)
-        _ = staticSet.updateTransforms(entities: filtered, tStore: tStore, mStore: mStore)
+        staticSet.updateTransforms(entities: filtered, tStore: tStore)
+    }
+
+    /// Replaces the attached chunk sets, placed relative to the physics origin.
+    @MainActor
+    public mutating func attachStaticChunks(_ chunks: [CollisionChunk], originWorld: SIMD3<Double>) {
+        staticChunks.removeAll(keepingCapacity: true)
+        chunkTriangleCount = 0
+        for chunk in chunks where chunk.set.hasTriangles {
+            staticChunks.append(AttachedChunk(chunk: chunk, offset: chunk.offset(originWorld: originWorld)))
+            chunkTriangleCount += chunk.triangleCount
+        }
     }
 
+    @MainActor
     public mutating func updateDynamicTransforms(world: World,
                                                  entities: [Entity],
                                                  activeEntityIDs: Set<UInt32>? = nil) {
         let tStore = world.store(TransformComponent.self)
-        let mStore = world.store(StaticMeshComponent.self)
         let filtered = filteredEntities(entities: entities, activeEntityIDs: activeEntityIDs)
-        _ = dynamicSet.updateTransforms(entities: filtered, tStore: tStore, mStore: mStore)
+        dynamicSet.updateTransforms(entities: filtered, tStore: tStore)
     }
 
     public func raycast(origin: SIMD3<Float>,
                         direction: SIMD3<Float>,
                         maxDistance: Float,
                         mask: UInt32) -> RaycastHit? {
-        let staticHit = raycastBVH(origin: origin,
-                                   direction: direction,
-                                   maxDistance: maxDistance,
-                                   set: staticSet,
-                                   triangleIndexOffset: 0,
-                                   mask: mask)
-        let dynamicHit = raycastBVH(origin: origin,
-                                    direction: direction,
-                                    maxDistance: maxDistance,
-                                    set: dynamicSet,
-                                    triangleIndexOffset: staticSet.triangleAABBs.count,
-                                    mask: mask)
-        return chooseNearest(staticHit, dynamicHit)
+        let ray = RayQuery(origin: origin, direction: direction, maxDistance: maxDistance, mask: mask)
+        var hit: RaycastHit?
+        raycastLanes(count: 1, ray: { _ in ray }, record: { _, h in hit = h })
+        return hit
     }
 
     public mutating func capsuleCast(from: SIMD3<Float>,
@@ -789,13 +1939,11 @@ public struct StaticTriMesh {
                                      radius: Float,
                                      halfHeight: Float,
                                      mask: UInt32) -> CapsuleCastHit? {
-        capsuleCastCombined(from: from,
-                            delta: delta,
-                            radius: radius,
-                            halfHeight: halfHeight,
-                            blockingOnly: false,
-                            minNormalY: nil,
-                            mask: mask)
+        capsuleCastSingle(CapsuleSweepQuery(from: from,
+                                            delta: delta,
+                                            radius: radius,
+                                            halfHeight: halfHeight,
+                                            mask: mask))
     }
 
     public mutating func capsuleCastBlocking(from: SIMD3<Float>,
@@ -803,13 +1951,12 @@ public struct StaticTriMesh {
                                              radius: Float,
                                              halfHeight: Float,
                                              mask: UInt32) -> CapsuleCastHit? {
-        capsuleCastCombined(from: from,
-                            delta: delta,
-                            radius: radius,
-                            halfHeight: halfHeight,
-                            blockingOnly: true,
-                            minNormalY: nil,
-                            mask: mask)
+        capsuleCastSingle(CapsuleSweepQuery(from: from,
+                                            delta: delta,
+                                            radius: radius,
+                                            halfHeight: halfHeight,
+                                            blockingOnly: true,
+                                            mask: mask))
     }
 
     public mutating func capsuleCastGround(from: SIMD3<Float>,
@@ -818,35 +1965,25 @@ public struct StaticTriMesh {
                                            halfHeight: Float,
                                            minNormalY: Float,
                                            mask: UInt32) -> CapsuleCastHit? {
-        capsuleCastCombined(from: from,
-                            delta: delta,
-                            radius: radius,
-                            halfHeight: halfHeight,
-                            blockingOnly: false,
-                            minNormalY: minNormalY,
-                            mask: mask)
+        capsuleCastSingle(CapsuleSweepQuery(from: from,
+                                            delta: delta,
+                                            radius: radius,
+                                            halfHeight: halfHeight,
+                                            minNormalY: minNormalY,
+                                            mask: mask))
     }
 
     public func capsuleOverlap(from: SIMD3<Float>,
                                radius: Float,
                                halfHeight: Float,
                                mask: UInt32) -> CapsuleOverlapHit? {
-        let staticHit = capsuleOverlapBVH(from: from,
-                                          radius: radius,
-                                          halfHeight: halfHeight,
-                                          set: staticSet,
-                                          triangleIndexOffset: 0,
-                                          mask: mask)
-        let dynamicHit = capsuleOverlapBVH(from: from,
-                                           radius: radius,
-                                           halfHeight: halfHeight,
-                                           set: dynamicSet,
-                                           triangleIndexOffset: staticSet.triangleAABBs.count,
-                                           mask: mask)
-        if let a = staticHit, let b = dynamicHit {
-            return a.depth >= b.depth ? a : b
-        }
-        return staticHit ?? dynamicHit
+        let query = CapsuleOverlapQuery(from: from, radius: radius, halfHeight: halfHeight, mask: mask)
+        var hit: CapsuleOverlapHit?
+        capsuleOverlapLanes(count: 1, query: { _ in query }, deepestOnly: true, record: { _, h in
+            hit = h
+            return true
+        })
+        return hit
     }
 
     public func capsuleOverlapAll(from: SIMD3<Float>,
@@ -854,35 +1991,63 @@ public struct StaticTriMesh {
                                   halfHeight: Float,
                                   maxHits: Int,
                                   mask: UInt32) -> [CapsuleOverlapHit] {
+        let query = CapsuleOverlapQuery(from: from, radius: radius, halfHeight: halfHeight, mask: mask)
         var hits: [CapsuleOverlapHit] = []
-        let staticHits = capsuleOverlapBVHAll(from: from,
-                                              radius: radius,
-                                              halfHeight: halfHeight,
-                                              set: staticSet,
-                                              triangleIndexOffset: 0,
-                                              maxHits: maxHits,
-                                              mask: mask)
-        hits.append(contentsOf: staticHits)
-        let remaining = max(0, maxHits - hits.count)
-        if remaining > 0 {
-            let dynamicHits = capsuleOverlapBVHAll(from: from,
-                                                   radius: radius,
-                                                   halfHeight: halfHeight,
-                                                   set: dynamicSet,
-                                                   triangleIndexOffset: staticSet.triangleAABBs.count,
-                                                   maxHits: remaining,
-                                                   mask: mask)
-            hits.append(contentsOf: dynamicHits)
+        hits.reserveCapacity(maxHits)
+        capsuleOverlapLanes(count: 1, query: { _ in query }, deepestOnly: false, record: { _, h in
+            hits.append(h)
+            return true
+        })
+        StaticTriMesh.keepDeepest(&hits, maxHits: maxHits)
+        return hits
+    }
+
+    public func raycastBatch(_ rays: [RayQuery]) -> [RaycastHit?] {
+        var hits = [RaycastHit?](repeating: nil, count: rays.count)
+        var start = 0
+        while start < rays.count {
+            let base = start
+            let count = min(StaticTriMesh.queryPacketSize, rays.count - base)
+            raycastLanes(count: count, ray: { rays[base + $0] }, record: { k, h in hits[base + k] = h })
+            start += count
         }
-        if hits.count > maxHits {
-            hits.sort { $0.depth > $1.depth }
-            hits = Array(hits.prefix(maxHits))
+        return hits
+    }
+
+    public mutating func capsuleCastBatch(_ sweeps: [CapsuleSweepQuery]) -> [CapsuleCastHit?] {
+        resetStats()
+        var hits = [CapsuleCastHit?](repeating: nil, count: sweeps.count)
+        var start = 0
+        while start < sweeps.count {
+            let base = start
+            let count = min(StaticTriMesh.queryPacketSize, sweeps.count - base)
+            capsuleCastLanes(count: count, sweep: { sweeps[base + $0] }, record: { k, h in hits[base + k] = h })
+            start += count
+        }
+        return hits
+    }
+
+    public func capsuleOverlapAllBatch(_ queries: [CapsuleOverlapQuery],
+                                       maxHits: Int) -> [[CapsuleOverlapHit]] {
+        var hits = [[CapsuleOverlapHit]](repeating: [], count: queries.count)
+        var start = 0
+        while start < queries.count {
+            let base = start
+            let count = min(StaticTriMesh.queryPacketSize, queries.count - base)
+            capsuleOverlapLanes(count: count, query: { queries[base + $0] }, deepestOnly: false, record: { k, h in
+                hits[base + k].append(h)
+                return true
+            })
+            for k in 0..<count {
+                StaticTriMesh.keepDeepest(&hits[base + k], maxHits: maxHits)
+            }
+            start += count
         }
         return hits
     }
 }
 
-private extension StaticTriMesh {
+private nonisolated extension StaticTriMesh {
     static func partitionEntities(entities: [Entity],
                                   pStore: ComponentStore<PhysicsBodyComponent>) -> ([Entity], [Entity]) {
         var statics: [Entity] = []
@@ -899,394 +2064,304 @@ private extension StaticTriMesh {
         return (statics, dynamics)
     }
 
-    func chooseNearest(_ a: RaycastHit?, _ b: RaycastHit?) -> RaycastHit? {
-        if let a = a, let b = b {
-            return a.distance <= b.distance ? a : b
+    /// Keeps the `maxHits` deepest overlaps, ties broken by triangle index. Every overlap is
+    /// gathered first, so which hits survive does not depend on traversal order.
+    static func keepDeepest(_ hits: inout [CapsuleOverlapHit], maxHits: Int) {
+        hits.sort { $0.depth != $1.depth ? $0.depth > $1.depth : $0.triangleIndex < $1.triangleIndex }
+        if hits.count > maxHits {
+            hits.removeLast(hits.count - maxHits)
         }
-        return a ?? b
     }
 
-    func chooseNearest(_ a: CapsuleCastHit?, _ b: CapsuleCastHit?) -> CapsuleCastHit? {
-        if let a = a, let b = b {
-            return a.toi <= b.toi ? a : b
-        }
-        return a ?? b
+    @inline(__always)
+    static func allLanes(_ count: Int) -> UInt32 {
+        UInt32.max >> UInt32(32 - count)
     }
 
-    private func raycastBVH(origin: SIMD3<Float>,
-                            direction: SIMD3<Float>,
-                            maxDistance: Float,
-                            set: TriangleMeshSet,
-                            triangleIndexOffset: Int,
-                            mask: UInt32) -> RaycastHit? {
-        guard let bvh = set.bvh, bvh.root >= 0 else { return nil }
-        let eps: Float = 1e-6
-        var closestT = maxDistance
-        var hit: RaycastHit?
-        var stack: [Int] = [bvh.root]
+    /// Visits the loose static set, each attached chunk, then the dynamic set, with the offset
+    /// and triangle index base each is queried with.
+    func forEachSet(_ body: (TriangleMeshSet, SIMD3<Float>, Int) -> Void) {
+        body(staticSet, SIMD3<Float>(repeating: 0), 0)
+        var base = staticSet.triangleCount
+        for attached in staticChunks {
+            body(attached.chunk.set, attached.offset, base)
+            base += attached.chunk.triangleCount
+        }
+        body(dynamicSet, SIMD3<Float>(repeating: 0), base)
+    }
 
-        while let nodeIndex = stack.popLast() {
-            let node = bvh.nodes[nodeIndex]
-            guard let range = rayAABB(origin: origin, direction: direction, bounds: node.bounds) else {
-                continue
-            }
-            if range.0 > closestT {
-                continue
-            }
+    /// Statics first, then dynamic with the limits the static passes left behind, so a
+    /// static hit wins exact ties. `record` fires on every improvement; the last call per lane wins.
+    func raycastLanes(count: Int,
+                      ray: (Int) -> RayQuery,
+                      record: (Int, RaycastHit) -> Void) {
+        var lanes = RayLanes()
+        for k in 0..<count {
+            lanes.set(lane: k, ray(k))
+        }
+        forEachSet { set, offset, base in
+            raycastSet(set, lanes: &lanes, active: StaticTriMesh.allLanes(count), offset: offset,
+                       triangleIndexOffset: base, record: record)
+        }
+    }
 
-            if node.left < 0 {
-                let start = node.start
-                let end = start + node.count
-                for i in start..<end {
-                    let triIndex = bvh.triOrder[i]
-                    if (set.triangleLayers[triIndex] & mask) == 0 {
-                        continue
-                    }
-                    let base = triIndex * 3
-                    if base + 2 >= set.indices.count { continue }
-                    let i0 = Int(set.indices[base])
-                    let i1 = Int(set.indices[base + 1])
-                    let i2 = Int(set.indices[base + 2])
-                    let v0 = set.positions[i0]
-                    let v1 = set.positions[i1]
-                    let v2 = set.positions[i2]
-                    if let t = rayTriangle(origin: origin,
-                                           direction: direction,
-                                           v0: v0,
-                                           v1: v1,
-                                           v2: v2,
-                                           eps: eps),
-                       t < closestT {
-                        let n = simd_normalize(simd_cross(v1 - v0, v2 - v0))
-                        let normal = simd_dot(n, direction) > 0 ? -n : n
-                        let position = origin + direction * t
-                        closestT = t
-                        hit = RaycastHit(distance: t,
-                                         position: position,
-                                         normal: normal,
-                                         triangleIndex: triIndex + triangleIndexOffset,
-                                         material: set.materialForTriangle(triIndex))
+    func raycastSet(_ set: TriangleMeshSet,
+                    lanes: inout RayLanes,
+                    active: UInt32,
+                    offset: SIMD3<Float>,
+                    triangleIndexOffset: Int,
+                    record: (Int, RaycastHit) -> Void) {
+        let eps: Float = 1e-6
+        set.walk(&lanes, lanes: active, offset: offset) { v, instance, packets, leafLanes in
+            var bits = leafLanes
+            while bits != 0 {
+                let k = bits.trailingZeroBitCount
+                bits &= bits - 1
+                // Packets are local: t from the local ray is the world t (affine map).
+                let origin = v.origin[k]
+                let direction = v.direction[k]
+                for packet in packets {
+                    let t = packet.intersect(origin: v.localOrigin[k],
+                                             direction: v.localDirection[k],
+                                             lanes: packet.valid,
+                                             eps: eps)
+                    for lane in 0..<4 where t[lane] < v.closest[k] {
+                        let local = Int(packet.triangles[lane])
+                        let (v0, v1, v2) = packet.vertices(lane: lane)
+                        let n = instance.worldNormal(simd_normalize(simd_cross(v1 - v0, v2 - v0)))
+                        v.closest[k] = t[lane]
+                        record(k, RaycastHit(distance: t[lane],
+                                             position: origin + direction * t[lane],
+                                             normal: simd_dot(n, direction) > 0 ? -n : n,
+                                             triangleIndex: instance.triangleBase + local + triangleIndexOffset,
+                                             material: instance.materialForTriangle(local)))
                     }
                 }
-            } else {
-                stack.append(node.left)
-                stack.append(node.right)
             }
+            return leafLanes
         }
-
-        return hit
     }
 
-    private mutating func capsuleCastCombined(from: SIMD3<Float>,
-                                              delta: SIMD3<Float>,
-                                              radius: Float,
-                                              halfHeight: Float,
-                                              blockingOnly: Bool,
-                                              minNormalY: Float?,
-                                              mask: UInt32) -> CapsuleCastHit? {
-        let len = simd_length(delta)
-        if len < 1e-6 { return nil }
+    mutating func capsuleCastSingle(_ sweep: CapsuleSweepQuery) -> CapsuleCastHit? {
+        // Single casts report stats for the latest cast only.
         resetStats()
-        let staticHit = capsuleCastBVH(from: from,
-                                       delta: delta,
-                                       radius: radius,
-                                       halfHeight: halfHeight,
-                                       set: staticSet,
-                                       triangleIndexOffset: 0,
-                                       blockingOnly: blockingOnly,
-                                       minNormalY: minNormalY,
-                                       mask: mask)
-        let dynamicHit = capsuleCastBVH(from: from,
-                                        delta: delta,
-                                        radius: radius,
-                                        halfHeight: halfHeight,
-                                        set: dynamicSet,
-                                        triangleIndexOffset: staticSet.triangleAABBs.count,
-                                        blockingOnly: blockingOnly,
-                                        minNormalY: minNormalY,
-                                        mask: mask)
-        return chooseNearest(staticHit, dynamicHit)
+        var hit: CapsuleCastHit?
+        capsuleCastLanes(count: 1, sweep: { _ in sweep }, record: { _, h in hit = h })
+        return hit
     }
 
-    private mutating func capsuleCastBVH(from: SIMD3<Float>,
-                                         delta: SIMD3<Float>,
-                                         radius: Float,
-                                         halfHeight: Float,
-                                         set: TriangleMeshSet,
-                                         triangleIndexOffset: Int,
-                                         blockingOnly: Bool,
-                                         minNormalY: Float?,
-                                         mask: UInt32) -> CapsuleCastHit? {
-        guard let bvh = set.bvh, bvh.root >= 0 else { return nil }
-        let len = simd_length(delta)
-        if len < 1e-6 { return nil }
-        let dir = delta / len
-
+    mutating func capsuleCastLanes(count: Int,
+                                   sweep: (Int) -> CapsuleSweepQuery,
+                                   record: (Int, CapsuleCastHit) -> Void) {
         let up = SIMD3<Float>(0, 1, 0)
-        let a0 = from + up * halfHeight
-        let b0 = from - up * halfHeight
-        let a1 = a0 + delta
-        let b1 = b0 + delta
-
-        var minP = simd_min(simd_min(a0, b0), simd_min(a1, b1))
-        var maxP = simd_max(simd_max(a0, b0), simd_max(a1, b1))
-        let ext = SIMD3<Float>(repeating: radius)
-        minP -= ext
-        maxP += ext
-
-        var bestHit: CapsuleCastHit?
-        var bestT = len
-        var sweepTests = 0
-        var sweepIterations = 0
-        var sweepMaxIterations = 0
-        var candidateCount = 0
-        var stack: [Int] = [bvh.root]
-
-        while let nodeIndex = stack.popLast() {
-            let node = bvh.nodes[nodeIndex]
-            if node.bounds.max.x < minP.x || node.bounds.min.x > maxP.x ||
-                node.bounds.max.y < minP.y || node.bounds.min.y > maxP.y ||
-                node.bounds.max.z < minP.z || node.bounds.min.z > maxP.z {
-                continue
-            }
-            if node.left < 0 {
-                let start = node.start
-                let end = start + node.count
-                for i in start..<end {
-                    let triIndex = bvh.triOrder[i]
-                    if (set.triangleLayers[triIndex] & mask) == 0 {
-                        continue
-                    }
-                    let triBounds = set.triangleAABBs[triIndex]
-                    if triBounds.max.x < minP.x || triBounds.min.x > maxP.x ||
-                        triBounds.max.y < minP.y || triBounds.min.y > maxP.y ||
-                        triBounds.max.z < minP.z || triBounds.min.z > maxP.z {
-                        continue
-                    }
-                    candidateCount += 1
-                    let base = triIndex * 3
-                    if base + 2 >= set.indices.count { continue }
-                    let v0 = set.positions[Int(set.indices[base])]
-                    let v1 = set.positions[Int(set.indices[base + 1])]
-                    let v2 = set.positions[Int(set.indices[base + 2])]
-                    sweepTests += 1
-                    var iterCount = 0
-                    if var hit = sweepCapsuleTriangle(from: from,
-                                                      dir: dir,
-                                                      maxDistance: len,
-                                                      radius: radius,
-                                                      halfHeight: halfHeight,
-                                                      v0: v0,
-                                                      v1: v1,
-                                                      v2: v2,
-                                                      triangleIndex: triIndex,
-                                                      iterations: &iterCount),
-                       hit.toi < bestT {
-                        hit.material = set.materialForTriangle(triIndex)
-                        hit.triangleIndex = triIndex + triangleIndexOffset
-                        if blockingOnly {
-                            if simd_dot(delta, hit.normal) >= 0 {
-                                continue
+        var lanes = BoxLanes()
+        var bestT = SIMD8<Float>(repeating: 0)
+        var active: UInt32 = 0
+        for k in 0..<count {
+            let s = sweep(k)
+            let len = simd_length(s.delta)
+            if len < 1e-6 { continue }
+            let axis = up * s.halfHeight
+            let a0 = s.from + axis
+            let b0 = s.from - axis
+            let ext = SIMD3<Float>(repeating: s.radius)
+            lanes.set(lane: k,
+                      min: simd_min(simd_min(a0, b0), simd_min(a0 + s.delta, b0 + s.delta)) - ext,
+                      max: simd_max(simd_max(a0, b0), simd_max(a0 + s.delta, b0 + s.delta)) + ext,
+                      mask: s.mask,
+                      from: s.from,
+                      axis: axis,
+                      delta: s.delta)
+            bestT[k] = len
+            active |= 1 << UInt32(k)
+        }
+        if active == 0 { return }
+
+        var pass = QueryStats()
+        forEachSet { set, offset, base in
+            capsuleCastSet(set, lanes: &lanes, active: active, bestT: &bestT, offset: offset,
+                           triangleIndexOffset: base, sweep: sweep, stats: &pass, record: record)
+        }
+        stats.merge(pass)
+    }
+
+    func capsuleCastSet(_ set: TriangleMeshSet,
+                        lanes: inout BoxLanes,
+                        active: UInt32,
+                        bestT: inout SIMD8<Float>,
+                        offset: SIMD3<Float>,
+                        triangleIndexOffset: Int,
+                        sweep: (Int) -> CapsuleSweepQuery,
+                        stats: inout QueryStats,
+                        record: (Int, CapsuleCastHit) -> Void) {
+        set.walk(&lanes, lanes: active, offset: offset) { v, instance, packets, leafLanes in
+            // Local packets take the capsule in instance units (`scale` world units per
+            // local unit); distances and contacts go back to world space on the way out.
+            let local = v.testsLocalTriangles(instance)
+            let scale = local ? instance.uniformScale : 1
+            var bits = leafLanes
+            while bits != 0 {
+                let k = bits.trailingZeroBitCount
+                bits &= bits - 1
+                let s = sweep(k)
+                let from = local ? v.localFrom[k] : s.from
+                let axis = local ? v.localAxis[k] : v.axis[k]
+                let delta = local ? v.localDelta[k] : s.delta
+                let len = simd_length(delta)
+                let dir = delta / len
+                let minP = local ? v.localMin[k] : v.worldMin[k]
+                let maxP = local ? v.localMax[k] : v.worldMax[k]
+                for packet in packets {
+                    let candidates = packet.valid .& packet.overlapMask(min: minP, max: maxP)
+                    if !any(candidates) { continue }
+                    for lane in 0..<4 where candidates[lane] {
+                        stats.capsuleCandidateCount += 1
+                        stats.capsuleSweepCount += 1
+                        let triangle = Int(packet.triangles[lane])
+                        let (v0, v1, v2) = packet.vertices(lane: lane)
+                        var iterCount = 0
+                        if var hit = sweepCapsuleTriangle(from: from,
+                                                          dir: dir,
+                                                          maxDistance: len,
+                                                          radius: s.radius / scale,
+                                                          axis: axis,
+                                                          v0: v0,
+                                                          v1: v1,
+                                                          v2: v2,
+                                                          triangleIndex: triangle,
+                                                          iterations: &iterCount),
+                           hit.toi * scale < bestT[k] {
+                            if local {
+                                hit.toi *= scale
+                                hit.position = instance.worldPoint(hit.position) + offset
+                                hit.normal = instance.worldNormal(hit.normal)
+                                hit.triangleNormal = instance.worldNormal(hit.triangleNormal)
                             }
-                            if simd_dot(delta, hit.triangleNormal) >= 0 {
-                                continue
+                            hit.material = instance.materialForTriangle(triangle)
+                            hit.triangleIndex = instance.triangleBase + triangle + triangleIndexOffset
+                            let blocked = !s.blockingOnly
+                                || (simd_dot(s.delta, hit.normal) < 0 && simd_dot(s.delta, hit.triangleNormal) < 0)
+                            let grounded = s.minNormalY.map { hit.triangleNormal.y >= $0 } ?? true
+                            if blocked && grounded {
+                                bestT[k] = hit.toi
+                                record(k, hit)
                             }
                         }
-                        if let minY = minNormalY, hit.triangleNormal.y < minY {
-                            continue
-                        }
-                        bestT = hit.toi
-                        bestHit = hit
-                    }
-                    sweepIterations += iterCount
-                    if iterCount > sweepMaxIterations {
-                        sweepMaxIterations = iterCount
+                        stats.capsuleSweepIterations += iterCount
+                        stats.capsuleSweepMaxIterations = max(stats.capsuleSweepMaxIterations, iterCount)
                     }
                 }
-            } else {
-                stack.append(node.left)
-                stack.append(node.right)
             }
+            return leafLanes
         }
-
-        stats.capsuleCandidateCount += candidateCount
-        stats.capsuleSweepCount += sweepTests
-        stats.capsuleSweepIterations += sweepIterations
-        stats.capsuleSweepMaxIterations = max(stats.capsuleSweepMaxIterations, sweepMaxIterations)
-        return bestHit
     }
 
-    private func capsuleOverlapBVH(from: SIMD3<Float>,
-                                   radius: Float,
-                                   halfHeight: Float,
-                                   set: TriangleMeshSet,
-                                   triangleIndexOffset: Int,
-                                   mask: UInt32) -> CapsuleOverlapHit? {
-        guard let bvh = set.bvh, bvh.root >= 0 else { return nil }
+    /// `deepestOnly` keeps the deepest contact per lane (capsuleOverlap); otherwise every
+    /// contact is recorded in traversal order until `record` returns false.
+    func capsuleOverlapLanes(count: Int,
+                             query: (Int) -> CapsuleOverlapQuery,
+                             deepestOnly: Bool,
+                             record: (Int, CapsuleOverlapHit) -> Bool) {
         let up = SIMD3<Float>(0, 1, 0)
-        let a0 = from + up * halfHeight
-        let b0 = from - up * halfHeight
-        var minP = simd_min(a0, b0)
-        var maxP = simd_max(a0, b0)
-        let ext = SIMD3<Float>(repeating: radius)
-        minP -= ext
-        maxP += ext
-
-        var bestHit: CapsuleOverlapHit?
-        var bestDepth: Float = 0
-        var stack: [Int] = [bvh.root]
-
-        while let nodeIndex = stack.popLast() {
-            let node = bvh.nodes[nodeIndex]
-            if node.bounds.max.x < minP.x || node.bounds.min.x > maxP.x ||
-                node.bounds.max.y < minP.y || node.bounds.min.y > maxP.y ||
-                node.bounds.max.z < minP.z || node.bounds.min.z > maxP.z {
-                continue
-            }
-            if node.left < 0 {
-                let start = node.start
-                let end = start + node.count
-                for i in start..<end {
-                    let triIndex = bvh.triOrder[i]
-                    if (set.triangleLayers[triIndex] & mask) == 0 {
-                        continue
-                    }
-                    let triBounds = set.triangleAABBs[triIndex]
-                    if triBounds.max.x < minP.x || triBounds.min.x > maxP.x ||
-                        triBounds.max.y < minP.y || triBounds.min.y > maxP.y ||
-                        triBounds.max.z < minP.z || triBounds.min.z > maxP.z {
-                        continue
-                    }
-                    let base = triIndex * 3
-                    if base + 2 >= set.indices.count { continue }
-                    let v0 = set.positions[Int(set.indices[base])]
-                    let v1 = set.positions[Int(set.indices[base + 1])]
-                    let v2 = set.positions[Int(set.indices[base + 2])]
-                    let (dist, segPoint, triPoint) = segmentTriangleDistance(center: from,
-                                                                             halfHeight: halfHeight,
-                                                                             v0: v0,
-                                                                             v1: v1,
-                                                                             v2: v2)
-                    if dist >= radius { continue }
-                    let depth = radius - dist
-                    if depth <= bestDepth { continue }
-                    let triNormal = simd_normalize(simd_cross(v1 - v0, v2 - v0))
-                    let n: SIMD3<Float>
-                    if dist < 1e-6 {
-                        n = triNormal
-                    } else {
-                        n = simd_normalize(segPoint - triPoint)
-                    }
-                    var triN = triNormal
-                    if simd_dot(triN, n) < 0 {
-                        triN = -triN
-                    }
-                    bestDepth = depth
-                    bestHit = CapsuleOverlapHit(depth: depth,
-                                                position: triPoint,
-                                                normal: n,
-                                                triangleNormal: triN,
-                                                triangleIndex: triIndex + triangleIndexOffset,
-                                                material: set.materialForTriangle(triIndex))
-                }
-            } else {
-                stack.append(node.left)
-                stack.append(node.right)
-            }
+        var lanes = BoxLanes()
+        for k in 0..<count {
+            let q = query(k)
+            let axis = up * q.halfHeight
+            let a0 = q.from + axis
+            let b0 = q.from - axis
+            let ext = SIMD3<Float>(repeating: q.radius)
+            lanes.set(lane: k,
+                      min: simd_min(a0, b0) - ext,
+                      max: simd_max(a0, b0) + ext,
+                      mask: q.mask,
+                      from: q.from,
+                      axis: axis,
+                      delta: SIMD3<Float>(repeating: 0))
+        }
+        var bestDepth = SIMD8<Float>(repeating: 0)
+        var active = StaticTriMesh.allLanes(count)
+        forEachSet { set, offset, base in
+            guard active != 0 else { return }
+            active = capsuleOverlapSet(set, lanes: &lanes, active: active, bestDepth: &bestDepth,
+                                       deepestOnly: deepestOnly, offset: offset, triangleIndexOffset: base,
+                                       query: query, record: record)
         }
-
-        return bestHit
     }
 
-    private func capsuleOverlapBVHAll(from: SIMD3<Float>,
-                                      radius: Float,
-                                      halfHeight: Float,
-                                      set: TriangleMeshSet,
-                                      triangleIndexOffset: Int,
-                                      maxHits: Int,
-                                      mask: UInt32) -> [CapsuleOverlapHit] {
-        guard let bvh = set.bvh, bvh.root >= 0 else { return [] }
-        let up = SIMD3<Float>(0, 1, 0)
-        let a0 = from + up * halfHeight
-        let b0 = from - up * halfHeight
-        var minP = simd_min(a0, b0)
-        var maxP = simd_max(a0, b0)
-        let ext = SIMD3<Float>(repeating: radius)
-        minP -= ext
-        maxP += ext
-
-        var hits: [CapsuleOverlapHit] = []
-        hits.reserveCapacity(maxHits)
-        var stack: [Int] = [bvh.root]
-
-        while let nodeIndex = stack.popLast() {
-            let node = bvh.nodes[nodeIndex]
-            if node.bounds.max.x < minP.x || node.bounds.min.x > maxP.x ||
-                node.bounds.max.y < minP.y || node.bounds.min.y > maxP.y ||
-                node.bounds.max.z < minP.z || node.bounds.min.z > maxP.z {
-                continue
-            }
-            if node.left < 0 {
-                let start = node.start
-                let end = start + node.count
-                for i in start..<end {
-                    let triIndex = bvh.triOrder[i]
-                    if (set.triangleLayers[triIndex] & mask) == 0 {
-                        continue
-                    }
-                    let triBounds = set.triangleAABBs[triIndex]
-                    if triBounds.max.x < minP.x || triBounds.min.x > maxP.x ||
-                        triBounds.max.y < minP.y || triBounds.min.y > maxP.y ||
-                        triBounds.max.z < minP.z || triBounds.min.z > maxP.z {
-                        continue
-                    }
-                    let base = triIndex * 3
-                    if base + 2 >= set.indices.count { continue }
-                    let v0 = set.positions[Int(set.indices[base])]
-                    let v1 = set.positions[Int(set.indices[base + 1])]
-                    let v2 = set.positions[Int(set.indices[base + 2])]
-                    let (dist, segPoint, triPoint) = segmentTriangleDistance(center: from,
-                                                                             halfHeight: halfHeight,
-                                                                             v0: v0,
-                                                                             v1: v1,
-                                                                             v2: v2)
-                    if dist >= radius { continue }
-                    let depth = radius - dist
-                    let triNormal = simd_normalize(simd_cross(v1 - v0, v2 - v0))
-                    let n: SIMD3<Float>
-                    if dist < 1e-6 {
-                        n = triNormal
-                    } else {
-                        n = simd_normalize(segPoint - triPoint)
-                    }
-                    var triN = triNormal
-                    if simd_dot(triN, n) < 0 {
-                        triN = -triN
-                    }
-                    hits.append(CapsuleOverlapHit(depth: depth,
-                                                  position: triPoint,
-                                                  normal: n,
-                                                  triangleNormal: triN,
-                                                  triangleIndex: triIndex + triangleIndexOffset,
-                                                  material: set.materialForTriangle(triIndex)))
-                    if hits.count >= maxHits {
-                        return hits
+    /// Returns the lanes that still accept contacts.
+    func capsuleOverlapSet(_ set: TriangleMeshSet,
+                           lanes: inout BoxLanes,
+                           active: UInt32,
+                           bestDepth: inout SIMD8<Float>,
+                           deepestOnly: Bool,
+                           offset: SIMD3<Float>,
+                           triangleIndexOffset: Int,
+                           query: (Int) -> CapsuleOverlapQuery,
+                           record: (Int, CapsuleOverlapHit) -> Bool) -> UInt32 {
+        var open = active
+        set.walk(&lanes, lanes: active, offset: offset) { v, instance, packets, leafLanes in
+            // As in capsuleCastSet: local packets take the capsule in instance units.
+            let local = v.testsLocalTriangles(instance)
+            let scale = local ? instance.uniformScale : 1
+            var remaining = leafLanes
+            var bits = leafLanes
+            laneLoop: while bits != 0 {
+                let k = bits.trailingZeroBitCount
+                bits &= bits - 1
+                let q = query(k)
+                let center = local ? v.localFrom[k] : q.from
+                let axis = local ? v.localAxis[k] : v.axis[k]
+                let minP = local ? v.localMin[k] : v.worldMin[k]
+                let maxP = local ? v.localMax[k] : v.worldMax[k]
+                for packet in packets {
+                    let candidates = packet.valid .& packet.overlapMask(min: minP, max: maxP)
+                    if !any(candidates) { continue }
+                    for lane in 0..<4 where candidates[lane] {
+                        let (v0, v1, v2) = packet.vertices(lane: lane)
+                        let (localDist, segPoint, triPoint) = segmentTriangleDistance(center: center,
+                                                                                      axis: axis,
+                                                                                      v0: v0,
+                                                                                      v1: v1,
+                                                                                      v2: v2)
+                        let dist = localDist * scale
+                        if dist >= q.radius { continue }
+                        let depth = q.radius - dist
+                        if deepestOnly && depth <= bestDepth[k] { continue }
+                        bestDepth[k] = max(bestDepth[k], depth)
+                        let triangle = Int(packet.triangles[lane])
+                        var triNormal = simd_normalize(simd_cross(v1 - v0, v2 - v0))
+                        var n = localDist < 1e-6 ? triNormal : simd_normalize(segPoint - triPoint)
+                        var position = triPoint
+                        if local {
+                            triNormal = instance.worldNormal(triNormal)
+                            n = instance.worldNormal(n)
+                            position = instance.worldPoint(triPoint) + offset
+                        }
+                        let triN = simd_dot(triNormal, n) < 0 ? -triNormal : triNormal
+                        let hit = CapsuleOverlapHit(depth: depth,
+                                                    position: position,
+                                                    normal: n,
+                                                    triangleNormal: triN,
+                                                    triangleIndex: instance.triangleBase + triangle + triangleIndexOffset,
+                                                    material: instance.materialForTriangle(triangle))
+                        if !record(k, hit) {
+                            remaining &= ~(1 << UInt32(k))
+                            open &= ~(1 << UInt32(k))
+                            continue laneLoop
+                        }
                     }
                 }
-            } else {
-                stack.append(node.left)
-                stack.append(node.right)
             }
+            return remaining
         }
-
-        return hits
+        return open
     }
 
     private func sweepCapsuleTriangle(from: SIMD3<Float>,
                                       dir: SIMD3<Float>,
                                       maxDistance: Float,
                                       radius: Float,
-                                      halfHeight: Float,
+                                      axis: SIMD3<Float>,
                                       v0: SIMD3<Float>,
                                       v1: SIMD3<Float>,
                                       v2: SIMD3<Float>,
@@ -1307,7 +2382,7 @@ private extension StaticTriMesh {
             }
             let center = from + dir * t
             let (dist, _, _) = segmentTriangleDistance(center: center,
-                                                       halfHeight: halfHeight,
+                                                       axis: axis,
                                                        v0: v0,
                                                        v1: v1,
                                                        v2: v2)
@@ -1315,7 +2390,7 @@ private extension StaticTriMesh {
                 let tHit = refineTOI(from: from,
                                      dir: dir,
                                      radius: radius,
-                                     halfHeight: halfHeight,
+                                     axis: axis,
                                      v0: v0,
                                      v1: v1,
                                      v2: v2,
@@ -1324,7 +2399,7 @@ private extension StaticTriMesh {
                                      maxDistance: maxDistance)
                 let hitCenter = from + dir * tHit
                 let (hitDist, hitSeg, hitTri) = segmentTriangleDistance(center: hitCenter,
-                                                                        halfHeight: halfHeight,
+                                                                        axis: axis,
                                                                         v0: v0,
                                                                         v1: v1,
                                                                         v2: v2)
@@ -1361,7 +2436,7 @@ private extension StaticTriMesh {
     private func refineTOI(from: SIMD3<Float>,
                            dir: SIMD3<Float>,
                            radius: Float,
-                           halfHeight: Float,
+                           axis: SIMD3<Float>,
                            v0: SIMD3<Float>,
                            v1: SIMD3<Float>,
                            v2: SIMD3<Float>,
@@ -1380,7 +2455,7 @@ private extension StaticTriMesh {
             let mid = 0.5 * (lo + hi)
             let center = from + dir * mid
             let (dist, _, _) = segmentTriangleDistance(center: center,
-                                                       halfHeight: halfHeight,
+                                                       axis: axis,
                                                        v0: v0,
                                                        v1: v1,
                                                        v2: v2)
@@ -1393,14 +2468,15 @@ private extension StaticTriMesh {
         return hi
     }
 
+    /// Distance from the capsule segment `center ± axis` to the triangle, with the closest
+    /// points on each.
     private func segmentTriangleDistance(center: SIMD3<Float>,
-                                         halfHeight: Float,
+                                         axis: SIMD3<Float>,
                                          v0: SIMD3<Float>,
                                          v1: SIMD3<Float>,
                                          v2: SIMD3<Float>) -> (Float, SIMD3<Float>, SIMD3<Float>) {
-        let up = SIMD3<Float>(0, 1, 0)
-        let a = center + up * halfHeight
-        let b = center - up * halfHeight
+        let a = center + axis
+        let b = center - axis
 
         if let hit = segmentTriangleIntersect(a: a, b: b, v0: v0, v1: v1, v2: v2) {
             return (0, hit, hit)
@@ -1424,14 +2500,24 @@ private extension StaticTriMesh {
             bestTri = p1
         }
 
-        let edges = [(v0, v1), (v1, v2), (v2, v0)]
-        for (e0, e1) in edges {
-            let (d, s, t) = segmentSegmentDistanceSq(p1: a, q1: b, p2: e0, q2: e1)
-            if d < bestDistSq {
-                bestDistSq = d
-                bestSeg = s
-                bestTri = t
-            }
+        // Unrolled over the three edges; an edge array here allocated on every distance call.
+        let (de0, se0, te0) = segmentSegmentDistanceSq(p1: a, q1: b, p2: v0, q2: v1)
+        if de0 < bestDistSq {
+            bestDistSq = de0
+            bestSeg = se0
+            bestTri = te0
+        }
+        let (de1, se1, te1) = segmentSegmentDistanceSq(p1: a, q1: b, p2: v1, q2: v2)
+        if de1 < bestDistSq {
+            bestDistSq = de1
+            bestSeg = se1
+            bestTri = te1
+        }
+        let (de2, se2, te2) = segmentSegmentDistanceSq(p1: a, q1: b, p2: v2, q2: v0)
+        if de2 < bestDistSq {
+            bestDistSq = de2
+            bestSeg = se2
+            bestTri = te2
         }
 
         return (sqrt(max(bestDistSq, 0)), bestSeg, bestTri)
@@ -1599,34 +2685,4 @@ private extension StaticTriMesh {
         let t = simd_dot(e2, qvec) * invDet
         return t >= 0 ? t : nil
     }
-
-    private func rayAABB(origin: SIMD3<Float>,
-                         direction: SIMD3<Float>,
-                         bounds: AABB) -> (Float, Float)? {
-        let invX = direction.x != 0 ? 1.0 / direction.x : Float.greatestFiniteMagnitude
-        let invY = direction.y != 0 ? 1.0 / direction.y : Float.greatestFiniteMagnitude
-        let invZ = direction.z != 0 ? 1.0 / direction.z : Float.greatestFiniteMagnitude
-
-        var tmin = (bounds.min.x - origin.x) * invX
-        var tmax = (bounds.max.x - origin.x) * invX
-        if tmin > tmax { swap(&tmin, &tmax) }
-
-        var tymin = (bounds.min.y - origin.y) * invY
-        var tymax = (bounds.max.y - origin.y) * invY
-        if tymin > tymax { swap(&tymin, &tymax) }
-
-        if tmin > tymax || tymin > tmax { return nil }
-        tmin = max(tmin, tymin)
-        tmax = min(tmax, tymax)
-
-        var tzmin = (bounds.min.z - origin.z) * invZ
-        var tzmax = (bounds.max.z - origin.z) * invZ
-        if tzmin > tzmax { swap(&tzmin, &tzmax) }
-
-        if tmin > tzmax || tzmin > tmax { return nil }
-        tmin = max(tmin, tzmin)
-        tmax = min(tmax, tzmax)
-
-        return (tmin, tmax)
-    }
 }
@@ -9,7 +9,7 @@ import simd
 
 // MARK: - Transform (TRS)
 
-public struct TransformComponent {
+public nonisolated struct TransformComponent: Sendable {
     public var translation: SIMD3<Float>
     public var rotation: simd_quatf
     public var scale: SIMD3<Float>
@@ -44,7 +44,7 @@ public struct TransformComponent {
     }
 }
 
-public enum CollisionLayer {
+public nonisolated enum CollisionLayer {
     public static let all: UInt32 = 0xFFFF_FFFF
     public static let defaultLayer: UInt32 = 1 << 0
 }
@@ -136,7 +136,27 @@ public struct WorldPositionComponent {
 
 // MARK: - Active Chunk Set
 
-public struct ActiveChunkComponent {
+public enum AssetLoadState {
+    case unloaded
+    case loading
+    case ready
+    case failed
+}
+
+/// Anchor of a streamed asset (see `AssetStreamer`): its WorldPositionComponent decides
+/// when the load is requested, and any RenderComponent on it is a placeholder that is
+/// removed when the asset spawns.
+public struct StreamedAssetComponent {
+    public var handle: AssetHandle
+    public var state: AssetLoadState
+
+    public init(handle: AssetHandle, state: AssetLoadState = .unloaded) {
+        self.handle = handle
+        self.state = state
+    }
+}
+
+public nonisolated struct ActiveChunkComponent: Sendable {
     public var centerChunk: SIMD3<Int64>
     public var originChunk: SIMD3<Int64>
     public var originLocal: SIMD3<Double>
@@ -190,6 +210,8 @@ public struct PoseComponent {
     public var model: [matrix_float4x4]
     public var palette: [matrix_float4x4]
     public var phase: Float
+    /// Bumped whenever the pose is re-evaluated; unchanged poses are not reskinned.
+    public var revision: UInt32
 
     public init(boneCount: Int, local: [matrix_float4x4]? = nil) {
         let base = local ?? Array(repeating: matrix_identity_float4x4, count: boneCount)
@@ -197,6 +219,46 @@ public struct PoseComponent {
         self.model = base
         self.palette = base
         self.phase = 0
+        self.revision = 0
+    }
+}
+
+public enum AnimationLOD: Int {
+    case full
+    case reduced
+    case far
+    /// Outside the view frustum or past the cull distance.
+    case hidden
+
+    /// Fixed steps per pose evaluation.
+    public var poseInterval: Int {
+        switch self {
+        case .full: return 1
+        case .reduced: return 2
+        case .far: return 4
+        case .hidden: return 8
+        }
+    }
+
+    /// Bone influences per skinned vertex; far characters follow their dominant bone only.
+    public var boneInfluences: Int {
+        switch self {
+        case .full, .reduced: return 4
+        case .far, .hidden: return 1
+        }
+    }
+}
+
+/// Set by AnimationLODSystem from the camera; PoseStackSystem banks the time of skipped steps.
+public struct AnimationLODComponent {
+    public var level: AnimationLOD
+    public var pendingSteps: Int
+    public var pendingTime: Float
+
+    public init(level: AnimationLOD = .full) {
+        self.level = level
+        self.pendingSteps = 0
+        self.pendingTime = 0
     }
 }
 
@@ -320,7 +382,7 @@ public struct FollowTargetComponent {
     }
 }
 
-public struct StaticMeshComponent {
+public nonisolated struct StaticMeshComponent: Sendable {
     public var mesh: ProceduralMeshDescriptor
     public var collisionMesh: ProceduralMeshDescriptor?
     public var material: SurfaceMaterial
@@ -350,7 +412,7 @@ public struct StaticMeshComponent {
     }
 }
 
-public struct CharacterControllerComponent {
+public nonisolated struct CharacterControllerComponent: Sendable {
     public var radius: Float
     public var halfHeight: Float
     public var skinWidth: Float
@@ -430,7 +492,7 @@ public struct CharacterControllerComponent {
     }
 }
 
-public struct AgentCollisionComponent {
+public nonisolated struct AgentCollisionComponent: Sendable {
     public var radiusOverride: Float?
     public var massWeight: Float
     public var isSolid: Bool
@@ -540,13 +602,13 @@ public struct TimeComponent {
 
 // MARK: - Physics
 
-public enum BodyType {
+public nonisolated enum BodyType: Sendable {
     case `static`
     case kinematic
     case dynamic
 }
 
-public struct PhysicsBodyComponent {
+public nonisolated struct PhysicsBodyComponent: Sendable {
     public var bodyType: BodyType
     public var position: SIMD3<Double>
     public var rotation: simd_quatf
@@ -701,7 +763,7 @@ public struct MovementComponent {
     }
 }
 
-public struct SurfaceMaterial: Equatable {
+public nonisolated struct SurfaceMaterial: Equatable, Sendable {
     public var muS: Float
     public var muK: Float
     public var flattenGround: Bool
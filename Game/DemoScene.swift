@@ -12,14 +12,24 @@ public final class DemoScene: RenderScene {
 
     public let camera = Camera()
 
-    public private(set) var renderItems: [RenderItem] = []
+    /// Retained by the extract system and updated in place, so it is not copied per frame.
+    public var renderItems: [RenderItem] { extractSystem.items }
+    public var renderChanges: RenderItemChanges? { extractSystem.changes }
     public private(set) var overlayItems: [RenderItem] = []
     public private(set) var revision: UInt64 = 0
     public var toneMappingExposure: Float = 1.0
     public var toneMappingEnabled: Bool = true
     public var directionalLights: [DirectionalLight] = []
     public var rtResolutionScale: Float = 1.0
+    public var rtTemporalEnabled: Bool = false
+    public var rtWavefrontEnabled: Bool = false
+    public var rtAlphaFunctionsEnabled: Bool = false
+    public var rtDynamicResolutionEnabled: Bool = false
+    public var rtTargetFrameMilliseconds: Float = 1000.0 / 60.0
+    /// Draw the profiler's per-system and per-pass breakdown under the overlay.
+    public var profilerOverlayEnabled: Bool = true
     private var fpsOverlaySystem: FPSOverlaySystem?
+    private var profilerOverlaySystem: ProfilerOverlaySystem?
 
     // ECS
     private let world = World()
@@ -33,6 +43,9 @@ public final class DemoScene: RenderScene {
     private let actionAnimationSystem = ActionAnimationSystem()
     private let dodgeSystem = DodgeSystem()
     private let activeChunkSystem = ActiveChunkSystem()
+    private let assetStreamer = AssetStreamer()
+    private let assetStreamingSystem: AssetStreamingSystem
+    private var streamedGeneration: UInt64 = 0
     private let physicsLocalizeSystem = PhysicsLocalizeSystem()
     private let gravitySystem = GravitySystem()
     private let locomotionProfileSystem = LocomotionProfileSystem()
@@ -47,9 +60,11 @@ public final class DemoScene: RenderScene {
     private let worldPositionSyncSystem = WorldPositionSyncSystem()
     private let fixedRunner: FixedStepRunner
     private let extractSystem = RenderExtractSystem()
+    private let animationLODSystem = AnimationLODSystem()
 
     public init() {
         self.inputSystem = InputSystem(camera: camera)
+        self.assetStreamingSystem = AssetStreamingSystem(streamer: assetStreamer)
         self.collisionQueryRefreshSystem = CollisionQueryRefreshSystem(kinematicMoveSystem: kinematicMoveSystem,
                                                                        agentSeparationSystem: agentSeparationSystem,
                                                                        services: sceneServices)
@@ -57,6 +72,7 @@ public final class DemoScene: RenderScene {
             preFixed: [spinSystem,
                        oscillateMoveSystem,
                        activeChunkSystem,
+                       assetStreamingSystem,
                        physicsLocalizeSystem,
                        dodgeSystem,
                        physicsIntentSystem,
@@ -77,7 +93,7 @@ public final class DemoScene: RenderScene {
 
     public func build(context: SceneContext) {
         let device = context.device
-
+        fixedRunner.profiler = context.profiler
 
         // Camera initial state
         camera.position = SIMD3<Float>(0, 0, 8)
@@ -130,249 +146,48 @@ public final class DemoScene: RenderScene {
                                               rotation: t.rotation))
         }
 
-        // --- Static Mesh: 17-Cheese (render-only parts)
-        do {
-            if let asset = StaticMeshLoader.loadStaticMeshAsset(named: "17-Cheese.static") {
-                let materials = MaterialLoader.loadMaterials(named: "17-Cheese.materials", device: device)
-                let fallbackBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                    height: 4,
-                                                                    color: SIMD4<UInt8>(255, 255, 255, 255),
-                                                                    format: .rgba8UnormSrgb)
-                let fallbackMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                              height: 4,
-                                                                              metallic: 0.0,
-                                                                              roughness: 0.5)
-                let fallbackDesc = MaterialDescriptor(baseColor: fallbackBase,
-                                                      metallicRoughness: fallbackMR,
-                                                      metallicFactor: 1.0,
-                                                      roughnessFactor: 1.0,
-                                                      alpha: 1.0)
-                let fallbackMat = MaterialFactory.make(device: device, descriptor: fallbackDesc, label: "CheeseMatFallback")
-                let collisionBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                     height: 4,
-                                                                     color: SIMD4<UInt8>(80, 180, 255, 255),
-                                                                     format: .rgba8UnormSrgb)
-                let collisionMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                               height: 4,
-                                                                               metallic: 0.0,
-                                                                               roughness: 0.5)
-                let collisionDesc = MaterialDescriptor(baseColor: collisionBase,
-                                                       metallicRoughness: collisionMR,
-                                                       metallicFactor: 0.0,
-                                                       roughnessFactor: 1.0,
-                                                       alpha: 0.25,
-                                                       unlit: true)
-                let collisionMat = MaterialFactory.make(device: device, descriptor: collisionDesc, label: "CheeseCollisionMat")
-
-                for part in asset.parts {
-                    let t = DemoScene.transformFromMatrix(part.transform)
-                    let indices = DemoScene.indicesAsUInt32(part.mesh)
-                    for sub in part.submeshes {
-                        let start = max(sub.start, 0)
-                        let end = min(start + sub.count, indices.count)
-                        if start >= end { continue }
-                        let slice = Array(indices[start..<end])
-                        let maxIndex = slice.max() ?? 0
-                        let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? slice.map { UInt16($0) } : nil
-                        let indices32: [UInt32]? = indices16 == nil ? slice : nil
-                        let desc = ProceduralMeshDescriptor(topology: .triangles,
-                                                            streams: part.mesh.streams,
-                                                            indices16: indices16,
-                                                            indices32: indices32,
-                                                            name: "\(part.name):\(sub.material)")
-                        let mesh = GPUMesh(device: device, descriptor: desc, label: "Cheese:\(part.name):\(sub.material)")
-                        let mat = materials[sub.material] ?? fallbackMat
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: mesh, material: mat))
-                    }
-
-                    for (i, hull) in part.collisionHulls.enumerated() {
-                        let hullMesh = GPUMesh(device: device, descriptor: hull, label: "CheeseHull:\(part.name):\(i)")
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: hullMesh, material: collisionMat))
-                        world.add(e, StaticMeshComponent(mesh: hull,
-                                                         material: SurfaceMaterial(muS: 0.6, muK: 0.5),
-                                                         dirty: false,
-                                                         collides: true))
-                        world.add(e, PhysicsBodyComponent(bodyType: .static,
-                                                          position: t.translation,
-                                                          rotation: t.rotation))
-                    }
-                }
-            } else {
-                print("DemoScene: missing static mesh asset: 17-Cheese.static.json")
-            }
-        }
-
-        // --- Static Mesh: Semla (render + collision debug)
-        do {
-            if let asset = StaticMeshLoader.loadStaticMeshAsset(named: "Semla.static") {
-                let materials = MaterialLoader.loadMaterials(named: "Semla.materials", device: device)
-                let semlaLayer: UInt32 = 1 << 3
-                let fallbackBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                    height: 4,
-                                                                    color: SIMD4<UInt8>(255, 255, 255, 255),
-                                                                    format: .rgba8UnormSrgb)
-                let fallbackMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                              height: 4,
-                                                                              metallic: 0.0,
-                                                                              roughness: 0.5)
-                let fallbackDesc = MaterialDescriptor(baseColor: fallbackBase,
-                                                      metallicRoughness: fallbackMR,
-                                                      metallicFactor: 1.0,
-                                                      roughnessFactor: 1.0,
-                                                      alpha: 1.0)
-                let fallbackMat = MaterialFactory.make(device: device, descriptor: fallbackDesc, label: "SemlaMatFallback")
-                let collisionBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                     height: 4,
-                                                                     color: SIMD4<UInt8>(120, 220, 180, 255),
-                                                                     format: .rgba8UnormSrgb)
-                let collisionMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                               height: 4,
-                                                                               metallic: 0.0,
-                                                                               roughness: 0.5)
-                let collisionDesc = MaterialDescriptor(baseColor: collisionBase,
-                                                       metallicRoughness: collisionMR,
-                                                       metallicFactor: 0.0,
-                                                       roughnessFactor: 1.0,
-                                                       alpha: 0.25,
-                                                       unlit: true)
-                let collisionMat = MaterialFactory.make(device: device, descriptor: collisionDesc, label: "SemlaCollisionMat")
-
-                let semlaOffset = SIMD3<Float>(18, 0, 10)
-                for part in asset.parts {
-                    var t = DemoScene.transformFromMatrix(part.transform)
-                    t.translation += semlaOffset
-                    let indices = DemoScene.indicesAsUInt32(part.mesh)
-                    for sub in part.submeshes {
-                        let start = max(sub.start, 0)
-                        let end = min(start + sub.count, indices.count)
-                        if start >= end { continue }
-                        let slice = Array(indices[start..<end])
-                        let maxIndex = slice.max() ?? 0
-                        let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? slice.map { UInt16($0) } : nil
-                        let indices32: [UInt32]? = indices16 == nil ? slice : nil
-                        let desc = ProceduralMeshDescriptor(topology: .triangles,
-                                                            streams: part.mesh.streams,
-                                                            indices16: indices16,
-                                                            indices32: indices32,
-                                                            name: "\(part.name):\(sub.material)")
-                        let mesh = GPUMesh(device: device, descriptor: desc, label: "Semla:\(part.name):\(sub.material)")
-                        let mat = materials[sub.material] ?? fallbackMat
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: mesh, material: mat))
-                    }
-
-                    for (i, hull) in part.collisionHulls.enumerated() {
-                        let hullMesh = GPUMesh(device: device, descriptor: hull, label: "SemlaHull:\(part.name):\(i)")
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: hullMesh, material: collisionMat))
-                        world.add(e, StaticMeshComponent(mesh: hull,
-                                                         material: SurfaceMaterial(muS: 0.6, muK: 0.5),
-                                                         dirty: false,
-                                                         collides: true,
-                                                         collisionLayer: semlaLayer))
-                        world.add(e, PhysicsBodyComponent(bodyType: .static,
-                                                          position: t.translation,
-                                                          rotation: t.rotation))
-                    }
-                }
-            } else {
-                print("DemoScene: missing static mesh asset: Semla.static.json")
-            }
-        }
-
-        // --- Static Mesh: Ornate Mirror (render + collision debug)
+        // --- Static Meshes: streamed in the background; a placeholder shows until each lands
         do {
-            if let asset = StaticMeshLoader.loadStaticMeshAsset(named: "ornate_mirror.static") {
-                let materials = MaterialLoader.loadMaterials(named: "ornate-mirror.materials", device: device)
-                let mirrorLayer: UInt32 = 1 << 4
-                let fallbackBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                    height: 4,
-                                                                    color: SIMD4<UInt8>(255, 255, 255, 255),
-                                                                    format: .rgba8UnormSrgb)
-                let fallbackMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                              height: 4,
-                                                                              metallic: 0.0,
-                                                                              roughness: 0.5)
-                let fallbackDesc = MaterialDescriptor(baseColor: fallbackBase,
-                                                      metallicRoughness: fallbackMR,
-                                                      metallicFactor: 1.0,
-                                                      roughnessFactor: 1.0,
-                                                      alpha: 1.0)
-                let fallbackMat = MaterialFactory.make(device: device, descriptor: fallbackDesc, label: "MirrorMatFallback")
-                let collisionBase = ProceduralTextureGenerator.solid(width: 4,
-                                                                     height: 4,
-                                                                     color: SIMD4<UInt8>(200, 160, 255, 255),
-                                                                     format: .rgba8UnormSrgb)
-                let collisionMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
-                                                                               height: 4,
-                                                                               metallic: 0.0,
-                                                                               roughness: 0.5)
-                let collisionDesc = MaterialDescriptor(baseColor: collisionBase,
-                                                       metallicRoughness: collisionMR,
-                                                       metallicFactor: 0.0,
-                                                       roughnessFactor: 1.0,
-                                                       alpha: 0.25,
-                                                       unlit: true)
-                let collisionMat = MaterialFactory.make(device: device, descriptor: collisionDesc, label: "MirrorCollisionMat")
-
-                let mirrorOffset = SIMD3<Float>(-10, 1, 4)
-                for part in asset.parts {
-                    var t = DemoScene.transformFromMatrix(part.transform)
-                    let upright = simd_quatf(angle: .pi * 0.5, axis: SIMD3<Float>(1, 0, 0))
-                    let flip = simd_quatf(angle: .pi, axis: SIMD3<Float>(1, 0, 0))
-                    t.rotation = simd_mul(t.rotation, simd_mul(upright, flip))
-                    t.scale *= 8.0
-                    t.translation += mirrorOffset
-                    let indices = DemoScene.indicesAsUInt32(part.mesh)
-                    for sub in part.submeshes {
-                        let start = max(sub.start, 0)
-                        let end = min(start + sub.count, indices.count)
-                        if start >= end { continue }
-                        let slice = Array(indices[start..<end])
-                        let maxIndex = slice.max() ?? 0
-                        let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? slice.map { UInt16($0) } : nil
-                        let indices32: [UInt32]? = indices16 == nil ? slice : nil
-                        let desc = ProceduralMeshDescriptor(topology: .triangles,
-                                                            streams: part.mesh.streams,
-                                                            indices16: indices16,
-                                                            indices32: indices32,
-                                                            name: "\(part.name):\(sub.material)")
-                        let mesh = GPUMesh(device: device, descriptor: desc, label: "Mirror:\(part.name):\(sub.material)")
-                        let mat = materials[sub.material] ?? fallbackMat
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: mesh, material: mat))
-                    }
-
-                    for (i, hull) in part.collisionHulls.enumerated() {
-                        let hullMesh = GPUMesh(device: device, descriptor: hull, label: "MirrorHull:\(part.name):\(i)")
-                        let e = world.createEntity()
-                        world.add(e, t)
-                        world.add(e, WorldPositionComponent(translation: t.translation))
-                        world.add(e, RenderComponent(mesh: hullMesh, material: collisionMat))
-                        world.add(e, StaticMeshComponent(mesh: hull,
-                                                         material: SurfaceMaterial(muS: 0.6, muK: 0.5),
-                                                         dirty: false,
-                                                         collides: true,
-                                                         collisionLayer: mirrorLayer))
-                        world.add(e, PhysicsBodyComponent(bodyType: .static,
-                                                          position: t.translation,
-                                                          rotation: t.rotation))
-                    }
-                }
-            } else {
-                print("DemoScene: missing static mesh asset: ornate_mirror.static.json")
+            let placeholderMesh = GPUMesh(device: device,
+                                          descriptor: ProceduralMeshes.box(BoxParams(size: 1.0)),
+                                          label: "StreamingPlaceholder")
+            let placeholderMat = Material(baseColorFactor: SIMD3<Float>(0.5, 0.5, 0.5),
+                                          metallicFactor: 0.0,
+                                          roughnessFactor: 0.8,
+                                          alpha: 0.35)
+            let upright = simd_quatf(angle: .pi * 0.5, axis: SIMD3<Float>(1, 0, 0))
+            let flip = simd_quatf(angle: .pi, axis: SIMD3<Float>(1, 0, 0))
+            let streamed = [
+                StreamedStaticMesh(label: "Cheese",
+                                   asset: "17-Cheese.static",
+                                   materials: "17-Cheese.materials",
+                                   collisionColor: SIMD4<UInt8>(80, 180, 255, 255),
+                                   collisionLayer: CollisionLayer.defaultLayer,
+                                   offset: SIMD3<Float>(0, 0, 0)),
+                StreamedStaticMesh(label: "Semla",
+                                   asset: "Semla.static",
+                                   materials: "Semla.materials",
+                                   collisionColor: SIMD4<UInt8>(120, 220, 180, 255),
+                                   collisionLayer: 1 << 3,
+                                   offset: SIMD3<Float>(18, 0, 10)),
+                StreamedStaticMesh(label: "Mirror",
+                                   asset: "ornate_mirror.static",
+                                   materials: "ornate-mirror.materials",
+                                   collisionColor: SIMD4<UInt8>(200, 160, 255, 255),
+                                   collisionLayer: 1 << 4,
+                                   offset: SIMD3<Float>(-10, 1, 4),
+                                   rotation: simd_mul(upright, flip),
+                                   scale: 8.0)
+            ]
+            for spec in streamed {
+                let handle = DemoScene.registerStreamedStaticMesh(spec, device: device, streamer: assetStreamer)
+                let e = world.createEntity()
+                var t = TransformComponent()
+                t.translation = spec.offset
+                world.add(e, t)
+                world.add(e, WorldPositionComponent(translation: t.translation))
+                world.add(e, RenderComponent(mesh: placeholderMesh, material: placeholderMat))
+                world.add(e, StreamedAssetComponent(handle: handle))
             }
         }
 
@@ -685,9 +500,10 @@ public final class DemoScene: RenderScene {
 
         // --- FPS overlay resources
         fpsOverlaySystem = FPSOverlaySystem(device: device)
+        profilerOverlaySystem = ProfilerOverlaySystem(device: device, profiler: context.profiler)
 
         // Extract initial draw calls
-        renderItems = extractSystem.extract(world: world, camera: camera)
+        extractSystem.extract(world: world, camera: camera)
         sceneServices.rebuildAll(world: world)
 
         // New resources were created -> bump revision once
@@ -703,18 +519,168 @@ public final class DemoScene: RenderScene {
         }
         fixedRunner.update(world: world)
         inputSystem.updateCamera(world: world)
+        // Streamed assets that spawned this frame brought new GPU resources.
+        if assetStreamer.generation != streamedGeneration {
+            streamedGeneration = assetStreamer.generation
+            revision &+= 1
+        }
 
         camera.updateView()
+        animationLODSystem.update(world: world, camera: camera)
 
         // Render extraction (derived every frame)
-        renderItems = extractSystem.extract(world: world, camera: camera)
+        extractSystem.extract(world: world, camera: camera)
         overlayItems = fpsOverlaySystem?.update(dt: dt) ?? []
+        if profilerOverlayEnabled, let profilerOverlaySystem {
+            overlayItems += profilerOverlaySystem.update(dt: dt)
+        }
     }
 
     public func viewportDidChange(size: SIMD2<Float>) {
         fpsOverlaySystem?.viewportDidChange(size: size)
     }
 
+    // MARK: - Headless runs
+
+    /// The ECS world, for harnesses that step the scene without a view and inspect the result.
+    var simulationWorld: World { world }
+
+    /// Replays recorded controller frames, one per `update`; nil returns to the controller.
+    func playInput(_ frames: [InputFrame]?) {
+        inputSystem.play(frames)
+    }
+
+    func startInputRecording() {
+        inputSystem.startRecording()
+    }
+
+    func stopInputRecording() -> [InputFrame] {
+        inputSystem.stopRecording()
+    }
+
+    /// Loads streamed assets on the simulation thread so spawns land on a reproducible step.
+    var synchronousAssetLoads: Bool {
+        get { assetStreamer.synchronousLoads }
+        set { assetStreamer.synchronousLoads = newValue }
+    }
+
+    /// Builds every collision chunk on the simulation thread instead of the chunk build
+    /// queue, so chunk collision also lands on a reproducible step.
+    var synchronousCollisionChunks: Bool {
+        get { !sceneServices.collisionQuery.chunkCache.asyncBuilds }
+        set { sceneServices.collisionQuery.chunkCache.asyncBuilds = !newValue }
+    }
+
+    /// A static mesh asset placed in the demo and loaded through the asset streamer.
+    private nonisolated struct StreamedStaticMesh: Sendable {
+        let label: String
+        let asset: String
+        let materials: String
+        let collisionColor: SIMD4<UInt8>
+        let collisionLayer: UInt32
+        let offset: SIMD3<Float>
+        var rotation = simd_quatf(angle: 0, axis: SIMD3<Float>(0, 1, 0))
+        var scale: Float = 1.0
+    }
+
+    /// What a streamed static mesh load produces: GPU meshes are built on the load queue,
+    /// so spawning only creates entities.
+    private nonisolated struct StreamedStaticMeshPayload: Sendable {
+        nonisolated struct Part: Sendable {
+            let transform: matrix_float4x4
+            let meshes: [(mesh: GPUMesh, material: Material)]
+            let hulls: [(descriptor: ProceduralMeshDescriptor, mesh: GPUMesh)]
+        }
+        let parts: [Part]
+        let collisionMaterial: Material
+    }
+
+    private static func registerStreamedStaticMesh(_ spec: StreamedStaticMesh,
+                                                   device: MTLDevice,
+                                                   streamer: AssetStreamer) -> AssetHandle {
+        let load = { @Sendable () -> StreamedStaticMeshPayload? in
+            guard let asset = StaticMeshLoader.loadStaticMeshAsset(named: spec.asset, device: device, prefault: true) else {
+                print("DemoScene: missing static mesh asset: \(spec.asset).json")
+                return nil
+            }
+            let materials = MaterialLoader.loadMaterials(named: spec.materials, device: device)
+            let fallbackBase = ProceduralTextureGenerator.solid(width: 4,
+                                                                height: 4,
+                                                                color: SIMD4<UInt8>(255, 255, 255, 255),
+                                                                format: .rgba8UnormSrgb)
+            let fallbackMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
+                                                                          height: 4,
+                                                                          metallic: 0.0,
+                                                                          roughness: 0.5)
+            let fallbackDesc = MaterialDescriptor(baseColor: fallbackBase,
+                                                  metallicRoughness: fallbackMR,
+                                                  metallicFactor: 1.0,
+                                                  roughnessFactor: 1.0,
+                                                  alpha: 1.0)
+            let fallbackMat = MaterialFactory.make(device: device, descriptor: fallbackDesc, label: "\(spec.label)MatFallback")
+            let collisionBase = ProceduralTextureGenerator.solid(width: 4,
+                                                                 height: 4,
+                                                                 color: spec.collisionColor,
+                                                                 format: .rgba8UnormSrgb)
+            let collisionMR = ProceduralTextureGenerator.metallicRoughness(width: 4,
+                                                                           height: 4,
+                                                                           metallic: 0.0,
+                                                                           roughness: 0.5)
+            let collisionDesc = MaterialDescriptor(baseColor: collisionBase,
+                                                   metallicRoughness: collisionMR,
+                                                   metallicFactor: 0.0,
+                                                   roughnessFactor: 1.0,
+                                                   alpha: 0.25,
+                                                   unlit: true)
+            let collisionMat = MaterialFactory.make(device: device, descriptor: collisionDesc, label: "\(spec.label)CollisionMat")
+
+            let parts = asset.parts.map { part in
+                let meshes = part.submeshes.compactMap { sub -> (mesh: GPUMesh, material: Material)? in
+                    guard let mesh = StaticMeshLoader.gpuMesh(for: sub,
+                                                              of: part,
+                                                              device: device,
+                                                              label: "\(spec.label):\(part.name):\(sub.material)") else { return nil }
+                    return (mesh, materials[sub.material] ?? fallbackMat)
+                }
+                let hulls = part.collisionHulls.enumerated().map { i, hull in
+                    (hull, GPUMesh(device: device, descriptor: hull, label: "\(spec.label)Hull:\(part.name):\(i)"))
+                }
+                return StreamedStaticMeshPayload.Part(transform: part.transform, meshes: meshes, hulls: hulls)
+            }
+            return StreamedStaticMeshPayload(parts: parts, collisionMaterial: collisionMat)
+        }
+
+        return streamer.register(spec.asset, load: load) { world, _, payload in
+            for part in payload.parts {
+                var t = DemoScene.transformFromMatrix(part.transform)
+                t.rotation = simd_mul(t.rotation, spec.rotation)
+                t.scale *= spec.scale
+                t.translation += spec.offset
+                for (mesh, material) in part.meshes {
+                    let e = world.createEntity()
+                    world.add(e, t)
+                    world.add(e, WorldPositionComponent(translation: t.translation))
+                    world.add(e, RenderComponent(mesh: mesh, material: material))
+                }
+
+                for (hull, hullMesh) in part.hulls {
+                    let e = world.createEntity()
+                    world.add(e, t)
+                    world.add(e, WorldPositionComponent(translation: t.translation))
+                    world.add(e, RenderComponent(mesh: hullMesh, material: payload.collisionMaterial))
+                    world.add(e, StaticMeshComponent(mesh: hull,
+                                                     material: SurfaceMaterial(muS: 0.6, muK: 0.5),
+                                                     dirty: false,
+                                                     collides: true,
+                                                     collisionLayer: spec.collisionLayer))
+                    world.add(e, PhysicsBodyComponent(bodyType: .static,
+                                                      position: t.translation,
+                                                      rotation: t.rotation))
+                }
+            }
+        }
+    }
+
     private static func transformFromMatrix(_ m: matrix_float4x4) -> TransformComponent {
         let translation = SIMD3<Float>(m.columns.3.x, m.columns.3.y, m.columns.3.z)
         let x = SIMD3<Float>(m.columns.0.x, m.columns.0.y, m.columns.0.z)
@@ -733,11 +699,4 @@ public final class DemoScene: RenderScene {
                                   rotation: rotation,
                                   scale: scale)
     }
-
-    private static func indicesAsUInt32(_ mesh: ProceduralMeshDescriptor) -> [UInt32] {
-        if let i16 = mesh.indices16 {
-            return i16.map { UInt32($0) }
-        }
-        return mesh.indices32 ?? []
-    }
 }
@@ -0,0 +1,150 @@
+//
+//  DynamicResolution.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+/// GPU time of the most recently completed frame, written from command buffer completion
+/// handlers and read on the frame thread. A frame is every command buffer tracked on its
+/// `GPUFrameSpan` (the main buffer and the async compute one), timed from the earliest GPU
+/// start to the latest GPU end, so async work outside the main buffer counts too.
+nonisolated final class GPUFrameTimer: @unchecked Sendable {
+    private let lock = NSLock()
+    private var latest: Double?
+
+    /// Starts a frame: track its command buffers on the span, then close it.
+    func beginFrame() -> GPUFrameSpan {
+        GPUFrameSpan(timer: self)
+    }
+
+    fileprivate func record(_ ms: Double) {
+        lock.lock()
+        latest = ms
+        lock.unlock()
+    }
+
+    /// The newest measurement, once; nil until another frame completes.
+    func take() -> Double? {
+        lock.lock()
+        defer { lock.unlock() }
+        let value = latest
+        latest = nil
+        return value
+    }
+}
+
+/// Command buffers of one frame. All state is guarded by `lock`; `pending` counts tracked
+/// buffers that have not completed, and the span is reported once it is closed and none
+/// remain, so a buffer finishing before the last one is tracked cannot end the frame early.
+nonisolated final class GPUFrameSpan: @unchecked Sendable {
+    private let lock = NSLock()
+    private let timer: GPUFrameTimer
+    private var pending = 0
+    private var closed = false
+    private var failed = false
+    private var start = Double.greatestFiniteMagnitude
+    private var end = 0.0
+
+    fileprivate init(timer: GPUFrameTimer) {
+        self.timer = timer
+    }
+
+    /// Adds `commandBuffer` to the frame; call before committing it.
+    func track(_ commandBuffer: MTLCommandBuffer) {
+        lock.lock()
+        pending += 1
+        lock.unlock()
+        commandBuffer.addCompletedHandler { buffer in
+            self.complete(buffer)
+        }
+    }
+
+    /// Ends the frame; call before committing its last command buffer.
+    func close() {
+        lock.lock()
+        closed = true
+        let ms = finishedMilliseconds()
+        lock.unlock()
+        if let ms {
+            timer.record(ms)
+        }
+    }
+
+    private func complete(_ buffer: MTLCommandBuffer) {
+        lock.lock()
+        if buffer.status == .completed, buffer.gpuEndTime > buffer.gpuStartTime {
+            start = min(start, buffer.gpuStartTime)
+            end = max(end, buffer.gpuEndTime)
+        } else {
+            failed = true
+        }
+        pending -= 1
+        let ms = finishedMilliseconds()
+        lock.unlock()
+        if let ms {
+            timer.record(ms)
+        }
+    }
+
+    /// The frame's GPU time once it is closed and every buffer completed. Caller holds `lock`.
+    private func finishedMilliseconds() -> Double? {
+        guard closed, pending == 0, !failed, end > start else { return nil }
+        return (end - start) * 1000
+    }
+}
+
+/// Steers the RT resolution scale toward a GPU frame-time target. Trace cost follows the
+/// traced pixel count (scale squared), so each move aims at `scale * sqrt(target / time)`
+/// from the smoothed GPU time, capped per step and taken at half size when growing.
+/// Inside the deadband nothing moves, and after a move the controller waits for frames
+/// in flight to report the new cost before moving again.
+final class DynamicResolutionController {
+    var targetMilliseconds: Double = 1000.0 / 60.0
+    var minScale: Float = 0.25
+    var maxScale: Float = 1.0
+    /// Relative error of the smoothed time that is tolerated without a move.
+    var deadband: Double = 0.06
+    /// Largest change of the scale per move.
+    var maxStep: Float = 0.1
+    /// Weight of the newest measurement in the smoothed time.
+    var smoothing: Double = 0.2
+
+    private(set) var scale: Float = 1.0
+    private var smoothedMilliseconds: Double?
+    private var cooldown = 0
+
+    /// Folds in a GPU frame time (nil when none completed) and returns the scale to trace at.
+    func update(gpuMilliseconds: Double?) -> Float {
+        scale = min(max(scale, minScale), maxScale)
+        guard let ms = gpuMilliseconds, ms > 0 else { return scale }
+        let smoothed = smoothedMilliseconds.map { $0 + (ms - $0) * smoothing } ?? ms
+        smoothedMilliseconds = smoothed
+        if cooldown > 0 {
+            cooldown -= 1
+            return scale
+        }
+
+        let ratio = targetMilliseconds / smoothed
+        guard abs(ratio - 1) > deadband else { return scale }
+        let desired = scale * Float(ratio.squareRoot())
+        var step = min(max(desired - scale, -maxStep), maxStep)
+        if step > 0 {
+            step *= 0.5
+        }
+        let next = min(max(scale + step, minScale), maxScale)
+        if next != scale {
+            scale = next
+            cooldown = maxBuffersInFlight
+        }
+        return scale
+    }
+
+    /// Forgets the smoothed time, e.g. after the target or the drawable size changed.
+    func reset() {
+        smoothedMilliseconds = nil
+        cooldown = 0
+    }
+}
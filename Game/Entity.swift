@@ -8,7 +8,7 @@
 import Foundation
 
 /// Entity is just an opaque ID.
-public struct Entity: Hashable, Sendable {
+public nonisolated struct Entity: Hashable, Sendable {
     public let id: UInt32
     public init(_ id: UInt32) { self.id = id }
 }
@@ -0,0 +1,202 @@
+//
+//  FrameProfiler.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+import os
+
+public nonisolated enum ProfileDomain {
+    case cpu
+    case gpu
+}
+
+/// One timed range. Times are host uptime nanoseconds (`DispatchTime`); GPU ranges are
+/// converted into the same timeline by `GPUProfiler`.
+public nonisolated struct ProfileSample {
+    public var name: String
+    public var domain: ProfileDomain
+    public var frame: UInt64
+    public var startNanoseconds: UInt64
+    public var durationNanoseconds: UInt64
+}
+
+/// A scope's smoothed time per frame, in first-seen order per domain.
+public nonisolated struct ProfileEntry {
+    public var name: String
+    public var domain: ProfileDomain
+    public var milliseconds: Double
+}
+
+/// Collects CPU scopes and GPU timestamps per frame and keeps a smoothed per-scope
+/// breakdown for the overlay. CPU scopes are also os_signpost intervals (Points of
+/// Interest in Instruments). Between `startRecording` and `writeTrace` every sample is
+/// kept for export as a Chrome trace (chrome://tracing, Perfetto). Scopes may be measured
+/// from scheduler workers; everything else runs on the frame thread.
+public nonisolated final class FrameProfiler: @unchecked Sendable {
+    private struct Key: Hashable {
+        let name: String
+        let domain: ProfileDomain
+    }
+
+    private static let log = OSLog(subsystem: "Game", category: .pointsOfInterest)
+    /// Entries whose smoothed time decays below this are dropped from the breakdown.
+    private static let dropMilliseconds = 0.0005
+
+    /// Clear to skip CPU scopes (the body still runs) and GPU sampling.
+    public var enabled = true
+    /// Weight of the newest frame in the smoothed breakdown.
+    public var smoothing: Double = 0.1
+
+    private let lock = NSLock()
+    private var frame: UInt64 = 0
+    private var pending: [ProfileSample] = []
+    private var smoothed: [Key: Double] = [:]
+    private var order: [Key] = []
+    private var recording: [ProfileSample]?
+    private var recordingLimit = 0
+
+    public init() {}
+
+    /// Frame new samples are attributed to.
+    public var currentFrame: UInt64 {
+        lock.lock()
+        defer { lock.unlock() }
+        return frame
+    }
+
+    /// Folds the last frame's samples (and any GPU results that landed) into the breakdown
+    /// and starts the next frame.
+    public func beginFrame() {
+        lock.lock()
+        defer { lock.unlock() }
+
+        var totals: [Key: UInt64] = [:]
+        for sample in pending {
+            totals[Key(name: sample.name, domain: sample.domain), default: 0] += sample.durationNanoseconds
+        }
+        if var recorded = recording {
+            let room = max(recordingLimit - recorded.count, 0)
+            recorded.append(contentsOf: pending.prefix(room))
+            recording = recorded
+        }
+        pending.removeAll(keepingCapacity: true)
+
+        for (key, total) in totals where smoothed[key] == nil {
+            smoothed[key] = Double(total) / 1_000_000
+            order.append(key)
+        }
+        for key in order {
+            let ms = Double(totals[key] ?? 0) / 1_000_000
+            smoothed[key] = smoothed[key]! * (1 - smoothing) + ms * smoothing
+        }
+        order.removeAll { key in
+            guard totals[key] == nil, smoothed[key]! < FrameProfiler.dropMilliseconds else { return false }
+            smoothed[key] = nil
+            return true
+        }
+        frame &+= 1
+    }
+
+    /// Times `body` as a CPU scope of the current frame.
+    @discardableResult
+    public func measure<T>(_ name: String, _ body: () throws -> T) rethrows -> T {
+        guard enabled else { return try body() }
+        let id = OSSignpostID(log: FrameProfiler.log)
+        os_signpost(.begin, log: FrameProfiler.log, name: "Scope", signpostID: id, "%{public}s", name)
+        let start = DispatchTime.now().uptimeNanoseconds
+        defer {
+            let end = DispatchTime.now().uptimeNanoseconds
+            os_signpost(.end, log: FrameProfiler.log, name: "Scope", signpostID: id)
+            record(name: name, domain: .cpu, frame: nil, startNanoseconds: start, durationNanoseconds: end &- start)
+        }
+        return try body()
+    }
+
+    /// Adds a finished range; `frame` nil means the current frame. GPU ranges arrive a few
+    /// frames late and are posted as signpost events since their interval has passed.
+    func record(name: String,
+                domain: ProfileDomain,
+                frame: UInt64?,
+                startNanoseconds: UInt64,
+                durationNanoseconds: UInt64) {
+        if domain == .gpu {
+            os_signpost(.event, log: FrameProfiler.log, name: "GPU", "%{public}s %.3f ms",
+                        name, Double(durationNanoseconds) / 1_000_000)
+        }
+        lock.lock()
+        pending.append(ProfileSample(name: name,
+                                     domain: domain,
+                                     frame: frame ?? self.frame,
+                                     startNanoseconds: startNanoseconds,
+                                     durationNanoseconds: durationNanoseconds))
+        lock.unlock()
+    }
+
+    /// Smoothed milliseconds per scope, CPU scopes first.
+    public func breakdown() -> [ProfileEntry] {
+        lock.lock()
+        defer { lock.unlock() }
+        let entries = order.map { ProfileEntry(name: $0.name, domain: $0.domain, milliseconds: smoothed[$0] ?? 0) }
+        return entries.filter { $0.domain == .cpu } + entries.filter { $0.domain == .gpu }
+    }
+
+    /// Keeps every sample from now on, up to `maxSamples`, for `writeTrace`.
+    public func startRecording(maxSamples: Int = 1_000_000) {
+        lock.lock()
+        recording = []
+        recordingLimit = maxSamples
+        lock.unlock()
+    }
+
+    /// Stops recording and returns what was kept.
+    @discardableResult
+    public func stopRecording() -> [ProfileSample] {
+        lock.lock()
+        defer { lock.unlock() }
+        let recorded = recording ?? []
+        recording = nil
+        return recorded
+    }
+
+    /// Writes the samples recorded so far as Chrome trace JSON, CPU and GPU on separate
+    /// tracks. Recording continues.
+    @discardableResult
+    public func writeTrace(to url: URL) -> Bool {
+        lock.lock()
+        let recorded = recording ?? []
+        lock.unlock()
+        guard let first = recorded.map(\.startNanoseconds).min() else {
+            print("FrameProfiler: nothing recorded")
+            return false
+        }
+
+        var events: [[String: Any]] = [
+            ["name": "thread_name", "ph": "M", "pid": 1, "tid": 1, "args": ["name": "CPU"]],
+            ["name": "thread_name", "ph": "M", "pid": 1, "tid": 2, "args": ["name": "GPU"]]
+        ]
+        events.reserveCapacity(recorded.count + 2)
+        for sample in recorded {
+            events.append([
+                "name": sample.name,
+                "cat": sample.domain == .cpu ? "cpu" : "gpu",
+                "ph": "X",
+                "pid": 1,
+                "tid": sample.domain == .cpu ? 1 : 2,
+                "ts": Double(sample.startNanoseconds &- first) / 1000,
+                "dur": Double(sample.durationNanoseconds) / 1000,
+                "args": ["frame": sample.frame]
+            ])
+        }
+        do {
+            let data = try JSONSerialization.data(withJSONObject: ["traceEvents": events, "displayTimeUnit": "ms"])
+            try data.write(to: url, options: .atomic)
+            return true
+        } catch {
+            print("FrameProfiler: unable to write trace:", url.path, error)
+            return false
+        }
+    }
+}
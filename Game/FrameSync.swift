@@ -19,9 +19,17 @@ final class FrameSync {
         self.event.signaledValue = UInt64(self.frameIndex - 1)
     }
 
-    func waitIfNeeded(timeoutMS: UInt64 = 10) {
+    /// Ring slot for the frame being encoded. The last frame to use this slot is the one
+    /// `waitIfNeeded` waits for, so CPU writes into per-slot buffers never race the GPU.
+    var slot: Int {
+        frameIndex % maxFramesInFlight
+    }
+
+    /// Returns false on timeout; the caller must not write this slot's buffers then.
+    @discardableResult
+    func waitIfNeeded(timeoutMS: UInt64 = 1000) -> Bool {
         let previousValueToWaitFor = frameIndex - maxFramesInFlight
-        event.wait(untilSignaledValue: UInt64(previousValueToWaitFor), timeoutMS: timeoutMS)
+        return event.wait(untilSignaledValue: UInt64(previousValueToWaitFor), timeoutMS: timeoutMS)
     }
 
     func signalNextFrame(on commandBuffer: MTLCommandBuffer) {
@@ -29,3 +37,26 @@ final class FrameSync {
         frameIndex += 1
     }
 }
+
+/// One shared buffer per frame slot for data the CPU rewrites every frame, grown on demand.
+struct FrameSlotBuffers {
+    private var buffers: [MTLBuffer?]
+    private let label: String
+
+    init(label: String, slots: Int = maxBuffersInFlight) {
+        self.buffers = Array(repeating: nil, count: slots)
+        self.label = label
+    }
+
+    /// The slot's buffer, reallocated if shorter than `length`.
+    mutating func buffer(slot: Int, length: Int, device: MTLDevice) -> MTLBuffer? {
+        let i = slot % buffers.count
+        if let existing = buffers[i], existing.length >= length {
+            return existing
+        }
+        let created = device.makeBuffer(length: max(length, 1), options: [.storageModeShared])
+        created?.label = label
+        buffers[i] = created
+        return created
+    }
+}
@@ -6,12 +6,64 @@
 //
 
 import Metal
+import simd
 
-public final class GPUMesh {
+/// Immutable once created, and Metal buffers may be shared between threads, so asset loads
+/// build these off the main thread.
+public nonisolated final class GPUMesh: @unchecked Sendable {
     public let vertexBuffer: MTLBuffer
     public let indexBuffer: MTLBuffer
     public let indexType: MTLIndexType
     public let indexCount: Int
+    /// Vertices in `vertexBuffer`, which may be longer (cooked buffers are page padded).
+    public let vertexCount: Int
+    /// Local-space bounding sphere of the vertices, used for raster culling.
+    public let boundingCenter: SIMD3<Float>
+    public let boundingRadius: Float
+
+    /// `vertexBuffer` holds `VertexPNUT`s; `bounds` is computed from them when not given
+    /// (pass it when several submeshes share one vertex buffer).
+    public init(vertexBuffer: MTLBuffer,
+                vertexCount: Int,
+                indexBuffer: MTLBuffer,
+                indexType: MTLIndexType,
+                indexCount: Int,
+                bounds: (center: SIMD3<Float>, radius: Float)? = nil) {
+        self.vertexBuffer = vertexBuffer
+        self.vertexCount = vertexCount
+        self.indexBuffer = indexBuffer
+        self.indexType = indexType
+        self.indexCount = indexCount
+        let sphere = bounds ?? GPUMesh.bounds(vertexBuffer: vertexBuffer, vertexCount: vertexCount)
+        self.boundingCenter = sphere.center
+        self.boundingRadius = sphere.radius
+    }
+
+    /// Bounding sphere of the first `vertexCount` `VertexPNUT`s in a shared buffer.
+    public static func bounds(vertexBuffer: MTLBuffer, vertexCount: Int) -> (center: SIMD3<Float>, radius: Float) {
+        let count = min(vertexCount, vertexBuffer.length / MemoryLayout<VertexPNUT>.stride)
+        let vertices = UnsafeBufferPointer(start: vertexBuffer.contents().bindMemory(to: VertexPNUT.self, capacity: count),
+                                           count: count)
+        return bounds(count: count) { vertices[$0].position }
+    }
+
+    /// Sphere around the AABB center of `count` positions.
+    private static func bounds(count: Int, position: (Int) -> SIMD3<Float>) -> (center: SIMD3<Float>, radius: Float) {
+        guard count > 0 else { return (.zero, 0) }
+        var lo = position(0)
+        var hi = lo
+        for i in 1..<count {
+            let p = position(i)
+            lo = simd_min(lo, p)
+            hi = simd_max(hi, p)
+        }
+        let center = (lo + hi) * 0.5
+        var radiusSquared: Float = 0
+        for i in 0..<count {
+            radiusSquared = max(radiusSquared, simd_length_squared(position(i) - center))
+        }
+        return (center, radiusSquared.squareRoot())
+    }
 
     public init(device: MTLDevice, descriptor: ProceduralMeshDescriptor, label: String = "GPUMesh") {
         guard descriptor.validate() else {
@@ -43,6 +95,10 @@ public final class GPUMesh {
         let vSize = vertices.count * MemoryLayout<VertexPNUT>.stride
         self.vertexBuffer = device.makeBuffer(bytes: vertices, length: max(vSize, 1), options: [.storageModeShared])!
         self.vertexBuffer.label = "\(label).vb"
+        self.vertexCount = vertices.count
+        let sphere = GPUMesh.bounds(count: positions.count) { positions[$0] }
+        self.boundingCenter = sphere.center
+        self.boundingRadius = sphere.radius
 
         if let i16 = descriptor.indices16 {
             self.indexType = .uint16
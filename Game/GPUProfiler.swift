@@ -0,0 +1,176 @@
+//
+//  GPUProfiler.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+/// GPU timestamps from counter sample buffers: each profiled encoder samples at its start
+/// and end. There is one sample buffer per frame slot, resolved when the slot comes around
+/// again (after `FrameSync` waited for it), so results reach `FrameProfiler` about
+/// `maxBuffersInFlight` frames late. `init` fails without stage-boundary sampling.
+final class GPUProfiler {
+    static let maxScopesPerFrame = 128
+
+    private let profiler: FrameProfiler
+    private let device: MTLDevice
+    private let sampleBuffers: [MTLCounterSampleBuffer]
+    private var scopes: [[String]]
+    private var slotFrames: [UInt64]
+    private var slot = 0
+
+    /// GPU timestamps are mapped to host time with `sampleTimestamps`, measured against
+    /// the pair taken at init so the rate estimate sharpens as the baseline grows.
+    private let nanosecondsPerCPUTick: Double
+    private let cpuReference: MTLTimestamp
+    private let gpuReference: MTLTimestamp
+    private var cpuLatest: MTLTimestamp = 0
+    private var gpuLatest: MTLTimestamp = 0
+    private var nanosecondsPerGPUTick: Double = 1
+
+    init?(device: MTLDevice, profiler: FrameProfiler, slots: Int = maxBuffersInFlight) {
+        guard device.supportsCounterSampling(.atStageBoundary),
+              let counterSet = device.counterSets?.first(where: { $0.name == MTLCommonCounterSet.timestamp.rawValue }) else {
+            print("GPUProfiler: stage-boundary timestamps unsupported")
+            return nil
+        }
+        let desc = MTLCounterSampleBufferDescriptor()
+        desc.counterSet = counterSet
+        desc.storageMode = .shared
+        desc.sampleCount = GPUProfiler.maxScopesPerFrame * 2
+        var buffers: [MTLCounterSampleBuffer] = []
+        for i in 0..<slots {
+            desc.label = "GPUProfiler\(i)"
+            do {
+                buffers.append(try device.makeCounterSampleBuffer(descriptor: desc))
+            } catch {
+                print("GPUProfiler: unable to create counter sample buffer. Error info: \(error)")
+                return nil
+            }
+        }
+
+        var timebase = mach_timebase_info_data_t()
+        mach_timebase_info(&timebase)
+        var cpu: MTLTimestamp = 0
+        var gpu: MTLTimestamp = 0
+        device.sampleTimestamps(&cpu, gpuTimestamp: &gpu)
+
+        self.profiler = profiler
+        self.device = device
+        self.sampleBuffers = buffers
+        self.scopes = Array(repeating: [], count: slots)
+        self.slotFrames = Array(repeating: 0, count: slots)
+        self.nanosecondsPerCPUTick = Double(timebase.numer) / Double(timebase.denom)
+        self.cpuReference = cpu
+        self.gpuReference = gpu
+        self.cpuLatest = cpu
+        self.gpuLatest = gpu
+    }
+
+    /// Resolves what the slot's previous frame sampled, then reuses it for this frame.
+    /// Call after `FrameSync.waitIfNeeded`.
+    func beginFrame(slot: Int) {
+        self.slot = slot % sampleBuffers.count
+        calibrate()
+        resolve(self.slot)
+        scopes[self.slot].removeAll(keepingCapacity: true)
+        slotFrames[self.slot] = profiler.currentFrame
+    }
+
+    /// Sample indices for one encoder named `name`, or nil when profiling is off or this
+    /// frame's buffer is full.
+    fileprivate func reserve(_ name: String) -> (buffer: MTLCounterSampleBuffer, start: Int, end: Int)? {
+        guard profiler.enabled, scopes[slot].count < GPUProfiler.maxScopesPerFrame else { return nil }
+        let start = scopes[slot].count * 2
+        scopes[slot].append(name)
+        return (sampleBuffers[slot], start, start + 1)
+    }
+
+    /// Samples the render pass made from `descriptor` as `scope`, or clears a previous
+    /// attachment when nothing can be reserved.
+    func attach(to descriptor: MTLRenderPassDescriptor, scope: String) {
+        guard let attachment = descriptor.sampleBufferAttachments[0] else { return }
+        guard let samples = reserve(scope) else {
+            attachment.sampleBuffer = nil
+            return
+        }
+        attachment.sampleBuffer = samples.buffer
+        attachment.startOfVertexSampleIndex = samples.start
+        attachment.endOfVertexSampleIndex = MTLCounterDontSample
+        attachment.startOfFragmentSampleIndex = MTLCounterDontSample
+        attachment.endOfFragmentSampleIndex = samples.end
+    }
+
+    private func calibrate() {
+        device.sampleTimestamps(&cpuLatest, gpuTimestamp: &gpuLatest)
+        guard gpuLatest > gpuReference, cpuLatest > cpuReference else { return }
+        nanosecondsPerGPUTick = Double(cpuLatest - cpuReference) * nanosecondsPerCPUTick
+            / Double(gpuLatest - gpuReference)
+    }
+
+    private func hostNanoseconds(_ gpu: MTLTimestamp) -> UInt64 {
+        let cpu = Double(cpuLatest) * nanosecondsPerCPUTick
+            + (Double(gpu) - Double(gpuLatest)) * nanosecondsPerGPUTick
+        return UInt64(max(cpu, 0))
+    }
+
+    private func resolve(_ slot: Int) {
+        let names = scopes[slot]
+        guard !names.isEmpty,
+              let data = sampleBuffers[slot].resolveCounterRange(0..<names.count * 2) else { return }
+        data.withUnsafeBytes { raw in
+            let stamps = raw.bindMemory(to: MTLCounterResultTimestamp.self)
+            guard stamps.count >= names.count * 2 else { return }
+            for (i, name) in names.enumerated() {
+                let start = stamps[i * 2].timestamp
+                let end = stamps[i * 2 + 1].timestamp
+                // Encoders that were never committed or had no work report error values.
+                guard start != 0, start != MTLCounterErrorValue, end != MTLCounterErrorValue, end >= start else {
+                    continue
+                }
+                profiler.record(name: name,
+                                domain: .gpu,
+                                frame: slotFrames[slot],
+                                startNanoseconds: hostNanoseconds(start),
+                                durationNanoseconds: UInt64(Double(end - start) * nanosecondsPerGPUTick))
+            }
+        }
+    }
+}
+
+extension MTLCommandBuffer {
+    /// Compute encoder labelled `scope`, sampled by `profiler` when there is one.
+    func makeComputeCommandEncoder(profiler: GPUProfiler?, scope: String) -> MTLComputeCommandEncoder? {
+        let encoder: MTLComputeCommandEncoder?
+        if let samples = profiler?.reserve(scope) {
+            let desc = MTLComputePassDescriptor()
+            desc.sampleBufferAttachments[0].sampleBuffer = samples.buffer
+            desc.sampleBufferAttachments[0].startOfEncoderSampleIndex = samples.start
+            desc.sampleBufferAttachments[0].endOfEncoderSampleIndex = samples.end
+            encoder = makeComputeCommandEncoder(descriptor: desc)
+        } else {
+            encoder = makeComputeCommandEncoder()
+        }
+        encoder?.label = scope
+        return encoder
+    }
+
+    /// Acceleration-structure encoder labelled `scope`, sampled by `profiler` when there is one.
+    func makeAccelerationStructureCommandEncoder(profiler: GPUProfiler?,
+                                                 scope: String) -> MTLAccelerationStructureCommandEncoder? {
+        let encoder: MTLAccelerationStructureCommandEncoder?
+        if let samples = profiler?.reserve(scope) {
+            let desc = MTLAccelerationStructurePassDescriptor()
+            desc.sampleBufferAttachments[0].sampleBuffer = samples.buffer
+            desc.sampleBufferAttachments[0].startOfEncoderSampleIndex = samples.start
+            desc.sampleBufferAttachments[0].endOfEncoderSampleIndex = samples.end
+            encoder = makeAccelerationStructureCommandEncoder(descriptor: desc)
+        } else {
+            encoder = makeAccelerationStructureCommandEncoder()
+        }
+        encoder?.label = scope
+        return encoder
+    }
+}
@@ -5,24 +5,329 @@
 //  Created by Codex on 3/9/26.
 //
 
+import CryptoKit
+import Foundation
 import Metal
+import MetalKit
 import simd
 
+/// Mirrors `IBLParams` in IBL.metalinc.
+private struct IBLParamsSwift {
+    var size: UInt32
+    var sampleCount: UInt32
+    var roughness: Float
+    var useEquirect: UInt32
+    var sourceSize: Float
+    var sourceMipCount: Float
+}
+
+/// Prefiltered environment cube and split-sum BRDF LUT for image-based lighting.
+/// Both are generated by compute kernels (IBL.metalinc) from an equirectangular HDR
+/// environment when one is bundled, else from the procedural sky, and cached on disk under
+/// Caches/IBL keyed by a hash of the inputs and settings, so later launches only read the
+/// file. Without the kernels the old CPU path fills the textures instead.
 final class IBLResources {
+    /// Bump when the kernels change what they write, so stale caches are ignored.
+    static let cacheVersion: UInt32 = 1
+    static let prefilterSampleCount = 512
+    static let brdfSampleCount = 256
+
     let envCube: MTLTexture
     let brdfLUT: MTLTexture
     let envMipCount: UInt32
 
-    init(device: MTLDevice) {
-        let envSize = 128
+    /// `Environment.hdr` or `Environment.exr` from the bundle, if present.
+    static func bundledEnvironmentURL() -> URL? {
+        Bundle.main.url(forResource: "Environment", withExtension: "hdr")
+            ?? Bundle.main.url(forResource: "Environment", withExtension: "exr")
+    }
+
+    init(device: MTLDevice,
+         environmentURL: URL? = IBLResources.bundledEnvironmentURL(),
+         envSize: Int = 128,
+         lutSize: Int = 128) {
         let envDesc = MTLTextureDescriptor.textureCubeDescriptor(pixelFormat: .rgba16Float,
                                                                   size: envSize,
                                                                   mipmapped: true)
-        envDesc.usage = [.shaderRead]
+        envDesc.usage = [.shaderRead, .shaderWrite]
         envDesc.storageMode = .shared
         let env = device.makeTexture(descriptor: envDesc)!
         env.label = "IBL.EnvCube"
 
+        let lutDesc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .rgba32Float,
+                                                               width: lutSize,
+                                                               height: lutSize,
+                                                               mipmapped: false)
+        lutDesc.usage = [.shaderRead, .shaderWrite]
+        lutDesc.storageMode = .shared
+        let lut = device.makeTexture(descriptor: lutDesc)!
+        lut.label = "IBL.BRDFLUT"
+
+        self.envCube = env
+        self.brdfLUT = lut
+        self.envMipCount = UInt32(env.mipmapLevelCount)
+
+        let environmentData = environmentURL.flatMap { try? Data(contentsOf: $0) }
+        if environmentURL != nil && environmentData == nil {
+            print("IBLResources: unable to read environment:", environmentURL!.path)
+        }
+        let cacheURL = IBLResources.cacheURL(environment: environmentData, envSize: envSize, lutSize: lutSize)
+
+        if let cacheURL, IBLResources.loadCache(cacheURL, env: env, lut: lut) {
+            return
+        }
+        if IBLResources.generateOnGPU(device: device,
+                                      env: env,
+                                      lut: lut,
+                                      environmentURL: environmentData == nil ? nil : environmentURL) {
+            if let cacheURL {
+                IBLResources.writeCache(cacheURL, env: env, lut: lut)
+            }
+            return
+        }
+        print("IBLResources: compute generation unavailable, using the CPU fallback")
+        IBLResources.fillEnvOnCPU(env)
+        IBLResources.fillLUTOnCPU(lut)
+    }
+
+    // MARK: GPU generation
+
+    private static func generateOnGPU(device: MTLDevice,
+                                      env: MTLTexture,
+                                      lut: MTLTexture,
+                                      environmentURL: URL?) -> Bool {
+        guard let library = device.makeDefaultLibrary(),
+              let sourceFn = library.makeFunction(name: "iblSourceKernel"),
+              let prefilterFn = library.makeFunction(name: "iblPrefilterKernel"),
+              let brdfFn = library.makeFunction(name: "iblBRDFKernel"),
+              let queue = device.makeCommandQueue() else {
+            return false
+        }
+        let sourcePipeline: MTLComputePipelineState
+        let prefilterPipeline: MTLComputePipelineState
+        let brdfPipeline: MTLComputePipelineState
+        do {
+            sourcePipeline = try device.makeComputePipelineState(function: sourceFn)
+            prefilterPipeline = try device.makeComputePipelineState(function: prefilterFn)
+            brdfPipeline = try device.makeComputePipelineState(function: brdfFn)
+        } catch {
+            print("IBLResources: unable to compile IBL kernels. Error info: \(error)")
+            return false
+        }
+
+        var equirect: MTLTexture?
+        if let environmentURL {
+            do {
+                equirect = try MTKTextureLoader(device: device).newTexture(URL: environmentURL, options: [
+                    .SRGB: false,
+                    .textureUsage: NSNumber(value: MTLTextureUsage.shaderRead.rawValue),
+                    .textureStorageMode: NSNumber(value: MTLStorageMode.private.rawValue),
+                ])
+            } catch {
+                print("IBLResources: unable to load environment:", environmentURL.path, error)
+            }
+        }
+
+        // Twice the output resolution so mip 0 (a mirror) and the sun stay sharp.
+        let sourceSize = env.width * 2
+        let sourceDesc = MTLTextureDescriptor.textureCubeDescriptor(pixelFormat: .rgba16Float,
+                                                                     size: sourceSize,
+                                                                     mipmapped: true)
+        sourceDesc.usage = [.shaderRead, .shaderWrite]
+        sourceDesc.storageMode = .private
+        guard let source = device.makeTexture(descriptor: sourceDesc),
+              let placeholder = equirect ?? makePlaceholder2D(device: device),
+              let commandBuffer = queue.makeCommandBuffer() else {
+            return false
+        }
+        source.label = "IBL.Source"
+        commandBuffer.label = "IBL.Generate"
+
+        let sourceMip0 = source.makeTextureView(pixelFormat: source.pixelFormat,
+                                                textureType: .typeCube,
+                                                levels: 0..<1,
+                                                slices: 0..<6)
+        guard let sourceMip0, let enc = commandBuffer.makeComputeCommandEncoder() else { return false }
+        var params = IBLParamsSwift(size: UInt32(sourceSize),
+                                    sampleCount: 0,
+                                    roughness: 0,
+                                    useEquirect: equirect == nil ? 0 : 1,
+                                    sourceSize: Float(sourceSize),
+                                    sourceMipCount: Float(source.mipmapLevelCount))
+        enc.setComputePipelineState(sourcePipeline)
+        enc.setTexture(sourceMip0, index: 0)
+        enc.setTexture(placeholder, index: 1)
+        enc.setBytes(&params, length: MemoryLayout<IBLParamsSwift>.stride, index: 0)
+        enc.dispatchThreads(MTLSize(width: sourceSize, height: sourceSize, depth: 6),
+                            threadsPerThreadgroup: MTLSize(width: 8, height: 8, depth: 1))
+        enc.endEncoding()
+
+        // The prefilter reads lower source mips for wide lobes.
+        guard let blit = commandBuffer.makeBlitCommandEncoder() else { return false }
+        blit.generateMipmaps(for: source)
+        blit.endEncoding()
+
+        guard let prefilter = commandBuffer.makeComputeCommandEncoder() else { return false }
+        prefilter.setComputePipelineState(prefilterPipeline)
+        prefilter.setTexture(source, index: 1)
+        let mipCount = env.mipmapLevelCount
+        for mip in 0..<mipCount {
+            let size = max(env.width >> mip, 1)
+            guard let view = env.makeTextureView(pixelFormat: env.pixelFormat,
+                                                 textureType: .typeCube,
+                                                 levels: mip..<(mip + 1),
+                                                 slices: 0..<6) else {
+                prefilter.endEncoding()
+                return false
+            }
+            params.size = UInt32(size)
+            params.sampleCount = UInt32(prefilterSampleCount)
+            params.roughness = mipCount > 1 ? Float(mip) / Float(mipCount - 1) : 0.0
+            prefilter.setTexture(view, index: 0)
+            prefilter.setBytes(&params, length: MemoryLayout<IBLParamsSwift>.stride, index: 0)
+            prefilter.dispatchThreads(MTLSize(width: size, height: size, depth: 6),
+                                      threadsPerThreadgroup: MTLSize(width: 8, height: 8, depth: 1))
+        }
+        prefilter.endEncoding()
+
+        guard let brdf = commandBuffer.makeComputeCommandEncoder() else { return false }
+        params.size = UInt32(lut.width)
+        params.sampleCount = UInt32(brdfSampleCount)
+        brdf.setComputePipelineState(brdfPipeline)
+        brdf.setTexture(lut, index: 0)
+        brdf.setBytes(&params, length: MemoryLayout<IBLParamsSwift>.stride, index: 0)
+        brdf.dispatchThreads(MTLSize(width: lut.width, height: lut.height, depth: 1),
+                             threadsPerThreadgroup: MTLSize(width: 8, height: 8, depth: 1))
+        brdf.endEncoding()
+
+        commandBuffer.commit()
+        commandBuffer.waitUntilCompleted()
+        if let error = commandBuffer.error {
+            print("IBLResources: generation failed. Error info: \(error)")
+            return false
+        }
+        return true
+    }
+
+    /// Bound in place of the equirect map when the sky is procedural.
+    private static func makePlaceholder2D(device: MTLDevice) -> MTLTexture? {
+        let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .rgba16Float,
+                                                            width: 1,
+                                                            height: 1,
+                                                            mipmapped: false)
+        desc.usage = [.shaderRead]
+        desc.storageMode = .private
+        return device.makeTexture(descriptor: desc)
+    }
+
+    // MARK: Disk cache
+
+    /// Caches/IBL/<sha256>.ibl, hashed over the cache version, sizes, sample counts, the
+    /// compiled shader library (so edits to the IBL kernels invalidate it) and the
+    /// environment file bytes (or a tag for the procedural sky).
+    private static func cacheURL(environment: Data?, envSize: Int, lutSize: Int) -> URL? {
+        guard let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else {
+            return nil
+        }
+        var hasher = SHA256()
+        var header: [UInt32] = [cacheVersion,
+                                UInt32(envSize),
+                                UInt32(lutSize),
+                                UInt32(prefilterSampleCount),
+                                UInt32(brdfSampleCount)]
+        header.withUnsafeBytes { hasher.update(bufferPointer: $0) }
+        // The IBL.metalinc kernels ship only inside default.metallib. Without it the
+        // kernels cannot be identified, so nothing is cached.
+        guard let libraryURL = Bundle.main.url(forResource: "default", withExtension: "metallib"),
+              let library = try? Data(contentsOf: libraryURL, options: .mappedIfSafe) else {
+            print("IBLResources: default.metallib not found; not caching")
+            return nil
+        }
+        hasher.update(data: library)
+        if let environment {
+            hasher.update(data: environment)
+        } else {
+            hasher.update(data: Data("procedural-sky".utf8))
+        }
+        let name = hasher.finalize().map { String(format: "%02x", $0) }.joined()
+        return caches.appendingPathComponent("IBL", isDirectory: true).appendingPathComponent(name + ".ibl")
+    }
+
+    /// Byte size of each env face per mip (rgba16Float), then of the LUT (rgba32Float).
+    private static func cacheLayout(env: MTLTexture, lut: MTLTexture) -> (faces: [Int], lut: Int) {
+        let faces = (0..<env.mipmapLevelCount).map { mip -> Int in
+            let size = max(env.width >> mip, 1)
+            return size * size * 4 * MemoryLayout<Float16>.stride
+        }
+        return (faces, lut.width * lut.height * MemoryLayout<SIMD4<Float>>.stride)
+    }
+
+    /// The file is the raw texels in `cacheLayout` order: every face of mip 0, then mip 1, ...,
+    /// then the LUT. Anything of the wrong length is ignored and regenerated.
+    private static func loadCache(_ url: URL, env: MTLTexture, lut: MTLTexture) -> Bool {
+        guard let data = try? Data(contentsOf: url, options: .mappedIfSafe) else { return false }
+        let layout = cacheLayout(env: env, lut: lut)
+        guard data.count == layout.faces.reduce(0, +) * 6 + layout.lut else {
+            print("IBLResources: ignoring cache with unexpected size:", url.path)
+            return false
+        }
+        data.withUnsafeBytes { raw in
+            var offset = 0
+            for mip in 0..<env.mipmapLevelCount {
+                let size = max(env.width >> mip, 1)
+                for face in 0..<6 {
+                    env.replace(region: MTLRegionMake2D(0, 0, size, size),
+                                mipmapLevel: mip,
+                                slice: face,
+                                withBytes: raw.baseAddress! + offset,
+                                bytesPerRow: size * 4 * MemoryLayout<Float16>.stride,
+                                bytesPerImage: layout.faces[mip])
+                    offset += layout.faces[mip]
+                }
+            }
+            lut.replace(region: MTLRegionMake2D(0, 0, lut.width, lut.height),
+                        mipmapLevel: 0,
+                        withBytes: raw.baseAddress! + offset,
+                        bytesPerRow: lut.width * MemoryLayout<SIMD4<Float>>.stride)
+        }
+        return true
+    }
+
+    private static func writeCache(_ url: URL, env: MTLTexture, lut: MTLTexture) {
+        let layout = cacheLayout(env: env, lut: lut)
+        var data = Data(count: layout.faces.reduce(0, +) * 6 + layout.lut)
+        data.withUnsafeMutableBytes { raw in
+            var offset = 0
+            for mip in 0..<env.mipmapLevelCount {
+                let size = max(env.width >> mip, 1)
+                for face in 0..<6 {
+                    env.getBytes(raw.baseAddress! + offset,
+                                 bytesPerRow: size * 4 * MemoryLayout<Float16>.stride,
+                                 bytesPerImage: layout.faces[mip],
+                                 from: MTLRegionMake2D(0, 0, size, size),
+                                 mipmapLevel: mip,
+                                 slice: face)
+                    offset += layout.faces[mip]
+                }
+            }
+            lut.getBytes(raw.baseAddress! + offset,
+                         bytesPerRow: lut.width * MemoryLayout<SIMD4<Float>>.stride,
+                         from: MTLRegionMake2D(0, 0, lut.width, lut.height),
+                         mipmapLevel: 0)
+        }
+        do {
+            try FileManager.default.createDirectory(at: url.deletingLastPathComponent(),
+                                                    withIntermediateDirectories: true)
+            try data.write(to: url, options: .atomic)
+        } catch {
+            print("IBLResources: unable to write cache:", url.path, error)
+        }
+    }
+
+    // MARK: CPU fallback
+
+    private static func fillEnvOnCPU(_ env: MTLTexture) {
+        let envSize = env.width
         let mipCount = env.mipmapLevelCount
         for mip in 0..<mipCount {
             let size = max(envSize >> mip, 1)
@@ -53,25 +358,16 @@ final class IBLResources {
                 }
             }
         }
+    }
 
-        self.envCube = env
-        self.envMipCount = UInt32(env.mipmapLevelCount)
-
-        let lutSize = 128
-        let lutDesc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .rgba32Float,
-                                                               width: lutSize,
-                                                               height: lutSize,
-                                                               mipmapped: false)
-        lutDesc.usage = [.shaderRead]
-        lutDesc.storageMode = .shared
-        let lut = device.makeTexture(descriptor: lutDesc)!
-        lut.label = "IBL.BRDFLUT"
+    private static func fillLUTOnCPU(_ lut: MTLTexture) {
+        let lutSize = lut.width
         var lutData = [Float](repeating: 0, count: lutSize * lutSize * 4)
         for y in 0..<lutSize {
             let roughness = max(Float(y) / Float(lutSize - 1), 0.001)
             for x in 0..<lutSize {
                 let nDotV = max(Float(x) / Float(lutSize - 1), 0.001)
-                let brdf = integrateBRDF(nDotV: nDotV, roughness: roughness, sampleCount: 256)
+                let brdf = integrateBRDF(nDotV: nDotV, roughness: roughness, sampleCount: brdfSampleCount)
                 let idx = (y * lutSize + x) * 4
                 lutData[idx + 0] = brdf.x
                 lutData[idx + 1] = brdf.y
@@ -86,7 +382,6 @@ final class IBLResources {
                         withBytes: raw.baseAddress!,
                         bytesPerRow: lutSize * MemoryLayout<SIMD4<Float>>.stride)
         }
-        self.brdfLUT = lut
     }
 }
 
@@ -8,6 +8,38 @@
 import GameController
 import simd
 
+/// The gamepad state `InputSystem` reads in one update: raw stick axes and the jump and
+/// dodge buttons. Recorded frames replay the same input without a controller.
+struct InputFrame: Codable, Equatable {
+    var leftStick: SIMD2<Float> = .zero
+    var rightStick: SIMD2<Float> = .zero
+    var jump: Bool = false
+    var dodge: Bool = false
+    /// False when no extended gamepad was available.
+    var connected: Bool = true
+
+    static let disconnected = InputFrame(connected: false)
+
+    init(leftStick: SIMD2<Float> = .zero,
+         rightStick: SIMD2<Float> = .zero,
+         jump: Bool = false,
+         dodge: Bool = false,
+         connected: Bool = true) {
+        self.leftStick = leftStick
+        self.rightStick = rightStick
+        self.jump = jump
+        self.dodge = dodge
+        self.connected = connected
+    }
+
+    init(pad: GCExtendedGamepad) {
+        self.init(leftStick: SIMD2<Float>(pad.leftThumbstick.xAxis.value, pad.leftThumbstick.yAxis.value),
+                  rightStick: SIMD2<Float>(pad.rightThumbstick.xAxis.value, pad.rightThumbstick.yAxis.value),
+                  jump: pad.buttonA.isPressed,
+                  dodge: pad.buttonB.isPressed)
+    }
+}
+
 final class InputSystem: System {
     private weak var camera: Camera?
     private var player: Entity?
@@ -23,6 +55,13 @@ final class InputSystem: System {
     private var lastDodgePressed: Bool = false
     public private(set) var exposureDelta: Float = 0
 
+    /// Replayed instead of the controller, one frame per update; past the end the
+    /// controller reads as disconnected.
+    private var playback: [InputFrame]?
+    private var playbackCursor = 0
+    /// Every frame consumed since `startRecording`.
+    private var recording: [InputFrame]?
+
     var lookSpeed: Float = 2.5      // used for right stick rotation + pitch
     var turnSpeed: Float = 16.0
     var cameraDistance: Float = 8.0
@@ -55,6 +94,22 @@ final class InputSystem: System {
         player = e
     }
 
+    /// Replays `frames` from the next update on; nil returns to the controller.
+    func play(_ frames: [InputFrame]?) {
+        playback = frames
+        playbackCursor = 0
+    }
+
+    func startRecording() {
+        recording = []
+    }
+
+    /// Stops recording and returns the frames consumed since `startRecording`.
+    func stopRecording() -> [InputFrame] {
+        defer { recording = nil }
+        return recording ?? []
+    }
+
     @objc private func controllerDidConnect(_ note: Notification) {
         if let c = note.object as? GCController {
             controller = c
@@ -70,13 +125,22 @@ final class InputSystem: System {
     func update(world: World, dt: Float) {
         guard let player = player else { return }
 
-        if controller == nil {
-            controller = GCController.controllers().first
+        let frame: InputFrame
+        if let playback {
+            frame = playbackCursor < playback.count ? playback[playbackCursor] : .disconnected
+            playbackCursor += 1
+        } else {
+            if controller == nil {
+                controller = GCController.controllers().first
+            }
+            frame = controller?.extendedGamepad.map { InputFrame(pad: $0) } ?? .disconnected
         }
+        recording?.append(frame)
+
         let mStore = world.store(MoveIntentComponent.self)
         let mvStore = world.store(MovementComponent.self)
         let dStore = world.store(DodgeActionComponent.self)
-        guard let pad = controller?.extendedGamepad else {
+        guard frame.connected else {
             mStore[player] = MoveIntentComponent()
             lastJumpPressed = false
             lastDodgePressed = false
@@ -86,12 +150,12 @@ final class InputSystem: System {
         let dodgeActive = dStore[player]?.active ?? false
 
         // RAW axes
-        let rawLX = pad.leftThumbstick.xAxis.value
-        let rawLY = pad.leftThumbstick.yAxis.value
-        let rawRX = pad.rightThumbstick.xAxis.value
-        let rawRY = pad.rightThumbstick.yAxis.value
-        let jumpPressed = pad.buttonA.isPressed
-        let dodgePressed = pad.buttonB.isPressed
+        let rawLX = frame.leftStick.x
+        let rawLY = frame.leftStick.y
+        let rawRX = frame.rightStick.x
+        let rawRY = frame.rightStick.y
+        let jumpPressed = frame.jump
+        let dodgePressed = frame.dodge
         exposureDelta = 0
 
         // Match the "correct version" axis sign convention
@@ -0,0 +1,164 @@
+//
+//  MappedAsset.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+import Metal
+
+/// A cooked binary asset (`Tools/CookAssets`) mapped into memory. The file is a 16-byte
+/// header (`"GBIN"`, version, chunk count, reserved), then one `(offset, length)` pair of
+/// UInt64 per chunk. Chunk 0 holds the JSON metadata; the others are raw little-endian
+/// arrays, 16-byte aligned, and chunks the GPU reads directly start on a 16 KB boundary
+/// with padding up to the next one so they can be wrapped without a copy.
+///
+/// Unchecked Sendable: nothing changes after `init?` and the mapping is read-only, so the
+/// buffers wrapping it may be released on any thread.
+nonisolated final class MappedAssetFile: @unchecked Sendable {
+    static let magic: UInt32 = 0x4E49_4247 // "GBIN"
+    static let version: UInt32 = 1
+    private static let headerSize = 16
+    private static let chunkEntrySize = 16
+    /// Every chunk starts on this boundary, so typed views of it are aligned for any element
+    /// type the cooker writes (at most 16-byte SIMD types).
+    private static let chunkAlignment = 16
+
+    let path: String
+    private let base: UnsafeMutableRawPointer
+    private let mappedLength: Int
+    private let chunks: [(offset: Int, length: Int)]
+
+    init?(path: String) {
+        let fd = open(path, O_RDONLY)
+        guard fd >= 0 else {
+            print("MappedAssetFile: unable to open:", path)
+            return nil
+        }
+        defer { close(fd) }
+
+        var info = stat()
+        guard fstat(fd, &info) == 0, info.st_size >= MappedAssetFile.headerSize else {
+            print("MappedAssetFile: unable to stat:", path)
+            return nil
+        }
+        let fileLength = Int(info.st_size)
+        let pageSize = Int(getpagesize())
+        let mappedLength = (fileLength + pageSize - 1) / pageSize * pageSize
+        // Private and writable so Metal can wrap it; pages are still read lazily from the file.
+        guard let base = mmap(nil, mappedLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0),
+              base != MAP_FAILED else {
+            print("MappedAssetFile: mmap failed:", path)
+            return nil
+        }
+
+        let magic = base.loadUnaligned(fromByteOffset: 0, as: UInt32.self)
+        let version = base.loadUnaligned(fromByteOffset: 4, as: UInt32.self)
+        let chunkCount = Int(base.loadUnaligned(fromByteOffset: 8, as: UInt32.self))
+        // Bounded by the file before any arithmetic, so a corrupt count cannot overflow.
+        let maxChunks = (fileLength - MappedAssetFile.headerSize) / MappedAssetFile.chunkEntrySize
+        guard magic == MappedAssetFile.magic,
+              version == MappedAssetFile.version,
+              chunkCount > 0,
+              chunkCount <= maxChunks else {
+            print("MappedAssetFile: invalid header:", path)
+            munmap(base, mappedLength)
+            return nil
+        }
+        let tableEnd = MappedAssetFile.headerSize + chunkCount * MappedAssetFile.chunkEntrySize
+
+        var chunks: [(offset: Int, length: Int)] = []
+        chunks.reserveCapacity(chunkCount)
+        for i in 0..<chunkCount {
+            let entry = MappedAssetFile.headerSize + i * MappedAssetFile.chunkEntrySize
+            // Entries are untrusted: a value past Int or a sum that overflows rejects the
+            // file (the caller falls back to the JSON asset) instead of trapping.
+            guard let offset = Int(exactly: base.loadUnaligned(fromByteOffset: entry, as: UInt64.self)),
+                  let length = Int(exactly: base.loadUnaligned(fromByteOffset: entry + 8, as: UInt64.self)),
+                  case let (end, overflow) = offset.addingReportingOverflow(length), !overflow,
+                  offset >= tableEnd, end <= fileLength,
+                  offset % MappedAssetFile.chunkAlignment == 0 else {
+                print("MappedAssetFile: chunk out of range or misaligned:", path, i)
+                munmap(base, mappedLength)
+                return nil
+            }
+            chunks.append((offset, length))
+        }
+
+        self.path = path
+        self.base = base
+        self.mappedLength = mappedLength
+        self.chunks = chunks
+    }
+
+    deinit {
+        munmap(base, mappedLength)
+    }
+
+    /// Touches every mapped page so later reads (including the GPU's through wrapped buffers)
+    /// do not fault them in from disk; used by background loads.
+    func prefault() {
+        let pageSize = Int(getpagesize())
+        var sum: UInt8 = 0
+        var offset = 0
+        while offset < mappedLength {
+            sum &+= base.load(fromByteOffset: offset, as: UInt8.self)
+            offset += pageSize
+        }
+        withExtendedLifetime(sum) {}
+    }
+
+    /// Decodes the metadata chunk.
+    func metadata<T: Decodable>(_ type: T.Type) -> T? {
+        let meta = chunks[0]
+        let data = Data(bytesNoCopy: base + meta.offset, count: meta.length, deallocator: .none)
+        do {
+            return try JSONDecoder().decode(type, from: data)
+        } catch {
+            print("MappedAssetFile: invalid metadata:", path, error)
+            return nil
+        }
+    }
+
+    /// `count` elements of chunk `index`, or nil when the chunk is too short (or `count`,
+    /// which comes from the metadata, is negative or overflows).
+    func elements<T>(_ type: T.Type, chunk index: Int, count: Int) -> UnsafeBufferPointer<T>? {
+        let (byteCount, overflow) = count.multipliedReportingOverflow(by: MemoryLayout<T>.stride)
+        guard index > 0, index < chunks.count, count >= 0, !overflow,
+              chunks[index].length >= byteCount,
+              MemoryLayout<T>.alignment <= MappedAssetFile.chunkAlignment else {
+            print("MappedAssetFile: chunk too short:", path, index)
+            return nil
+        }
+        let start = (base + chunks[index].offset).bindMemory(to: type, capacity: count)
+        return UnsafeBufferPointer(start: start, count: count)
+    }
+
+    /// Copy of `count` elements of chunk `index` (a single memcpy for SIMD element types).
+    func array<T>(_ type: T.Type, chunk index: Int, count: Int) -> [T]? {
+        elements(type, chunk: index, count: count).map { Array($0) }
+    }
+
+    /// Shared buffer over chunk `index`. Page-aligned chunks are wrapped in place (the buffer
+    /// then includes the page padding) and keep the mapping alive; anything else is copied.
+    func makeBuffer(device: MTLDevice, chunk index: Int, label: String) -> MTLBuffer? {
+        guard index > 0, index < chunks.count else { return nil }
+        let chunk = chunks[index]
+        let pageSize = Int(getpagesize())
+        let wrappedLength = max((chunk.length + pageSize - 1) / pageSize * pageSize, pageSize)
+        let buffer: MTLBuffer?
+        if chunk.offset % pageSize == 0 && chunk.offset + wrappedLength <= mappedLength {
+            buffer = device.makeBuffer(bytesNoCopy: base + chunk.offset,
+                                       length: wrappedLength,
+                                       options: [.storageModeShared],
+                                       deallocator: { _, _ in withExtendedLifetime(self) {} })
+        } else {
+            buffer = device.makeBuffer(bytes: base + chunk.offset,
+                                       length: max(chunk.length, 1),
+                                       options: [.storageModeShared])
+        }
+        buffer?.label = label
+        return buffer
+    }
+}
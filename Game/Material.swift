@@ -8,7 +8,7 @@
 import Metal
 import simd
 
-public struct Material {
+public nonisolated struct Material: Sendable {
     public var baseColorTexture: TextureResource?
     public var normalTexture: TextureResource?
     public var metallicRoughnessTexture: TextureResource?
@@ -20,6 +20,8 @@ public struct Material {
     public var emissiveFactor: SIMD3<Float>
     public var occlusionStrength: Float
     public var alpha: Float
+    /// Alpha-tested (mask) when > 0: coverage below the cutoff is a hole, above is opaque.
+    public var alphaCutoff: Float
     public var transmissionFactor: Float
     public var ior: Float
     public var unlit: Bool
@@ -40,6 +42,7 @@ public struct Material {
                 emissiveFactor: SIMD3<Float> = SIMD3<Float>(0, 0, 0),
                 occlusionStrength: Float = 1.0,
                 alpha: Float = 1.0,
+                alphaCutoff: Float = 0.0,
                 transmissionFactor: Float = 0.0,
                 ior: Float = 1.5,
                 unlit: Bool = false,
@@ -59,6 +62,7 @@ public struct Material {
         self.emissiveFactor = emissiveFactor
         self.occlusionStrength = occlusionStrength
         self.alpha = alpha
+        self.alphaCutoff = alphaCutoff
         self.transmissionFactor = transmissionFactor
         self.ior = ior
         self.unlit = unlit
@@ -70,7 +74,7 @@ public struct Material {
     }
 }
 
-public struct MaterialDescriptor {
+public nonisolated struct MaterialDescriptor: Sendable {
     public var baseColor: ProceduralTexture?
     public var normal: ProceduralTexture?
     public var metallicRoughness: ProceduralTexture?
@@ -82,6 +86,8 @@ public struct MaterialDescriptor {
     public var emissiveFactor: SIMD3<Float>
     public var occlusionStrength: Float
     public var alpha: Float
+    /// Alpha-tested (mask) when > 0: coverage below the cutoff is a hole, above is opaque.
+    public var alphaCutoff: Float
     public var transmissionFactor: Float
     public var ior: Float
     public var unlit: Bool
@@ -102,6 +108,7 @@ public struct MaterialDescriptor {
                 emissiveFactor: SIMD3<Float> = SIMD3<Float>(0, 0, 0),
                 occlusionStrength: Float = 1.0,
                 alpha: Float = 1.0,
+                alphaCutoff: Float = 0.0,
                 transmissionFactor: Float = 0.0,
                 ior: Float = 1.5,
                 unlit: Bool = false,
@@ -121,6 +128,7 @@ public struct MaterialDescriptor {
         self.emissiveFactor = emissiveFactor
         self.occlusionStrength = occlusionStrength
         self.alpha = alpha
+        self.alphaCutoff = alphaCutoff
         self.transmissionFactor = transmissionFactor
         self.ior = ior
         self.unlit = unlit
@@ -132,13 +140,14 @@ public struct MaterialDescriptor {
     }
 }
 
-public enum MaterialFactory {
+public nonisolated enum MaterialFactory {
     public static func make(device: MTLDevice, descriptor: MaterialDescriptor, label: String) -> Material {
         let base = descriptor.baseColor.map { TextureResource(device: device, source: $0, label: "\(label).baseColor") }
         let normal = descriptor.normal.map { TextureResource(device: device, source: $0, label: "\(label).normal") }
         let mr = descriptor.metallicRoughness.map { TextureResource(device: device, source: $0, label: "\(label).metallicRoughness") }
         let emissive = descriptor.emissive.map { TextureResource(device: device, source: $0, label: "\(label).emissive") }
         let occlusion = descriptor.occlusion.map { TextureResource(device: device, source: $0, label: "\(label).occlusion") }
+        TextureResource.generateMipmaps([base, normal, mr, emissive, occlusion].compactMap { $0 })
 
         return Material(baseColorTexture: base,
                         normalTexture: normal,
@@ -151,6 +160,7 @@ public enum MaterialFactory {
                         emissiveFactor: descriptor.emissiveFactor,
                         occlusionStrength: descriptor.occlusionStrength,
                         alpha: descriptor.alpha,
+                        alphaCutoff: descriptor.alphaCutoff,
                         transmissionFactor: descriptor.transmissionFactor,
                         ior: descriptor.ior,
                         unlit: descriptor.unlit,
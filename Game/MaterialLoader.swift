@@ -10,7 +10,7 @@ import Metal
 import MetalKit
 import simd
 
-enum MaterialLoader {
+nonisolated enum MaterialLoader {
     static func loadMaterials(named name: String,
                               device: MTLDevice) -> [String: Material] {
         guard let path = Bundle.main.path(forResource: name, ofType: "json") else {
@@ -63,6 +63,7 @@ enum MaterialLoader {
                                                  emissiveFactor: emissive,
                                                  occlusionStrength: entry.occlusionStrength,
                                                  alpha: entry.alpha,
+                                                 alphaCutoff: entry.alphaCutoff ?? 0.0,
                                                  transmissionFactor: entry.transmissionFactor,
                                                  ior: entry.ior,
                                                  unlit: entry.unlit,
@@ -80,7 +81,7 @@ enum MaterialLoader {
     }
 }
 
-private func loadTexture(path: String?,
+private nonisolated func loadTexture(path: String?,
                          device: MTLDevice,
                          baseDir: String,
                          srgb: Bool,
@@ -104,7 +105,7 @@ private func loadTexture(path: String?,
     }
 }
 
-private func resolveTextureURL(path: String, baseDir: String) -> URL? {
+private nonisolated func resolveTextureURL(path: String, baseDir: String) -> URL? {
     let nsPath = path as NSString
     if nsPath.isAbsolutePath {
         let url = URL(fileURLWithPath: path)
@@ -123,12 +124,12 @@ private func resolveTextureURL(path: String, baseDir: String) -> URL? {
     return nil
 }
 
-private struct MaterialsJSON: Codable {
+private nonisolated struct MaterialsJSON: Codable {
     let version: Int
     let materials: [MaterialJSON]
 }
 
-private struct MaterialJSON: Codable {
+private nonisolated struct MaterialJSON: Codable {
     let name: String
     let baseColorFactor: [Float]
     let metallicFactor: Float
@@ -136,6 +137,7 @@ private struct MaterialJSON: Codable {
     let emissiveFactor: [Float]
     let occlusionStrength: Float
     let alpha: Float
+    let alphaCutoff: Float?
     let transmissionFactor: Float
     let ior: Float
     let unlit: Bool
@@ -150,7 +152,7 @@ private struct MaterialJSON: Codable {
     let occlusionChannel: String?
 }
 
-private func vec3(_ values: [Float], fallback: SIMD3<Float>) -> SIMD3<Float> {
+private nonisolated func vec3(_ values: [Float], fallback: SIMD3<Float>) -> SIMD3<Float> {
     guard values.count >= 3 else { return fallback }
     return SIMD3<Float>(values[0], values[1], values[2])
 }
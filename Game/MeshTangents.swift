@@ -7,7 +7,7 @@
 
 import simd
 
-enum MeshTangents {
+nonisolated enum MeshTangents {
     static func compute(positions: [SIMD3<Float>],
                         normals: [SIMD3<Float>],
                         uvs: [SIMD2<Float>],
@@ -7,16 +7,16 @@
 
 import simd
 
-public enum MeshTopology {
+public nonisolated enum MeshTopology: Sendable {
     case triangles
 }
 
-public struct MeshBounds {
+public nonisolated struct MeshBounds: Sendable {
     public var min: SIMD3<Float>
     public var max: SIMD3<Float>
 }
 
-public struct VertexStreams {
+public nonisolated struct VertexStreams: Sendable {
     public var positions: [SIMD3<Float>]
     public var normals: [SIMD3<Float>]?
     public var uvs: [SIMD2<Float>]?
@@ -62,7 +62,7 @@ public struct VertexStreams {
     }
 }
 
-public struct ProceduralMeshDescriptor {
+public nonisolated struct ProceduralMeshDescriptor: Sendable {
     public var topology: MeshTopology
     public var streams: VertexStreams
     public var indices16: [UInt16]?
@@ -10,6 +10,18 @@ import simd
 public final class PoseStackSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(SkeletonComponent.self)
+            .reading(ActionAnimationComponent.self)
+            .reading(TransformComponent.self)
+            .reading(CharacterControllerComponent.self)
+            .writing(PoseComponent.self)
+            .writing(LocomotionProfileComponent.self)
+            .writing(MotionProfileComponent.self)
+            .writing(AnimationLODComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         let entities = world.query(SkeletonComponent.self, PoseComponent.self)
         if entities.isEmpty { return }
@@ -21,16 +33,33 @@ public final class PoseStackSystem: FixedStepSystem {
         let aStore = world.store(ActionAnimationComponent.self)
         let tStore = world.store(TransformComponent.self)
         let controllerStore = world.store(CharacterControllerComponent.self)
+        let lodStore = world.store(AnimationLODComponent.self)
 
         for e in entities {
             guard let skeleton = sStore[e]?.skeleton,
                   var pose = pStore[e] else {
                 continue
             }
+            // Lower LODs evaluate every poseInterval steps, advancing by the banked time.
+            var stepDT = dt
+            if var lod = lodStore[e] {
+                lod.pendingSteps += 1
+                lod.pendingTime += dt
+                if lod.pendingSteps < lod.level.poseInterval {
+                    lodStore[e] = lod
+                    continue
+                }
+                stepDT = lod.pendingTime
+                lod.pendingSteps = 0
+                lod.pendingTime = 0
+                lodStore[e] = lod
+            }
             var runLeanWeight: Float = 0
 
             if pose.local.count != skeleton.boneCount {
+                let revision = pose.revision
                 pose = PoseComponent(boneCount: skeleton.boneCount, local: skeleton.bindLocal)
+                pose.revision = revision
             }
 
             if var locomotion = lStore[e],
@@ -39,10 +68,10 @@ public final class PoseStackSystem: FixedStepSystem {
                 let walkCycle = max(locomotion.walkProfile.phase?.cycleDuration ?? locomotion.walkProfile.duration, 0.001)
                 let runCycle = max(locomotion.runProfile.phase?.cycleDuration ?? locomotion.runProfile.duration, 0.001)
                 let fallCycle = max(locomotion.fallProfile.phase?.cycleDuration ?? locomotion.fallProfile.duration, 0.001)
-                locomotion.idleTime += dt * profile.playbackRate
-                locomotion.walkTime += dt * profile.playbackRate
-                locomotion.runTime += dt * profile.playbackRate
-                locomotion.fallTime += dt * profile.playbackRate
+                locomotion.idleTime += stepDT * profile.playbackRate
+                locomotion.walkTime += stepDT * profile.playbackRate
+                locomotion.runTime += stepDT * profile.playbackRate
+                locomotion.fallTime += stepDT * profile.playbackRate
                 if profile.loop {
                     locomotion.idleTime = locomotion.idleTime.truncatingRemainder(dividingBy: idleCycle)
                     locomotion.walkTime = locomotion.walkTime.truncatingRemainder(dividingBy: walkCycle)
@@ -58,7 +87,7 @@ public final class PoseStackSystem: FixedStepSystem {
                 if locomotion.isBlending {
                     if locomotion.state == .idle {
                         let halfLife = max(locomotion.idleInertiaHalfLife, 0.001)
-                        let decay = pow(0.5, dt / halfLife)
+                        let decay = pow(0.5, stepDT / halfLife)
                         locomotion.idleInertia *= decay
                         if locomotion.idleInertia <= 0.001 {
                             locomotion.idleInertia = 0
@@ -67,7 +96,7 @@ public final class PoseStackSystem: FixedStepSystem {
                         }
                     } else {
                         let blendDuration = max(locomotion.blendTime, 0.001)
-                        locomotion.blendT = min(locomotion.blendT + dt / blendDuration, 1.0)
+                        locomotion.blendT = min(locomotion.blendT + stepDT / blendDuration, 1.0)
                         if locomotion.blendT >= 1.0 {
                             locomotion.isBlending = false
                         }
@@ -141,30 +170,23 @@ public final class PoseStackSystem: FixedStepSystem {
                     }
                 }
 
+                let fromProfile = profileFor(fromState).evaluator
+                let toProfile = profileFor(toState).evaluator
+                let fromPhase = phaseFor(fromState)
+                let toPhase = phaseFor(toState)
+                let fromSlots = fromProfile.slots(for: skeleton.names)
+                let toSlots = toProfile.slots(for: skeleton.names)
+
                 for i in 0..<skeleton.boneCount {
-                    let name = skeleton.names[i]
                     let restScaled = skeleton.restTranslation[i]
                     let restRaw = skeleton.rawRestTranslation[i]
 
-                    let fromProfile = profileFor(fromState)
-                    let toProfile = profileFor(toState)
-                    let fromPhase = phaseFor(fromState)
-                    let toPhase = phaseFor(toState)
-                    let fromBone = fromProfile.bones[name]
-                    let toBone = toProfile.bones[name]
-
-                    let fromRaw = fromBone.map {
-                        MotionProfileEvaluator.evaluateChannel($0.translation,
-                                                               phase: fromPhase,
-                                                               order: fromProfile.order,
-                                                               defaultValue: restRaw)
-                    } ?? restRaw
-                    let toRaw = toBone.map {
-                        MotionProfileEvaluator.evaluateChannel($0.translation,
-                                                               phase: toPhase,
-                                                               order: toProfile.order,
-                                                               defaultValue: restRaw)
-                    } ?? restRaw
+                    let (fromRaw, fromR) = fromProfile.sample(slot: fromSlots[i],
+                                                              phase: fromPhase,
+                                                              restTranslation: restRaw)
+                    let (toRaw, toR) = toProfile.sample(slot: toSlots[i],
+                                                        phase: toPhase,
+                                                        restTranslation: restRaw)
 
                     let fromDelta = fromRaw - restRaw
                     let toDelta = toRaw - restRaw
@@ -178,18 +200,6 @@ public final class PoseStackSystem: FixedStepSystem {
                         toT.z = restScaled.z
                     }
 
-                    let fromR = fromBone.map {
-                        MotionProfileEvaluator.evaluateChannel($0.rotation,
-                                                               phase: fromPhase,
-                                                               order: fromProfile.order,
-                                                               defaultValue: SIMD3<Float>(0, 0, 0))
-                    } ?? SIMD3<Float>(0, 0, 0)
-                    let toR = toBone.map {
-                        MotionProfileEvaluator.evaluateChannel($0.rotation,
-                                                               phase: toPhase,
-                                                               order: toProfile.order,
-                                                               defaultValue: SIMD3<Float>(0, 0, 0))
-                    } ?? SIMD3<Float>(0, 0, 0)
                     var fromRot = simd_mul(Skeleton.rotationXYZDegrees(skeleton.preRotationDegrees[i]),
                                            Skeleton.rotationXYZDegrees(fromR))
                     var toRot = simd_mul(Skeleton.rotationXYZDegrees(skeleton.preRotationDegrees[i]),
@@ -223,7 +233,7 @@ public final class PoseStackSystem: FixedStepSystem {
                 mStore[e] = profile
             } else if var profile = mStore[e] {
                 let cycle = max(profile.profile.phase?.cycleDuration ?? profile.profile.duration, 0.001)
-                profile.time += dt * profile.playbackRate
+                profile.time += stepDT * profile.playbackRate
                 if profile.loop {
                     profile.time = profile.time.truncatingRemainder(dividingBy: cycle)
                 } else {
@@ -240,18 +250,16 @@ public final class PoseStackSystem: FixedStepSystem {
                 for i in 0..<skeleton.boneCount {
                     pose.local[i] = skeleton.bindLocal[i]
                 }
+                let evaluator = profile.profile.evaluator
+                let slots = evaluator.slots(for: skeleton.names)
                 for i in 0..<skeleton.boneCount {
-                    let name = skeleton.names[i]
-                    guard let bone = profile.profile.bones[name] else {
+                    guard slots[i] >= 0 else {
                         continue
                     }
 
                     let restScaled = skeleton.restTranslation[i]
                     let restRaw = skeleton.rawRestTranslation[i]
-                    let animRaw = MotionProfileEvaluator.evaluateChannel(bone.translation,
-                                                                         phase: phase,
-                                                                         order: profile.profile.order,
-                                                                         defaultValue: restRaw)
+                    let (animRaw, animR) = evaluator.sample(slot: slots[i], phase: phase, restTranslation: restRaw)
                     let delta = animRaw - restRaw
                     var t = restScaled + (delta * skeleton.unitScale)
 
@@ -260,10 +268,6 @@ public final class PoseStackSystem: FixedStepSystem {
                         t.z = restScaled.z
                     }
 
-                    let animR = MotionProfileEvaluator.evaluateChannel(bone.rotation,
-                                                                       phase: phase,
-                                                                       order: profile.profile.order,
-                                                                       defaultValue: SIMD3<Float>(0, 0, 0))
                     var rot = simd_mul(Skeleton.rotationXYZDegrees(skeleton.preRotationDegrees[i]),
                                        Skeleton.rotationXYZDegrees(animR))
                     if i == 0 {
@@ -290,25 +294,19 @@ public final class PoseStackSystem: FixedStepSystem {
                 for i in 0..<skeleton.boneCount {
                     actionLocal[i] = skeleton.bindLocal[i]
                 }
+                let evaluator = action.profile.evaluator
+                let slots = evaluator.slots(for: skeleton.names)
                 for i in 0..<skeleton.boneCount {
-                    let name = skeleton.names[i]
-                    guard let bone = action.profile.bones[name] else { continue }
+                    guard slots[i] >= 0 else { continue }
                     let restScaled = skeleton.restTranslation[i]
                     let restRaw = skeleton.rawRestTranslation[i]
-                    let animRaw = MotionProfileEvaluator.evaluateChannel(bone.translation,
-                                                                         phase: phase,
-                                                                         order: action.profile.order,
-                                                                         defaultValue: restRaw)
+                    let (animRaw, animR) = evaluator.sample(slot: slots[i], phase: phase, restTranslation: restRaw)
                     let delta = animRaw - restRaw
                     var t = restScaled + (delta * skeleton.unitScale)
                     if i == 0 && action.inPlace {
                         t.x = restScaled.x
                         t.z = restScaled.z
                     }
-                    let animR = MotionProfileEvaluator.evaluateChannel(bone.rotation,
-                                                                       phase: phase,
-                                                                       order: action.profile.order,
-                                                                       defaultValue: SIMD3<Float>(0, 0, 0))
                     var rot = simd_mul(Skeleton.rotationXYZDegrees(skeleton.preRotationDegrees[i]),
                                        Skeleton.rotationXYZDegrees(animR))
                     if i == 0 {
@@ -401,6 +399,7 @@ public final class PoseStackSystem: FixedStepSystem {
                 pose.palette[i] = simd_mul(pose.model[i], skeleton.invBindModel[i])
             }
 
+            pose.revision &+= 1
             pStore[e] = pose
         }
     }
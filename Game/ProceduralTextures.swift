@@ -5,30 +5,178 @@
 //  Created by Codex on 3/9/26.
 //
 
+import Foundation
 import simd
 
-public enum ProceduralTextureFormat {
+public nonisolated enum ProceduralTextureFormat: Sendable {
     case rgba8Unorm
     case rgba8UnormSrgb
 }
 
-public struct ProceduralTexture {
+public nonisolated struct ProceduralTexture: Sendable {
     public let width: Int
     public let height: Int
     public let format: ProceduralTextureFormat
     public let bytes: [UInt8]
+    /// Uploaded with a full mip chain generated on the GPU by the next frame
+    /// (`TextureResource.generateMipmaps`).
+    public let mipmapped: Bool
 
-    public init(width: Int, height: Int, format: ProceduralTextureFormat, bytes: [UInt8]) {
+    public init(width: Int, height: Int, format: ProceduralTextureFormat, bytes: [UInt8], mipmapped: Bool = false) {
         self.width = width
         self.height = height
         self.format = format
         self.bytes = bytes
+        self.mipmapped = mipmapped
     }
 }
 
-public enum ProceduralTextureGenerator {
+/// Memoization key of a generated texture: the generator name and every parameter.
+public nonisolated struct ProceduralTextureKey: Hashable, Sendable {
+    public let generator: String
+    public let ints: [Int]
+    public let floats: [Float]
+
+    public init(_ generator: String, ints: [Int] = [], floats: [Float] = []) {
+        self.generator = generator
+        self.ints = ints
+        self.floats = floats
+    }
+}
+
+/// Value noise shared by the noise generators.
+private nonisolated enum ProceduralNoise {
+    static func hash2(_ x: Int, _ y: Int) -> Float {
+        let ux = UInt32(bitPattern: Int32(truncatingIfNeeded: x))
+        let uy = UInt32(bitPattern: Int32(truncatingIfNeeded: y))
+        var n = (ux &* 374761393) &+ (uy &* 668265263) &+ 0x9E3779B9
+        n ^= n >> 13
+        n &*= 1274126177
+        return Float(n & 0x00FFFFFF) / Float(0x01000000)
+    }
+
+    static func smooth(_ t: Float) -> Float { t * t * (3.0 - 2.0 * t) }
+
+    static func noise(_ u: Float, _ v: Float) -> Float {
+        let x0 = Int(floor(u))
+        let y0 = Int(floor(v))
+        let x1 = x0 + 1
+        let y1 = y0 + 1
+        let tx = smooth(u - Float(x0))
+        let ty = smooth(v - Float(y0))
+        let a = hash2(x0, y0)
+        let b = hash2(x1, y0)
+        let c = hash2(x0, y1)
+        let d = hash2(x1, y1)
+        let ab = a + (b - a) * tx
+        let cd = c + (d - c) * tx
+        return ab + (cd - ab) * ty
+    }
+
+    static func fbm(_ u: Float, _ v: Float, octaves: Int, amplitude: Float) -> Float {
+        var sum: Float = 0
+        var amp = amplitude
+        var freq: Float = 1.0
+        for _ in 0..<max(octaves, 1) {
+            sum += noise(u * freq, v * freq) * amp
+            freq *= 2.0
+            amp *= 0.5
+        }
+        return sum
+    }
+
+    static func encodeNormal(_ n: SIMD3<Float>, into row: UnsafeMutablePointer<UInt8>, at idx: Int) {
+        row[idx + 0] = UInt8(max(0, min(255, Int((n.x * 0.5 + 0.5) * 255))))
+        row[idx + 1] = UInt8(max(0, min(255, Int((n.y * 0.5 + 0.5) * 255))))
+        row[idx + 2] = UInt8(max(0, min(255, Int((n.z * 0.5 + 0.5) * 255))))
+        row[idx + 3] = 255
+    }
+}
+
+/// Nonisolated: generators run on scene builds, the asset load queue and, through
+/// `fillRows`, on the row workers.
+public nonisolated enum ProceduralTextureGenerator {
     public static let digitsAtlasCellWidth: Int = 8
     public static let digitsAtlasCellHeight: Int = 12
+    /// Rows per worker band in `fillRows`; textures with fewer rows run on the caller.
+    private static let rowBand = 32
+    /// Pixel bytes `memoized` keeps; least recently used textures are dropped past it.
+    private static let cacheByteBudget = 32 << 20
+
+    private nonisolated struct CacheEntry {
+        let texture: ProceduralTexture
+        var lastUse: UInt64
+    }
+
+    /// `cacheLock` guards `cache`, `cacheBytes` and `cacheClock`.
+    private static let cacheLock = NSLock()
+    nonisolated(unsafe) private static var cache: [ProceduralTextureKey: CacheEntry] = [:]
+    nonisolated(unsafe) private static var cacheBytes = 0
+    nonisolated(unsafe) private static var cacheClock: UInt64 = 0
+
+    /// The texture generated for `key`, running `make` only when it is not cached. Generators
+    /// with per-pixel loops go through here, so materials that share parameters reuse the
+    /// bytes; copies share storage until written. Bounded by `cacheByteBudget` (LRU) and
+    /// cleared when the renderer replaces its scene.
+    public static func memoized(_ key: ProceduralTextureKey, _ make: () -> ProceduralTexture) -> ProceduralTexture {
+        cacheLock.lock()
+        cacheClock += 1
+        if let cached = cache[key] {
+            cache[key]?.lastUse = cacheClock
+            cacheLock.unlock()
+            return cached.texture
+        }
+        cacheLock.unlock()
+        let texture = make()
+        let bytes = texture.bytes.count
+        guard bytes <= cacheByteBudget else { return texture }
+        cacheLock.lock()
+        defer { cacheLock.unlock() }
+        if let raced = cache[key] {
+            return raced.texture
+        }
+        while cacheBytes + bytes > cacheByteBudget,
+              let oldest = cache.min(by: { $0.value.lastUse < $1.value.lastUse }) {
+            cacheBytes -= oldest.value.texture.bytes.count
+            cache[oldest.key] = nil
+        }
+        cache[key] = CacheEntry(texture: texture, lastUse: cacheClock)
+        cacheBytes += bytes
+        return texture
+    }
+
+    /// Drops memoized textures, e.g. after a scene is torn down.
+    public static func clearCache() {
+        cacheLock.lock()
+        cache.removeAll()
+        cacheBytes = 0
+        cacheLock.unlock()
+    }
+
+    /// RGBA8 pixels filled by `row(y, rowPointer)`, with bands of `rowBand` rows spread over
+    /// the cores. `row` must only write its own row, and like every generator here it is
+    /// nonisolated, so it may run on any worker.
+    private static func fillRows(width: Int,
+                                 height: Int,
+                                 fill: UInt8 = 0,
+                                 _ row: (Int, UnsafeMutablePointer<UInt8>) -> Void) -> [UInt8] {
+        var bytes = [UInt8](repeating: fill, count: width * height * 4)
+        let rowBytes = width * 4
+        bytes.withUnsafeMutableBufferPointer { out in
+            guard let base = out.baseAddress else { return }
+            let bands = (height + rowBand - 1) / rowBand
+            if bands <= 1 {
+                for y in 0..<height { row(y, base + y * rowBytes) }
+                return
+            }
+            DispatchQueue.concurrentPerform(iterations: bands) { band in
+                let lo = band * rowBand
+                let hi = min(lo + rowBand, height)
+                for y in lo..<hi { row(y, base + y * rowBytes) }
+            }
+        }
+        return bytes
+    }
 
     public static func solid(width: Int,
                              height: Int,
@@ -52,55 +200,116 @@ public enum ProceduralTextureGenerator {
                                     cell: Int = 32,
                                     colorA: UInt8 = 230,
                                     colorB: UInt8 = 40,
-                                    format: ProceduralTextureFormat = .rgba8Unorm) -> ProceduralTexture {
-        var bytes = [UInt8](repeating: 0, count: width * height * 4)
-        for y in 0..<height {
-            for x in 0..<width {
-                let cx = (x / cell) % 2
+                                    format: ProceduralTextureFormat = .rgba8Unorm,
+                                    mipmapped: Bool = false) -> ProceduralTexture {
+        let key = ProceduralTextureKey("checkerboard",
+                                       ints: [width, height, cell, Int(colorA), Int(colorB),
+                                              format == .rgba8UnormSrgb ? 1 : 0, mipmapped ? 1 : 0])
+        return memoized(key) {
+            let bytes = fillRows(width: width, height: height) { y, row in
                 let cy = (y / cell) % 2
-                let on = (cx ^ cy) == 0
-                let c: UInt8 = on ? colorA : colorB
-                let idx = (y * width + x) * 4
-                bytes[idx + 0] = c
-                bytes[idx + 1] = c
-                bytes[idx + 2] = c
-                bytes[idx + 3] = 255
+                for x in 0..<width {
+                    let cx = (x / cell) % 2
+                    let on = (cx ^ cy) == 0
+                    let c: UInt8 = on ? colorA : colorB
+                    let idx = x * 4
+                    row[idx + 0] = c
+                    row[idx + 1] = c
+                    row[idx + 2] = c
+                    row[idx + 3] = 255
+                }
             }
+            return ProceduralTexture(width: width,
+                                     height: height,
+                                     format: format,
+                                     bytes: bytes,
+                                     mipmapped: mipmapped)
         }
-        return ProceduralTexture(width: width,
-                                 height: height,
-                                 format: format,
-                                 bytes: bytes)
     }
 
     /// Digits atlas (0-9) in a single row, alpha-masked for overlay text.
     public static func digitsAtlas(format: ProceduralTextureFormat = .rgba8Unorm) -> ProceduralTexture {
+        memoized(ProceduralTextureKey("digitsAtlas", ints: [format == .rgba8UnormSrgb ? 1 : 0])) {
+            makeDigitsAtlas(format: format)
+        }
+    }
+
+    private static func makeDigitsAtlas(format: ProceduralTextureFormat) -> ProceduralTexture {
+        makeGlyphAtlas(Array("0123456789"), format: format)
+    }
+
+    /// Characters of `textAtlas`, in cell order; anything else is drawn as a space.
+    public static let textAtlasCharacters: [Character] = Array(" 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/%()_")
+
+    /// Overlay text atlas: `textAtlasCharacters` in a single row of digits-atlas sized cells.
+    public static func textAtlas(format: ProceduralTextureFormat = .rgba8Unorm) -> ProceduralTexture {
+        memoized(ProceduralTextureKey("textAtlas", ints: [format == .rgba8UnormSrgb ? 1 : 0])) {
+            makeGlyphAtlas(textAtlasCharacters, format: format)
+        }
+    }
+
+    /// 5x7 bitmaps of the atlas glyphs.
+    private static let glyphRows: [Character: [String]] = [
+        "0": ["01110","10001","10011","10101","11001","10001","01110"],
+        "1": ["00100","01100","00100","00100","00100","00100","01110"],
+        "2": ["01110","10001","00001","00010","00100","01000","11111"],
+        "3": ["11110","00001","00001","01110","00001","00001","11110"],
+        "4": ["00010","00110","01010","10010","11111","00010","00010"],
+        "5": ["11111","10000","11110","00001","00001","10001","01110"],
+        "6": ["00110","01000","10000","11110","10001","10001","01110"],
+        "7": ["11111","00001","00010","00100","01000","01000","01000"],
+        "8": ["01110","10001","10001","01110","10001","10001","01110"],
+        "9": ["01110","10001","10001","01111","00001","00010","11100"],
+        "A": ["01110","10001","10001","11111","10001","10001","10001"],
+        "B": ["11110","10001","10001","11110","10001","10001","11110"],
+        "C": ["01110","10001","10000","10000","10000","10001","01110"],
+        "D": ["11100","10010","10001","10001","10001","10010","11100"],
+        "E": ["11111","10000","10000","11110","10000","10000","11111"],
+        "F": ["11111","10000","10000","11110","10000","10000","10000"],
+        "G": ["01110","10001","10000","10111","10001","10001","01111"],
+        "H": ["10001","10001","10001","11111","10001","10001","10001"],
+        "I": ["01110","00100","00100","00100","00100","00100","01110"],
+        "J": ["00111","00010","00010","00010","00010","10010","01100"],
+        "K": ["10001","10010","10100","11000","10100","10010","10001"],
+        "L": ["10000","10000","10000","10000","10000","10000","11111"],
+        "M": ["10001","11011","10101","10101","10001","10001","10001"],
+        "N": ["10001","10001","11001","10101","10011","10001","10001"],
+        "O": ["01110","10001","10001","10001","10001","10001","01110"],
+        "P": ["11110","10001","10001","11110","10000","10000","10000"],
+        "Q": ["01110","10001","10001","10001","10101","10010","01101"],
+        "R": ["11110","10001","10001","11110","10100","10010","10001"],
+        "S": ["01111","10000","10000","01110","00001","00001","11110"],
+        "T": ["11111","00100","00100","00100","00100","00100","00100"],
+        "U": ["10001","10001","10001","10001","10001","10001","01110"],
+        "V": ["10001","10001","10001","10001","10001","01010","00100"],
+        "W": ["10001","10001","10001","10101","10101","10101","01010"],
+        "X": ["10001","10001","01010","00100","01010","10001","10001"],
+        "Y": ["10001","10001","10001","01010","00100","00100","00100"],
+        "Z": ["11111","00001","00010","00100","01000","10000","11111"],
+        ".": ["00000","00000","00000","00000","00000","01100","01100"],
+        ":": ["00000","01100","01100","00000","01100","01100","00000"],
+        "-": ["00000","00000","00000","11111","00000","00000","00000"],
+        "/": ["00001","00001","00010","00100","01000","10000","10000"],
+        "%": ["11000","11001","00010","00100","01000","10011","00011"],
+        "(": ["00010","00100","01000","01000","01000","00100","00010"],
+        ")": ["01000","00100","00010","00010","00010","00100","01000"],
+        "_": ["00000","00000","00000","00000","00000","00000","11111"]
+    ]
+
+    private static func makeGlyphAtlas(_ characters: [Character], format: ProceduralTextureFormat) -> ProceduralTexture {
         let cellW = digitsAtlasCellWidth
         let cellH = digitsAtlasCellHeight
-        let atlasW = cellW * 10
+        let atlasW = cellW * characters.count
         let atlasH = cellH
         var bytes = [UInt8](repeating: 0, count: atlasW * atlasH * 4)
 
-        let glyphs: [[String]] = [
-            ["01110","10001","10011","10101","11001","10001","01110"], // 0
-            ["00100","01100","00100","00100","00100","00100","01110"], // 1
-            ["01110","10001","00001","00010","00100","01000","11111"], // 2
-            ["11110","00001","00001","01110","00001","00001","11110"], // 3
-            ["00010","00110","01010","10010","11111","00010","00010"], // 4
-            ["11111","10000","11110","00001","00001","10001","01110"], // 5
-            ["00110","01000","10000","11110","10001","10001","01110"], // 6
-            ["11111","00001","00010","00100","01000","01000","01000"], // 7
-            ["01110","10001","10001","01110","10001","10001","01110"], // 8
-            ["01110","10001","10001","01111","00001","00010","11100"]  // 9
-        ]
-
         let padX = max((cellW - 5) / 2, 0)
         let padY = max((cellH - 7) / 2, 0)
 
-        for digit in 0..<10 {
-            let originX = digit * cellW + padX
+        for (cell, ch) in characters.enumerated() {
+            guard let rows = glyphRows[ch] else { continue }
+            let originX = cell * cellW + padX
             let originY = padY
-            let rows = glyphs[digit]
             for y in 0..<rows.count {
                 let row = Array(rows[y])
                 for x in 0..<row.count where row[x] == "1" {
@@ -154,42 +363,40 @@ public enum ProceduralTextureGenerator {
     public static func occlusionRadial(width: Int = 256,
                                        height: Int = 256,
                                        innerRadius: Float = 0.2,
-                                       outerRadius: Float = 0.9) -> ProceduralTexture {
-        var bytes = [UInt8](repeating: 0, count: width * height * 4)
-        let cx = Float(width - 1) * 0.5
-        let cy = Float(height - 1) * 0.5
-        let maxR = max(cx, cy)
-        let inner = max(0.0, min(innerRadius, 1.0))
-        let outer = max(inner, min(outerRadius, 1.0))
-
-        func smoothstep(_ a: Float, _ b: Float, _ x: Float) -> Float {
-            let t = max(0.0, min((x - a) / max(b - a, 1e-4), 1.0))
-            return t * t * (3.0 - 2.0 * t)
-        }
-
-        for y in 0..<height {
-            for x in 0..<width {
-                let dx = (Float(x) - cx) / maxR
+                                       outerRadius: Float = 0.9,
+                                       mipmapped: Bool = false) -> ProceduralTexture {
+        let key = ProceduralTextureKey("occlusionRadial",
+                                       ints: [width, height, mipmapped ? 1 : 0],
+                                       floats: [innerRadius, outerRadius])
+        return memoized(key) {
+            let cx = Float(width - 1) * 0.5
+            let cy = Float(height - 1) * 0.5
+            let maxR = max(cx, cy)
+            let inner = max(0.0, min(innerRadius, 1.0))
+            let outer = max(inner, min(outerRadius, 1.0))
+
+            let bytes = fillRows(width: width, height: height) { y, row in
                 let dy = (Float(y) - cy) / maxR
-                let r = sqrt(dx * dx + dy * dy)
-                let occ = smoothstep(inner, outer, r)
-                let o = UInt8(max(0, min(255, Int(occ * 255))))
-                let idx = (y * width + x) * 4
-                bytes[idx + 0] = o
-                bytes[idx + 1] = o
-                bytes[idx + 2] = o
-                bytes[idx + 3] = 255
+                for x in 0..<width {
+                    let dx = (Float(x) - cx) / maxR
+                    let r = sqrt(dx * dx + dy * dy)
+                    let occ = ProceduralNoise.smooth(max(0.0, min((r - inner) / max(outer - inner, 1e-4), 1.0)))
+                    let o = UInt8(max(0, min(255, Int(occ * 255))))
+                    let idx = x * 4
+                    row[idx + 0] = o
+                    row[idx + 1] = o
+                    row[idx + 2] = o
+                    row[idx + 3] = 255
+                }
             }
+            return ProceduralTexture(width: width,
+                                     height: height,
+                                     format: .rgba8Unorm,
+                                     bytes: bytes,
+                                     mipmapped: mipmapped)
         }
-
-        return ProceduralTexture(width: width,
-                                 height: height,
-                                 format: .rgba8Unorm,
-                                 bytes: bytes)
     }
 
-    
-
     public static func emissive(width: Int = 4,
                                 height: Int = 4,
                                 color: SIMD3<Float>,
@@ -206,181 +413,107 @@ public enum ProceduralTextureGenerator {
     public static func normalMapFromHeight(width: Int = 256,
                                            height: Int = 256,
                                            amplitude: Float = 1.0,
-                                           frequency: Float = 6.0) -> ProceduralTexture {
-        func heightFunc(_ u: Float, _ v: Float) -> Float {
-            let s = sin(u * frequency * Float.pi * 2.0)
-            let c = cos(v * frequency * Float.pi * 2.0)
-            return s * c * 0.5 + 0.5
-        }
+                                           frequency: Float = 6.0,
+                                           mipmapped: Bool = false) -> ProceduralTexture {
+        let key = ProceduralTextureKey("normalMapFromHeight",
+                                       ints: [width, height, mipmapped ? 1 : 0],
+                                       floats: [amplitude, frequency])
+        return memoized(key) {
+            func heightFunc(_ u: Float, _ v: Float) -> Float {
+                let s = sin(u * frequency * Float.pi * 2.0)
+                let c = cos(v * frequency * Float.pi * 2.0)
+                return s * c * 0.5 + 0.5
+            }
 
-        var bytes = [UInt8](repeating: 0, count: width * height * 4)
-        let du = 1.0 / Float(width)
-        let dv = 1.0 / Float(height)
-        for y in 0..<height {
-            for x in 0..<width {
-                let u = Float(x) * du
+            let du = 1.0 / Float(width)
+            let dv = 1.0 / Float(height)
+            let bytes = fillRows(width: width, height: height) { y, row in
                 let v = Float(y) * dv
-                let hL = heightFunc(u - du, v)
-                let hR = heightFunc(u + du, v)
-                let hD = heightFunc(u, v - dv)
-                let hU = heightFunc(u, v + dv)
-                let dx = (hR - hL) * amplitude
-                let dy = (hU - hD) * amplitude
-                var n = SIMD3<Float>(-dx, -dy, 1.0)
-                n = simd_normalize(n)
-                let idx = (y * width + x) * 4
-                bytes[idx + 0] = UInt8(max(0, min(255, Int((n.x * 0.5 + 0.5) * 255))))
-                bytes[idx + 1] = UInt8(max(0, min(255, Int((n.y * 0.5 + 0.5) * 255))))
-                bytes[idx + 2] = UInt8(max(0, min(255, Int((n.z * 0.5 + 0.5) * 255))))
-                bytes[idx + 3] = 255
+                for x in 0..<width {
+                    let u = Float(x) * du
+                    let hL = heightFunc(u - du, v)
+                    let hR = heightFunc(u + du, v)
+                    let hD = heightFunc(u, v - dv)
+                    let hU = heightFunc(u, v + dv)
+                    let dx = (hR - hL) * amplitude
+                    let dy = (hU - hD) * amplitude
+                    let n = simd_normalize(SIMD3<Float>(-dx, -dy, 1.0))
+                    ProceduralNoise.encodeNormal(n, into: row, at: x * 4)
+                }
             }
+            return ProceduralTexture(width: width,
+                                     height: height,
+                                     format: .rgba8Unorm,
+                                     bytes: bytes,
+                                     mipmapped: mipmapped)
         }
-
-        return ProceduralTexture(width: width,
-                                 height: height,
-                                 format: .rgba8Unorm,
-                                 bytes: bytes)
     }
 
     public static func normalMapNoise(width: Int = 256,
                                       height: Int = 256,
                                       amplitude: Float = 1.0,
                                       frequency: Float = 6.0,
-                                      octaves: Int = 4) -> ProceduralTexture {
-        func hash2(_ x: Int, _ y: Int) -> Float {
-            let ux = UInt32(bitPattern: Int32(truncatingIfNeeded: x))
-            let uy = UInt32(bitPattern: Int32(truncatingIfNeeded: y))
-            var n = (ux &* 374761393) &+ (uy &* 668265263) &+ 0x9E3779B9
-            n ^= n >> 13
-            n &*= 1274126177
-            return Float(n & 0x00FFFFFF) / Float(0x01000000)
-        }
-
-        func smooth(_ t: Float) -> Float { t * t * (3.0 - 2.0 * t) }
-
-        func noise(_ u: Float, _ v: Float) -> Float {
-            let x0 = Int(floor(u))
-            let y0 = Int(floor(v))
-            let x1 = x0 + 1
-            let y1 = y0 + 1
-            let tx = smooth(u - Float(x0))
-            let ty = smooth(v - Float(y0))
-            let a = hash2(x0, y0)
-            let b = hash2(x1, y0)
-            let c = hash2(x0, y1)
-            let d = hash2(x1, y1)
-            let ab = a + (b - a) * tx
-            let cd = c + (d - c) * tx
-            return ab + (cd - ab) * ty
-        }
-
-        func fbm(_ u: Float, _ v: Float) -> Float {
-            var sum: Float = 0
-            var amp: Float = 0.5
-            var freq: Float = 1.0
-            for _ in 0..<max(octaves, 1) {
-                sum += noise(u * freq, v * freq) * amp
-                freq *= 2.0
-                amp *= 0.5
-            }
-            return sum
-        }
-
-        var bytes = [UInt8](repeating: 0, count: width * height * 4)
-        let du = 1.0 / Float(width)
-        let dv = 1.0 / Float(height)
-        for y in 0..<height {
-            for x in 0..<width {
-                let u = Float(x) * du * frequency
+                                      octaves: Int = 4,
+                                      mipmapped: Bool = false) -> ProceduralTexture {
+        let key = ProceduralTextureKey("normalMapNoise",
+                                       ints: [width, height, octaves, mipmapped ? 1 : 0],
+                                       floats: [amplitude, frequency])
+        return memoized(key) {
+            let du = 1.0 / Float(width)
+            let dv = 1.0 / Float(height)
+            let bytes = fillRows(width: width, height: height) { y, row in
                 let v = Float(y) * dv * frequency
-                let hL = fbm(u - du, v)
-                let hR = fbm(u + du, v)
-                let hD = fbm(u, v - dv)
-                let hU = fbm(u, v + dv)
-                let dx = (hR - hL) * amplitude
-                let dy = (hU - hD) * amplitude
-                var n = SIMD3<Float>(-dx, -dy, 1.0)
-                n = simd_normalize(n)
-                let idx = (y * width + x) * 4
-                bytes[idx + 0] = UInt8(max(0, min(255, Int((n.x * 0.5 + 0.5) * 255))))
-                bytes[idx + 1] = UInt8(max(0, min(255, Int((n.y * 0.5 + 0.5) * 255))))
-                bytes[idx + 2] = UInt8(max(0, min(255, Int((n.z * 0.5 + 0.5) * 255))))
-                bytes[idx + 3] = 255
+                for x in 0..<width {
+                    let u = Float(x) * du * frequency
+                    let hL = ProceduralNoise.fbm(u - du, v, octaves: octaves, amplitude: 0.5)
+                    let hR = ProceduralNoise.fbm(u + du, v, octaves: octaves, amplitude: 0.5)
+                    let hD = ProceduralNoise.fbm(u, v - dv, octaves: octaves, amplitude: 0.5)
+                    let hU = ProceduralNoise.fbm(u, v + dv, octaves: octaves, amplitude: 0.5)
+                    let dx = (hR - hL) * amplitude
+                    let dy = (hU - hD) * amplitude
+                    let n = simd_normalize(SIMD3<Float>(-dx, -dy, 1.0))
+                    ProceduralNoise.encodeNormal(n, into: row, at: x * 4)
+                }
             }
+            return ProceduralTexture(width: width,
+                                     height: height,
+                                     format: .rgba8Unorm,
+                                     bytes: bytes,
+                                     mipmapped: mipmapped)
         }
-
-        return ProceduralTexture(width: width,
-                                 height: height,
-                                 format: .rgba8Unorm,
-                                 bytes: bytes)
     }
 
     public static func occlusionGrime(width: Int = 256,
                                       height: Int = 256,
                                       frequency: Float = 2.5,
-                                      contrast: Float = 1.6) -> ProceduralTexture {
-        func hash2(_ x: Int, _ y: Int) -> Float {
-            let ux = UInt32(bitPattern: Int32(truncatingIfNeeded: x))
-            let uy = UInt32(bitPattern: Int32(truncatingIfNeeded: y))
-            var n = (ux &* 374761393) &+ (uy &* 668265263) &+ 0x9E3779B9
-            n ^= n >> 13
-            n &*= 1274126177
-            return Float(n & 0x00FFFFFF) / Float(0x01000000)
-        }
-
-        func smooth(_ t: Float) -> Float { t * t * (3.0 - 2.0 * t) }
-
-        func noise(_ u: Float, _ v: Float) -> Float {
-            let x0 = Int(floor(u))
-            let y0 = Int(floor(v))
-            let x1 = x0 + 1
-            let y1 = y0 + 1
-            let tx = smooth(u - Float(x0))
-            let ty = smooth(v - Float(y0))
-            let a = hash2(x0, y0)
-            let b = hash2(x1, y0)
-            let c = hash2(x0, y1)
-            let d = hash2(x1, y1)
-            let ab = a + (b - a) * tx
-            let cd = c + (d - c) * tx
-            return ab + (cd - ab) * ty
-        }
-
-        func fbm(_ u: Float, _ v: Float) -> Float {
-            var sum: Float = 0
-            var amp: Float = 0.6
-            var freq: Float = 1.0
-            for _ in 0..<4 {
-                sum += noise(u * freq, v * freq) * amp
-                freq *= 2.0
-                amp *= 0.5
-            }
-            return sum
-        }
-
-        var bytes = [UInt8](repeating: 255, count: width * height * 4)
-        let du = 1.0 / Float(width)
-        let dv = 1.0 / Float(height)
-        for y in 0..<height {
-            for x in 0..<width {
-                let u = Float(x) * du * frequency
+                                      contrast: Float = 1.6,
+                                      mipmapped: Bool = false) -> ProceduralTexture {
+        let key = ProceduralTextureKey("occlusionGrime",
+                                       ints: [width, height, mipmapped ? 1 : 0],
+                                       floats: [frequency, contrast])
+        return memoized(key) {
+            let du = 1.0 / Float(width)
+            let dv = 1.0 / Float(height)
+            let bytes = fillRows(width: width, height: height, fill: 255) { y, row in
                 let v = Float(y) * dv * frequency
-                var n = fbm(u, v)
-                n = max(0.0, min(n, 1.0))
-                let grime = pow(n, contrast)
-                let occ = 1.0 - grime * 0.85
-                let o = UInt8(max(0, min(255, Int(occ * 255))))
-                let idx = (y * width + x) * 4
-                bytes[idx + 0] = o
-                bytes[idx + 1] = o
-                bytes[idx + 2] = o
-                bytes[idx + 3] = 255
+                for x in 0..<width {
+                    let u = Float(x) * du * frequency
+                    let n = max(0.0, min(ProceduralNoise.fbm(u, v, octaves: 4, amplitude: 0.6), 1.0))
+                    let grime = pow(n, contrast)
+                    let occ = 1.0 - grime * 0.85
+                    let o = UInt8(max(0, min(255, Int(occ * 255))))
+                    let idx = x * 4
+                    row[idx + 0] = o
+                    row[idx + 1] = o
+                    row[idx + 2] = o
+                    row[idx + 3] = 255
+                }
             }
+            return ProceduralTexture(width: width,
+                                     height: height,
+                                     format: .rgba8Unorm,
+                                     bytes: bytes,
+                                     mipmapped: mipmapped)
         }
-
-        return ProceduralTexture(width: width,
-                                 height: height,
-                                 format: .rgba8Unorm,
-                                 bytes: bytes)
     }
 }
@@ -0,0 +1,122 @@
+//
+//  ProfilerOverlaySystem.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+import Metal
+import simd
+
+/// Draws `FrameProfiler`'s smoothed breakdown as overlay text in the top-left corner:
+/// one line per CPU scope, then one per GPU scope, in milliseconds. The text is rebuilt
+/// every `refreshInterval` so the values stay readable.
+final class ProfilerOverlaySystem {
+    private let profiler: FrameProfiler
+    private let glyphMeshes: [GPUMesh]
+    private let glyphIndex: [Character: Int]
+    private let material: Material
+    private let glyphPixelSize: SIMD2<Float>
+    private let margin: Float = 12
+    private let lineSpacing: Float = 2
+    private let nameColumns = 24
+    private let maxLines = 40
+    private var sinceRefresh: Float = .infinity
+    private var items: [RenderItem] = []
+
+    /// Seconds between text rebuilds.
+    var refreshInterval: Float = 0.25
+
+    init(device: MTLDevice, profiler: FrameProfiler) {
+        self.profiler = profiler
+
+        let atlas = ProceduralTextureGenerator.textAtlas(format: .rgba8UnormSrgb)
+        let mr = ProceduralTextureGenerator.metallicRoughness(width: 4,
+                                                              height: 4,
+                                                              metallic: 0.0,
+                                                              roughness: 1.0)
+        let desc = MaterialDescriptor(baseColor: atlas,
+                                      metallicRoughness: mr,
+                                      baseColorFactor: SIMD3<Float>(1.0, 0.9, 0.4),
+                                      metallicFactor: 1.0,
+                                      roughnessFactor: 1.0,
+                                      alpha: 1.0,
+                                      unlit: true)
+        var mat = MaterialFactory.make(device: device, descriptor: desc, label: "ProfilerText")
+        mat.cullMode = .none
+        self.material = mat
+
+        let characters = ProceduralTextureGenerator.textAtlasCharacters
+        let cellW = ProceduralTextureGenerator.digitsAtlasCellWidth
+        let cellH = ProceduralTextureGenerator.digitsAtlasCellHeight
+        let atlasW = cellW * characters.count
+        let scale: Float = 1.5
+        self.glyphPixelSize = SIMD2<Float>(Float(cellW) * scale, Float(cellH) * scale)
+
+        var glyphIndex: [Character: Int] = [:]
+        for (i, ch) in characters.enumerated() {
+            glyphIndex[ch] = i
+        }
+        self.glyphIndex = glyphIndex
+        self.glyphMeshes = characters.indices.map { cell in
+            let u0 = Float(cell * cellW) / Float(atlasW)
+            let u1 = Float((cell + 1) * cellW) / Float(atlasW)
+            let desc = ProceduralMeshes.quad(QuadParams(uvMin: SIMD2<Float>(u0, 0),
+                                                       uvMax: SIMD2<Float>(u1, 1)))
+            return GPUMesh(device: device, descriptor: desc, label: "ProfilerGlyph\(cell)")
+        }
+    }
+
+    func update(dt: Float) -> [RenderItem] {
+        sinceRefresh += dt
+        guard sinceRefresh >= refreshInterval else { return items }
+        sinceRefresh = 0
+
+        let entries = profiler.breakdown()
+        var lines: [String] = []
+        for domain in [ProfileDomain.cpu, .gpu] {
+            let rows = entries.filter { $0.domain == domain }
+            guard !rows.isEmpty else { continue }
+            let total = rows.reduce(0) { $0 + $1.milliseconds }
+            lines.append(line(domain == .cpu ? "CPU MS" : "GPU MS", total))
+            for row in rows {
+                lines.append(line("  " + row.name, row.milliseconds))
+            }
+        }
+
+        items.removeAll(keepingCapacity: true)
+        var y = margin
+        for text in lines.prefix(maxLines) {
+            var x = margin
+            for ch in text {
+                if let cell = glyphIndex[ch], cell != 0 {
+                    let t = TransformComponent(translation: SIMD3<Float>(x, y, 0),
+                                               rotation: simd_quatf(angle: 0, axis: SIMD3<Float>(0, 1, 0)),
+                                               scale: SIMD3<Float>(glyphPixelSize.x, glyphPixelSize.y, 1))
+                    items.append(RenderItem(mesh: glyphMeshes[cell], material: material, modelMatrix: t.modelMatrix))
+                }
+                x += glyphPixelSize.x
+            }
+            y += glyphPixelSize.y + lineSpacing
+        }
+        return items
+    }
+
+    /// `name` in the atlas alphabet, padded to the name column, then the milliseconds.
+    /// Type names are split at case changes and lose a trailing "System".
+    private func line(_ name: String, _ milliseconds: Double) -> String {
+        var words = ""
+        var previous: Character?
+        for ch in name.hasSuffix("System") && name.count > 6 ? String(name.dropLast(6)) : name {
+            if ch.isUppercase, let previous, previous.isLowercase {
+                words.append(" ")
+            }
+            words.append(ch)
+            previous = ch
+        }
+        let label = String(words.uppercased().prefix(nameColumns))
+        let padded = label.padding(toLength: nameColumns, withPad: " ", startingAt: 0)
+        return padded + String(format: "%7.2f", milliseconds)
+    }
+}
@@ -7,141 +7,97 @@
 
 import Metal
 
+/// One private scratch buffer reused across encoders and frames. Each encoder carves its
+/// builds out of it from offset zero; encoders in a command buffer (and command buffers on
+/// the queue) are ordered on the buffer, so no two live builds share bytes.
+private struct RTScratchPool {
+    private static let alignment = 256
+    private(set) var buffer: MTLBuffer?
+
+    /// Offsets for `sizes`, growing the buffer to fit all of them.
+    mutating func reserve(_ sizes: [Int], device: MTLDevice) -> (buffer: MTLBuffer, offsets: [Int])? {
+        var offsets: [Int] = []
+        offsets.reserveCapacity(sizes.count)
+        var total = 0
+        for size in sizes {
+            offsets.append(total)
+            total += (max(size, 1) + RTScratchPool.alignment - 1) / RTScratchPool.alignment * RTScratchPool.alignment
+        }
+        if buffer == nil || buffer!.length < total {
+            let length = max(total, (buffer?.length ?? 0) * 2)
+            buffer = device.makeBuffer(length: max(length, RTScratchPool.alignment), options: .storageModePrivate)
+            buffer?.label = "RTScratch"
+        }
+        guard let buffer else { return nil }
+        return (buffer, offsets)
+    }
+}
+
 final class RTAccelerationBuilder {
     private let device: MTLDevice
 
     private var tlas: MTLAccelerationStructure?
     private var tlasSize: Int = 0
-    private var tlasScratch: MTLBuffer?
-    private var tlasRefitScratch: MTLBuffer?
-    private var instanceBuffer: MTLBuffer?
-    private var lastInstanceCount: Int = 0
-    private var lastTLASKey: (instanceCount: Int, blasCount: Int)?
-
+    private var instanceBuffers = FrameSlotBuffers(label: "RTInstanceDescriptors")
+    /// Refit is valid only while the BLAS list and per-instance BLAS indices are unchanged.
+    private var tlasBLASRevision: UInt64?
+    private var tlasAccelIndices: [UInt32] = []
+    private var tlasNonOpaque: [Bool] = []
+    private var blasRevision: UInt64 = 0
+
+    /// Static BLAS per resident mesh (`RTGeometrySlice.geometryID`), kept across static set changes.
+    private var staticBLASByID: [UInt64: MTLAccelerationStructure] = [:]
+    private var cachedStaticIDs: [UInt64] = []
     private var cachedStaticBLAS: [MTLAccelerationStructure] = []
     private var cachedDynamicBLAS: [MTLAccelerationStructure] = []
-    private var dynamicRefitScratch: [MTLBuffer] = []
-    private var transientScratch: [MTLBuffer] = []
+    private var scratchPool = RTScratchPool()
+    private var pendingCompactions: [PendingCompaction] = []
+
+    /// Every BLAS the current TLAS references; the trace encoder must `useResources` them.
+    var primitiveAccelerationStructures: [MTLAccelerationStructure] {
+        cachedStaticBLAS + cachedDynamicBLAS
+    }
 
-    init(device: MTLDevice) {
+    /// A static BLAS whose compacted size is written by `commandBuffer`.
+    private struct PendingCompaction {
+        let geometryID: UInt64
+        let source: MTLAccelerationStructure
+        let sizeBuffer: MTLBuffer
+        let sizeOffset: Int
+        let commandBuffer: MTLCommandBuffer
+    }
+
+    private let profiler: GPUProfiler?
+
+    init(device: MTLDevice, profiler: GPUProfiler? = nil) {
         self.device = device
+        self.profiler = profiler
     }
 
     func build(state: RTGeometryState,
                items: [RenderItem],
+               frameSlot: Int,
                commandBuffer: MTLCommandBuffer) -> MTLAccelerationStructure? {
         let buffers = state.buffers
 
-        transientScratch.removeAll(keepingCapacity: true)
+        compactFinishedBuilds(commandBuffer: commandBuffer)
 
         if state.staticChanged || cachedStaticBLAS.count != state.staticSlices.count {
-            cachedStaticBLAS.removeAll(keepingCapacity: true)
-            cachedStaticBLAS.reserveCapacity(state.staticSlices.count)
-            let encoder = commandBuffer.makeAccelerationStructureCommandEncoder()!
-            for slice in state.staticSlices {
-                let geometry = MTLAccelerationStructureTriangleGeometryDescriptor()
-                geometry.vertexBuffer = buffers.staticVertexBuffer
-                geometry.vertexBufferOffset = slice.baseVertex * MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexStride = MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexFormat = .float3
-                geometry.indexBuffer = buffers.staticIndexBuffer
-                geometry.indexBufferOffset = slice.baseIndex * MemoryLayout<UInt32>.stride
-                geometry.indexType = .uint32
-                geometry.triangleCount = slice.indexCount / 3
-                geometry.opaque = true
-
-                let desc = MTLPrimitiveAccelerationStructureDescriptor()
-                desc.geometryDescriptors = [geometry]
-                desc.usage = [.refit]
-
-                let sizes = device.accelerationStructureSizes(descriptor: desc)
-                let blas = device.makeAccelerationStructure(size: sizes.accelerationStructureSize)!
-                let scratch = device.makeBuffer(length: sizes.buildScratchBufferSize,
-                                                options: .storageModePrivate)!
-
-                encoder.build(accelerationStructure: blas,
-                              descriptor: desc,
-                              scratchBuffer: scratch,
-                              scratchBufferOffset: 0)
-
-                cachedStaticBLAS.append(blas)
-                transientScratch.append(scratch)
-            }
-            encoder.endEncoding()
+            buildStaticBLAS(slices: state.staticSlices, buffers: buffers, commandBuffer: commandBuffer)
         }
 
         if state.dynamicChanged || cachedDynamicBLAS.count != state.dynamicSlices.count {
-            cachedDynamicBLAS.removeAll(keepingCapacity: true)
-            cachedDynamicBLAS.reserveCapacity(state.dynamicSlices.count)
-            dynamicRefitScratch.removeAll(keepingCapacity: true)
-            dynamicRefitScratch.reserveCapacity(state.dynamicSlices.count)
-
-            let encoder = commandBuffer.makeAccelerationStructureCommandEncoder()!
-            for slice in state.dynamicSlices {
-                let geometry = MTLAccelerationStructureTriangleGeometryDescriptor()
-                geometry.vertexBuffer = buffers.dynamicVertexBuffer
-                geometry.vertexBufferOffset = slice.baseVertex * MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexStride = MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexFormat = .float3
-                geometry.indexBuffer = buffers.dynamicIndexBuffer
-                geometry.indexBufferOffset = slice.baseIndex * MemoryLayout<UInt32>.stride
-                geometry.indexType = .uint32
-                geometry.triangleCount = slice.indexCount / 3
-                geometry.opaque = true
-
-                let desc = MTLPrimitiveAccelerationStructureDescriptor()
-                desc.geometryDescriptors = [geometry]
-                desc.usage = [.refit]
-
-                let sizes = device.accelerationStructureSizes(descriptor: desc)
-                let blas = device.makeAccelerationStructure(size: sizes.accelerationStructureSize)!
-                let scratch = device.makeBuffer(length: sizes.buildScratchBufferSize,
-                                                options: .storageModePrivate)!
-
-                encoder.build(accelerationStructure: blas,
-                              descriptor: desc,
-                              scratchBuffer: scratch,
-                              scratchBufferOffset: 0)
-
-                let refitScratch = device.makeBuffer(length: max(sizes.refitScratchBufferSize, 1),
-                                                     options: .storageModePrivate)!
-                cachedDynamicBLAS.append(blas)
-                dynamicRefitScratch.append(refitScratch)
-                transientScratch.append(scratch)
-            }
-            encoder.endEncoding()
+            buildDynamicBLAS(slices: state.dynamicSlices, buffers: buffers, commandBuffer: commandBuffer)
         } else if !cachedDynamicBLAS.isEmpty {
-            let encoder = commandBuffer.makeAccelerationStructureCommandEncoder()!
-            for (i, slice) in state.dynamicSlices.enumerated() {
-                let geometry = MTLAccelerationStructureTriangleGeometryDescriptor()
-                geometry.vertexBuffer = buffers.dynamicVertexBuffer
-                geometry.vertexBufferOffset = slice.baseVertex * MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexStride = MemoryLayout<SIMD3<Float>>.stride
-                geometry.vertexFormat = .float3
-                geometry.indexBuffer = buffers.dynamicIndexBuffer
-                geometry.indexBufferOffset = slice.baseIndex * MemoryLayout<UInt32>.stride
-                geometry.indexType = .uint32
-                geometry.triangleCount = slice.indexCount / 3
-                geometry.opaque = true
-
-                let desc = MTLPrimitiveAccelerationStructureDescriptor()
-                desc.geometryDescriptors = [geometry]
-                desc.usage = [.refit]
-
-                let sizes = device.accelerationStructureSizes(descriptor: desc)
-                if dynamicRefitScratch[i].length < sizes.refitScratchBufferSize {
-                    dynamicRefitScratch[i] = device.makeBuffer(length: sizes.refitScratchBufferSize,
-                                                               options: .storageModePrivate)!
-                }
+            refitDynamicBLAS(slices: state.dynamicSlices,
+                             skinned: state.dynamicSlicesSkinned,
+                             buffers: buffers,
+                             commandBuffer: commandBuffer)
+        }
 
-                encoder.refit(sourceAccelerationStructure: cachedDynamicBLAS[i],
-                              descriptor: desc,
-                              destinationAccelerationStructure: cachedDynamicBLAS[i],
-                              scratchBuffer: dynamicRefitScratch[i],
-                              scratchBufferOffset: 0,
-                              options: .vertexData)
-            }
-            encoder.endEncoding()
+        guard cachedStaticBLAS.count == state.staticSlices.count,
+              cachedDynamicBLAS.count == state.dynamicSlices.count else {
+            return nil
         }
 
         var blasList: [MTLAccelerationStructure] = []
@@ -151,16 +107,12 @@ final class RTAccelerationBuilder {
 
         var accelIndexForItem: [UInt32] = []
         accelIndexForItem.reserveCapacity(items.count)
-        var staticIndex = 0
-        var dynamicIndex = 0
-
+        // Items sharing a static mesh share its BLAS.
         for slice in state.instanceSlices {
             if slice.bufferIndex == 0 {
-                accelIndexForItem.append(UInt32(staticIndex))
-                staticIndex += 1
+                accelIndexForItem.append(UInt32(slice.sliceIndex))
             } else {
-                accelIndexForItem.append(UInt32(cachedStaticBLAS.count + dynamicIndex))
-                dynamicIndex += 1
+                accelIndexForItem.append(UInt32(cachedStaticBLAS.count + slice.sliceIndex))
             }
         }
 
@@ -171,7 +123,9 @@ final class RTAccelerationBuilder {
             var desc = MTLAccelerationStructureInstanceDescriptor()
             desc.accelerationStructureIndex = accelIndexForItem[i]
             desc.mask = 0xFF
-            desc.options = []
+            // Opaque instances skip intersection functions; the kernel forces opacity
+            // when they are not in use.
+            desc.options = i < state.instanceNonOpaque.count && state.instanceNonOpaque[i] ? .nonOpaque : .opaque
             desc.intersectionFunctionTableOffset = 0
 
             let m = item.modelMatrix
@@ -185,14 +139,13 @@ final class RTAccelerationBuilder {
         }
 
         let instanceSize = instances.count * MemoryLayout<MTLAccelerationStructureInstanceDescriptor>.stride
-        if instanceBuffer == nil || instances.count != lastInstanceCount {
-            instanceBuffer = device.makeBuffer(length: max(instanceSize, 1),
-                                               options: .storageModeShared)
-            lastInstanceCount = instances.count
+        guard let instanceBuffer = instanceBuffers.buffer(slot: frameSlot, length: instanceSize, device: device) else {
+            return nil
         }
-        if let buf = instanceBuffer, !instances.isEmpty {
-            let raw = instances.withUnsafeBytes { $0 }
-            memcpy(buf.contents(), raw.baseAddress!, raw.count)
+        if !instances.isEmpty {
+            _ = instances.withUnsafeBytes { raw in
+                memcpy(instanceBuffer.contents(), raw.baseAddress!, raw.count)
+            }
         }
 
         let tlasDesc = MTLInstanceAccelerationStructureDescriptor()
@@ -203,45 +156,219 @@ final class RTAccelerationBuilder {
         tlasDesc.usage = [.refit]
 
         let tlasSizes = device.accelerationStructureSizes(descriptor: tlasDesc)
+        // Transform-only frames refit the TLAS in place.
         let canRefit = tlas != nil
-            && lastTLASKey?.instanceCount == instances.count
-            && lastTLASKey?.blasCount == blasList.count
+            && tlasBLASRevision == blasRevision
+            && tlasAccelIndices == accelIndexForItem
+            && tlasNonOpaque == state.instanceNonOpaque
         if tlas == nil || tlasSize < tlasSizes.accelerationStructureSize {
             tlas = device.makeAccelerationStructure(size: tlasSizes.accelerationStructureSize)
             tlasSize = tlasSizes.accelerationStructureSize
+            tlasBLASRevision = nil
         }
-        if tlasScratch == nil || tlasScratch!.length < tlasSizes.buildScratchBufferSize {
-            tlasScratch = device.makeBuffer(length: tlasSizes.buildScratchBufferSize,
-                                            options: .storageModePrivate)
-        }
-        if tlasRefitScratch == nil || tlasRefitScratch!.length < tlasSizes.refitScratchBufferSize {
-            tlasRefitScratch = device.makeBuffer(length: max(tlasSizes.refitScratchBufferSize, 1),
-                                                 options: .storageModePrivate)
-        }
+        guard let tlas else { return nil }
 
-        if let tlas = tlas, canRefit, let scratch = tlasRefitScratch {
-            let encoder = commandBuffer.makeAccelerationStructureCommandEncoder()!
+        if canRefit && tlasBLASRevision != nil {
+            guard let scratch = scratchPool.reserve([tlasSizes.refitScratchBufferSize], device: device),
+                  let encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT TLAS Refit") else {
+                return nil
+            }
             encoder.refit(sourceAccelerationStructure: tlas,
                           descriptor: tlasDesc,
                           destinationAccelerationStructure: tlas,
-                          scratchBuffer: scratch,
-                          scratchBufferOffset: 0,
-                          options: .perPrimitiveData)
+                          scratchBuffer: scratch.buffer,
+                          scratchBufferOffset: scratch.offsets[0])
             encoder.endEncoding()
             return tlas
         }
 
-        if let tlas = tlas, let scratch = tlasScratch {
-            let encoder = commandBuffer.makeAccelerationStructureCommandEncoder()!
-            encoder.build(accelerationStructure: tlas,
-                          descriptor: tlasDesc,
-                          scratchBuffer: scratch,
-                          scratchBufferOffset: 0)
+        guard let scratch = scratchPool.reserve([tlasSizes.buildScratchBufferSize], device: device),
+              let encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT TLAS Build") else {
+            return nil
+        }
+        encoder.build(accelerationStructure: tlas,
+                      descriptor: tlasDesc,
+                      scratchBuffer: scratch.buffer,
+                      scratchBufferOffset: scratch.offsets[0])
+        encoder.endEncoding()
+        tlasBLASRevision = blasRevision
+        tlasAccelIndices = accelIndexForItem
+        tlasNonOpaque = state.instanceNonOpaque
+        return tlas
+    }
+
+    /// Builds BLAS only for meshes that became resident and drops those that left; new ones
+    /// are queued for compaction once their build completes.
+    private func buildStaticBLAS(slices: [RTGeometrySlice],
+                                 buffers: RTGeometryBuffers,
+                                 commandBuffer: MTLCommandBuffer) {
+        var builds: [(slice: RTGeometrySlice, desc: MTLPrimitiveAccelerationStructureDescriptor, size: MTLAccelerationStructureSizes)] = []
+        for slice in slices where staticBLASByID[slice.geometryID] == nil {
+            let desc = RTAccelerationBuilder.descriptor(slice: slice,
+                                                        vertexBuffer: buffers.staticVertexBuffer,
+                                                        indexBuffer: buffers.staticIndexBuffer,
+                                                        refit: false)
+            builds.append((slice, desc, device.accelerationStructureSizes(descriptor: desc)))
+        }
+
+        if !builds.isEmpty,
+           let scratch = scratchPool.reserve(builds.map { $0.size.buildScratchBufferSize }, device: device),
+           let sizeBuffer = device.makeBuffer(length: builds.count * MemoryLayout<UInt32>.stride,
+                                              options: .storageModeShared),
+           let encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT Static BLAS Build") {
+            sizeBuffer.label = "RTCompactedSizes"
+            for (i, build) in builds.enumerated() {
+                guard let blas = device.makeAccelerationStructure(size: build.size.accelerationStructureSize) else {
+                    continue
+                }
+                encoder.build(accelerationStructure: blas,
+                              descriptor: build.desc,
+                              scratchBuffer: scratch.buffer,
+                              scratchBufferOffset: scratch.offsets[i])
+                encoder.writeCompactedSize(accelerationStructure: blas,
+                                           buffer: sizeBuffer,
+                                           offset: i * MemoryLayout<UInt32>.stride)
+                staticBLASByID[build.slice.geometryID] = blas
+                pendingCompactions.append(PendingCompaction(geometryID: build.slice.geometryID,
+                                                            source: blas,
+                                                            sizeBuffer: sizeBuffer,
+                                                            sizeOffset: i * MemoryLayout<UInt32>.stride,
+                                                            commandBuffer: commandBuffer))
+            }
             encoder.endEncoding()
-            lastTLASKey = (instances.count, blasList.count)
-            return tlas
         }
 
-        return nil
+        let live = Set(slices.map { $0.geometryID })
+        for id in staticBLASByID.keys where !live.contains(id) {
+            staticBLASByID[id] = nil
+        }
+        pendingCompactions.removeAll { !live.contains($0.geometryID) }
+        cachedStaticIDs = slices.map { $0.geometryID }
+        refreshStaticList()
+    }
+
+    /// Swaps in compacted copies of static BLAS whose builds (and so their size queries)
+    /// have completed on the GPU.
+    private func compactFinishedBuilds(commandBuffer: MTLCommandBuffer) {
+        guard !pendingCompactions.isEmpty else { return }
+        var encoder: MTLAccelerationStructureCommandEncoder?
+        var swapped = false
+        pendingCompactions.removeAll { pending in
+            switch pending.commandBuffer.status {
+            case .completed:
+                break
+            case .error:
+                return true
+            default:
+                return false
+            }
+            guard staticBLASByID[pending.geometryID] === pending.source else { return true }
+            let size = Int(pending.sizeBuffer.contents().load(fromByteOffset: pending.sizeOffset, as: UInt32.self))
+            guard size > 0, size < pending.source.size,
+                  let compacted = device.makeAccelerationStructure(size: size) else {
+                return true
+            }
+            if encoder == nil {
+                encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT BLAS Compaction")
+            }
+            guard let encoder else { return false }
+            encoder.copyAndCompact(sourceAccelerationStructure: pending.source,
+                                   destinationAccelerationStructure: compacted)
+            staticBLASByID[pending.geometryID] = compacted
+            swapped = true
+            return true
+        }
+        encoder?.endEncoding()
+        if swapped {
+            refreshStaticList()
+        }
+    }
+
+    private func refreshStaticList() {
+        cachedStaticBLAS = cachedStaticIDs.compactMap { staticBLASByID[$0] }
+        blasRevision &+= 1
+    }
+
+    private func buildDynamicBLAS(slices: [RTGeometrySlice],
+                                  buffers: RTGeometryBuffers,
+                                  commandBuffer: MTLCommandBuffer) {
+        cachedDynamicBLAS.removeAll(keepingCapacity: true)
+        cachedDynamicBLAS.reserveCapacity(slices.count)
+        blasRevision &+= 1
+        guard !slices.isEmpty else { return }
+
+        let descs = slices.map {
+            RTAccelerationBuilder.descriptor(slice: $0,
+                                             vertexBuffer: buffers.dynamicVertexBuffer,
+                                             indexBuffer: buffers.dynamicIndexBuffer,
+                                             refit: true)
+        }
+        let sizes = descs.map { device.accelerationStructureSizes(descriptor: $0) }
+        guard let scratch = scratchPool.reserve(sizes.map { $0.buildScratchBufferSize }, device: device),
+              let encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT Dynamic BLAS Build") else {
+            return
+        }
+        for (i, desc) in descs.enumerated() {
+            guard let blas = device.makeAccelerationStructure(size: sizes[i].accelerationStructureSize) else {
+                continue
+            }
+            encoder.build(accelerationStructure: blas,
+                          descriptor: desc,
+                          scratchBuffer: scratch.buffer,
+                          scratchBufferOffset: scratch.offsets[i])
+            cachedDynamicBLAS.append(blas)
+        }
+        encoder.endEncoding()
+    }
+
+    /// Refits only the slices reskinned this frame; the rest kept their vertices.
+    private func refitDynamicBLAS(slices: [RTGeometrySlice],
+                                  skinned: [Bool],
+                                  buffers: RTGeometryBuffers,
+                                  commandBuffer: MTLCommandBuffer) {
+        let refitIndices = slices.indices.filter { $0 < skinned.count && skinned[$0] && $0 < cachedDynamicBLAS.count }
+        guard !refitIndices.isEmpty else { return }
+        let descs = refitIndices.map {
+            RTAccelerationBuilder.descriptor(slice: slices[$0],
+                                             vertexBuffer: buffers.dynamicVertexBuffer,
+                                             indexBuffer: buffers.dynamicIndexBuffer,
+                                             refit: true)
+        }
+        let sizes = descs.map { device.accelerationStructureSizes(descriptor: $0).refitScratchBufferSize }
+        guard let scratch = scratchPool.reserve(sizes, device: device),
+              let encoder = commandBuffer.makeAccelerationStructureCommandEncoder(profiler: profiler, scope: "RT Dynamic BLAS Refit") else {
+            return
+        }
+        for (i, desc) in descs.enumerated() {
+            let blas = cachedDynamicBLAS[refitIndices[i]]
+            encoder.refit(sourceAccelerationStructure: blas,
+                          descriptor: desc,
+                          destinationAccelerationStructure: blas,
+                          scratchBuffer: scratch.buffer,
+                          scratchBufferOffset: scratch.offsets[i],
+                          options: .vertexData)
+        }
+        encoder.endEncoding()
+    }
+
+    private static func descriptor(slice: RTGeometrySlice,
+                                   vertexBuffer: MTLBuffer,
+                                   indexBuffer: MTLBuffer,
+                                   refit: Bool) -> MTLPrimitiveAccelerationStructureDescriptor {
+        let geometry = MTLAccelerationStructureTriangleGeometryDescriptor()
+        geometry.vertexBuffer = vertexBuffer
+        geometry.vertexBufferOffset = slice.baseVertex * MemoryLayout<SIMD3<Float>>.stride
+        geometry.vertexStride = MemoryLayout<SIMD3<Float>>.stride
+        geometry.vertexFormat = .float3
+        geometry.indexBuffer = indexBuffer
+        geometry.indexBufferOffset = slice.baseIndex * MemoryLayout<UInt32>.stride
+        geometry.indexType = .uint32
+        geometry.triangleCount = slice.indexCount / 3
+        geometry.opaque = true
+
+        let desc = MTLPrimitiveAccelerationStructureDescriptor()
+        desc.geometryDescriptors = [geometry]
+        desc.usage = refit ? [.refit] : []
+        return desc
     }
 }
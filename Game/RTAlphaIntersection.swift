@@ -0,0 +1,70 @@
+//
+//  RTAlphaIntersection.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+/// The `rtAlphaFunctions` variant of raytraceKernel, linked with `rtAlphaIntersection`.
+/// Hits on non-opaque instances (`RTGeometryState.instanceNonOpaque`) run the function during
+/// traversal: alpha-tested holes are skipped, and shadow rays collect transmittance in one
+/// traversal rather than restarting per layer.
+final class RTAlphaIntersection {
+    let pipelineState: MTLComputePipelineState
+    private let functionHandle: MTLFunctionHandle
+    /// One table per frame slot: its buffers are rebound every frame.
+    private var tables: [MTLIntersectionFunctionTable?]
+
+    init?(device: MTLDevice) {
+        guard let library = device.makeDefaultLibrary(),
+              let alphaFunction = library.makeFunction(name: "rtAlphaIntersection") else {
+            print("Ray tracing alpha intersection function not found")
+            return nil
+        }
+        do {
+            let constants = MTLFunctionConstantValues()
+            var enabled = true
+            constants.setConstantValue(&enabled, type: .bool, index: FunctionConstantIndex.rtAlphaFunctions.rawValue)
+            let kernel = try library.makeFunction(name: "raytraceKernel", constantValues: constants)
+            let linked = MTLLinkedFunctions()
+            linked.functions = [alphaFunction]
+            let desc = MTLComputePipelineDescriptor()
+            desc.computeFunction = kernel
+            desc.linkedFunctions = linked
+            desc.label = "RayTraceAlphaFunctions"
+            self.pipelineState = try device.makeComputePipelineState(descriptor: desc, options: [], reflection: nil)
+        } catch {
+            print("Unable to compile alpha intersection pipeline state. Error info: \(error)")
+            return nil
+        }
+        guard let handle = pipelineState.functionHandle(function: alphaFunction) else { return nil }
+        self.functionHandle = handle
+        self.tables = Array(repeating: nil, count: maxBuffersInFlight)
+    }
+
+    /// Binds this slot's intersection function table, pointing it at `geometry` and its
+    /// material table; `rtFrameBuffer` supplies the texture count.
+    func bind(enc: MTLComputeCommandEncoder, geometry: RTGeometryBuffers, rtFrameBuffer: MTLBuffer, frameSlot: Int) {
+        let slot = frameSlot % tables.count
+        if tables[slot] == nil {
+            let desc = MTLIntersectionFunctionTableDescriptor()
+            desc.functionCount = 1
+            let table = pipelineState.makeIntersectionFunctionTable(descriptor: desc)
+            table?.setFunction(functionHandle, index: 0)
+            tables[slot] = table
+        }
+        guard let table = tables[slot] else { return }
+
+        table.setBuffer(geometry.instanceInfoBuffer, offset: 0, index: 0)
+        table.setBuffer(geometry.staticIndexBuffer, offset: 0, index: 1)
+        table.setBuffer(geometry.dynamicIndexBuffer, offset: 0, index: 2)
+        table.setBuffer(geometry.staticUVBuffer, offset: 0, index: 3)
+        table.setBuffer(geometry.dynamicUVBuffer, offset: 0, index: 4)
+        table.setBuffer(geometry.materialBuffer, offset: 0, index: 5)
+        table.setBuffer(geometry.textureTableBuffer, offset: 0, index: 6)
+        table.setBuffer(rtFrameBuffer, offset: 0, index: 7)
+        enc.setIntersectionFunctionTable(table, bufferIndex: BufferIndex.rtAlphaFunctions.rawValue)
+    }
+}
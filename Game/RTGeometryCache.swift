@@ -8,6 +8,7 @@
 import Metal
 import simd
 
+/// Static streams are private and compact (`RTVertexEncoding`); dynamic streams stay float.
 struct RTGeometryBuffers {
     let staticVertexBuffer: MTLBuffer
     let staticIndexBuffer: MTLBuffer
@@ -20,6 +21,11 @@ struct RTGeometryBuffers {
     let dynamicUVBuffer: MTLBuffer
     let dynamicNormalBuffer: MTLBuffer
     let dynamicTangentBuffer: MTLBuffer
+    /// `RTMaterialInfo` per material, indexed by `RTInstanceInfo.materialIndex`.
+    let materialBuffer: MTLBuffer
+    /// Bindless `RTTexture` table indexed by the material *TexIndex fields.
+    let textureTableBuffer: MTLBuffer
+    /// The textures referenced by `textureTableBuffer`, for residency.
     let textures: [MTLTexture]
 }
 
@@ -28,15 +34,25 @@ struct RTGeometrySlice {
     let baseIndex: Int
     let indexCount: Int
     let bufferIndex: UInt32
+    /// Index into `staticSlices` or `dynamicSlices` (per `bufferIndex`), i.e. the BLAS to use.
+    let sliceIndex: Int
+    /// Identifies a static mesh's residency in the arena (0 for dynamic slices); stable while
+    /// the ranges are, so BLAS can be kept across static set changes.
+    let geometryID: UInt64
 }
 
 struct RTGeometryState {
     let buffers: RTGeometryBuffers
     let instanceSlices: [RTGeometrySlice]
+    /// Per instance: the material can let rays through (blended or alpha-tested), so the
+    /// TLAS marks it non-opaque and alpha intersection functions resolve its hits.
+    let instanceNonOpaque: [Bool]
     let staticSlices: [RTGeometrySlice]
     let dynamicSlices: [RTGeometrySlice]
     let staticChanged: Bool
     let dynamicChanged: Bool
+    /// Per dynamic slice: reskinned this frame, so its BLAS needs a refit.
+    let dynamicSlicesSkinned: [Bool]
     let skinningJobs: [RTSkinningJob]
 }
 
@@ -47,47 +63,433 @@ struct RTSkinningJob {
     let sourceBoneIndices: MTLBuffer
     let sourceBoneWeights: MTLBuffer
     let paletteBuffer: MTLBuffer
+    let paletteOffset: Int
     let vertexCount: Int
     let dstBaseVertex: Int
+    let boneInfluences: Int
+}
+
+/// First-fit allocator over element ranges; released ranges coalesce with their neighbours.
+struct RTRangeAllocator {
+    private(set) var capacity: Int = 0
+    /// Free ranges sorted by start, never adjacent.
+    private var free: [Range<Int>] = []
+
+    mutating func allocate(_ count: Int) -> Range<Int>? {
+        guard count > 0 else { return 0..<0 }
+        for i in free.indices where free[i].count >= count {
+            let r = free[i]
+            let out = r.lowerBound..<(r.lowerBound + count)
+            if r.count == count {
+                free.remove(at: i)
+            } else {
+                free[i] = out.upperBound..<r.upperBound
+            }
+            return out
+        }
+        return nil
+    }
+
+    mutating func release(_ range: Range<Int>) {
+        guard !range.isEmpty else { return }
+        var i = 0
+        while i < free.count && free[i].lowerBound < range.lowerBound {
+            i += 1
+        }
+        var merged = range
+        if i > 0 && free[i - 1].upperBound == merged.lowerBound {
+            merged = free[i - 1].lowerBound..<merged.upperBound
+            free.remove(at: i - 1)
+            i -= 1
+        }
+        if i < free.count && free[i].lowerBound == merged.upperBound {
+            merged = merged.lowerBound..<free[i].upperBound
+            free.remove(at: i)
+        }
+        free.insert(merged, at: i)
+    }
+
+    mutating func grow(to newCapacity: Int) {
+        guard newCapacity > capacity else { return }
+        let old = capacity
+        capacity = newCapacity
+        release(old..<newCapacity)
+    }
+}
+
+/// Compact encodings for the static RT attribute streams; decoded in `RayTracing.metalinc`.
+enum RTVertexEncoding {
+    /// Two IEEE half floats, x in the low 16 bits.
+    static func half2(_ v: SIMD2<Float>) -> UInt32 {
+        UInt32(half(v.x)) | (UInt32(half(v.y)) << 16)
+    }
+
+    /// Octahedral unit vector as two snorm16 values (Metal's `unpack_snorm2x16_to_float`).
+    static func octNormal(_ n: SIMD3<Float>) -> UInt32 {
+        let e = octahedral(n)
+        return UInt32(UInt16(bitPattern: snorm16(e.x))) | (UInt32(UInt16(bitPattern: snorm16(e.y))) << 16)
+    }
+
+    /// Octahedral tangent as two unorm15 values, handedness (`w`) in the top bit.
+    static func octTangent(_ t: SIMD4<Float>) -> UInt32 {
+        let e = octahedral(SIMD3<Float>(t.x, t.y, t.z)) * 0.5 + 0.5
+        let x = UInt32((simd_clamp(e.x, 0, 1) * 32767).rounded())
+        let y = UInt32((simd_clamp(e.y, 0, 1) * 32767).rounded())
+        return x | (y << 15) | (t.w < 0 ? 0x8000_0000 : 0)
+    }
+
+    private static func octahedral(_ v: SIMD3<Float>) -> SIMD2<Float> {
+        let len = abs(v.x) + abs(v.y) + abs(v.z)
+        guard len > 0 else { return SIMD2<Float>(0, 1) }
+        let p = SIMD3<Float>(v.x, v.y, v.z) / len
+        if p.z >= 0 {
+            return SIMD2<Float>(p.x, p.y)
+        }
+        return SIMD2<Float>((1 - abs(p.y)) * (p.x >= 0 ? 1 : -1),
+                            (1 - abs(p.x)) * (p.y >= 0 ? 1 : -1))
+    }
+
+    private static func snorm16(_ f: Float) -> Int16 {
+        Int16((simd_clamp(f, -1, 1) * 32767).rounded())
+    }
+
+    /// Round-to-nearest float to half conversion; `Float16` is unavailable on x86_64 macOS.
+    static func half(_ f: Float) -> UInt16 {
+        let bits = f.bitPattern
+        let sign = UInt16((bits >> 16) & 0x8000)
+        let exponent = Int((bits >> 23) & 0xFF)
+        let mantissa = bits & 0x7F_FFFF
+        if exponent == 0xFF {
+            return sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0)
+        }
+        let e = exponent - 127 + 15
+        if e >= 0x1F {
+            return sign | 0x7C00
+        }
+        if e <= 0 {
+            guard e >= -10 else { return sign }
+            let m = mantissa | 0x80_0000
+            let shift = UInt32(14 - e)
+            var half = m >> shift
+            let rest = m & ((1 << shift) - 1)
+            let halfway = UInt32(1) << (shift - 1)
+            if rest > halfway || (rest == halfway && (half & 1) != 0) {
+                half += 1
+            }
+            return sign | UInt16(half)
+        }
+        var half = (UInt32(e) << 10) | (mantissa >> 13)
+        let rest = mantissa & 0x1FFF
+        if rest > 0x1000 || (rest == 0x1000 && (half & 1) != 0) {
+            half += 1
+        }
+        return sign | UInt16(half)
+    }
+}
+
+/// Persistent static RT geometry: one set of private attribute and index buffers,
+/// sub-allocated per mesh. A mesh is converted into a shared staging buffer on first use and
+/// blitted into place by `encodeUploads`; its ranges go back to the free list only after it
+/// has been unused for `maxBuffersInFlight` frames, so frames still on the GPU never see
+/// them rewritten.
+private final class RTStaticGeometryArena {
+    struct Entry {
+        /// Retained so `ObjectIdentifier(mesh)` cannot be reused by another mesh.
+        let mesh: GPUMesh
+        let vertices: Range<Int>
+        let indices: Range<Int>
+        let id: UInt64
+        var lastUsedFrame: UInt64
+    }
+
+    private enum Stream: Int, CaseIterable {
+        case position, uv, normal, tangent, index
+
+        var stride: Int {
+            switch self {
+            case .position: return MemoryLayout<SIMD3<Float>>.stride
+            case .uv, .normal, .tangent, .index: return MemoryLayout<UInt32>.stride
+            }
+        }
+
+        var label: String {
+            switch self {
+            case .position: return "RTStaticVertices"
+            case .uv: return "RTStaticUVs"
+            case .normal: return "RTStaticNormals"
+            case .tangent: return "RTStaticTangents"
+            case .index: return "RTStaticIndices"
+            }
+        }
+    }
+
+    /// Old contents to carry into a stream's current buffer after it grew.
+    private struct PendingGrowth {
+        let source: MTLBuffer
+        let length: Int
+    }
+
+    private static let minimumVertexCapacity = 1 << 16
+    private static let minimumIndexCapacity = 1 << 18
+
+    private let device: MTLDevice
+    private var buffers: [MTLBuffer?] = Array(repeating: nil, count: Stream.allCases.count)
+    private var growths: [PendingGrowth?] = Array(repeating: nil, count: Stream.allCases.count)
+    private var vertexAllocator = RTRangeAllocator()
+    private var indexAllocator = RTRangeAllocator()
+    private var entries: [ObjectIdentifier: Entry] = [:]
+    private var pendingUploads: [Entry] = []
+    private var nextID: UInt64 = 1
+
+    var vertexBuffer: MTLBuffer? { buffers[Stream.position.rawValue] }
+    var uvBuffer: MTLBuffer? { buffers[Stream.uv.rawValue] }
+    var normalBuffer: MTLBuffer? { buffers[Stream.normal.rawValue] }
+    var tangentBuffer: MTLBuffer? { buffers[Stream.tangent.rawValue] }
+    var indexBuffer: MTLBuffer? { buffers[Stream.index.rawValue] }
+
+    init(device: MTLDevice) {
+        self.device = device
+    }
+
+    /// Returns the mesh's ranges, queueing an upload first if it is not resident.
+    func acquire(_ mesh: GPUMesh, frame: UInt64) -> Entry? {
+        let key = ObjectIdentifier(mesh)
+        if var entry = entries[key] {
+            entry.lastUsedFrame = frame
+            entries[key] = entry
+            return entry
+        }
+
+        let vertexCount = mesh.vertexCount
+        let indexCount = mesh.indexCount
+        guard let vertices = allocateVertices(vertexCount) else { return nil }
+        guard let indices = allocateIndices(indexCount) else {
+            vertexAllocator.release(vertices)
+            return nil
+        }
+        let entry = Entry(mesh: mesh, vertices: vertices, indices: indices, id: nextID, lastUsedFrame: frame)
+        nextID &+= 1
+        entries[key] = entry
+        pendingUploads.append(entry)
+        return entry
+    }
+
+    /// Creates the buffers at their minimum size so an arena with no meshes still binds.
+    func reserveMinimum() -> Bool {
+        if vertexBuffer == nil && !growVertices(to: RTStaticGeometryArena.minimumVertexCapacity) {
+            return false
+        }
+        if indexBuffer == nil && !growIndices(to: RTStaticGeometryArena.minimumIndexCapacity) {
+            return false
+        }
+        return true
+    }
+
+    /// Frees meshes no in-flight frame can still reference.
+    func releaseUnused(frame: UInt64) {
+        let horizon = UInt64(maxBuffersInFlight)
+        for (key, entry) in entries where frame &- entry.lastUsedFrame > horizon {
+            vertexAllocator.release(entry.vertices)
+            indexAllocator.release(entry.indices)
+            entries[key] = nil
+        }
+    }
+
+    /// Copies grown buffers' old contents, then blits queued meshes from one staging buffer.
+    /// Must be encoded before anything in `commandBuffer` reads the static streams.
+    func encodeUploads(commandBuffer: MTLCommandBuffer) {
+        if growths.contains(where: { $0 != nil }), let blit = commandBuffer.makeBlitCommandEncoder() {
+            blit.label = "RTStaticGrow"
+            for stream in Stream.allCases {
+                guard let growth = growths[stream.rawValue], let dst = buffers[stream.rawValue] else { continue }
+                blit.copy(from: growth.source, sourceOffset: 0,
+                          to: dst, destinationOffset: 0,
+                          size: growth.length)
+            }
+            blit.endEncoding()
+        }
+        growths = Array(repeating: nil, count: Stream.allCases.count)
+
+        guard !pendingUploads.isEmpty else { return }
+        defer { pendingUploads.removeAll(keepingCapacity: true) }
+        let vertexBytes = Stream.position.stride + Stream.uv.stride + Stream.normal.stride + Stream.tangent.stride
+        var stagingBytes = 0
+        for entry in pendingUploads {
+            stagingBytes += entry.vertices.count * vertexBytes + entry.indices.count * Stream.index.stride
+        }
+        guard stagingBytes > 0,
+              let staging = device.makeBuffer(length: stagingBytes, options: [.storageModeShared]),
+              let blit = commandBuffer.makeBlitCommandEncoder() else {
+            return
+        }
+        staging.label = "RTStaticStaging"
+        blit.label = "RTStaticUpload"
+
+        var offset = 0
+        for entry in pendingUploads {
+            offset = stage(entry, into: staging, at: offset, blit: blit)
+        }
+        blit.endEncoding()
+    }
+
+    /// Converts one mesh into `staging` at `offset` and encodes its copies; returns the next offset.
+    private func stage(_ entry: Entry, into staging: MTLBuffer, at offset: Int, blit: MTLBlitCommandEncoder) -> Int {
+        let mesh = entry.mesh
+        let vCount = entry.vertices.count
+        let iCount = entry.indices.count
+        var cursor = offset
+        var streamOffsets: [Int] = []
+        for stream in Stream.allCases {
+            streamOffsets.append(cursor)
+            cursor += (stream == .index ? iCount : vCount) * stream.stride
+        }
+
+        let base = staging.contents()
+        if vCount > 0 {
+            let src = mesh.vertexBuffer.contents().bindMemory(to: VertexPNUT.self, capacity: vCount)
+            let positions = (base + streamOffsets[Stream.position.rawValue]).bindMemory(to: SIMD3<Float>.self, capacity: vCount)
+            let uvs = (base + streamOffsets[Stream.uv.rawValue]).bindMemory(to: UInt32.self, capacity: vCount)
+            let normals = (base + streamOffsets[Stream.normal.rawValue]).bindMemory(to: UInt32.self, capacity: vCount)
+            let tangents = (base + streamOffsets[Stream.tangent.rawValue]).bindMemory(to: UInt32.self, capacity: vCount)
+            for i in 0..<vCount {
+                let v = src[i]
+                positions[i] = v.position
+                uvs[i] = RTVertexEncoding.half2(v.uv)
+                normals[i] = RTVertexEncoding.octNormal(v.normal)
+                tangents[i] = RTVertexEncoding.octTangent(v.tangent)
+            }
+        }
+        if iCount > 0 {
+            let dst = (base + streamOffsets[Stream.index.rawValue]).bindMemory(to: UInt32.self, capacity: iCount)
+            switch mesh.indexType {
+            case .uint16:
+                let iPtr = mesh.indexBuffer.contents().bindMemory(to: UInt16.self, capacity: iCount)
+                for i in 0..<iCount {
+                    dst[i] = UInt32(iPtr[i])
+                }
+            case .uint32:
+                memcpy(dst, mesh.indexBuffer.contents(), iCount * MemoryLayout<UInt32>.stride)
+            @unknown default:
+                break
+            }
+        }
+
+        for stream in Stream.allCases {
+            let range = stream == .index ? entry.indices : entry.vertices
+            guard !range.isEmpty, let dst = buffers[stream.rawValue] else { continue }
+            blit.copy(from: staging, sourceOffset: streamOffsets[stream.rawValue],
+                      to: dst, destinationOffset: range.lowerBound * stream.stride,
+                      size: range.count * stream.stride)
+        }
+        return cursor
+    }
+
+    private func allocateVertices(_ count: Int) -> Range<Int>? {
+        if let range = vertexAllocator.allocate(count) {
+            return range
+        }
+        let capacity = RTStaticGeometryArena.grownCapacity(vertexAllocator.capacity,
+                                                           needed: count,
+                                                           minimum: RTStaticGeometryArena.minimumVertexCapacity)
+        guard growVertices(to: capacity) else { return nil }
+        return vertexAllocator.allocate(count)
+    }
+
+    private func growVertices(to capacity: Int) -> Bool {
+        let streams: [Stream] = [.position, .uv, .normal, .tangent]
+        var created: [MTLBuffer] = []
+        for stream in streams {
+            guard let buffer = makeBuffer(stream, elements: capacity) else { return false }
+            created.append(buffer)
+        }
+        for (stream, buffer) in zip(streams, created) {
+            replace(stream, with: buffer)
+        }
+        vertexAllocator.grow(to: capacity)
+        return true
+    }
+
+    private func allocateIndices(_ count: Int) -> Range<Int>? {
+        if let range = indexAllocator.allocate(count) {
+            return range
+        }
+        let capacity = RTStaticGeometryArena.grownCapacity(indexAllocator.capacity,
+                                                           needed: count,
+                                                           minimum: RTStaticGeometryArena.minimumIndexCapacity)
+        guard growIndices(to: capacity) else { return nil }
+        return indexAllocator.allocate(count)
+    }
+
+    private func growIndices(to capacity: Int) -> Bool {
+        guard let buffer = makeBuffer(.index, elements: capacity) else { return false }
+        replace(.index, with: buffer)
+        indexAllocator.grow(to: capacity)
+        return true
+    }
+
+    /// Doubling growth. The tail free range may be short of `needed`, so grow past it in full.
+    private static func grownCapacity(_ capacity: Int, needed: Int, minimum: Int) -> Int {
+        max(capacity * 2, capacity + needed, minimum)
+    }
+
+    private func makeBuffer(_ stream: Stream, elements: Int) -> MTLBuffer? {
+        let buffer = device.makeBuffer(length: max(elements * stream.stride, 1), options: [.storageModePrivate])
+        buffer?.label = stream.label
+        return buffer
+    }
+
+    /// Frames already encoded keep the old buffer alive, and no slice moves, so only the
+    /// binding changes. A stream that grows twice before `encodeUploads` still copies from
+    /// the buffer the GPU last saw; queued uploads target whichever buffer is current.
+    private func replace(_ stream: Stream, with buffer: MTLBuffer) {
+        let i = stream.rawValue
+        if growths[i] == nil, let old = buffers[i] {
+            growths[i] = PendingGrowth(source: old, length: old.length)
+        }
+        buffers[i] = buffer
+    }
 }
 
 final class RTGeometryCache {
     private let device: MTLDevice
 
-    private var staticVertexBuffer: MTLBuffer?
-    private var staticIndexBuffer: MTLBuffer?
-    private var staticUVBuffer: MTLBuffer?
-    private var staticNormalBuffer: MTLBuffer?
-    private var staticTangentBuffer: MTLBuffer?
+    private let staticArena: RTStaticGeometryArena
+    private let materialTable: RTMaterialTable
+    private var frame: UInt64 = 0
     private var dynamicVertexBuffer: MTLBuffer?
     private var dynamicIndexBuffer: MTLBuffer?
     private var dynamicUVBuffer: MTLBuffer?
     private var dynamicNormalBuffer: MTLBuffer?
     private var dynamicTangentBuffer: MTLBuffer?
-    private var geometryInstanceInfoBuffer: MTLBuffer?
+    /// CPU-written every frame, so one copy per frame slot.
+    private var instanceInfoBuffers = FrameSlotBuffers(label: "RTInstanceInfo")
+    private var paletteBuffers = FrameSlotBuffers(label: "RTSkinningPalette")
     private var dynamicVertexCapacity: Int = 0
     private var dynamicIndexCapacity: Int = 0
     private var dynamicUVCapacity: Int = 0
     private var dynamicNormalCapacity: Int = 0
     private var dynamicTangentCapacity: Int = 0
-    private var instanceInfoCapacity: Int = 0
     private var dynamicVertexIsPrivate: Bool = false
     private var skinnedSources: [SkinnedSourceKey: SkinnedSource] = [:]
 
     private var cachedStaticSlices: [RTGeometrySlice] = []
     private var cachedDynamicSlices: [RTGeometrySlice] = []
-    private var cachedStaticKey: [StaticKey] = []
+    /// Resident static meshes in slice order; a change means the static BLAS set changed.
+    private var cachedStaticKey: [ObjectIdentifier] = []
     private var cachedDynamicKey: [DynamicKey] = []
+    /// Slice of each resident static mesh in `cachedStaticKey`.
+    private var sliceIndexForMesh: [ObjectIdentifier: Int] = [:]
+    /// `RenderItemChanges.structureVersion` the keys were last built from; nil after a
+    /// failed build or when the caller passed no change set.
+    private var keyedStructureVersion: UInt64?
+    /// What each dynamic slice was last skinned from; equal keys skip the reskin and refit.
+    private var skinnedKeys: [SkinKey?] = []
+    private var skinnedOutputs: [MTLBuffer] = []
 
     init(device: MTLDevice) {
         self.device = device
-    }
-
-    private struct StaticKey: Equatable {
-        let meshID: ObjectIdentifier
-        let vertexBytes: Int
-        let indexCount: Int
-        let indexType: MTLIndexType
+        self.staticArena = RTStaticGeometryArena(device: device)
+        self.materialTable = RTMaterialTable(device: device)
     }
 
     private struct DynamicKey: Equatable {
@@ -95,6 +497,12 @@ final class RTGeometryCache {
         let indexCount: Int
     }
 
+    private struct SkinKey: Equatable {
+        let paletteID: UInt32
+        let revision: UInt32
+        let boneInfluences: Int
+    }
+
     private struct SkinnedSourceKey: Hashable {
         let vertexPtr: UInt
         let vertexCount: Int
@@ -110,7 +518,10 @@ final class RTGeometryCache {
         let vertexCount: Int
     }
 
-    func build(items: [RenderItem]) -> RTGeometryState? {
+    func build(items: [RenderItem],
+               changes: RenderItemChanges?,
+               frameSlot: Int,
+               commandBuffer: MTLCommandBuffer) -> RTGeometryState? {
         guard !items.isEmpty else { return nil }
 
         var dynamicVertices: [SIMD3<Float>] = []
@@ -119,121 +530,83 @@ final class RTGeometryCache {
         var dynamicTangents: [SIMD4<Float>] = []
         var dynamicIndices: [UInt32] = []
         var skinningJobs: [RTSkinningJob] = []
+        var pendingSkins: [(sliceIndex: Int, key: SkinKey, job: RTSkinningJob)] = []
         var instances: [RTInstanceInfoSwift] = []
-        var textureIndexForTexture: [ObjectIdentifier: Int] = [:]
-        var texturesByIndex: [MTLTexture] = []
 
         dynamicVertices.reserveCapacity(items.count * 128)
         dynamicIndices.reserveCapacity(items.count * 128)
         instances.reserveCapacity(items.count)
 
-        let staticKey = items.compactMap { item -> StaticKey? in
-            guard let mesh = item.mesh, item.skinnedMesh == nil else { return nil }
-            return StaticKey(meshID: ObjectIdentifier(mesh),
-                             vertexBytes: mesh.vertexBuffer.length,
-                             indexCount: mesh.indexCount,
-                             indexType: mesh.indexType)
-        }
-
-        let staticChanged = staticKey != cachedStaticKey
-            || staticVertexBuffer == nil
-            || staticIndexBuffer == nil
-            || staticUVBuffer == nil
-            || staticNormalBuffer == nil
-            || staticTangentBuffer == nil
-
-        if staticChanged {
-            cachedStaticKey = staticKey
-            cachedStaticSlices.removeAll(keepingCapacity: true)
-
-            var staticVertices: [SIMD3<Float>] = []
-            var staticUVs: [SIMD2<Float>] = []
-            var staticNormals: [SIMD3<Float>] = []
-            var staticTangents: [SIMD4<Float>] = []
-            var staticIndices: [UInt32] = []
-
-            staticVertices.reserveCapacity(staticKey.count * 256)
-            staticIndices.reserveCapacity(staticKey.count * 256)
-
+        // A change set whose structure version matches the one the keys below were built
+        // from means the same meshes and skinned layouts in the same order: skip acquiring
+        // and keying. `frame` does not advance then, so residency only ages across structure
+        // changes and nothing an in-flight frame reads is released early.
+        let keyedVersion = keyedStructureVersion
+        keyedStructureVersion = nil
+        let structureUnchanged = changes != nil && changes?.structureVersion == keyedVersion
+
+        // Static meshes live in the persistent arena: only meshes not yet resident are
+        // uploaded, and each distinct mesh gets one slice (and one BLAS) however many
+        // items draw it.
+        guard staticArena.reserveMinimum() else { return nil }
+        var staticChanged = false
+        if !structureUnchanged {
+            frame &+= 1
+            var staticEntries: [ObjectIdentifier: RTStaticGeometryArena.Entry] = [:]
+            var staticResident = true
             for item in items {
-                guard let mesh = item.mesh, item.skinnedMesh == nil else { continue }
-                let baseVertex = UInt32(staticVertices.count)
-                let baseIndex = UInt32(staticIndices.count)
-
-                let vCount = mesh.vertexBuffer.length / MemoryLayout<VertexPNUT>.stride
-                let vPtr = mesh.vertexBuffer.contents().bindMemory(to: VertexPNUT.self,
-                                                                   capacity: vCount)
-                for i in 0..<vCount {
-                    let v = vPtr[i]
-                    staticVertices.append(v.position)
-                    staticUVs.append(v.uv)
-                    staticNormals.append(v.normal)
-                    staticTangents.append(v.tangent)
-                }
-
-                let indexCount = mesh.indexCount
-                switch mesh.indexType {
-                case .uint16:
-                    let iPtr = mesh.indexBuffer.contents().bindMemory(to: UInt16.self,
-                                                                      capacity: indexCount)
-                    for i in 0..<indexCount {
-                        staticIndices.append(UInt32(iPtr[i]))
-                    }
-                case .uint32:
-                    let iPtr = mesh.indexBuffer.contents().bindMemory(to: UInt32.self,
-                                                                      capacity: indexCount)
-                    for i in 0..<indexCount {
-                        staticIndices.append(iPtr[i])
-                    }
-                @unknown default:
+                // Same split as the per-item loop below: skinned items without a palette draw static.
+                guard let mesh = item.mesh, item.skinnedMesh == nil || item.skinningPalette == nil else { continue }
+                let key = ObjectIdentifier(mesh)
+                if staticEntries[key] != nil { continue }
+                guard let entry = staticArena.acquire(mesh, frame: frame) else {
+                    staticResident = false
                     break
                 }
-
-                cachedStaticSlices.append(RTGeometrySlice(baseVertex: Int(baseVertex),
-                                                          baseIndex: Int(baseIndex),
-                                                          indexCount: indexCount,
-                                                          bufferIndex: 0))
+                staticEntries[key] = entry
+            }
+            staticArena.encodeUploads(commandBuffer: commandBuffer)
+            staticArena.releaseUnused(frame: frame)
+            guard staticResident else { return nil }
+
+            let residentOrder = staticEntries.sorted { $0.value.vertices.lowerBound < $1.value.vertices.lowerBound }
+            let staticKey = residentOrder.map { $0.key }
+            staticChanged = staticKey != cachedStaticKey
+            if staticChanged {
+                cachedStaticKey = staticKey
+                cachedStaticSlices.removeAll(keepingCapacity: true)
+                for (i, resident) in residentOrder.enumerated() {
+                    let entry = resident.value
+                    cachedStaticSlices.append(RTGeometrySlice(baseVertex: entry.vertices.lowerBound,
+                                                              baseIndex: entry.indices.lowerBound,
+                                                              indexCount: entry.indices.count,
+                                                              bufferIndex: 0,
+                                                              sliceIndex: i,
+                                                              geometryID: entry.id))
+                }
+            }
+            sliceIndexForMesh.removeAll(keepingCapacity: true)
+            for (i, key) in staticKey.enumerated() {
+                sliceIndexForMesh[key] = i
             }
-
-            let vBytes = staticVertices.count * MemoryLayout<SIMD3<Float>>.stride
-            let uvBytes = staticUVs.count * MemoryLayout<SIMD2<Float>>.stride
-            let nBytes = staticNormals.count * MemoryLayout<SIMD3<Float>>.stride
-            let tBytes = staticTangents.count * MemoryLayout<SIMD4<Float>>.stride
-            let iBytes = staticIndices.count * MemoryLayout<UInt32>.stride
-            staticVertexBuffer = device.makeBuffer(bytes: staticVertices,
-                                                   length: max(vBytes, 1),
-                                                   options: [.storageModeShared])
-            staticUVBuffer = device.makeBuffer(bytes: staticUVs,
-                                               length: max(uvBytes, 1),
-                                               options: [.storageModeShared])
-            staticNormalBuffer = device.makeBuffer(bytes: staticNormals,
-                                                   length: max(nBytes, 1),
-                                                   options: [.storageModeShared])
-            staticTangentBuffer = device.makeBuffer(bytes: staticTangents,
-                                                    length: max(tBytes, 1),
-                                                    options: [.storageModeShared])
-            staticIndexBuffer = device.makeBuffer(bytes: staticIndices,
-                                                  length: max(iBytes, 1),
-                                                  options: [.storageModeShared])
-            staticVertexBuffer?.label = "RTStaticVertices"
-            staticUVBuffer?.label = "RTStaticUVs"
-            staticNormalBuffer?.label = "RTStaticNormals"
-            staticTangentBuffer?.label = "RTStaticTangents"
-            staticIndexBuffer?.label = "RTStaticIndices"
         }
 
         var instanceSlices: [RTGeometrySlice] = []
         instanceSlices.reserveCapacity(items.count)
-        var staticSliceIndex = 0
-        var dynamicKey: [DynamicKey] = []
-        dynamicKey.reserveCapacity(items.count)
-        for item in items {
-            if let skinned = item.skinnedMesh {
-                dynamicKey.append(DynamicKey(vertexCount: skinned.streams.vertexCount,
-                                             indexCount: skinned.indexCount))
+        var instanceNonOpaque: [Bool] = []
+        instanceNonOpaque.reserveCapacity(items.count)
+        var dynamicKey = cachedDynamicKey
+        if !structureUnchanged {
+            dynamicKey.removeAll(keepingCapacity: true)
+            dynamicKey.reserveCapacity(items.count)
+            for item in items {
+                if let skinned = item.skinnedMesh {
+                    dynamicKey.append(DynamicKey(vertexCount: skinned.streams.vertexCount,
+                                                 indexCount: skinned.indexCount))
+                }
             }
         }
-        let dynamicChanged = dynamicKey != cachedDynamicKey
+        let dynamicChanged = (!structureUnchanged && dynamicKey != cachedDynamicKey)
             || dynamicVertexBuffer == nil
             || dynamicIndexBuffer == nil
             || dynamicUVBuffer == nil
@@ -242,26 +615,37 @@ final class RTGeometryCache {
         var dynamicSlices: [RTGeometrySlice] = dynamicChanged ? [] : cachedDynamicSlices
         var dynamicSliceIndex = 0
 
-        func registerTexture(_ tex: MTLTexture?) -> UInt32 {
-            guard let tex else { return UInt32.max }
-            let key = ObjectIdentifier(tex)
-            if let existing = textureIndexForTexture[key] {
-                return UInt32(existing)
-            }
-            if texturesByIndex.count >= maxRTTextures {
-                return UInt32.max
+        // One palette per id (the parts of a skinned group share theirs), resolved straight
+        // into this slot's palette buffer.
+        let paletteAlignment = 256
+        var paletteBytes = 0
+        var paletteOffsets: [UInt32: Int] = [:]
+        var palettes: [SkinningPalette] = []
+        for item in items where item.skinnedMesh != nil {
+            guard let palette = item.skinningPalette, paletteOffsets[palette.id] == nil else { continue }
+            paletteOffsets[palette.id] = paletteBytes
+            palettes.append(palette)
+            paletteBytes += RTGeometryCache.aligned(palette.count * MemoryLayout<matrix_float4x4>.stride,
+                                                    to: paletteAlignment)
+        }
+        let paletteBuffer = paletteBytes > 0
+            ? paletteBuffers.buffer(slot: frameSlot, length: paletteBytes, device: device)
+            : nil
+        if let paletteBuffer {
+            for palette in palettes {
+                palette.write(to: paletteBuffer.contents() + paletteOffsets[palette.id]!)
             }
-            let index = texturesByIndex.count
-            texturesByIndex.append(tex)
-            textureIndexForTexture[key] = index
-            return UInt32(index)
         }
 
+        materialTable.beginBuild()
+
         for item in items {
             var baseVertex: UInt32 = 0
             var baseIndex: UInt32 = 0
             var indexCount = 0
             var bufferIndex: UInt32 = 0
+            var sliceIndex = 0
+            var geometryID: UInt64 = 0
 
             if let skinned = item.skinnedMesh, let palette = item.skinningPalette {
                 let vCount = skinned.streams.vertexCount
@@ -294,10 +678,13 @@ final class RTGeometryCache {
                         dynamicIndices.append(contentsOf: i32)
                     }
                     bufferIndex = 1
+                    sliceIndex = dynamicSlices.count
                     dynamicSlices.append(RTGeometrySlice(baseVertex: Int(baseVertex),
                                                          baseIndex: Int(baseIndex),
                                                          indexCount: indexCount,
-                                                         bufferIndex: bufferIndex))
+                                                         bufferIndex: bufferIndex,
+                                                         sliceIndex: sliceIndex,
+                                                         geometryID: 0))
                 } else {
                     if dynamicSliceIndex >= cachedDynamicSlices.count { return nil }
                     let slice = cachedDynamicSlices[dynamicSliceIndex]
@@ -306,17 +693,27 @@ final class RTGeometryCache {
                     baseIndex = UInt32(slice.baseIndex)
                     indexCount = slice.indexCount
                     bufferIndex = slice.bufferIndex
+                    sliceIndex = slice.sliceIndex
                 }
 
-                if let job = makeSkinningJob(skinned: skinned,
-                                             palette: palette,
-                                             dstBaseVertex: Int(baseVertex)) {
-                    skinningJobs.append(job)
+                if let paletteBuffer,
+                   let paletteOffset = paletteOffsets[palette.id],
+                   let job = makeSkinningJob(skinned: skinned,
+                                             paletteBuffer: paletteBuffer,
+                                             paletteOffset: paletteOffset,
+                                             dstBaseVertex: Int(baseVertex),
+                                             boneInfluences: palette.boneInfluences) {
+                    let key = SkinKey(paletteID: palette.id,
+                                      revision: palette.revision,
+                                      boneInfluences: palette.boneInfluences)
+                    pendingSkins.append((sliceIndex, key, job))
                 }
-            } else if item.mesh != nil {
-                if staticSliceIndex >= cachedStaticSlices.count { return nil }
-                let slice = cachedStaticSlices[staticSliceIndex]
-                staticSliceIndex += 1
+            } else if let mesh = item.mesh {
+                guard let index = sliceIndexForMesh[ObjectIdentifier(mesh)],
+                      index < cachedStaticSlices.count else { return nil }
+                let slice = cachedStaticSlices[index]
+                sliceIndex = index
+                geometryID = slice.geometryID
                 baseVertex = UInt32(slice.baseVertex)
                 baseIndex = UInt32(slice.baseIndex)
                 indexCount = slice.indexCount
@@ -325,38 +722,21 @@ final class RTGeometryCache {
                 continue
             }
 
-            let baseTexIndex = registerTexture(item.material.baseColorTexture?.texture)
-            let normalTexIndex = registerTexture(item.material.normalTexture?.texture)
-            let mrTexIndex = registerTexture(item.material.metallicRoughnessTexture?.texture)
-            let emissiveTexIndex = registerTexture(item.material.emissiveTexture?.texture)
-            let occlusionTexIndex = registerTexture(item.material.occlusionTexture?.texture)
-
             instances.append(RTInstanceInfoSwift(baseIndex: baseIndex,
                                                  baseVertex: baseVertex,
                                                  indexCount: UInt32(indexCount),
                                                  bufferIndex: bufferIndex,
                                                  modelMatrix: item.modelMatrix,
-                                                 baseColorFactor: item.material.baseColorFactor,
-                                                 metallicFactor: item.material.metallicFactor,
-                                                 emissiveFactor: item.material.emissiveFactor,
-                                                 occlusionStrength: item.material.occlusionStrength,
-                                                 mrFactors: SIMD2<Float>(item.material.roughnessFactor,
-                                                                        item.material.alpha),
-                                                 transmissionFactor: item.material.transmissionFactor,
-                                                 ior: item.material.ior,
-                                                 normalScale: item.material.normalScale,
-                                                 pad2: .zero,
-                                                 baseColorTexIndex: baseTexIndex,
-                                                 normalTexIndex: normalTexIndex,
-                                                 metallicRoughnessTexIndex: mrTexIndex,
-                                                 emissiveTexIndex: emissiveTexIndex,
-                                                 occlusionTexIndex: occlusionTexIndex,
-                                                 padding1: .zero))
+                                                 materialIndex: materialTable.materialIndex(for: item.material),
+                                                 pad0: .zero))
 
+            instanceNonOpaque.append(item.material.alphaCutoff > 0 || item.material.alpha < 0.999)
             instanceSlices.append(RTGeometrySlice(baseVertex: Int(baseVertex),
                                                   baseIndex: Int(baseIndex),
                                                   indexCount: indexCount,
-                                                  bufferIndex: bufferIndex))
+                                                  bufferIndex: bufferIndex,
+                                                  sliceIndex: sliceIndex,
+                                                  geometryID: geometryID))
         }
 
         cachedDynamicKey = dynamicKey
@@ -371,9 +751,13 @@ final class RTGeometryCache {
         let iBytes = dynamicIndices.count * MemoryLayout<UInt32>.stride
         let instBytes = instances.count * MemoryLayout<RTInstanceInfoSwift>.stride
 
-        let useGPUSkinning = !skinningJobs.isEmpty
+        let useGPUSkinning = !pendingSkins.isEmpty
+        // Shared dynamic streams are rewritten only when the layout changes; write those into
+        // fresh buffers so frames still in flight keep reading the old ones.
+        let rewriteShared = dynamicChanged && !useGPUSkinning
         if dynamicVertexBuffer == nil
             || vBytes > dynamicVertexCapacity
+            || rewriteShared
             || (dynamicVertexIsPrivate && !useGPUSkinning)
             || (!dynamicVertexIsPrivate && useGPUSkinning) {
             dynamicVertexCapacity = max(vBytes, 1)
@@ -383,7 +767,7 @@ final class RTGeometryCache {
             dynamicVertexBuffer?.label = "RTDynamicVertices"
             dynamicVertexIsPrivate = useGPUSkinning
         }
-        if dynamicUVBuffer == nil || uvBytes > dynamicUVCapacity {
+        if dynamicUVBuffer == nil || uvBytes > dynamicUVCapacity || dynamicChanged {
             dynamicUVCapacity = max(uvBytes, 1)
             dynamicUVBuffer = device.makeBuffer(length: dynamicUVCapacity,
                                                 options: [.storageModeShared])
@@ -391,6 +775,7 @@ final class RTGeometryCache {
         }
         if dynamicNormalBuffer == nil
             || nBytes > dynamicNormalCapacity
+            || rewriteShared
             || (dynamicVertexIsPrivate && !useGPUSkinning)
             || (!dynamicVertexIsPrivate && useGPUSkinning) {
             dynamicNormalCapacity = max(nBytes, 1)
@@ -401,6 +786,7 @@ final class RTGeometryCache {
         }
         if dynamicTangentBuffer == nil
             || tBytes > dynamicTangentCapacity
+            || rewriteShared
             || (dynamicVertexIsPrivate && !useGPUSkinning)
             || (!dynamicVertexIsPrivate && useGPUSkinning) {
             dynamicTangentCapacity = max(tBytes, 1)
@@ -409,18 +795,13 @@ final class RTGeometryCache {
                                                      options: options)
             dynamicTangentBuffer?.label = "RTDynamicTangents"
         }
-        if dynamicIndexBuffer == nil || iBytes > dynamicIndexCapacity {
+        if dynamicIndexBuffer == nil || iBytes > dynamicIndexCapacity || dynamicChanged {
             dynamicIndexCapacity = max(iBytes, 1)
             dynamicIndexBuffer = device.makeBuffer(length: dynamicIndexCapacity,
                                                    options: [.storageModeShared])
             dynamicIndexBuffer?.label = "RTDynamicIndices"
         }
-        if geometryInstanceInfoBuffer == nil || instBytes > instanceInfoCapacity {
-            instanceInfoCapacity = max(instBytes, 1)
-            geometryInstanceInfoBuffer = device.makeBuffer(length: instanceInfoCapacity,
-                                                            options: [.storageModeShared])
-            geometryInstanceInfoBuffer?.label = "RTInstanceInfo"
-        }
+        let geometryInstanceInfoBuffer = instanceInfoBuffers.buffer(slot: frameSlot, length: instBytes, device: device)
 
         if dynamicChanged, let buf = dynamicVertexBuffer, !dynamicVertices.isEmpty, !useGPUSkinning {
             _ = dynamicVertices.withUnsafeBytes { raw in
@@ -453,20 +834,40 @@ final class RTGeometryCache {
             }
         }
 
-        guard let staticVB = staticVertexBuffer,
-              let staticUVB = staticUVBuffer,
-              let staticNB = staticNormalBuffer,
-              let staticTB = staticTangentBuffer,
-              let staticIB = staticIndexBuffer,
+        guard let staticVB = staticArena.vertexBuffer,
+              let staticUVB = staticArena.uvBuffer,
+              let staticNB = staticArena.normalBuffer,
+              let staticTB = staticArena.tangentBuffer,
+              let staticIB = staticArena.indexBuffer,
               let dynamicVB = dynamicVertexBuffer,
               let dynamicUVB = dynamicUVBuffer,
               let dynamicNB = dynamicNormalBuffer,
               let dynamicTB = dynamicTangentBuffer,
               let dynamicIB = dynamicIndexBuffer,
-              let instb = geometryInstanceInfoBuffer else {
+              let instb = geometryInstanceInfoBuffer,
+              materialTable.upload(),
+              let materialB = materialTable.materialBuffer,
+              let textureTableB = materialTable.textureBuffer else {
             return nil
         }
 
+        // Skinned output persists in the private dynamic buffers, so a slice whose pose and
+        // LOD are unchanged since its last skin keeps it; fresh buffers reskin everything.
+        let outputs = [dynamicVB, dynamicNB, dynamicTB]
+        let outputsReplaced = outputs.count != skinnedOutputs.count
+            || zip(outputs, skinnedOutputs).contains { $0 !== $1 }
+        if dynamicChanged || outputsReplaced || skinnedKeys.count != cachedDynamicSlices.count {
+            skinnedKeys = Array(repeating: nil, count: cachedDynamicSlices.count)
+            skinnedOutputs = outputs
+        }
+        var dynamicSlicesSkinned = Array(repeating: false, count: cachedDynamicSlices.count)
+        for pending in pendingSkins where pending.sliceIndex < skinnedKeys.count {
+            if skinnedKeys[pending.sliceIndex] == pending.key { continue }
+            skinnedKeys[pending.sliceIndex] = pending.key
+            dynamicSlicesSkinned[pending.sliceIndex] = true
+            skinningJobs.append(pending.job)
+        }
+
         let buffers = RTGeometryBuffers(staticVertexBuffer: staticVB,
                                         staticIndexBuffer: staticIB,
                                         instanceInfoBuffer: instb,
@@ -478,20 +879,31 @@ final class RTGeometryCache {
                                         dynamicUVBuffer: dynamicUVB,
                                         dynamicNormalBuffer: dynamicNB,
                                         dynamicTangentBuffer: dynamicTB,
-                                        textures: texturesByIndex)
+                                        materialBuffer: materialB,
+                                        textureTableBuffer: textureTableB,
+                                        textures: materialTable.textures)
 
+        keyedStructureVersion = changes?.structureVersion
         return RTGeometryState(buffers: buffers,
                                instanceSlices: instanceSlices,
+                               instanceNonOpaque: instanceNonOpaque,
                                staticSlices: cachedStaticSlices,
                                dynamicSlices: cachedDynamicSlices,
                                staticChanged: staticChanged,
                                dynamicChanged: dynamicChanged,
+                               dynamicSlicesSkinned: dynamicSlicesSkinned,
                                skinningJobs: skinningJobs)
     }
 
+    private static func aligned(_ bytes: Int, to alignment: Int) -> Int {
+        (bytes + alignment - 1) / alignment * alignment
+    }
+
     private func makeSkinningJob(skinned: SkinnedMeshDescriptor,
-                                 palette: [matrix_float4x4],
-                                 dstBaseVertex: Int) -> RTSkinningJob? {
+                                 paletteBuffer: MTLBuffer,
+                                 paletteOffset: Int,
+                                 dstBaseVertex: Int,
+                                 boneInfluences: Int) -> RTSkinningJob? {
         let vertexCount = skinned.streams.vertexCount
         let indexCount = skinned.indexCount
         guard vertexCount > 0 else { return nil }
@@ -553,25 +965,15 @@ final class RTGeometryCache {
             return created
         }()
 
-        let paletteBytes = palette.count * MemoryLayout<matrix_float4x4>.stride
-        guard let paletteBuffer = device.makeBuffer(length: max(paletteBytes, 1),
-                                                    options: [.storageModeShared]) else {
-            return nil
-        }
-        paletteBuffer.label = "RTSkinningPalette"
-        if paletteBytes > 0 {
-            _ = palette.withUnsafeBytes { raw in
-                memcpy(paletteBuffer.contents(), raw.baseAddress!, raw.count)
-            }
-        }
-
         return RTSkinningJob(sourcePositions: source.positions,
                              sourceNormals: source.normals,
                              sourceTangents: source.tangents,
                              sourceBoneIndices: source.boneIndices,
                              sourceBoneWeights: source.boneWeights,
                              paletteBuffer: paletteBuffer,
+                             paletteOffset: paletteOffset,
                              vertexCount: source.vertexCount,
-                             dstBaseVertex: dstBaseVertex)
+                             dstBaseVertex: dstBaseVertex,
+                             boneInfluences: boneInfluences)
     }
 }
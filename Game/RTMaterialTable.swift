@@ -0,0 +1,146 @@
+//
+//  RTMaterialTable.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+/// Material constants and bindless textures for the RT path. Each distinct material is
+/// written once into `materialBuffer` and each distinct texture's resource ID once into
+/// `textureBuffer` (an array of `RTTexture`); instances only carry a `materialIndex`.
+/// Both tables are append-only, so entries read by frames in flight are never rewritten:
+/// new entries go past the uploaded tail, growth and compaction switch to fresh buffers.
+final class RTMaterialTable {
+    private static let minCapacity = 64
+    /// `RTTexture` holds one texture handle.
+    private static let textureStride = MemoryLayout<MTLResourceID>.stride
+
+    private let device: MTLDevice
+    private var materials: [RTMaterialInfoSwift] = []
+    private var indexForMaterial: [RTMaterialInfoSwift: UInt32] = [:]
+    private(set) var textures: [MTLTexture] = []
+    private var indexForTexture: [ObjectIdentifier: UInt32] = [:]
+    private var uploadedMaterials = 0
+    private var uploadedTextures = 0
+    private var usedThisBuild = Set<UInt32>()
+
+    private(set) var materialBuffer: MTLBuffer?
+    private(set) var textureBuffer: MTLBuffer?
+
+    init(device: MTLDevice) {
+        self.device = device
+    }
+
+    var textureCount: Int { textures.count }
+
+    /// Starts a build. Tables mostly holding materials no longer drawn (e.g. animated
+    /// factors) are dropped and rebuilt from what this build registers.
+    func beginBuild() {
+        let live = usedThisBuild.count
+        if materials.count > RTMaterialTable.minCapacity && materials.count > live * 4 {
+            materials.removeAll(keepingCapacity: true)
+            indexForMaterial.removeAll(keepingCapacity: true)
+            textures.removeAll(keepingCapacity: true)
+            indexForTexture.removeAll(keepingCapacity: true)
+            uploadedMaterials = 0
+            uploadedTextures = 0
+            materialBuffer = nil
+            textureBuffer = nil
+        }
+        usedThisBuild.removeAll(keepingCapacity: true)
+    }
+
+    /// Table index of `material`, appending it (and any new textures) on first use.
+    func materialIndex(for material: Material) -> UInt32 {
+        let info = RTMaterialInfoSwift(baseColorFactor: material.baseColorFactor,
+                                       metallicFactor: material.metallicFactor,
+                                       emissiveFactor: material.emissiveFactor,
+                                       occlusionStrength: material.occlusionStrength,
+                                       mrFactors: SIMD2<Float>(material.roughnessFactor, material.alpha),
+                                       transmissionFactor: material.transmissionFactor,
+                                       ior: material.ior,
+                                       normalScale: material.normalScale,
+                                       alphaCutoff: material.alphaCutoff,
+                                       pad0: .zero,
+                                       baseColorTexIndex: textureIndex(material.baseColorTexture?.texture),
+                                       normalTexIndex: textureIndex(material.normalTexture?.texture),
+                                       metallicRoughnessTexIndex: textureIndex(material.metallicRoughnessTexture?.texture),
+                                       emissiveTexIndex: textureIndex(material.emissiveTexture?.texture),
+                                       occlusionTexIndex: textureIndex(material.occlusionTexture?.texture),
+                                       pad1: .zero)
+        let index: UInt32
+        if let existing = indexForMaterial[info] {
+            index = existing
+        } else {
+            index = UInt32(materials.count)
+            materials.append(info)
+            indexForMaterial[info] = index
+        }
+        usedThisBuild.insert(index)
+        return index
+    }
+
+    /// Uploads entries appended since the last upload; false if a buffer could not be made.
+    func upload() -> Bool {
+        guard let materialBuffer = ensure(materialBuffer,
+                                          count: materials.count,
+                                          stride: MemoryLayout<RTMaterialInfoSwift>.stride,
+                                          uploaded: &uploadedMaterials,
+                                          label: "RTMaterials"),
+              let textureBuffer = ensure(textureBuffer,
+                                         count: textures.count,
+                                         stride: RTMaterialTable.textureStride,
+                                         uploaded: &uploadedTextures,
+                                         label: "RTMaterialTextures") else {
+            return false
+        }
+        self.materialBuffer = materialBuffer
+        self.textureBuffer = textureBuffer
+
+        if uploadedMaterials < materials.count {
+            materials[uploadedMaterials...].withUnsafeBytes { raw in
+                let offset = uploadedMaterials * MemoryLayout<RTMaterialInfoSwift>.stride
+                memcpy(materialBuffer.contents() + offset, raw.baseAddress!, raw.count)
+            }
+            uploadedMaterials = materials.count
+        }
+        let base = textureBuffer.contents()
+        for i in uploadedTextures..<textures.count {
+            base.storeBytes(of: textures[i].gpuResourceID,
+                            toByteOffset: i * RTMaterialTable.textureStride,
+                            as: MTLResourceID.self)
+        }
+        uploadedTextures = textures.count
+        return true
+    }
+
+    private func textureIndex(_ texture: MTLTexture?) -> UInt32 {
+        guard let texture else { return UInt32.max }
+        let key = ObjectIdentifier(texture)
+        if let existing = indexForTexture[key] {
+            return existing
+        }
+        let index = UInt32(textures.count)
+        textures.append(texture)
+        indexForTexture[key] = index
+        return index
+    }
+
+    /// `buffer` if `count` entries fit, else a fresh buffer with room to grow; a fresh buffer
+    /// resets `uploaded` so every entry is written into it.
+    private func ensure(_ buffer: MTLBuffer?, count: Int, stride: Int, uploaded: inout Int, label: String) -> MTLBuffer? {
+        if let buffer, buffer.length >= count * stride {
+            return buffer
+        }
+        var capacity = RTMaterialTable.minCapacity
+        while capacity < count {
+            capacity *= 2
+        }
+        let fresh = device.makeBuffer(length: capacity * stride, options: .storageModeShared)
+        fresh?.label = label
+        uploaded = 0
+        return fresh
+    }
+}
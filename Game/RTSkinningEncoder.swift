@@ -7,12 +7,18 @@
 
 import Metal
 
+/// Skins every job in one dispatch: a per-slot job table holds each job's source streams
+/// and palette by GPU address and a prefix sum of vertex counts, which `skinningKernel`
+/// searches to find the job for its thread.
 final class RTSkinningEncoder {
     private let device: MTLDevice
     private let pipelineState: MTLComputePipelineState
+    private var jobBuffers = FrameSlotBuffers(label: "RTSkinningJobs")
+    private let profiler: GPUProfiler?
 
-    init?(device: MTLDevice) {
+    init?(device: MTLDevice, profiler: GPUProfiler? = nil) {
         self.device = device
+        self.profiler = profiler
         let library = device.makeDefaultLibrary()
         guard let fn = library?.makeFunction(name: "skinningKernel") else {
             return nil
@@ -28,35 +34,68 @@ final class RTSkinningEncoder {
                 outputBuffer: MTLBuffer,
                 outputNormalBuffer: MTLBuffer,
                 outputTangentBuffer: MTLBuffer,
-                jobs: [RTSkinningJob]) {
+                jobs: [RTSkinningJob],
+                frameSlot: Int) {
         guard !jobs.isEmpty,
-              let enc = commandBuffer.makeComputeCommandEncoder() else {
+              let jobBuffer = jobBuffers.buffer(slot: frameSlot,
+                                                length: jobs.count * MemoryLayout<SkinningJobSwift>.stride,
+                                                device: device),
+              let enc = commandBuffer.makeComputeCommandEncoder(profiler: profiler, scope: "RT Skinning") else {
             return
         }
-        enc.setComputePipelineState(pipelineState)
-        for job in jobs {
-            var params = SkinningParamsSwift(baseVertex: UInt32(job.dstBaseVertex),
-                                             vertexCount: UInt32(job.vertexCount))
-            enc.setBuffer(job.sourcePositions, offset: 0, index: 0)
-            enc.setBuffer(job.sourceNormals, offset: 0, index: 1)
-            enc.setBuffer(job.sourceTangents, offset: 0, index: 2)
-            enc.setBuffer(job.sourceBoneIndices, offset: 0, index: 3)
-            enc.setBuffer(job.sourceBoneWeights, offset: 0, index: 4)
-            enc.setBuffer(job.paletteBuffer, offset: 0, index: 5)
-            enc.setBuffer(outputBuffer, offset: 0, index: 6)
-            enc.setBuffer(outputNormalBuffer, offset: 0, index: 7)
-            enc.setBuffer(outputTangentBuffer, offset: 0, index: 8)
-            enc.setBytes(&params, length: MemoryLayout<SkinningParamsSwift>.stride, index: 9)
-
-            let threadsPerThreadgroup = MTLSize(width: 64, height: 1, depth: 1)
-            let threadsPerGrid = MTLSize(width: job.vertexCount, height: 1, depth: 1)
-            enc.dispatchThreads(threadsPerGrid, threadsPerThreadgroup: threadsPerThreadgroup)
+        let table = jobBuffer.contents().bindMemory(to: SkinningJobSwift.self, capacity: jobs.count)
+        var sources: [MTLResource] = []
+        var seen = Set<ObjectIdentifier>()
+        var threadCount = 0
+        for (i, job) in jobs.enumerated() {
+            table[i] = SkinningJobSwift(positions: job.sourcePositions.gpuAddress,
+                                        normals: job.sourceNormals.gpuAddress,
+                                        tangents: job.sourceTangents.gpuAddress,
+                                        boneIndices: job.sourceBoneIndices.gpuAddress,
+                                        boneWeights: job.sourceBoneWeights.gpuAddress,
+                                        palette: job.paletteBuffer.gpuAddress + UInt64(job.paletteOffset),
+                                        baseVertex: UInt32(job.dstBaseVertex),
+                                        vertexCount: UInt32(job.vertexCount),
+                                        firstThread: UInt32(threadCount),
+                                        boneInfluences: UInt32(job.boneInfluences))
+            threadCount += job.vertexCount
+            for buffer in [job.sourcePositions, job.sourceNormals, job.sourceTangents,
+                           job.sourceBoneIndices, job.sourceBoneWeights, job.paletteBuffer]
+            where seen.insert(ObjectIdentifier(buffer)).inserted {
+                sources.append(buffer)
+            }
         }
+        var params = SkinningParamsSwift(jobCount: UInt32(jobs.count), threadCount: UInt32(threadCount))
+
+        enc.setComputePipelineState(pipelineState)
+        enc.useResources(sources, usage: .read)
+        enc.setBuffer(jobBuffer, offset: 0, index: 0)
+        enc.setBuffer(outputBuffer, offset: 0, index: 1)
+        enc.setBuffer(outputNormalBuffer, offset: 0, index: 2)
+        enc.setBuffer(outputTangentBuffer, offset: 0, index: 3)
+        enc.setBytes(&params, length: MemoryLayout<SkinningParamsSwift>.stride, index: 4)
+        let threadsPerThreadgroup = MTLSize(width: 64, height: 1, depth: 1)
+        let threadsPerGrid = MTLSize(width: max(threadCount, 1), height: 1, depth: 1)
+        enc.dispatchThreads(threadsPerGrid, threadsPerThreadgroup: threadsPerThreadgroup)
         enc.endEncoding()
     }
 }
 
-private struct SkinningParamsSwift {
+/// Matches `SkinningJob` in the shader (64 bytes).
+private struct SkinningJobSwift {
+    var positions: UInt64
+    var normals: UInt64
+    var tangents: UInt64
+    var boneIndices: UInt64
+    var boneWeights: UInt64
+    var palette: UInt64
     var baseVertex: UInt32
     var vertexCount: UInt32
+    var firstThread: UInt32
+    var boneInfluences: UInt32
+}
+
+private struct SkinningParamsSwift {
+    var jobCount: UInt32
+    var threadCount: UInt32
 }
@@ -0,0 +1,173 @@
+//
+//  RTTemporalResolver.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+import simd
+
+/// Temporal mode for the ray tracer: the trace runs at a reduced resolution with a
+/// per-frame sub-pixel jitter, and `rtTemporalResolveKernel` reprojects the accumulated
+/// history through last frame's view-projection, rejects disoccluded pixels by depth and
+/// blends the new samples in at the output resolution.
+final class RTTemporalResolver {
+    /// Upper bound on the accumulated sample weight; caps ghosting under motion.
+    static let maxHistory: Float = 16
+    private static let jitterPhases = 8
+
+    private let device: MTLDevice
+    private let pipelineState: MTLComputePipelineState
+
+    private var traceColor: MTLTexture?
+    private var traceDepth: MTLTexture?
+    /// Traced region of the trace targets, which are output-sized so scale changes
+    /// (dynamic resolution) never reallocate them.
+    private var traceSize = SIMD2<Int>(1, 1)
+    /// Ping-ponged: one is read as last frame's history while the other is written.
+    private var historyColor: [MTLTexture] = []
+    private var historyDepth: [MTLTexture] = []
+    private var historyIndex = 0
+
+    private var frameIndex = 0
+    private var historyValid = false
+    private var prevViewProj = matrix_identity_float4x4
+    private var prevCameraPosition = SIMD3<Float>(repeating: 0)
+    private var prevWorldOrigin = SIMD3<Float>(repeating: 0)
+    private var uniformBuffers = FrameSlotBuffers(label: "RTTemporalUniforms")
+    private let profiler: GPUProfiler?
+
+    init?(device: MTLDevice, profiler: GPUProfiler? = nil) {
+        self.device = device
+        self.profiler = profiler
+        guard let fn = device.makeDefaultLibrary()?.makeFunction(name: "rtTemporalResolveKernel") else {
+            print("Ray tracing temporal resolve kernel not found")
+            return nil
+        }
+        do {
+            self.pipelineState = try device.makeComputePipelineState(function: fn)
+        } catch {
+            print("Unable to compile temporal resolve pipeline state. Error info: \(error)")
+            return nil
+        }
+    }
+
+    /// Sub-pixel offset of this frame's primary rays, in trace pixels within [-0.5, 0.5).
+    var jitter: SIMD2<Float> {
+        let i = frameIndex % RTTemporalResolver.jitterPhases + 1
+        return SIMD2<Float>(RTTemporalResolver.halton(i, base: 2),
+                            RTTemporalResolver.halton(i, base: 3)) - 0.5
+    }
+
+    /// Drops the history so the next resolve starts from the current trace alone.
+    func invalidate() {
+        historyValid = false
+    }
+
+    /// Trace targets for this frame and the traced size at `scale` of `output`; targets
+    /// and history are output-sized and (re)created only when the output size changes.
+    func traceTargets(output: MTLTexture, scale: Float) -> (color: MTLTexture, depth: MTLTexture, width: Int, height: Int)? {
+        let width = min(max(Int((Float(output.width) * scale).rounded(.toNearestOrAwayFromZero)), 1), output.width)
+        let height = min(max(Int((Float(output.height) * scale).rounded(.toNearestOrAwayFromZero)), 1), output.height)
+        if traceColor?.width != output.width || traceColor?.height != output.height {
+            traceColor = makeTexture(width: output.width, height: output.height, format: .rgba16Float, label: "RTTraceColor")
+            traceDepth = makeTexture(width: output.width, height: output.height, format: .r32Float, label: "RTTraceDepth")
+        }
+        if historyColor.first?.width != output.width || historyColor.first?.height != output.height {
+            historyColor = (0..<2).compactMap { i in
+                makeTexture(width: output.width, height: output.height, format: .rgba16Float, label: "RTHistoryColor\(i)")
+            }
+            historyDepth = (0..<2).compactMap { i in
+                makeTexture(width: output.width, height: output.height, format: .r32Float, label: "RTHistoryDepth\(i)")
+            }
+            historyValid = false
+        }
+        guard let traceColor, let traceDepth, historyColor.count == 2, historyDepth.count == 2 else {
+            return nil
+        }
+        traceSize = SIMD2<Int>(width, height)
+        return (traceColor, traceDepth, width, height)
+    }
+
+    /// Resolves the targets returned by `traceTargets` into `output` and advances the history.
+    func encodeResolve(commandBuffer: MTLCommandBuffer,
+                       viewProj: matrix_float4x4,
+                       cameraPosition: SIMD3<Float>,
+                       worldOrigin: SIMD3<Float>,
+                       output: MTLTexture,
+                       frameSlot: Int) {
+        guard let traceColor, let traceDepth, historyColor.count == 2, historyDepth.count == 2 else { return }
+        // A rebased origin moves every render-space position; the history no longer lines up.
+        if worldOrigin != prevWorldOrigin {
+            historyValid = false
+        }
+
+        var params = RTTemporalUniformsSwift(
+            invViewProj: simd_inverse(viewProj),
+            prevViewProj: prevViewProj,
+            cameraPosition: cameraPosition,
+            pad0: 0,
+            prevCameraPosition: prevCameraPosition,
+            pad1: 0,
+            inputSize: SIMD2<UInt32>(UInt32(traceSize.x), UInt32(traceSize.y)),
+            outputSize: SIMD2<UInt32>(UInt32(output.width), UInt32(output.height)),
+            jitter: jitter,
+            maxHistory: RTTemporalResolver.maxHistory,
+            historyValid: historyValid ? 1 : 0
+        )
+        guard let uniforms = uniformBuffers.buffer(slot: frameSlot,
+                                                   length: MemoryLayout<RTTemporalUniformsSwift>.stride,
+                                                   device: device),
+              let enc = commandBuffer.makeComputeCommandEncoder(profiler: profiler, scope: "RT Temporal Resolve") else {
+            return
+        }
+        memcpy(uniforms.contents(), &params, MemoryLayout<RTTemporalUniformsSwift>.stride)
+
+        let read = historyIndex
+        let write = 1 - historyIndex
+        enc.setComputePipelineState(pipelineState)
+        enc.setTexture(traceColor, index: 0)
+        enc.setTexture(traceDepth, index: 1)
+        enc.setTexture(historyColor[read], index: 2)
+        enc.setTexture(historyDepth[read], index: 3)
+        enc.setTexture(historyColor[write], index: 4)
+        enc.setTexture(historyDepth[write], index: 5)
+        enc.setTexture(output, index: 6)
+        enc.setBuffer(uniforms, offset: 0, index: 0)
+        enc.dispatchThreads(MTLSize(width: output.width, height: output.height, depth: 1),
+                            threadsPerThreadgroup: MTLSize(width: 8, height: 8, depth: 1))
+        enc.endEncoding()
+
+        historyIndex = write
+        historyValid = true
+        prevViewProj = viewProj
+        prevCameraPosition = cameraPosition
+        prevWorldOrigin = worldOrigin
+        frameIndex += 1
+    }
+
+    private func makeTexture(width: Int, height: Int, format: MTLPixelFormat, label: String) -> MTLTexture? {
+        let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: format,
+                                                            width: width,
+                                                            height: height,
+                                                            mipmapped: false)
+        desc.usage = [.shaderRead, .shaderWrite]
+        desc.storageMode = .private
+        let tex = device.makeTexture(descriptor: desc)
+        tex?.label = label
+        return tex
+    }
+
+    private static func halton(_ index: Int, base: Int) -> Float {
+        var f: Float = 1
+        var r: Float = 0
+        var i = index
+        while i > 0 {
+            f /= Float(base)
+            r += f * Float(i % base)
+            i /= base
+        }
+        return r
+    }
+}
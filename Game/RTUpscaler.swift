@@ -0,0 +1,77 @@
+//
+//  RTUpscaler.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+private struct RTUpscaleParamsSwift {
+    var inputSize: SIMD2<UInt32>
+    var outputSize: SIMD2<UInt32>
+}
+
+/// Reduced-resolution trace without temporal accumulation: the trace renders into the
+/// top-left region of a texture sized like the output, so scale changes never reallocate,
+/// and `rtUpscaleKernel` resamples that region to the output with a Catmull-Rom filter.
+final class RTUpscaler {
+    private let device: MTLDevice
+    private let pipelineState: MTLComputePipelineState
+    private let profiler: GPUProfiler?
+    private var source: MTLTexture?
+    private var contentSize = SIMD2<Int>(1, 1)
+
+    init?(device: MTLDevice, profiler: GPUProfiler? = nil) {
+        self.device = device
+        self.profiler = profiler
+        guard let fn = device.makeDefaultLibrary()?.makeFunction(name: "rtUpscaleKernel") else {
+            print("Ray tracing upscale kernel not found")
+            return nil
+        }
+        do {
+            self.pipelineState = try device.makeComputePipelineState(function: fn)
+        } catch {
+            print("Unable to compile upscale pipeline state. Error info: \(error)")
+            return nil
+        }
+    }
+
+    /// Trace target and traced size for `scale` of `output`; nil when the scale covers the
+    /// whole output, in which case the trace writes `output` directly.
+    func traceTarget(output: MTLTexture, scale: Float) -> (texture: MTLTexture, width: Int, height: Int)? {
+        let width = min(max(Int((Float(output.width) * scale).rounded(.toNearestOrAwayFromZero)), 1), output.width)
+        let height = min(max(Int((Float(output.height) * scale).rounded(.toNearestOrAwayFromZero)), 1), output.height)
+        guard width < output.width || height < output.height else { return nil }
+        if source?.width != output.width || source?.height != output.height || source?.pixelFormat != output.pixelFormat {
+            let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: output.pixelFormat,
+                                                                width: output.width,
+                                                                height: output.height,
+                                                                mipmapped: false)
+            desc.usage = [.shaderRead, .shaderWrite]
+            desc.storageMode = .private
+            source = device.makeTexture(descriptor: desc)
+            source?.label = "RTUpscaleSource"
+        }
+        guard let source else { return nil }
+        contentSize = SIMD2<Int>(width, height)
+        return (source, width, height)
+    }
+
+    /// Resamples what the last `traceTarget` was traced with into `output`.
+    func encode(commandBuffer: MTLCommandBuffer, output: MTLTexture) {
+        guard let source,
+              let enc = commandBuffer.makeComputeCommandEncoder(profiler: profiler, scope: "RT Upscale") else {
+            return
+        }
+        var params = RTUpscaleParamsSwift(inputSize: SIMD2<UInt32>(UInt32(contentSize.x), UInt32(contentSize.y)),
+                                          outputSize: SIMD2<UInt32>(UInt32(output.width), UInt32(output.height)))
+        enc.setComputePipelineState(pipelineState)
+        enc.setTexture(source, index: 0)
+        enc.setTexture(output, index: 1)
+        enc.setBytes(&params, length: MemoryLayout<RTUpscaleParamsSwift>.stride, index: 0)
+        enc.dispatchThreads(MTLSize(width: output.width, height: output.height, depth: 1),
+                            threadsPerThreadgroup: MTLSize(width: 8, height: 8, depth: 1))
+        enc.endEncoding()
+    }
+}
@@ -0,0 +1,191 @@
+//
+//  RTWavefrontTracer.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+
+/// Drives the kernels in RayTracingWavefront.metalinc. A primary dispatch fills the
+/// reflection, refraction and shadow queues; each queue is then traced by its own indirect
+/// dispatch sized on the GPU from the queue counters, and a resolve writes the output.
+/// Queues are sized before each frame is encoded for the most rays it can queue, so no
+/// frame overflows; the kernels still resolve rays that find a queue full inline
+/// (background or unshadowed light).
+final class RTWavefrontTracer {
+    /// Stride of `RTQueuedRay` in the shader.
+    static let rayStride = 48
+    /// Matches RT_WAVEFRONT_GROUP.
+    private static let groupSize = 64
+    private static let argsStride = MemoryLayout<MTLDispatchThreadgroupsIndirectArguments>.stride
+
+    private enum Queue: Int, CaseIterable {
+        case reflection
+        case refraction
+        case shadow
+    }
+
+    /// Mirrors RTQueueLayout in RayTracingWavefront.metalinc.
+    private struct QueueLayout {
+        var capacity: SIMD4<UInt32>
+        var base: SIMD4<UInt32>
+    }
+
+    private let device: MTLDevice
+    private let primaryPipeline: MTLComputePipelineState
+    private let reflectionPipeline: MTLComputePipelineState
+    private let refractionPipeline: MTLComputePipelineState
+    private let shadowPipeline: MTLComputePipelineState
+    private let dispatchArgsPipeline: MTLComputePipelineState
+    private let resolvePipeline: MTLComputePipelineState
+
+    private var radianceBuffer: MTLBuffer?
+    private var rayBuffer: MTLBuffer?
+    private var queueLayout = QueueLayout(capacity: .zero, base: .zero)
+    private let counterBuffer: MTLBuffer
+    private let argsBuffer: MTLBuffer
+    private let profiler: GPUProfiler?
+
+    init?(device: MTLDevice, profiler: GPUProfiler? = nil) {
+        self.device = device
+        self.profiler = profiler
+        guard let library = device.makeDefaultLibrary() else { return nil }
+        func pipeline(_ name: String) -> MTLComputePipelineState? {
+            guard let fn = library.makeFunction(name: name) else {
+                print("Wavefront kernel \(name) not found")
+                return nil
+            }
+            do {
+                return try device.makeComputePipelineState(function: fn)
+            } catch {
+                print("Unable to compile wavefront pipeline \(name). Error info: \(error)")
+                return nil
+            }
+        }
+        guard let primary = pipeline("rtWavefrontPrimaryKernel"),
+              let reflection = pipeline("rtWavefrontReflectionKernel"),
+              let refraction = pipeline("rtWavefrontRefractionKernel"),
+              let shadow = pipeline("rtWavefrontShadowKernel"),
+              let dispatchArgs = pipeline("rtWavefrontDispatchArgsKernel"),
+              let resolve = pipeline("rtWavefrontResolveKernel"),
+              let counters = device.makeBuffer(length: Queue.allCases.count * MemoryLayout<UInt32>.stride,
+                                               options: .storageModePrivate),
+              let args = device.makeBuffer(length: Queue.allCases.count * RTWavefrontTracer.argsStride,
+                                           options: .storageModePrivate) else {
+            return nil
+        }
+        self.primaryPipeline = primary
+        self.reflectionPipeline = reflection
+        self.refractionPipeline = refraction
+        self.shadowPipeline = shadow
+        self.dispatchArgsPipeline = dispatchArgs
+        self.resolvePipeline = resolve
+        counters.label = "RTWavefrontCounters"
+        args.label = "RTWavefrontDispatchArgs"
+        self.counterBuffer = counters
+        self.argsBuffer = args
+    }
+
+    /// `bindScene` sets the frame uniforms, acceleration structure, geometry streams, lights,
+    /// and material and IBL textures at the megakernel's indices. `lightCount` bounds the
+    /// shadow rays a refraction hit can queue.
+    func encode(commandBuffer: MTLCommandBuffer,
+                outputTexture: MTLTexture,
+                depthTexture: MTLTexture,
+                width: Int,
+                height: Int,
+                lightCount: Int,
+                bindScene: (MTLComputeCommandEncoder) -> Void) {
+        guard ensureCapacity(pixelCount: width * height, lightCount: lightCount),
+              let radianceBuffer,
+              let rayBuffer,
+              let blit = commandBuffer.makeBlitCommandEncoder() else {
+            return
+        }
+        blit.fill(buffer: counterBuffer, range: 0..<counterBuffer.length, value: 0)
+        blit.endEncoding()
+
+        guard let enc = commandBuffer.makeComputeCommandEncoder(profiler: profiler, scope: "RT Wavefront") else { return }
+        bindScene(enc)
+        var layout = queueLayout
+        enc.setBuffer(radianceBuffer, offset: 0, index: BufferIndex.rtRadiance.rawValue)
+        enc.setBuffer(rayBuffer, offset: 0, index: BufferIndex.rtRayQueue.rawValue)
+        enc.setBuffer(counterBuffer, offset: 0, index: BufferIndex.rtQueueCounters.rawValue)
+        enc.setBytes(&layout, length: MemoryLayout<QueueLayout>.stride, index: BufferIndex.rtQueueCapacity.rawValue)
+        enc.setBuffer(argsBuffer, offset: 0, index: BufferIndex.rtDispatchArgs.rawValue)
+        let tile = MTLSize(width: 8, height: 8, depth: 1)
+        let grid = MTLSize(width: width, height: height, depth: 1)
+
+        enc.setComputePipelineState(primaryPipeline)
+        enc.setTexture(depthTexture, index: 0)
+        enc.dispatchThreads(grid, threadsPerThreadgroup: tile)
+
+        encodeDispatchArgs(enc)
+        dispatchQueue(enc, pipeline: reflectionPipeline, queue: .reflection)
+        dispatchQueue(enc, pipeline: refractionPipeline, queue: .refraction)
+        // Secondary hits append shadow rays, so the shadow count is only final now.
+        encodeDispatchArgs(enc)
+        dispatchQueue(enc, pipeline: shadowPipeline, queue: .shadow)
+
+        enc.setComputePipelineState(resolvePipeline)
+        enc.setTexture(outputTexture, index: 0)
+        enc.dispatchThreads(grid, threadsPerThreadgroup: tile)
+        enc.endEncoding()
+    }
+
+    private func encodeDispatchArgs(_ enc: MTLComputeCommandEncoder) {
+        let count = Queue.allCases.count
+        enc.setComputePipelineState(dispatchArgsPipeline)
+        enc.dispatchThreads(MTLSize(width: count, height: 1, depth: 1),
+                            threadsPerThreadgroup: MTLSize(width: count, height: 1, depth: 1))
+    }
+
+    private func dispatchQueue(_ enc: MTLComputeCommandEncoder, pipeline: MTLComputePipelineState, queue: Queue) {
+        enc.setComputePipelineState(pipeline)
+        enc.dispatchThreadgroups(indirectBuffer: argsBuffer,
+                                 indirectBufferOffset: queue.rawValue * RTWavefrontTracer.argsStride,
+                                 threadsPerThreadgroup: MTLSize(width: RTWavefrontTracer.groupSize, height: 1, depth: 1))
+    }
+
+    /// Sizes each queue for the most rays one frame can queue: every pixel queues a
+    /// reflection, a refraction and a shadow ray per layer, each reflection a shadow ray and
+    /// each refraction one per light. Runs before the frame is encoded, so a higher
+    /// resolution or light count grows the queues for the frame that needs them. Queues
+    /// never shrink, so resolution changes do not reallocate back and forth.
+    private func ensureCapacity(pixelCount: Int, lightCount: Int) -> Bool {
+        let pixels = max(pixelCount, 1)
+        let layers = 3
+        let needed = SIMD4<Int>(pixels * layers, pixels * layers, pixels * layers * (2 + max(lightCount, 1)), 0)
+        var capacity = SIMD4<Int>(repeating: 0)
+        var grow = rayBuffer == nil
+        for queue in Queue.allCases {
+            let q = queue.rawValue
+            let current = Int(queueLayout.capacity[q])
+            let rounded = (needed[q] + RTWavefrontTracer.groupSize - 1) / RTWavefrontTracer.groupSize * RTWavefrontTracer.groupSize
+            capacity[q] = max(rounded, current)
+            grow = grow || capacity[q] > current
+        }
+
+        let radianceLength = pixels * 4 * MemoryLayout<Float>.stride
+        if !grow, let radianceBuffer, radianceBuffer.length >= radianceLength {
+            return true
+        }
+        let total = capacity.wrappedSum()
+        guard total <= Int(UInt32.max) else {
+            print("RTWavefrontTracer: ray queues of \(total) rays exceed the addressable range")
+            return false
+        }
+        if grow {
+            rayBuffer = device.makeBuffer(length: total * RTWavefrontTracer.rayStride, options: .storageModePrivate)
+            rayBuffer?.label = "RTWavefrontRays"
+            let c = SIMD4<UInt32>(truncatingIfNeeded: capacity)
+            queueLayout = QueueLayout(capacity: c, base: SIMD4<UInt32>(0, c[0], c[0] + c[1], 0))
+        }
+        if radianceBuffer.map({ $0.length < radianceLength }) ?? true {
+            radianceBuffer = device.makeBuffer(length: radianceLength, options: .storageModePrivate)
+            radianceBuffer?.label = "RTWavefrontRadiance"
+        }
+        return rayBuffer != nil && radianceBuffer != nil
+    }
+}
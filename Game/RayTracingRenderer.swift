@@ -9,38 +9,60 @@ import Metal
 import MetalKit
 import simd
 
+/// Per-frame inputs shared by the scene-build and trace passes.
+struct RayTracingFrameInput {
+    let items: [RenderItem]
+    /// The scene's change set for `items`; nil rebuilds the geometry keys from `items`.
+    let changes: RenderItemChanges?
+    let lights: [DirectionalLight]
+    let camera: Camera
+    let projection: matrix_float4x4
+    let viewMatrix: matrix_float4x4
+    let outputTexture: MTLTexture
+    /// Selects the per-frame copies of CPU-written buffers (see `FrameSync.slot`).
+    let frameSlot: Int
+    /// Trace at `traceScale` of `outputTexture` and accumulate into it over frames.
+    let temporal: Bool
+    /// Traced fraction of `outputTexture` per axis; the trace fills that region of an
+    /// output-sized target and is upscaled (RTUpscaler) or resolved (temporal) into it.
+    let traceScale: Float
+    /// Trace secondary and shadow rays from queues (RTWavefrontTracer) instead of the megakernel.
+    let wavefront: Bool
+    /// Resolve non-opaque instances with alpha intersection functions (megakernel only).
+    let alphaFunctions: Bool
+}
+
 final class RayTracingRenderer {
     private let device: MTLDevice
 
     private let rtPipelineState: MTLComputePipelineState
     private let rtScene: RayTracingScene
-    private let rtFrameBuffer: MTLBuffer
-
-    private var dirLightBuffer: MTLBuffer
-    private var dirLightCapacity: Int = 0
+    private var rtFrameBuffers = FrameSlotBuffers(label: "RTFrameUniforms")
+    private var dirLightBuffers = FrameSlotBuffers(label: "RTDirectionalLights")
     private let ibl: IBLResources
+    private let temporal: RTTemporalResolver?
+    private let wavefront: RTWavefrontTracer?
+    private let upscaler: RTUpscaler?
+    private let alphaIntersection: RTAlphaIntersection?
+    /// Bound as the depth target when temporal accumulation is off: the trace kernels
+    /// declare it unconditionally and only skip the write.
+    private let placeholderDepth: MTLTexture
+    /// Output of the last `encodeScene`, consumed by `encodeTrace`.
+    private var sceneGeometry: RTGeometryBuffers?
+    private var sceneTLAS: MTLAccelerationStructure?
+    private let profiler: GPUProfiler?
 
-    init?(device: MTLDevice) {
+    init?(device: MTLDevice, profiler: GPUProfiler? = nil) {
         self.device = device
-        self.rtScene = RayTracingScene(device: device)
-
-        guard let rtBuffer = device.makeBuffer(length: MemoryLayout<RTFrameUniformsSwift>.stride,
-                                               options: [.storageModeShared]) else {
-            return nil
-        }
-        self.rtFrameBuffer = rtBuffer
-
-        guard let dirBuf = device.makeBuffer(length: max(MemoryLayout<RTDirectionalLightSwift>.stride, 1),
-                                             options: [.storageModeShared]) else {
-            return nil
-        }
-        dirBuf.label = "RTDirectionalLights"
-        self.dirLightBuffer = dirBuf
-        self.dirLightCapacity = MemoryLayout<RTDirectionalLightSwift>.stride
+        self.profiler = profiler
+        self.rtScene = RayTracingScene(device: device, profiler: profiler)
 
         do {
             let library = device.makeDefaultLibrary()
-            guard let fn = library?.makeFunction(name: "raytraceKernel") else {
+            let constants = MTLFunctionConstantValues()
+            var alphaFunctions = false
+            constants.setConstantValue(&alphaFunctions, type: .bool, index: FunctionConstantIndex.rtAlphaFunctions.rawValue)
+            guard let fn = try library?.makeFunction(name: "raytraceKernel", constantValues: constants) else {
                 print("Ray tracing kernel not found")
                 return nil
             }
@@ -49,24 +71,64 @@ final class RayTracingRenderer {
             print("Unable to compile ray tracing pipeline state. Error info: \(error)")
             return nil
         }
+        let depthDesc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .r32Float,
+                                                                 width: 1,
+                                                                 height: 1,
+                                                                 mipmapped: false)
+        depthDesc.usage = [.shaderRead, .shaderWrite]
+        depthDesc.storageMode = .private
+        guard let placeholderDepth = device.makeTexture(descriptor: depthDesc) else {
+            print("Unable to create ray tracing placeholder depth texture")
+            return nil
+        }
+        placeholderDepth.label = "RTPlaceholderDepth"
+        self.placeholderDepth = placeholderDepth
         self.ibl = IBLResources(device: device)
+        self.temporal = RTTemporalResolver(device: device, profiler: profiler)
+        self.wavefront = RTWavefrontTracer(device: device, profiler: profiler)
+        self.upscaler = RTUpscaler(device: device, profiler: profiler)
+        self.alphaIntersection = RTAlphaIntersection(device: device)
+    }
+
+    func encode(commandBuffer: MTLCommandBuffer, input: RayTracingFrameInput) {
+        encodeScene(commandBuffer: commandBuffer, input: input)
+        encodeTrace(commandBuffer: commandBuffer, input: input)
+    }
+
+    /// Geometry uploads, skinning and acceleration-structure builds for `input.items`.
+    func encodeScene(commandBuffer: MTLCommandBuffer, input: RayTracingFrameInput) {
+        // No-op under Renderer, which already encoded them; covers standalone use.
+        TextureResource.encodePendingMipmaps(commandBuffer: commandBuffer)
+        sceneGeometry = rtScene.buildGeometryBuffers(items: input.items,
+                                                     changes: input.changes,
+                                                     frameSlot: input.frameSlot,
+                                                     commandBuffer: commandBuffer)
+        sceneTLAS = rtScene.buildAccelerationStructures(items: input.items,
+                                                        frameSlot: input.frameSlot,
+                                                        commandBuffer: commandBuffer)
     }
 
-    func encode(commandBuffer: MTLCommandBuffer,
-                outputTexture: MTLTexture,
-                outputSize: CGSize,
-                items: [RenderItem],
-                lights: [DirectionalLight],
-                camera: Camera,
-                projection: matrix_float4x4,
-                viewMatrix: matrix_float4x4) {
-        let geometry = rtScene.buildGeometryBuffers(items: items, commandBuffer: commandBuffer)
-        let tlas = rtScene.buildAccelerationStructures(items: items, commandBuffer: commandBuffer)
-
-        let viewProj = simd_mul(projection, viewMatrix)
+    /// Traces the scene built by the last `encodeScene` into `input.outputTexture`.
+    func encodeTrace(commandBuffer: MTLCommandBuffer, input: RayTracingFrameInput) {
+        let geometry = sceneGeometry
+        let tlas = sceneTLAS
+        let camera = input.camera
+        let lights = input.lights
+        let frameSlot = input.frameSlot
+
+        let targets = input.temporal ? temporal?.traceTargets(output: input.outputTexture, scale: input.traceScale) : nil
+        if targets == nil {
+            temporal?.invalidate()
+        }
+        // Without temporal accumulation a reduced scale traces into RTUpscaler's target.
+        let upscale = targets == nil ? upscaler?.traceTarget(output: input.outputTexture, scale: input.traceScale) : nil
+        let outputTexture = targets?.color ?? upscale?.texture ?? input.outputTexture
+        let jitter = targets == nil ? SIMD2<Float>(repeating: 0) : (temporal?.jitter ?? .zero)
+
+        let viewProj = simd_mul(input.projection, input.viewMatrix)
         let invViewProj = simd_inverse(viewProj)
-        let width = max(Int(outputSize.width), 1)
-        let height = max(Int(outputSize.height), 1)
+        let width = max(targets?.width ?? upscale?.width ?? outputTexture.width, 1)
+        let height = max(targets?.height ?? upscale?.height ?? outputTexture.height, 1)
         let (envSH0, envSH1) = RayTracingRenderer.makeHemisphereSH()
 
         let cameraWorld = WorldPosition.toWorld(chunk: camera.worldChunk, local: camera.worldLocal)
@@ -93,38 +155,104 @@ final class RayTracingRenderer {
             envSH5: .zero,
             envSH6: .zero,
             envSH7: .zero,
-            envSH8: .zero
+            envSH8: .zero,
+            jitter: jitter,
+            temporalEnabled: targets == nil ? 0 : 1,
+            pad3: 0
         )
+        guard let rtFrameBuffer = rtFrameBuffers.buffer(slot: frameSlot,
+                                                        length: MemoryLayout<RTFrameUniformsSwift>.stride,
+                                                        device: device),
+              let dirLightBuffer = updateLightBuffers(lights: lights, frameSlot: frameSlot) else {
+            return
+        }
         memcpy(rtFrameBuffer.contents(), &rtFrame, MemoryLayout<RTFrameUniformsSwift>.stride)
 
-        updateLightBuffers(lights: lights)
-
         encodeRaytracePass(commandBuffer: commandBuffer,
                            tlas: tlas,
                            geometry: geometry,
+                           rtFrameBuffer: rtFrameBuffer,
+                           dirLightBuffer: dirLightBuffer,
                            rtFrame: rtFrame,
                            outputTexture: outputTexture,
+                           depthTexture: targets?.depth ?? placeholderDepth,
+                           useWavefront: input.wavefront,
+                           useAlphaFunctions: input.alphaFunctions,
+                           frameSlot: frameSlot,
                            width: width,
                            height: height)
+
+        if upscale != nil {
+            upscaler?.encode(commandBuffer: commandBuffer, output: input.outputTexture)
+        }
+        if targets != nil {
+            temporal?.encodeResolve(commandBuffer: commandBuffer,
+                                    viewProj: viewProj,
+                                    cameraPosition: camera.position,
+                                    worldOrigin: worldOrigin,
+                                    output: input.outputTexture,
+                                    frameSlot: frameSlot)
+        }
     }
 
     private func encodeRaytracePass(commandBuffer: MTLCommandBuffer,
                                     tlas: MTLAccelerationStructure?,
                                     geometry: RTGeometryBuffers?,
+                                    rtFrameBuffer: MTLBuffer,
+                                    dirLightBuffer: MTLBuffer,
                                     rtFrame: RTFrameUniformsSwift,
                                     outputTexture: MTLTexture,
+                                    depthTexture: MTLTexture,
+                                    useWavefront: Bool,
+                                    useAlphaFunctions: Bool,
+                                    frameSlot: Int,
                                     width: Int,
                                     height: Int) {
-        guard let tlas = tlas,
-              let geometry = geometry,
-              let enc = commandBuffer.makeComputeCommandEncoder() else {
+        guard let tlas = tlas, let geometry = geometry else { return }
+        let bindScene = { (enc: MTLComputeCommandEncoder) in
+            self.bindScene(enc: enc,
+                           tlas: tlas,
+                           geometry: geometry,
+                           rtFrameBuffer: rtFrameBuffer,
+                           dirLightBuffer: dirLightBuffer)
+        }
+        if useWavefront, let wavefront {
+            wavefront.encode(commandBuffer: commandBuffer,
+                             outputTexture: outputTexture,
+                             depthTexture: depthTexture,
+                             width: width,
+                             height: height,
+                             lightCount: Int(rtFrame.dirLightCount),
+                             bindScene: bindScene)
             return
         }
+        guard let enc = commandBuffer.makeComputeCommandEncoder(profiler: profiler, scope: "RT Trace") else { return }
 
-        enc.setComputePipelineState(rtPipelineState)
+        if useAlphaFunctions, let alphaIntersection {
+            enc.setComputePipelineState(alphaIntersection.pipelineState)
+            alphaIntersection.bind(enc: enc, geometry: geometry, rtFrameBuffer: rtFrameBuffer, frameSlot: frameSlot)
+        } else {
+            enc.setComputePipelineState(rtPipelineState)
+        }
         enc.setTexture(outputTexture, index: 0)
+        enc.setTexture(depthTexture, index: 3)
+        bindScene(enc)
+        dispatch(enc: enc, width: width, height: height)
+        enc.endEncoding()
+    }
+
+    /// Scene resources shared by the megakernel and the wavefront kernels.
+    private func bindScene(enc: MTLComputeCommandEncoder,
+                           tlas: MTLAccelerationStructure,
+                           geometry: RTGeometryBuffers,
+                           rtFrameBuffer: MTLBuffer,
+                           dirLightBuffer: MTLBuffer) {
         enc.setBuffer(rtFrameBuffer, offset: 0, index: BufferIndex.rtFrame.rawValue)
         enc.setAccelerationStructure(tlas, bufferIndex: BufferIndex.rtAccel.rawValue)
+        let blas = rtScene.primitiveAccelerationStructures.map { $0 as MTLResource }
+        if !blas.isEmpty {
+            enc.useResources(blas, usage: .read)
+        }
         enc.setBuffer(geometry.staticVertexBuffer, offset: 0, index: BufferIndex.rtVertices.rawValue)
         enc.setBuffer(geometry.staticIndexBuffer, offset: 0, index: BufferIndex.rtIndices.rawValue)
         enc.setBuffer(geometry.instanceInfoBuffer, offset: 0, index: BufferIndex.rtInstances.rawValue)
@@ -137,26 +265,21 @@ final class RayTracingRenderer {
         enc.setBuffer(geometry.dynamicUVBuffer, offset: 0, index: BufferIndex(rawValue: 11)!.rawValue)
         enc.setBuffer(geometry.dynamicNormalBuffer, offset: 0, index: BufferIndex(rawValue: 14)!.rawValue)
         enc.setBuffer(geometry.dynamicTangentBuffer, offset: 0, index: BufferIndex(rawValue: 15)!.rawValue)
-        enc.setTexture(ibl.envCube, index: 1 + maxRTTextures)
-        enc.setTexture(ibl.brdfLUT, index: 2 + maxRTTextures)
+        enc.setTexture(ibl.envCube, index: 1)
+        enc.setTexture(ibl.brdfLUT, index: 2)
 
+        enc.setBuffer(geometry.materialBuffer, offset: 0, index: BufferIndex.rtMaterials.rawValue)
+        enc.setBuffer(geometry.textureTableBuffer, offset: 0, index: BufferIndex.rtMaterialTextures.rawValue)
         if !geometry.textures.isEmpty {
-            let count = min(geometry.textures.count, maxRTTextures)
-            let texArray: [MTLTexture?] = Array(geometry.textures.prefix(count))
-            enc.__setTextures(texArray, with: NSRange(location: 1, length: count))
+            enc.useResources(geometry.textures, usage: .read)
         }
-
-        dispatch(enc: enc, width: width, height: height)
-        enc.endEncoding()
     }
 
-    private func updateLightBuffers(lights: [DirectionalLight]) {
+    private func updateLightBuffers(lights: [DirectionalLight], frameSlot: Int) -> MTLBuffer? {
         let count = max(lights.count, 1)
         let bytes = count * MemoryLayout<RTDirectionalLightSwift>.stride
-        if bytes > dirLightCapacity {
-            dirLightCapacity = bytes
-            dirLightBuffer = device.makeBuffer(length: bytes, options: [.storageModeShared])!
-            dirLightBuffer.label = "RTDirectionalLights"
+        guard let dirLightBuffer = dirLightBuffers.buffer(slot: frameSlot, length: bytes, device: device) else {
+            return nil
         }
         let dirPtr = dirLightBuffer.contents().bindMemory(to: RTDirectionalLightSwift.self, capacity: count)
         if lights.isEmpty {
@@ -177,6 +300,7 @@ final class RayTracingRenderer {
                                                     padding: .zero)
             }
         }
+        return dirLightBuffer
     }
 
     private func dispatch(enc: MTLComputeCommandEncoder, width: Int, height: Int) {
@@ -13,21 +13,32 @@ final class RayTracingScene {
     private let skinningEncoder: RTSkinningEncoder?
     private var lastGeometryState: RTGeometryState?
 
-    init(device: MTLDevice) {
+    init(device: MTLDevice, profiler: GPUProfiler? = nil) {
         self.geometryCache = RTGeometryCache(device: device)
-        self.accelBuilder = RTAccelerationBuilder(device: device)
-        self.skinningEncoder = RTSkinningEncoder(device: device)
+        self.accelBuilder = RTAccelerationBuilder(device: device, profiler: profiler)
+        self.skinningEncoder = RTSkinningEncoder(device: device, profiler: profiler)
     }
 
     func buildAccelerationStructures(items: [RenderItem],
+                                     frameSlot: Int,
                                      commandBuffer: MTLCommandBuffer) -> MTLAccelerationStructure? {
         guard let state = lastGeometryState else { return nil }
-        return accelBuilder.build(state: state, items: items, commandBuffer: commandBuffer)
+        return accelBuilder.build(state: state, items: items, frameSlot: frameSlot, commandBuffer: commandBuffer)
+    }
+
+    /// BLAS referenced by the last TLAS; trace encoders must make them resident.
+    var primitiveAccelerationStructures: [MTLAccelerationStructure] {
+        accelBuilder.primitiveAccelerationStructures
     }
 
     func buildGeometryBuffers(items: [RenderItem],
+                              changes: RenderItemChanges?,
+                              frameSlot: Int,
                               commandBuffer: MTLCommandBuffer) -> RTGeometryBuffers? {
-        guard let state = geometryCache.build(items: items) else {
+        guard let state = geometryCache.build(items: items,
+                                              changes: changes,
+                                              frameSlot: frameSlot,
+                                              commandBuffer: commandBuffer) else {
             lastGeometryState = nil
             return nil
         }
@@ -37,7 +48,8 @@ final class RayTracingScene {
                            outputBuffer: state.buffers.dynamicVertexBuffer,
                            outputNormalBuffer: state.buffers.dynamicNormalBuffer,
                            outputTangentBuffer: state.buffers.dynamicTangentBuffer,
-                           jobs: state.skinningJobs)
+                           jobs: state.skinningJobs,
+                           frameSlot: frameSlot)
         }
         return state.buffers
     }
@@ -28,6 +28,23 @@ struct RTFrameUniformsSwift {
     var envSH6: SIMD3<Float>
     var envSH7: SIMD3<Float>
     var envSH8: SIMD3<Float>
+    var jitter: SIMD2<Float>
+    var temporalEnabled: UInt32
+    var pad3: UInt32
+}
+
+struct RTTemporalUniformsSwift {
+    var invViewProj: matrix_float4x4
+    var prevViewProj: matrix_float4x4
+    var cameraPosition: SIMD3<Float>
+    var pad0: Float
+    var prevCameraPosition: SIMD3<Float>
+    var pad1: Float
+    var inputSize: SIMD2<UInt32>
+    var outputSize: SIMD2<UInt32>
+    var jitter: SIMD2<Float>
+    var maxHistory: Float
+    var historyValid: UInt32
 }
 
 struct RTDirectionalLightSwift {
@@ -46,6 +63,11 @@ struct RTInstanceInfoSwift {
     var indexCount: UInt32
     var bufferIndex: UInt32
     var modelMatrix: matrix_float4x4
+    var materialIndex: UInt32
+    var pad0: SIMD3<UInt32>
+}
+
+struct RTMaterialInfoSwift: Hashable {
     var baseColorFactor: SIMD3<Float>
     var metallicFactor: Float
     var emissiveFactor: SIMD3<Float>
@@ -54,11 +76,12 @@ struct RTInstanceInfoSwift {
     var transmissionFactor: Float
     var ior: Float
     var normalScale: Float
-    var pad2: SIMD3<Float>
+    var alphaCutoff: Float
+    var pad0: SIMD3<Float>
     var baseColorTexIndex: UInt32
     var normalTexIndex: UInt32
     var metallicRoughnessTexIndex: UInt32
     var emissiveTexIndex: UInt32
     var occlusionTexIndex: UInt32
-    var padding1: SIMD3<UInt32>
+    var pad1: SIMD3<UInt32>
 }
@@ -13,13 +13,19 @@ final class RenderContext {
     let device: MTLDevice
 
     let commandQueue: MTLCommandQueue
+    /// Second queue for graph passes that prefer `.async`; nil runs them on the main queue.
+    let asyncCommandQueue: MTLCommandQueue?
+    /// Frames the CPU may run ahead of the GPU; CPU-written buffers keep this many copies.
+    let maxFramesInFlight: Int
 
     init?(view: MTKView, maxFramesInFlight: Int) {
         guard let device = view.device else { return nil }
         self.device = device
 
-        _ = maxFramesInFlight
+        self.maxFramesInFlight = maxFramesInFlight
         self.commandQueue = device.makeCommandQueue()!
+        self.asyncCommandQueue = device.makeCommandQueue()
+        self.asyncCommandQueue?.label = "AsyncCompute"
     }
 
     func prepareResidency(meshes: [GPUMesh], textures: [MTLTexture], uniforms: MTLBuffer) {
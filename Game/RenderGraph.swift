@@ -34,6 +34,8 @@ enum AttachmentResource {
 enum RenderResourceKind: Hashable {
     case external(ObjectIdentifier)
     case temporary(Int)
+    /// Logical resource with no single Metal object, e.g. the RT scene (buffers + TLAS).
+    case named(String)
 }
 
 struct RenderResourceID: Hashable {
@@ -48,6 +50,14 @@ func resourceID(for temp: TemporaryTexture) -> RenderResourceID {
     RenderResourceID(kind: .temporary(temp.id))
 }
 
+func resourceID(for buffer: MTLBuffer) -> RenderResourceID {
+    RenderResourceID(kind: .external(ObjectIdentifier(buffer)))
+}
+
+func resourceID(named name: String) -> RenderResourceID {
+    RenderResourceID(kind: .named(name))
+}
+
 struct ColorAttachment {
     let resource: AttachmentResource
     let loadAction: MTLLoadAction
@@ -96,6 +106,10 @@ struct FrameContext {
 
     let context: RenderContext
     let uniformRing: UniformRingBuffer
+    /// Samples each render pass; nil when GPU timestamps are unavailable.
+    let gpuProfiler: GPUProfiler?
+    /// Times this frame's command buffers for dynamic resolution.
+    let gpuFrame: GPUFrameSpan
 
     let pipelineState: MTLRenderPipelineState
     let depthState: MTLDepthStencilState
@@ -109,16 +123,68 @@ struct FrameContext {
     let viewMatrix: matrix_float4x4
     let cameraPosition: SIMD3<Float>
     let cameraWorldOrigin: SIMD3<Float>
+
+    let rayTracing: RayTracingFrameInput?
+}
+
+/// Where a temporary is first and last touched in the sorted pass list.
+struct TemporaryLifetime {
+    let temp: TemporaryTexture
+    let firstPass: Int
+    let lastPass: Int
 }
 
+/// Frame-persistent temporaries. Each frame's lifetimes are planned once and the plan is
+/// reused while it is unchanged. Private temporaries with disjoint lifetimes alias the
+/// same memory in one placement heap. Other temporaries come from a pool keyed by
+/// descriptor, where disjoint lifetimes share a texture. Aliased
+/// contents are undefined on first use in a frame, so the first pass must clear or fully
+/// overwrite them.
 final class RenderGraphResources {
     private let device: MTLDevice
-    private let view: MTKView
+    private var viewSize: (width: Int, height: Int) = (1, 1)
     private var temporaryTextures: [Int: MTLTexture] = [:]
+    private var planSignature: [PlanEntry] = []
+    private var heap: MTLHeap?
+    private var pool: [PoolKey: [MTLTexture]] = [:]
+    /// Temporaries resolved outside any planned lifetime, by id; kept so they are made once.
+    private var unplanned: [Int: (key: PoolKey, texture: MTLTexture)] = [:]
+
+    private struct PoolKey: Hashable {
+        let pixelFormat: UInt
+        let width: Int
+        let height: Int
+        let usage: UInt
+        let storageMode: UInt
+    }
+
+    private struct PlanEntry: Equatable {
+        let id: Int
+        let key: PoolKey
+        let firstPass: Int
+        let lastPass: Int
+    }
 
-    init(device: MTLDevice, view: MTKView) {
+    init(device: MTLDevice) {
         self.device = device
-        self.view = view
+    }
+
+    /// Assigns textures for this frame's temporaries, replanning only if they changed.
+    func beginFrame(view: MTKView, lifetimes: [TemporaryLifetime]) {
+        viewSize = (max(Int(view.drawableSize.width), 1), max(Int(view.drawableSize.height), 1))
+        let signature = lifetimes.map {
+            PlanEntry(id: $0.temp.id, key: poolKey($0.temp.desc), firstPass: $0.firstPass, lastPass: $0.lastPass)
+        }
+        if signature == planSignature {
+            return
+        }
+        planSignature = signature
+        temporaryTextures.removeAll(keepingCapacity: true)
+
+        let ordered = lifetimes.sorted { ($0.firstPass, $0.temp.id) < ($1.firstPass, $1.temp.id) }
+        let aliased = ordered.filter { $0.temp.desc.storageMode == .private }
+        planHeap(aliased)
+        planPool(ordered.filter { $0.temp.desc.storageMode != .private })
     }
 
     func resolveTexture(_ resource: AttachmentResource) -> MTLTexture {
@@ -129,7 +195,13 @@ final class RenderGraphResources {
             if let tex = temporaryTextures[temp.id] {
                 return tex
             }
+            let key = poolKey(temp.desc)
+            if let cached = unplanned[temp.id], cached.key == key {
+                temporaryTextures[temp.id] = cached.texture
+                return cached.texture
+            }
             let tex = makeTemporaryTexture(temp.desc)
+            unplanned[temp.id] = (key, tex)
             temporaryTextures[temp.id] = tex
             return tex
         }
@@ -139,7 +211,119 @@ final class RenderGraphResources {
         resolveTexture(.temporary(temp))
     }
 
-    private func makeTemporaryTexture(_ desc: TemporaryTextureDescriptor) -> MTLTexture {
+    /// Interval packing into alias slots: a temporary reuses the best-fitting slot whose last
+    /// occupant finished before it starts, growing a free slot only when none fits.
+    private func planHeap(_ lifetimes: [TemporaryLifetime]) {
+        guard !lifetimes.isEmpty else {
+            heap = nil
+            return
+        }
+        struct Slot {
+            var size: Int
+            var busyUntil: Int
+        }
+        var slots: [Slot] = []
+        var slotForTemp: [Int] = []
+        var alignment = 1
+        var descriptors: [MTLTextureDescriptor] = []
+        for lifetime in lifetimes {
+            let td = textureDescriptor(lifetime.temp.desc)
+            let sizeAndAlign = device.heapTextureSizeAndAlign(descriptor: td)
+            alignment = max(alignment, sizeAndAlign.align)
+            descriptors.append(td)
+
+            var best: Int?
+            var largestFree: Int?
+            for (i, slot) in slots.enumerated() where slot.busyUntil < lifetime.firstPass {
+                if slot.size >= sizeAndAlign.size && (best == nil || slot.size < slots[best!].size) {
+                    best = i
+                }
+                if largestFree == nil || slot.size > slots[largestFree!].size {
+                    largestFree = i
+                }
+            }
+            let index: Int
+            if let best {
+                index = best
+            } else if let largestFree {
+                index = largestFree
+                slots[index].size = sizeAndAlign.size
+            } else {
+                index = slots.count
+                slots.append(Slot(size: sizeAndAlign.size, busyUntil: -1))
+            }
+            slots[index].busyUntil = lifetime.lastPass
+            slotForTemp.append(index)
+        }
+
+        var offsets: [Int] = []
+        var total = 0
+        for slot in slots {
+            offsets.append(total)
+            total += (slot.size + alignment - 1) / alignment * alignment
+        }
+
+        if heap == nil || heap!.size < total {
+            let hd = MTLHeapDescriptor()
+            hd.type = .placement
+            hd.storageMode = .private
+            // Tracked so aliased occupants of a slot are ordered against each other.
+            hd.hazardTrackingMode = .tracked
+            hd.size = total
+            heap = device.makeHeap(descriptor: hd)
+            heap?.label = "RenderGraphTransients"
+        }
+        for (i, lifetime) in lifetimes.enumerated() {
+            let tex = heap?.makeTexture(descriptor: descriptors[i], offset: offsets[slotForTemp[i]])
+                ?? makeTemporaryTexture(lifetime.temp.desc)
+            tex.label = lifetime.temp.desc.label
+            temporaryTextures[lifetime.temp.id] = tex
+        }
+    }
+
+    private func planPool(_ lifetimes: [TemporaryLifetime]) {
+        var busyUntil: [PoolKey: [Int]] = [:]
+        var used: [PoolKey: Int] = [:]
+        for lifetime in lifetimes {
+            let key = poolKey(lifetime.temp.desc)
+            var busy = busyUntil[key, default: []]
+            var textures = pool[key, default: []]
+            let index: Int
+            if let free = busy.firstIndex(where: { $0 < lifetime.firstPass }) {
+                index = free
+            } else {
+                index = busy.count
+                busy.append(-1)
+                if index >= textures.count {
+                    textures.append(makeTemporaryTexture(lifetime.temp.desc))
+                }
+            }
+            busy[index] = lifetime.lastPass
+            busyUntil[key] = busy
+            pool[key] = textures
+            used[key] = max(used[key] ?? 0, index + 1)
+            temporaryTextures[lifetime.temp.id] = textures[index]
+        }
+        for key in Array(pool.keys) {
+            let count = used[key] ?? 0
+            if count == 0 {
+                pool[key] = nil
+            } else if pool[key]!.count > count {
+                pool[key]!.removeLast(pool[key]!.count - count)
+            }
+        }
+    }
+
+    private func poolKey(_ desc: TemporaryTextureDescriptor) -> PoolKey {
+        let size = resolveSize(desc.size)
+        return PoolKey(pixelFormat: desc.pixelFormat.rawValue,
+                       width: size.width,
+                       height: size.height,
+                       usage: desc.usage.rawValue,
+                       storageMode: desc.storageMode.rawValue)
+    }
+
+    private func textureDescriptor(_ desc: TemporaryTextureDescriptor) -> MTLTextureDescriptor {
         let size = resolveSize(desc.size)
         let td = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: desc.pixelFormat,
                                                           width: size.width,
@@ -147,7 +331,11 @@ final class RenderGraphResources {
                                                           mipmapped: false)
         td.usage = desc.usage
         td.storageMode = desc.storageMode
-        let tex = device.makeTexture(descriptor: td)!
+        return td
+    }
+
+    private func makeTemporaryTexture(_ desc: TemporaryTextureDescriptor) -> MTLTexture {
+        let tex = device.makeTexture(descriptor: textureDescriptor(desc))!
         tex.label = desc.label
         return tex
     }
@@ -155,9 +343,7 @@ final class RenderGraphResources {
     private func resolveSize(_ size: RenderTargetSize) -> (width: Int, height: Int) {
         switch size {
         case .view:
-            let w = max(Int(view.drawableSize.width), 1)
-            let h = max(Int(view.drawableSize.height), 1)
-            return (w, h)
+            return viewSize
         case .absolute(let width, let height):
             return (max(width, 1), max(height, 1))
         }
@@ -180,9 +366,45 @@ extension RenderPass {
     }
 }
 
+enum RenderPassQueue {
+    case main
+    /// Runs on `RenderContext.asyncCommandQueue` when every producer it reads from is also
+    /// async; otherwise falls back to the main queue.
+    case async
+}
+
+/// A graph node that records its own compute, blit or acceleration-structure encoders.
+/// It is culled and ordered by its declared reads and writes like a render pass.
+protocol CommandPass: RenderPass {
+    var preferredQueue: RenderPassQueue { get }
+    func encode(frame: FrameContext, resources: RenderGraphResources, commandBuffer: MTLCommandBuffer)
+}
+
+extension CommandPass {
+    var preferredQueue: RenderPassQueue { .main }
+
+    func makeTarget(frame: FrameContext) -> RenderTargetSource? {
+        nil
+    }
+
+    func encode(frame: FrameContext, resources: RenderGraphResources, encoder: MTLRenderCommandEncoder) {
+        _ = frame
+        _ = resources
+        _ = encoder
+    }
+}
+
 final class RenderGraph {
     private var passes: [RenderPass] = []
     private var nextTempID: Int = 0
+    private var temporaries: [Int: TemporaryTexture] = [:]
+    private var resources: RenderGraphResources?
+    /// Orders the async and main command buffers. Values only increase.
+    private var queueEvent: MTLSharedEvent?
+    private var queueEventValue: UInt64 = 0
+    /// Signalled on the main queue once it is done with the last frame's async outputs;
+    /// the next async command buffer waits on it before overwriting them.
+    private var asyncReleaseValue: UInt64 = 0
 
     func addPass(_ pass: RenderPass) {
         passes.append(pass)
@@ -190,7 +412,9 @@ final class RenderGraph {
 
     func makeTemporaryTexture(_ desc: TemporaryTextureDescriptor) -> TemporaryTexture {
         defer { nextTempID += 1 }
-        return TemporaryTexture(id: nextTempID, desc: desc)
+        let temp = TemporaryTexture(id: nextTempID, desc: desc)
+        temporaries[temp.id] = temp
+        return temp
     }
 
     func execute(frame: FrameContext, view: MTKView, commandBuffer: MTLCommandBuffer) {
@@ -198,15 +422,64 @@ final class RenderGraph {
         let livePasses = pruneUnusedPasses(passInfos: passInfos)
         let orderedPasses = sortPasses(passInfos: livePasses)
 
-        let resources = RenderGraphResources(device: frame.context.device, view: view)
+        let resources = self.resources ?? RenderGraphResources(device: frame.context.device)
+        self.resources = resources
+        resources.beginFrame(view: view, lifetimes: temporaryLifetimes(orderedPasses: orderedPasses))
+
+        let asyncPasses = asyncPassIndices(orderedPasses: orderedPasses, frame: frame)
+        var asyncDoneValue: UInt64?
+        if !asyncPasses.isEmpty,
+           let asyncQueue = frame.context.asyncCommandQueue,
+           let asyncBuffer = asyncQueue.makeCommandBuffer(),
+           let event = makeQueueEventIfNeeded(device: frame.context.device) {
+            asyncBuffer.label = "Async"
+            if asyncReleaseValue > 0 {
+                asyncBuffer.encodeWaitForEvent(event, value: asyncReleaseValue)
+            }
+            for info in orderedPasses where asyncPasses.contains(info.index) {
+                (info.pass as? CommandPass)?.encode(frame: frame, resources: resources, commandBuffer: asyncBuffer)
+            }
+            queueEventValue += 1
+            asyncBuffer.encodeSignalEvent(event, value: queueEventValue)
+            frame.gpuFrame.track(asyncBuffer)
+            asyncBuffer.commit()
+            asyncDoneValue = queueEventValue
+        }
+        let encodedAsync: Set<Int> = asyncDoneValue == nil ? [] : asyncPasses
+
+        // Main passes reading async outputs wait for them once; after the last such pass,
+        // signal that the async queue may start overwriting them for the next frame.
+        let asyncWrites = orderedPasses
+            .filter { encodedAsync.contains($0.index) }
+            .reduce(into: Set<RenderResourceID>()) { $0.formUnion($1.writes) }
+        let lastConsumer = orderedPasses.lastIndex { info in
+            !encodedAsync.contains(info.index) && !info.reads.isDisjoint(with: asyncWrites)
+        }
+        var waited = false
 
-        for info in orderedPasses {
+        for (position, info) in orderedPasses.enumerated() where !encodedAsync.contains(info.index) {
+            if let asyncDoneValue, let event = queueEvent, !waited, !info.reads.isDisjoint(with: asyncWrites) {
+                commandBuffer.encodeWaitForEvent(event, value: asyncDoneValue)
+                waited = true
+            }
+            defer {
+                if position == lastConsumer, let event = queueEvent {
+                    queueEventValue += 1
+                    commandBuffer.encodeSignalEvent(event, value: queueEventValue)
+                    asyncReleaseValue = queueEventValue
+                }
+            }
+            if let command = info.pass as? CommandPass {
+                command.encode(frame: frame, resources: resources, commandBuffer: commandBuffer)
+                continue
+            }
             guard let target = info.pass.makeTarget(frame: frame) else { continue }
             guard let rpd = makeRenderPassDescriptor(pass: info.pass,
                                                      target: target,
                                                      frame: frame,
                                                      view: view,
                                                      resources: resources) else { continue }
+            frame.gpuProfiler?.attach(to: rpd, scope: info.pass.name)
             guard let enc = commandBuffer.makeRenderCommandEncoder(descriptor: rpd) else { continue }
             enc.label = info.pass.name
             info.pass.encode(frame: frame, resources: resources, encoder: enc)
@@ -214,6 +487,34 @@ final class RenderGraph {
         }
     }
 
+    private func makeQueueEventIfNeeded(device: MTLDevice) -> MTLSharedEvent? {
+        if queueEvent == nil {
+            queueEvent = device.makeSharedEvent()
+        }
+        return queueEvent
+    }
+
+    /// Async-preferring command passes whose producers are all async too, so the async
+    /// command buffer never waits on the main one within a frame.
+    private func asyncPassIndices(orderedPasses: [PassInfo], frame: FrameContext) -> Set<Int> {
+        guard frame.context.asyncCommandQueue != nil else { return [] }
+        var writers: [RenderResourceID: [Int]] = [:]
+        for info in orderedPasses {
+            for res in info.writes {
+                writers[res, default: []].append(info.index)
+            }
+        }
+        var async: Set<Int> = []
+        for info in orderedPasses {
+            guard let command = info.pass as? CommandPass, command.preferredQueue == .async else { continue }
+            let producers = info.reads.flatMap { writers[$0] ?? [] }.filter { $0 != info.index }
+            if producers.allSatisfy({ async.contains($0) }) {
+                async.insert(info.index)
+            }
+        }
+        return async
+    }
+
     private func makeRenderPassDescriptor(pass: RenderPass,
                                           target: RenderTargetSource,
                                           frame: FrameContext,
@@ -252,6 +553,42 @@ final class RenderGraph {
         }
     }
 
+    /// First and last position in `orderedPasses` at which each temporary is read, written
+    /// or attached.
+    private func temporaryLifetimes(orderedPasses: [PassInfo]) -> [TemporaryLifetime] {
+        var spans: [Int: (first: Int, last: Int)] = [:]
+        func touch(_ id: Int, _ position: Int) {
+            if let span = spans[id] {
+                spans[id] = (span.first, max(span.last, position))
+            } else {
+                spans[id] = (position, position)
+            }
+        }
+        for (position, info) in orderedPasses.enumerated() {
+            for res in info.reads.union(info.writes) {
+                if case .temporary(let id) = res.kind {
+                    touch(id, position)
+                }
+            }
+            guard case .offscreen(let rt)? = info.target else { continue }
+            var attachments = rt.colorAttachments.map { $0.resource }
+            if let depth = rt.depthAttachment {
+                attachments.append(depth.resource)
+            }
+            if let stencil = rt.stencilAttachment {
+                attachments.append(stencil.resource)
+            }
+            for case .temporary(let temp) in attachments {
+                temporaries[temp.id] = temp
+                touch(temp.id, position)
+            }
+        }
+        return spans.compactMap { id, span in
+            temporaries[id].map { TemporaryLifetime(temp: $0, firstPass: span.first, lastPass: span.last) }
+        }
+        .sorted { $0.temp.id < $1.temp.id }
+    }
+
     private struct PassInfo {
         let pass: RenderPass
         let index: Int
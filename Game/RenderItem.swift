@@ -10,13 +10,13 @@ import simd
 public struct RenderItem {
     public var mesh: GPUMesh?
     public var skinnedMesh: SkinnedMeshDescriptor?
-    public var skinningPalette: [matrix_float4x4]?
+    public var skinningPalette: SkinningPalette?
     public var material: Material
     public var modelMatrix: matrix_float4x4
 
     public init(mesh: GPUMesh?,
                 skinnedMesh: SkinnedMeshDescriptor? = nil,
-                skinningPalette: [matrix_float4x4]? = nil,
+                skinningPalette: SkinningPalette? = nil,
                 material: Material,
                 modelMatrix: matrix_float4x4) {
         self.mesh = mesh
@@ -26,3 +26,81 @@ public struct RenderItem {
         self.modelMatrix = modelMatrix
     }
 }
+
+/// What the last extraction changed in a scene's `renderItems`.
+public struct RenderItemChanges {
+    /// Bumped when items were added, removed or reordered, or an item's mesh or material
+    /// changed. Consumers compare it with the value they last built from, so a skipped
+    /// frame cannot hide a change; index-keyed caches must rebuild when it moves.
+    public var structureVersion: UInt64
+    /// Items whose `modelMatrix` changed without a structure change. A camera move
+    /// lists every item (render positions are camera-relative).
+    public var transformed: [Int]
+    /// Items whose skinning palette (pose revision or LOD) changed without a structure change.
+    public var posed: [Int]
+
+    public init(structureVersion: UInt64 = 0, transformed: [Int] = [], posed: [Int] = []) {
+        self.structureVersion = structureVersion
+        self.transformed = transformed
+        self.posed = posed
+    }
+}
+
+/// Bone matrices of a skinned item, resolved only when written to the GPU: `bones[i] *
+/// invBind[i]` when an inverse bind pose is given, else `bones` as is. Holding the pose
+/// arrays (copy-on-write) spares building a palette array per item every frame.
+public struct SkinningPalette {
+    /// Items with the same id (the parts of one skinned group) share a single GPU palette.
+    public var id: UInt32
+    public var bones: [matrix_float4x4]
+    public var invBind: [matrix_float4x4]?
+    /// `PoseComponent.revision`: the RT path reskins only when this changes.
+    public var revision: UInt32
+    /// Bone influences per vertex for the skinning LOD (4, or 1 for the dominant bone).
+    public var boneInfluences: Int
+
+    public init(id: UInt32,
+                bones: [matrix_float4x4],
+                invBind: [matrix_float4x4]? = nil,
+                revision: UInt32 = 0,
+                boneInfluences: Int = 4) {
+        self.id = id
+        self.bones = bones
+        self.invBind = invBind?.count == bones.count ? invBind : nil
+        self.revision = revision
+        self.boneInfluences = boneInfluences
+    }
+
+    public var count: Int { bones.count }
+
+    /// `pose`'s model matrices against `invBind` when the bone counts match, else its palette.
+    static func resolve(entity: Entity,
+                        pose: PoseComponent,
+                        invBind: [matrix_float4x4]?,
+                        lod: AnimationLOD = .full) -> SkinningPalette {
+        if let invBind, invBind.count == pose.model.count {
+            return SkinningPalette(id: entity.id, bones: pose.model, invBind: invBind,
+                                   revision: pose.revision, boneInfluences: lod.boneInfluences)
+        }
+        return SkinningPalette(id: entity.id, bones: pose.palette,
+                               revision: pose.revision, boneInfluences: lod.boneInfluences)
+    }
+
+    /// Writes the `count` palette matrices to `dst`.
+    func write(to dst: UnsafeMutableRawPointer) {
+        let out = dst.bindMemory(to: matrix_float4x4.self, capacity: bones.count)
+        bones.withUnsafeBufferPointer { b in
+            guard let invBind else {
+                if let base = b.baseAddress {
+                    out.update(from: base, count: b.count)
+                }
+                return
+            }
+            invBind.withUnsafeBufferPointer { ib in
+                for i in 0..<b.count {
+                    out[i] = simd_mul(b[i], ib[i])
+                }
+            }
+        }
+    }
+}
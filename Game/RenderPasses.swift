@@ -6,50 +6,119 @@
 //
 
 import Metal
+import simd
 
+/// View-frustum and distance test for raster items, against bounding spheres.
+private struct RasterCulling {
+    /// Inward planes (xyz normal, w distance) of `projection * view`, Metal clip depth [0, 1].
+    private let planes: [SIMD4<Float>]
+    private let view: matrix_float4x4
+    private let maxDistance: Float
+
+    init(projection: matrix_float4x4, view: matrix_float4x4, maxDistance: Float) {
+        let m = projection * view
+        let r0 = SIMD4<Float>(m.columns.0.x, m.columns.1.x, m.columns.2.x, m.columns.3.x)
+        let r1 = SIMD4<Float>(m.columns.0.y, m.columns.1.y, m.columns.2.y, m.columns.3.y)
+        let r2 = SIMD4<Float>(m.columns.0.z, m.columns.1.z, m.columns.2.z, m.columns.3.z)
+        let r3 = SIMD4<Float>(m.columns.0.w, m.columns.1.w, m.columns.2.w, m.columns.3.w)
+        self.planes = [r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2].map { plane in
+            let length = simd_length(SIMD3<Float>(plane.x, plane.y, plane.z))
+            return length > 0 ? plane / length : plane
+        }
+        self.view = view
+        self.maxDistance = maxDistance
+    }
+
+    func isVisible(_ mesh: GPUMesh, model: matrix_float4x4) -> Bool {
+        let center = model * SIMD4<Float>(mesh.boundingCenter, 1)
+        let scale = max(simd_length(SIMD3<Float>(model.columns.0.x, model.columns.0.y, model.columns.0.z)),
+                        simd_length(SIMD3<Float>(model.columns.1.x, model.columns.1.y, model.columns.1.z)),
+                        simd_length(SIMD3<Float>(model.columns.2.x, model.columns.2.y, model.columns.2.z)))
+        let radius = mesh.boundingRadius * scale
+        for plane in planes where simd_dot(plane, center) < -radius {
+            return false
+        }
+        if maxDistance.isFinite {
+            let viewCenter = view * center
+            if -viewCenter.z - radius > maxDistance { return false }
+        }
+        return true
+    }
+}
+
+/// Culls `items`, writes the pass uniforms once and one `DrawInstance` per visible item,
+/// then issues one instanced draw per run of consecutive items sharing mesh, textures and
+/// raster state. Runs keep item order, so blended items still draw back to front.
 private func encodeItems(_ items: [RenderItem],
                          frame: FrameContext,
-                         encoder: MTLRenderCommandEncoder) {
+                         encoder: MTLRenderCommandEncoder,
+                         maxDistance: Float = .infinity) {
+    let culling = RasterCulling(projection: frame.projection, view: frame.viewMatrix, maxDistance: maxDistance)
+    var visible: [(mesh: GPUMesh, item: RenderItem)] = []
+    visible.reserveCapacity(items.count)
     for item in items {
-        guard let mesh = item.mesh else { continue }
-        encoder.setCullMode(item.material.cullMode)
-        encoder.setFrontFacing(item.material.frontFacing)
-
-        let u = frame.uniformRing.allocate()
-        writeUniforms(u.pointer,
-                      projection: frame.projection,
-                      view: frame.viewMatrix,
-                      model: item.modelMatrix,
-                      baseColorFactor: item.material.baseColorFactor,
-                      baseAlpha: item.material.alpha,
-                      emissiveFactor: item.material.emissiveFactor,
-                      unlit: item.material.unlit,
-                      normalScale: item.material.normalScale,
-                      occlusionStrength: item.material.occlusionStrength,
-                      exposure: item.material.exposure,
-                      toneMapEnabled: item.material.toneMapped,
-                      cameraPosition: frame.cameraPosition,
-                      worldOrigin: frame.cameraWorldOrigin)
-
-        let tex = item.material.baseColorTexture?.texture ?? frame.fallbackWhite.texture
-        let normalTex = item.material.normalTexture?.texture ?? frame.fallbackNormal.texture
-        let emissiveTex = item.material.emissiveTexture?.texture ?? frame.fallbackEmissive.texture
-        let occlusionTex = item.material.occlusionTexture?.texture ?? frame.fallbackOcclusion.texture
+        guard let mesh = item.mesh, culling.isVisible(mesh, model: item.modelMatrix) else { continue }
+        visible.append((mesh, item))
+    }
+    if visible.isEmpty { return }
+
+    guard let u = frame.uniformRing.allocate(Uniforms.self),
+          let instances = frame.uniformRing.allocate(DrawInstance.self, count: visible.count) else { return }
+    writeUniforms(u.pointer,
+                  projection: frame.projection,
+                  view: frame.viewMatrix,
+                  cameraPosition: frame.cameraPosition,
+                  worldOrigin: frame.cameraWorldOrigin)
+    for (i, entry) in visible.enumerated() {
+        writeDrawInstance(instances.pointer + i, model: entry.item.modelMatrix, material: entry.item.material)
+    }
+
+    encoder.setVertexBuffer(u.buffer, offset: u.offset, index: BufferIndex.uniforms.rawValue)
+    encoder.setFragmentBuffer(u.buffer, offset: u.offset, index: BufferIndex.uniforms.rawValue)
+    encoder.setVertexBuffer(instances.buffer, offset: instances.offset, index: BufferIndex.drawInstances.rawValue)
+    encoder.setFragmentBuffer(instances.buffer, offset: instances.offset, index: BufferIndex.drawInstances.rawValue)
+
+    func textures(_ material: Material) -> [MTLTexture] {
+        [material.baseColorTexture?.texture ?? frame.fallbackWhite.texture,
+         material.normalTexture?.texture ?? frame.fallbackNormal.texture,
+         material.emissiveTexture?.texture ?? frame.fallbackEmissive.texture,
+         material.occlusionTexture?.texture ?? frame.fallbackOcclusion.texture]
+    }
+
+    var first = 0
+    while first < visible.count {
+        let mesh = visible[first].mesh
+        let material = visible[first].item.material
+        let tex = textures(material)
+        var end = first + 1
+        while end < visible.count,
+              visible[end].mesh === mesh,
+              visible[end].item.material.cullMode == material.cullMode,
+              visible[end].item.material.frontFacing == material.frontFacing,
+              zip(textures(visible[end].item.material), tex).allSatisfy({ $0 === $1 }) {
+            end += 1
+        }
+
+        encoder.setCullMode(material.cullMode)
+        encoder.setFrontFacing(material.frontFacing)
+        let instanceOffset = instances.offset + first * MemoryLayout<DrawInstance>.stride
+        encoder.setVertexBufferOffset(instanceOffset, index: BufferIndex.drawInstances.rawValue)
+        encoder.setFragmentBufferOffset(instanceOffset, index: BufferIndex.drawInstances.rawValue)
         encoder.setVertexBuffer(mesh.vertexBuffer, offset: 0, index: BufferIndex.meshVertices.rawValue)
-        encoder.setVertexBuffer(u.buffer, offset: u.offset, index: BufferIndex.uniforms.rawValue)
-        encoder.setFragmentBuffer(u.buffer, offset: u.offset, index: BufferIndex.uniforms.rawValue)
-        encoder.setFragmentTexture(tex, index: TextureIndex.baseColor.rawValue)
-        encoder.setFragmentTexture(normalTex, index: TextureIndex.normal.rawValue)
-        encoder.setFragmentTexture(emissiveTex, index: TextureIndex.emissive.rawValue)
-        encoder.setFragmentTexture(occlusionTex, index: TextureIndex.occlusion.rawValue)
+        encoder.setFragmentTexture(tex[0], index: TextureIndex.baseColor.rawValue)
+        encoder.setFragmentTexture(tex[1], index: TextureIndex.normal.rawValue)
+        encoder.setFragmentTexture(tex[2], index: TextureIndex.emissive.rawValue)
+        encoder.setFragmentTexture(tex[3], index: TextureIndex.occlusion.rawValue)
 
         encoder.drawIndexedPrimitives(
             type: .triangle,
             indexCount: mesh.indexCount,
             indexType: mesh.indexType,
             indexBuffer: mesh.indexBuffer,
-            indexBufferOffset: 0
+            indexBufferOffset: 0,
+            instanceCount: end - first
         )
+        first = end
     }
 }
 
@@ -72,7 +141,56 @@ final class MainPass: RenderPass {
         encoder.setRenderPipelineState(frame.pipelineState)
         encoder.setDepthStencilState(frame.depthState)
 
-        encodeItems(frame.items, frame: frame, encoder: encoder)
+        encodeItems(frame.items, frame: frame, encoder: encoder, maxDistance: frame.scene.rasterDrawDistance)
+    }
+}
+
+/// Geometry uploads, skinning and BLAS/TLAS builds. Prefers the async queue so the next
+/// frame's scene work can overlap this frame's composite and UI.
+final class RayTracingScenePass: CommandPass {
+    static let sceneResource = resourceID(named: "RayTracingScene")
+
+    let name = "Ray Tracing Scene"
+    let preferredQueue: RenderPassQueue = .async
+    private let rayTracing: RayTracingRenderer
+
+    init(rayTracing: RayTracingRenderer) {
+        self.rayTracing = rayTracing
+    }
+
+    func readResources(frame: FrameContext) -> [RenderResourceID] {
+        []
+    }
+
+    func writeResources(frame: FrameContext) -> [RenderResourceID] {
+        frame.rayTracing == nil ? [] : [RayTracingScenePass.sceneResource]
+    }
+
+    func encode(frame: FrameContext, resources: RenderGraphResources, commandBuffer: MTLCommandBuffer) {
+        guard let input = frame.rayTracing else { return }
+        rayTracing.encodeScene(commandBuffer: commandBuffer, input: input)
+    }
+}
+
+final class RayTracingTracePass: CommandPass {
+    let name = "Ray Tracing"
+    private let rayTracing: RayTracingRenderer
+
+    init(rayTracing: RayTracingRenderer) {
+        self.rayTracing = rayTracing
+    }
+
+    func readResources(frame: FrameContext) -> [RenderResourceID] {
+        frame.rayTracing == nil ? [] : [RayTracingScenePass.sceneResource]
+    }
+
+    func writeResources(frame: FrameContext) -> [RenderResourceID] {
+        frame.rayTracing.map { [resourceID(for: $0.outputTexture)] } ?? []
+    }
+
+    func encode(frame: FrameContext, resources: RenderGraphResources, commandBuffer: MTLCommandBuffer) {
+        guard let input = frame.rayTracing else { return }
+        rayTracing.encodeTrace(commandBuffer: commandBuffer, input: input)
     }
 }
 
@@ -84,7 +202,7 @@ final class CompositePass: RenderPass {
     }
 
     func readResources(frame: FrameContext) -> [RenderResourceID] {
-        []
+        frame.rayTracing.map { [resourceID(for: $0.outputTexture)] } ?? []
     }
 
     func writeResources(frame: FrameContext) -> [RenderResourceID] {
@@ -27,6 +27,10 @@ public protocol RenderScene: AnyObject {
     /// Increment this when renderItems/resources change (mesh/texture/material changes).
     var revision: UInt64 { get }
 
+    /// Change set of the last update, for scenes that extract incrementally; nil means
+    /// untracked, and consumers rebuild from `renderItems` each frame.
+    var renderChanges: RenderItemChanges? { get }
+
     /// Tone mapping exposure (applied in composite pass).
     var toneMappingExposure: Float { get }
     /// Enable/disable tone mapping in composite pass.
@@ -37,6 +41,21 @@ public protocol RenderScene: AnyObject {
 
     /// RT resolution scale (1.0 = full res, 0.5 = quarter pixels).
     var rtResolutionScale: Float { get }
+    /// Accumulate RT over frames: trace at `rtResolutionScale` with jitter, and reproject
+    /// and upscale into a full-resolution result.
+    var rtTemporalEnabled: Bool { get }
+    /// Trace reflections, refractions and shadows as separate queued dispatches; faster
+    /// when only part of the screen is glossy or transmissive.
+    var rtWavefrontEnabled: Bool { get }
+    /// Resolve blended and alpha-tested instances with intersection functions during
+    /// traversal instead of re-intersecting per transparent layer.
+    var rtAlphaFunctionsEnabled: Bool { get }
+    /// Drive the RT scale from GPU frame time: it moves between 0.25 and
+    /// `rtResolutionScale` to hold `rtTargetFrameMilliseconds`.
+    var rtDynamicResolutionEnabled: Bool { get }
+    var rtTargetFrameMilliseconds: Float { get }
+    /// Raster items whose bounds lie entirely beyond this view distance are not drawn.
+    var rasterDrawDistance: Float { get }
 
     func viewportDidChange(size: SIMD2<Float>)
 }
@@ -46,8 +65,15 @@ extension RenderScene {
         _ = size
     }
 
+    var renderChanges: RenderItemChanges? { nil }
     var toneMappingExposure: Float { 1.0 }
     var toneMappingEnabled: Bool { true }
     var directionalLights: [DirectionalLight] { [] }
     var rtResolutionScale: Float { 1.0 }
+    var rtTemporalEnabled: Bool { false }
+    var rtWavefrontEnabled: Bool { false }
+    var rtAlphaFunctionsEnabled: Bool { false }
+    var rtDynamicResolutionEnabled: Bool { false }
+    var rtTargetFrameMilliseconds: Float { 1000.0 / 60.0 }
+    var rasterDrawDistance: Float { .infinity }
 }
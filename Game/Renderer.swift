@@ -16,6 +16,10 @@ final class Renderer: NSObject, MTKViewDelegate {
     private let context: RenderContext
     private let frameSync: FrameSync
     private let uniformRing: UniformRingBuffer
+    private let profiler: FrameProfiler
+    private let gpuProfiler: GPUProfiler?
+    private let gpuFrameTimer = GPUFrameTimer()
+    private let dynamicResolution = DynamicResolutionController()
 
     // Main pipeline (still available for raster fallback)
     private let pipelineState: MTLRenderPipelineState
@@ -31,6 +35,8 @@ final class Renderer: NSObject, MTKViewDelegate {
     private var scene: RenderScene?
     private var sceneContext: SceneContext
     private var lastSceneRevision: UInt64 = 0
+    /// `RenderItemChanges.structureVersion` the residency set was built from.
+    private var lastItemStructureVersion: UInt64?
 
     private let compositePass = CompositePass()
     private let uiPass = UIPass()
@@ -49,7 +55,11 @@ final class Renderer: NSObject, MTKViewDelegate {
     init?(metalKitView: MTKView) {
         guard let device = metalKitView.device else { return nil }
         self.device = device
-        self.sceneContext = SceneContext(device: device)
+        let sceneContext = SceneContext(device: device)
+        self.sceneContext = sceneContext
+        self.profiler = sceneContext.profiler
+        let gpuProfiler = GPUProfiler(device: device, profiler: sceneContext.profiler)
+        self.gpuProfiler = gpuProfiler
 
         metalKitView.depthStencilPixelFormat = .depth32Float_stencil8
         metalKitView.colorPixelFormat = .bgra8Unorm_srgb
@@ -60,7 +70,7 @@ final class Renderer: NSObject, MTKViewDelegate {
 
         self.frameSync = FrameSync(device: device, maxFramesInFlight: maxBuffersInFlight)
 
-        // IMPORTANT: use per-draw allocator ring (you already have beginFrame/allocate)
+        // Per-frame linear allocator for pass uniforms and instance data; grows on demand
         guard let ring = UniformRingBuffer(device: device, maxFramesInFlight: maxBuffersInFlight) else { return nil }
         self.uniformRing = ring
 
@@ -107,8 +117,10 @@ final class Renderer: NSObject, MTKViewDelegate {
                                                          occlusion: 1.0),
             label: "FallbackOcclusion"
         )
-        guard let rt = RayTracingRenderer(device: device) else { return nil }
+        guard let rt = RayTracingRenderer(device: device, profiler: gpuProfiler) else { return nil }
         self.rayTracing = rt
+        self.renderGraph.addPass(RayTracingScenePass(rayTracing: rt))
+        self.renderGraph.addPass(RayTracingTracePass(rayTracing: rt))
         self.renderGraph.addPass(compositePass)
         self.renderGraph.addPass(uiPass)
 
@@ -120,17 +132,26 @@ final class Renderer: NSObject, MTKViewDelegate {
 
     // External API: plug a scene
     func setScene(_ scene: RenderScene) {
+        if self.scene != nil {
+            // The old scene's materials are uploaded; its generated pixels are not needed.
+            ProceduralTextureGenerator.clearCache()
+        }
         self.scene = scene
         scene.build(context: sceneContext)
         lastSceneRevision = 0 // force rebuild on next draw
+        lastItemStructureVersion = nil
     }
 
     // MARK: - Residency
 
     private func rebuildResidencyIfNeeded(items: [RenderItem]) {
         guard let scene = scene else { return }
-        if scene.revision == lastSceneRevision { return }
+        // Item structure changes (streamed or removed entities) can change the mesh and
+        // texture set without a revision bump; transform and pose changes never do.
+        let structureVersion = scene.renderChanges?.structureVersion
+        if scene.revision == lastSceneRevision && structureVersion == lastItemStructureVersion { return }
         lastSceneRevision = scene.revision
+        lastItemStructureVersion = structureVersion
 
         let meshes = items.compactMap { $0.mesh }
         let textures = items.flatMap { item in
@@ -155,14 +176,23 @@ final class Renderer: NSObject, MTKViewDelegate {
 
     func draw(in view: MTKView) {
         guard let scene = scene else { return }
-        guard let drawable = view.currentDrawable else { return }
-        guard let commandBuffer = context.commandQueue.makeCommandBuffer() else { return }
 
         let now = CACurrentMediaTime()
         let dt = Float(max(0.0, min(now - lastTime, 0.1)))
         lastTime = now
 
-        scene.update(dt: dt)
+        profiler.beginFrame()
+        // Simulate while up to maxBuffersInFlight earlier frames are still on the GPU; only
+        // writing this slot's buffers has to wait for the frame that last used them.
+        profiler.measure("Scene Update") { scene.update(dt: dt) }
+        guard profiler.measure("Frame Wait", { frameSync.waitIfNeeded() }) else { return }
+        let frameSlot = frameSync.slot
+        gpuProfiler?.beginFrame(slot: frameSlot)
+
+        guard let drawable = view.currentDrawable else { return }
+        guard let commandBuffer = context.commandQueue.makeCommandBuffer() else { return }
+        // Materials created since the last frame: their mips come before anything samples them.
+        TextureResource.encodePendingMipmaps(commandBuffer: commandBuffer)
 
         let items = scene.renderItems
         let overlayItems = scene.overlayItems
@@ -172,20 +202,35 @@ final class Renderer: NSObject, MTKViewDelegate {
         let projection = scene.camera.projection
         let viewM = scene.camera.view
 
-        let rtScale = max(0.25, min(scene.rtResolutionScale, 1.0))
-        updateRTTargetIfNeeded(view: view, scale: rtScale)
-        if let rtTarget = rtColorTexture {
-            rayTracing.encode(commandBuffer: commandBuffer,
-                              outputTexture: rtTarget,
-                              outputSize: CGSize(width: rtTarget.width, height: rtTarget.height),
-                              items: items,
-                              lights: scene.directionalLights,
-                              camera: scene.camera,
-                              projection: projection,
-                              viewMatrix: viewM)
+        // rtResolutionScale is the fixed scale, or the upper bound in dynamic mode.
+        let maxScale = max(0.25, min(scene.rtResolutionScale, 1.0))
+        let rtScale: Float
+        if scene.rtDynamicResolutionEnabled {
+            dynamicResolution.maxScale = maxScale
+            dynamicResolution.targetMilliseconds = Double(scene.rtTargetFrameMilliseconds)
+            rtScale = dynamicResolution.update(gpuMilliseconds: gpuFrameTimer.take())
+        } else {
+            rtScale = maxScale
+        }
+        let rtTemporal = scene.rtTemporalEnabled
+        // The target is always full size; the trace covers rtScale of it and is upscaled.
+        updateRTTargetIfNeeded(view: view)
+        let rtInput = rtColorTexture.map {
+            RayTracingFrameInput(items: items,
+                                 changes: scene.renderChanges,
+                                 lights: scene.directionalLights,
+                                 camera: scene.camera,
+                                 projection: projection,
+                                 viewMatrix: viewM,
+                                 outputTexture: $0,
+                                 frameSlot: frameSlot,
+                                 temporal: rtTemporal,
+                                 traceScale: rtScale,
+                                 wavefront: scene.rtWavefrontEnabled,
+                                 alphaFunctions: scene.rtAlphaFunctionsEnabled)
         }
 
-        _ = uniformRing.beginFrame()
+        _ = uniformRing.beginFrame(slot: frameSlot)
 
         let overlayProjection = orthoRH(left: 0,
                                         right: Float(view.drawableSize.width),
@@ -202,12 +247,15 @@ final class Renderer: NSObject, MTKViewDelegate {
         let cameraWorldOrigin = SIMD3<Float>(Float(cameraWorld.x),
                                              Float(cameraWorld.y),
                                              Float(cameraWorld.z))
+        let gpuFrame = gpuFrameTimer.beginFrame()
         let frame = FrameContext(scene: scene,
                                  items: [],
                                  compositeItems: compositeItems,
                                  overlayItems: overlayItems,
                                  context: context,
                                  uniformRing: uniformRing,
+                                 gpuProfiler: gpuProfiler,
+                                 gpuFrame: gpuFrame,
                                  pipelineState: pipelineState,
                                  depthState: uiDepthState,
                                  fallbackWhite: fallbackWhite,
@@ -217,33 +265,40 @@ final class Renderer: NSObject, MTKViewDelegate {
                                  projection: overlayProjection,
                                  viewMatrix: overlayView,
                                  cameraPosition: scene.camera.position,
-                                 cameraWorldOrigin: cameraWorldOrigin)
-        renderGraph.execute(frame: frame, view: view, commandBuffer: commandBuffer)
+                                 cameraWorldOrigin: cameraWorldOrigin,
+                                 rayTracing: rtInput)
+        profiler.measure("Encode") {
+            renderGraph.execute(frame: frame, view: view, commandBuffer: commandBuffer)
+        }
 
         commandBuffer.present(drawable)
+        gpuFrame.track(commandBuffer)
+        gpuFrame.close()
+        frameSync.signalNextFrame(on: commandBuffer)
         commandBuffer.commit()
     }
 
     func mtkView(_ view: MTKView, drawableSizeWillChange size: CGSize) {
         scene?.camera.updateProjection(width: Float(size.width), height: Float(size.height))
         scene?.viewportDidChange(size: SIMD2<Float>(Float(size.width), Float(size.height)))
+        dynamicResolution.reset()
     }
 
-    private func updateRTTargetIfNeeded(view: MTKView, scale: Float) {
-        let scaledWidth = max(Int((Float(view.drawableSize.width) * scale).rounded(.toNearestOrAwayFromZero)), 1)
-        let scaledHeight = max(Int((Float(view.drawableSize.height) * scale).rounded(.toNearestOrAwayFromZero)), 1)
+    private func updateRTTargetIfNeeded(view: MTKView) {
+        let width = max(Int(view.drawableSize.width), 1)
+        let height = max(Int(view.drawableSize.height), 1)
         let format: MTLPixelFormat = .rgba16Float
 
         if let existing = rtColorTexture,
-           existing.width == scaledWidth,
-           existing.height == scaledHeight,
+           existing.width == width,
+           existing.height == height,
            existing.pixelFormat == format {
             return
         }
 
         let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: format,
-                                                            width: scaledWidth,
-                                                            height: scaledHeight,
+                                                            width: width,
+                                                            height: height,
                                                             mipmapped: false)
         desc.usage = [.shaderRead, .shaderWrite]
         desc.storageMode = .private
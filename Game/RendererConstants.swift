@@ -7,13 +7,12 @@
 
 import Foundation
 
-// The 256 byte aligned size of our uniform structure
-let alignedUniformsSize = (MemoryLayout<Uniforms>.size + 0xFF) & -0x100
+// Start alignment of each UniformRingBuffer allocation (buffer offsets bound to constant
+// address space arguments must be 256 byte aligned on older GPUs)
+let uniformAllocationAlignment = 256
 
 let maxBuffersInFlight = 3
 
-let maxRTTextures = 32
-
 nonisolated enum RendererError: Error {
     case badVertexDescriptor
 }
@@ -11,8 +11,11 @@ import Metal
 /// Keep it minimal; you can add more later (e.g. asset registry, thread pools).
 public struct SceneContext {
     public let device: MTLDevice
+    /// Shared with the renderer, which feeds it frame boundaries and GPU timings.
+    public let profiler: FrameProfiler
 
-    public init(device: MTLDevice) {
+    public init(device: MTLDevice, profiler: FrameProfiler = FrameProfiler()) {
         self.device = device
+        self.profiler = profiler
     }
 }
@@ -35,6 +35,10 @@ public final class CollisionQueryService {
     private var dirty: Bool = true
     private var staticMeshCache: [Entity: StaticMeshSnapshot] = [:]
     private var lastActiveEntityIDs: Set<UInt32>?
+    /// Streams chunked statics when updated with an active chunk set.
+    public let chunkCache = CollisionChunkCache()
+    private var attachedChunks: [CollisionChunk] = []
+    private var attachedOrigin: SIMD3<Double>?
 
     public init() {}
 
@@ -43,25 +47,62 @@ public final class CollisionQueryService {
     }
 
     public func rebuild(world: World, activeEntityIDs: Set<UInt32>? = nil) {
-        query = CollisionQuery(world: world, activeEntityIDs: activeEntityIDs)
+        query = CollisionQuery(world: world, activeEntityIDs: activeEntityIDs, reusingMeshesFrom: query)
         dirty = false
         lastActiveEntityIDs = activeEntityIDs
         refreshStaticMeshCache(world: world, activeEntityIDs: activeEntityIDs)
+        if activeEntityIDs != nil, let attachedOrigin, !attachedChunks.isEmpty {
+            query?.attachStaticChunks(attachedChunks, originWorld: attachedOrigin)
+        }
     }
 
     public func update(world: World, activeEntityIDs: Set<UInt32>? = nil) {
+        if attachedOrigin != nil {
+            attachedChunks = []
+            attachedOrigin = nil
+            chunkCache.removeAll()
+            dirty = true
+        }
+        _ = refresh(world: world, activeEntityIDs: activeEntityIDs)
+    }
+
+    /// Chunked statics (see `CollisionChunkCache.isChunked`) come from per-chunk sets built once
+    /// and reattached as the active set moves; only loose statics and dynamics go through
+    /// the rebuild/refit path, so crossing a chunk border no longer rebuilds the scene.
+    public func update(world: World, active: ActiveChunkComponent) {
+        let resolved = chunkCache.update(world: world, center: active.centerChunk, radius: active.radiusChunks)
+        let originWorld = WorldPosition.toWorld(chunk: active.originChunk, local: active.originLocal)
+        let moved = resolved.changed || attachedOrigin != originWorld
+        attachedChunks = resolved.chunks
+        attachedOrigin = originWorld
+
+        let wStore = world.store(WorldPositionComponent.self)
+        let pStore = world.store(PhysicsBodyComponent.self)
+        var looseIDs = Set<UInt32>()
+        for id in active.activeStaticEntityIDs
+        where !CollisionChunkCache.isChunked(Entity(id), wStore: wStore, pStore: pStore) {
+            looseIDs.insert(id)
+        }
+        let rebuilt = refresh(world: world, activeEntityIDs: looseIDs)
+        if moved && !rebuilt {
+            query?.attachStaticChunks(attachedChunks, originWorld: originWorld)
+        }
+    }
+
+    /// Returns true when the query was rebuilt (which reattaches chunks itself).
+    private func refresh(world: World, activeEntityIDs: Set<UInt32>?) -> Bool {
         if activeEntityIDs != lastActiveEntityIDs {
             rebuild(world: world, activeEntityIDs: activeEntityIDs)
-            return
+            return true
         }
         if dirty || query == nil {
             rebuild(world: world, activeEntityIDs: activeEntityIDs)
-            return
+            return true
         }
         let changeSet = staticMeshChanges(world: world, activeEntityIDs: activeEntityIDs)
         if changeSet.structuralChange {
             rebuild(world: world, activeEntityIDs: activeEntityIDs)
-            return
+            return true
         }
         if !changeSet.staticTransforms.isEmpty {
             query?.updateStaticTransforms(world: world,
@@ -74,6 +115,7 @@ public final class CollisionQueryService {
                                            activeEntityIDs: activeEntityIDs)
         }
         refreshStaticMeshCache(world: world, activeEntityIDs: activeEntityIDs)
+        return false
     }
 
     private struct StaticMeshSnapshot {
@@ -38,7 +38,21 @@ typedef NS_ENUM(EnumBackingType, BufferIndex)
     BufferIndexRTNormals         = 12,
     BufferIndexRTTangents        = 13,
     BufferIndexRTNormalsDynamic  = 14,
-    BufferIndexRTTangentsDynamic = 15
+    BufferIndexRTTangentsDynamic = 15,
+    BufferIndexRTRadiance        = 16,
+    BufferIndexRTRayQueue        = 17,
+    BufferIndexRTQueueCounters   = 18,
+    BufferIndexRTQueueCapacity   = 19,
+    BufferIndexRTDispatchArgs    = 20,
+    BufferIndexRTAlphaFunctions  = 21,
+    BufferIndexRTMaterials       = 22,
+    BufferIndexRTMaterialTextures = 23,
+    BufferIndexDrawInstances     = 24
+};
+
+typedef NS_ENUM(EnumBackingType, FunctionConstantIndex)
+{
+    FunctionConstantIndexRTAlphaFunctions = 0
 };
 
 typedef NS_ENUM(EnumBackingType, VertexAttribute)
@@ -58,10 +72,20 @@ typedef NS_ENUM(EnumBackingType, TextureIndex)
     TextureIndexOcclusion       = 4
 };
 
+/// Raster per-pass data, written once per pass (BufferIndexUniforms).
 typedef struct
 {
     matrix_float4x4 projectionMatrix;
     matrix_float4x4 viewMatrix;
+    vector_float3 cameraPosition;
+    float pad0;
+    vector_float3 worldOrigin;
+    float pad1;
+} Uniforms;
+
+/// Raster per-draw data, one per instance of an instanced draw (BufferIndexDrawInstances).
+typedef struct
+{
     matrix_float4x4 modelMatrix;
     vector_float3 baseColorFactor;
     float baseAlpha;
@@ -71,11 +95,7 @@ typedef struct
     float exposure;
     float toneMapEnabled;
     float occlusionStrength;
-    vector_float3 cameraPosition;
-    float pad0;
-    vector_float3 worldOrigin;
-    float pad1;
-} Uniforms;
+} DrawInstance;
 
 typedef struct
 {
@@ -99,8 +119,26 @@ typedef struct
     vector_float3 envSH6;
     vector_float3 envSH7;
     vector_float3 envSH8;
+    vector_float2 jitter;
+    uint32_t temporalEnabled;
+    uint32_t pad3;
 } RTFrameUniforms;
 
+typedef struct
+{
+    matrix_float4x4 invViewProj;
+    matrix_float4x4 prevViewProj;
+    vector_float3 cameraPosition;
+    float pad0;
+    vector_float3 prevCameraPosition;
+    float pad1;
+    vector_uint2 inputSize;
+    vector_uint2 outputSize;
+    vector_float2 jitter;
+    float maxHistory;
+    uint32_t historyValid;
+} RTTemporalUniforms;
+
 typedef struct
 {
     uint32_t baseIndex;
@@ -108,6 +146,12 @@ typedef struct
     uint32_t indexCount;
     uint32_t bufferIndex;
     matrix_float4x4 modelMatrix;
+    uint32_t materialIndex;
+    vector_uint3 pad0;
+} RTInstanceInfo;
+
+typedef struct
+{
     vector_float3 baseColorFactor;
     float metallicFactor;
     vector_float3 emissiveFactor;
@@ -116,14 +160,15 @@ typedef struct
     float transmissionFactor;
     float ior;
     float normalScale;
-    vector_float3 pad2;
+    float alphaCutoff;
+    vector_float3 pad0;
     uint32_t baseColorTexIndex;
     uint32_t normalTexIndex;
     uint32_t metallicRoughnessTexIndex;
     uint32_t emissiveTexIndex;
     uint32_t occlusionTexIndex;
-    vector_uint3 padding1;
-} RTInstanceInfo;
+    vector_uint3 pad1;
+} RTMaterialInfo;
 
 typedef struct
 {
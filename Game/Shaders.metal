@@ -13,7 +13,7 @@
 using namespace metal;
 using namespace metal::raytracing;
 
-#define MAX_RT_TEXTURES 32
-
 #include "ShadersRaster.metalinc"
 #include "RayTracing.metalinc"
+#include "RayTracingWavefront.metalinc"
+#include "IBL.metalinc"
@@ -14,7 +14,14 @@ struct SkinnedMeshAsset {
 }
 
 enum SkinnedMeshLoader {
+    /// Loads `name.bin` (see `Tools/CookAssets`) when bundled, else `name.json`.
     static func loadSkinnedMeshAsset(named name: String, skeleton: Skeleton) -> SkinnedMeshAsset? {
+        if let path = Bundle.main.path(forResource: name, ofType: "bin") {
+            if let asset = loadCooked(path: path, skeleton: skeleton) {
+                return asset
+            }
+            print("SkinnedMeshLoader: falling back to json:", name)
+        }
         guard let path = Bundle.main.path(forResource: name, ofType: "json") else {
             print("SkinnedMeshLoader: missing json:", name)
             return nil
@@ -29,6 +36,37 @@ enum SkinnedMeshLoader {
         }
     }
 
+    /// Cooked skinned mesh: vertex streams are stored in their SIMD layouts, so each one is a
+    /// single copy out of the mapping before the skeleton remap.
+    private static func loadCooked(path: String, skeleton: Skeleton) -> SkinnedMeshAsset? {
+        guard let file = MappedAssetFile(path: path),
+              let meta = file.metadata(CookedSkinnedMeshMeta.self) else {
+            return nil
+        }
+        guard meta.kind == "skinned" else {
+            print("SkinnedMeshLoader: cooked asset is not a skinned mesh:", path)
+            return nil
+        }
+        let vCount = meta.vertexCount
+        guard let positions = file.array(SIMD3<Float>.self, chunk: meta.positions, count: vCount),
+              let normals = file.array(SIMD3<Float>.self, chunk: meta.normals, count: vCount),
+              let uvs = file.array(SIMD2<Float>.self, chunk: meta.uvs, count: vCount),
+              let joints = file.array(SIMD4<UInt16>.self, chunk: meta.joints, count: vCount),
+              let weights = file.array(SIMD4<Float>.self, chunk: meta.weights, count: vCount),
+              let indices = file.array(UInt32.self, chunk: meta.indices, count: meta.indexCount) else {
+            return nil
+        }
+        return buildAsset(positions: positions,
+                          normals: normals,
+                          uvs: uvs,
+                          joints: joints,
+                          weights: weights,
+                          indices: indices,
+                          submeshes: meta.submeshes,
+                          skinBones: meta.bones,
+                          skeleton: skeleton)
+    }
+
     private static func buildAsset(from json: SkinnedMeshJSON,
                                    skeleton: Skeleton) -> SkinnedMeshAsset {
         let mesh = json.mesh
@@ -43,45 +81,69 @@ enum SkinnedMeshLoader {
             return SkinnedMeshAsset(meshes: [], materialNames: [])
         }
 
-        let boneMap = makeBoneRemap(skinBones: json.skin.bones, skeleton: skeleton)
-        let invBindModel = buildInvBindModel(skinBones: json.skin.bones,
-                                             boneMap: boneMap,
-                                             skeleton: skeleton)
-
         var positions: [SIMD3<Float>] = []
         var normals: [SIMD3<Float>] = []
         var uvs: [SIMD2<Float>] = []
-        var boneIndices: [SIMD4<UInt16>] = []
-        var boneWeights: [SIMD4<Float>] = []
-
+        var joints: [SIMD4<UInt16>] = []
+        var weights: [SIMD4<Float>] = []
         positions.reserveCapacity(vCount)
         normals.reserveCapacity(vCount)
         uvs.reserveCapacity(vCount)
-        boneIndices.reserveCapacity(vCount)
-        boneWeights.reserveCapacity(vCount)
-
+        joints.reserveCapacity(vCount)
+        weights.reserveCapacity(vCount)
         for i in 0..<vCount {
             let pi = i * 3
             let ui = i * 2
             let bi = i * 4
-
-            let scale = skeleton.unitScale
-            positions.append(SIMD3<Float>(mesh.positions[pi] * scale,
-                                          mesh.positions[pi + 1] * scale,
-                                          mesh.positions[pi + 2] * scale))
-            normals.append(SIMD3<Float>(mesh.normals[pi],
-                                        mesh.normals[pi + 1],
-                                        mesh.normals[pi + 2]))
+            positions.append(SIMD3<Float>(mesh.positions[pi], mesh.positions[pi + 1], mesh.positions[pi + 2]))
+            normals.append(SIMD3<Float>(mesh.normals[pi], mesh.normals[pi + 1], mesh.normals[pi + 2]))
             uvs.append(SIMD2<Float>(mesh.uvs[ui], mesh.uvs[ui + 1]))
+            joints.append(SIMD4<UInt16>(mesh.joints[bi], mesh.joints[bi + 1], mesh.joints[bi + 2], mesh.joints[bi + 3]))
+            weights.append(SIMD4<Float>(mesh.weights[bi], mesh.weights[bi + 1], mesh.weights[bi + 2], mesh.weights[bi + 3]))
+        }
+        return buildAsset(positions: positions,
+                          normals: normals,
+                          uvs: uvs,
+                          joints: joints,
+                          weights: weights,
+                          indices: mesh.indices,
+                          submeshes: mesh.submeshes,
+                          skinBones: json.skin.bones,
+                          skeleton: skeleton)
+    }
+
+    private static func buildAsset(positions sourcePositions: [SIMD3<Float>],
+                                   normals: [SIMD3<Float>],
+                                   uvs: [SIMD2<Float>],
+                                   joints: [SIMD4<UInt16>],
+                                   weights sourceWeights: [SIMD4<Float>],
+                                   indices: [UInt32],
+                                   submeshes sourceSubmeshes: [SkinnedMeshSubmeshJSON]?,
+                                   skinBones: [SkinnedMeshBoneJSON],
+                                   skeleton: Skeleton) -> SkinnedMeshAsset {
+        let vCount = sourcePositions.count
+        guard vCount > 0 else {
+            print("SkinnedMeshLoader: mesh has no vertices.")
+            return SkinnedMeshAsset(meshes: [], materialNames: [])
+        }
 
+        let boneMap = makeBoneRemap(skinBones: skinBones, skeleton: skeleton)
+        let invBindModel = buildInvBindModel(skinBones: skinBones,
+                                             boneMap: boneMap,
+                                             skeleton: skeleton)
+
+        let positions = sourcePositions.map { $0 * skeleton.unitScale }
+        var boneIndices: [SIMD4<UInt16>] = []
+        var boneWeights: [SIMD4<Float>] = []
+        boneIndices.reserveCapacity(vCount)
+        boneWeights.reserveCapacity(vCount)
+
+        for i in 0..<vCount {
             var remappedJoints = SIMD4<UInt16>(repeating: 0)
-            var weights = SIMD4<Float>(mesh.weights[bi],
-                                       mesh.weights[bi + 1],
-                                       mesh.weights[bi + 2],
-                                       mesh.weights[bi + 3])
+            var weights = sourceWeights[i]
 
             for j in 0..<4 {
-                let srcIndex = Int(mesh.joints[bi + j])
+                let srcIndex = Int(joints[i][j])
                 let mapped = srcIndex < boneMap.count ? boneMap[srcIndex] : nil
                 if let dst = mapped {
                     remappedJoints[j] = UInt16(dst)
@@ -106,8 +168,8 @@ enum SkinnedMeshLoader {
                                            boneIndices: boneIndices,
                                            boneWeights: boneWeights)
 
-        let submeshes = mesh.submeshes?.isEmpty == false ? mesh.submeshes! : [
-            SkinnedMeshSubmeshJSON(start: 0, count: mesh.indices.count, material: "Default")
+        let submeshes = sourceSubmeshes?.isEmpty == false ? sourceSubmeshes! : [
+            SkinnedMeshSubmeshJSON(start: 0, count: indices.count, material: "Default")
         ]
 
         var descriptors: [SkinnedMeshDescriptor] = []
@@ -117,9 +179,9 @@ enum SkinnedMeshLoader {
 
         for sub in submeshes {
             let start = max(sub.start, 0)
-            let end = min(start + sub.count, mesh.indices.count)
+            let end = min(start + sub.count, indices.count)
             if start >= end { continue }
-            let slice = Array(mesh.indices[start..<end])
+            let slice = Array(indices[start..<end])
             let maxIndex = slice.max() ?? 0
             let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? slice.map { UInt16($0) } : nil
             let indicesFinal32: [UInt32]? = indices16 == nil ? slice : nil
@@ -218,3 +280,17 @@ private struct SkinnedMeshSubmeshJSON: Codable {
     let count: Int
     let material: String
 }
+
+private struct CookedSkinnedMeshMeta: Decodable {
+    let kind: String
+    let vertexCount: Int
+    let positions: Int
+    let normals: Int
+    let uvs: Int
+    let joints: Int
+    let weights: Int
+    let indices: Int
+    let indexCount: Int
+    let submeshes: [SkinnedMeshSubmeshJSON]?
+    let bones: [SkinnedMeshBoneJSON]
+}
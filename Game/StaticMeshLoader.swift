@@ -6,28 +6,41 @@
 //
 
 import Foundation
+import Metal
 import simd
 
-struct StaticMeshPart {
+nonisolated struct StaticMeshPart: Sendable {
     let name: String
     let transform: matrix_float4x4
-    let mesh: ProceduralMeshDescriptor
+    /// CPU streams; nil for cooked assets, whose submeshes carry their GPU meshes.
+    let mesh: ProceduralMeshDescriptor?
     let submeshes: [StaticMeshSubmesh]
     let collisionHulls: [ProceduralMeshDescriptor]
 }
 
-struct StaticMeshAsset {
+nonisolated struct StaticMeshAsset: Sendable {
     let parts: [StaticMeshPart]
 }
 
-struct StaticMeshSubmesh {
+nonisolated struct StaticMeshSubmesh: Sendable {
     let start: Int
     let count: Int
     let material: String
+    /// Buffers wrapped from a cooked asset; nil when loaded from JSON.
+    var gpuMesh: GPUMesh? = nil
 }
 
-enum StaticMeshLoader {
-    static func loadStaticMeshAsset(named name: String) -> StaticMeshAsset? {
+/// Nonisolated: streamed assets load on the asset load queue.
+nonisolated enum StaticMeshLoader {
+    /// Loads `name.bin` (see `Tools/CookAssets`) when bundled, else `name.json`. `prefault`
+    /// reads a cooked file's pages in up front, for loads off the render thread.
+    static func loadStaticMeshAsset(named name: String, device: MTLDevice, prefault: Bool = false) -> StaticMeshAsset? {
+        if let path = Bundle.main.path(forResource: name, ofType: "bin") {
+            if let asset = loadCooked(path: path, device: device, prefault: prefault) {
+                return asset
+            }
+            print("StaticMeshLoader: falling back to json:", name)
+        }
         guard let path = Bundle.main.path(forResource: name, ofType: "json") else {
             print("StaticMeshLoader: missing json:", name)
             return nil
@@ -42,6 +55,97 @@ enum StaticMeshLoader {
         }
     }
 
+    /// GPU mesh for `sub`: the cooked buffers, or one built from the part's streams and the
+    /// submesh's index range.
+    static func gpuMesh(for sub: StaticMeshSubmesh,
+                        of part: StaticMeshPart,
+                        device: MTLDevice,
+                        label: String) -> GPUMesh? {
+        if let mesh = sub.gpuMesh {
+            return mesh
+        }
+        guard let mesh = part.mesh else { return nil }
+        let indices: [UInt32] = mesh.indices16?.map { UInt32($0) } ?? mesh.indices32 ?? []
+        let start = max(sub.start, 0)
+        let end = min(start + sub.count, indices.count)
+        if start >= end { return nil }
+        let slice = Array(indices[start..<end])
+        let maxIndex = slice.max() ?? 0
+        let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? slice.map { UInt16($0) } : nil
+        let indices32: [UInt32]? = indices16 == nil ? slice : nil
+        let desc = ProceduralMeshDescriptor(topology: .triangles,
+                                            streams: mesh.streams,
+                                            indices16: indices16,
+                                            indices32: indices32,
+                                            name: "\(part.name):\(sub.material)")
+        return GPUMesh(device: device, descriptor: desc, label: label)
+    }
+
+    /// Cooked static mesh: interleaved `VertexPNUT` (tangents baked) and per-submesh index
+    /// chunks are wrapped as Metal buffers in place; only the small hulls are copied out.
+    private static func loadCooked(path: String, device: MTLDevice, prefault: Bool) -> StaticMeshAsset? {
+        guard let file = MappedAssetFile(path: path),
+              let meta = file.metadata(CookedStaticMeshMeta.self) else {
+            return nil
+        }
+        if prefault {
+            file.prefault()
+        }
+        guard meta.kind == "static",
+              meta.vertexStride == MemoryLayout<VertexPNUT>.stride else {
+            print("StaticMeshLoader: cooked asset does not match this build:", path)
+            return nil
+        }
+
+        var parts: [StaticMeshPart] = []
+        parts.reserveCapacity(meta.parts.count)
+        for entry in meta.parts {
+            let label = "\((path as NSString).lastPathComponent):\(entry.name)"
+            guard let vertexBuffer = file.makeBuffer(device: device, chunk: entry.vertices, label: "\(label).vb") else {
+                print("StaticMeshLoader: invalid vertices for mesh:", entry.name)
+                return nil
+            }
+            let bounds = GPUMesh.bounds(vertexBuffer: vertexBuffer, vertexCount: entry.vertexCount)
+            var submeshes: [StaticMeshSubmesh] = []
+            submeshes.reserveCapacity(entry.submeshes.count)
+            for sub in entry.submeshes {
+                let indexType: MTLIndexType = sub.indexType == "uint16" ? .uint16 : .uint32
+                guard let indexBuffer = file.makeBuffer(device: device,
+                                                        chunk: sub.indices,
+                                                        label: "\(label):\(sub.material).ib") else {
+                    print("StaticMeshLoader: invalid indices for mesh:", entry.name)
+                    return nil
+                }
+                let mesh = GPUMesh(vertexBuffer: vertexBuffer,
+                                   vertexCount: entry.vertexCount,
+                                   indexBuffer: indexBuffer,
+                                   indexType: indexType,
+                                   indexCount: sub.indexCount,
+                                   bounds: bounds)
+                submeshes.append(StaticMeshSubmesh(start: sub.start,
+                                                   count: sub.indexCount,
+                                                   material: sub.material,
+                                                   gpuMesh: mesh))
+            }
+
+            var hulls: [ProceduralMeshDescriptor] = []
+            for hull in entry.hulls {
+                guard let positions = file.array(SIMD3<Float>.self, chunk: hull.positions, count: hull.vertexCount),
+                      let indices = file.array(UInt32.self, chunk: hull.indices, count: hull.indexCount),
+                      let desc = buildCollisionHull(positions: positions, indices: indices) else { continue }
+                hulls.append(desc)
+            }
+
+            let transform = entry.transform.count == 16 ? matrixFromArrayRowMajor(entry.transform) : matrix_identity_float4x4
+            parts.append(StaticMeshPart(name: entry.name,
+                                        transform: transform,
+                                        mesh: nil,
+                                        submeshes: submeshes,
+                                        collisionHulls: hulls))
+        }
+        return StaticMeshAsset(parts: parts)
+    }
+
     private static func buildAsset(from json: StaticMeshJSON) -> StaticMeshAsset {
         var parts: [StaticMeshPart] = []
         parts.reserveCapacity(json.meshes.count)
@@ -141,7 +245,6 @@ enum StaticMeshLoader {
             let vCount = hull.positions.count / 3
             guard vCount > 0,
                   hull.positions.count == vCount * 3 else { continue }
-            guard !hull.indices.isEmpty else { continue }
             var positions: [SIMD3<Float>] = []
             positions.reserveCapacity(vCount)
             for i in 0..<vCount {
@@ -150,34 +253,40 @@ enum StaticMeshLoader {
                                               hull.positions[pi + 1],
                                               hull.positions[pi + 2]))
             }
-            let streams = VertexStreams(positions: positions)
-            let maxIndex = hull.indices.max() ?? 0
-            let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? hull.indices.map { UInt16($0) } : nil
-            let indices32: [UInt32]? = indices16 == nil ? hull.indices : nil
-            let desc = ProceduralMeshDescriptor(topology: .triangles,
-                                                streams: streams,
-                                                indices16: indices16,
-                                                indices32: indices32,
-                                                name: "CollisionHull")
-            descriptors.append(desc)
+            if let desc = buildCollisionHull(positions: positions, indices: hull.indices) {
+                descriptors.append(desc)
+            }
         }
         return descriptors
     }
+
+    private static func buildCollisionHull(positions: [SIMD3<Float>], indices: [UInt32]) -> ProceduralMeshDescriptor? {
+        guard !positions.isEmpty, !indices.isEmpty else { return nil }
+        let streams = VertexStreams(positions: positions)
+        let maxIndex = indices.max() ?? 0
+        let indices16: [UInt16]? = maxIndex <= UInt32(UInt16.max) ? indices.map { UInt16($0) } : nil
+        let indices32: [UInt32]? = indices16 == nil ? indices : nil
+        return ProceduralMeshDescriptor(topology: .triangles,
+                                        streams: streams,
+                                        indices16: indices16,
+                                        indices32: indices32,
+                                        name: "CollisionHull")
+    }
 }
 
-private struct StaticMeshJSON: Codable {
+private nonisolated struct StaticMeshJSON: Codable {
     let version: Int
     let meshes: [StaticMeshEntryJSON]
 }
 
-private struct StaticMeshEntryJSON: Codable {
+private nonisolated struct StaticMeshEntryJSON: Codable {
     let name: String
     let transform: [Float]
     let mesh: StaticMeshDataJSON
     let collisionHulls: [StaticMeshHullJSON]?
 }
 
-private struct StaticMeshDataJSON: Codable {
+private nonisolated struct StaticMeshDataJSON: Codable {
     let positions: [Float]
     let normals: [Float]
     let uvs: [Float]
@@ -185,13 +294,43 @@ private struct StaticMeshDataJSON: Codable {
     let submeshes: [StaticMeshSubmeshJSON]?
 }
 
-private struct StaticMeshSubmeshJSON: Codable {
+private nonisolated struct StaticMeshSubmeshJSON: Codable {
     let start: Int
     let count: Int
     let material: String
 }
 
-private struct StaticMeshHullJSON: Codable {
+private nonisolated struct StaticMeshHullJSON: Codable {
     let positions: [Float]
     let indices: [UInt32]
 }
+
+private nonisolated struct CookedStaticMeshMeta: Decodable {
+    let kind: String
+    let vertexStride: Int
+    let parts: [CookedStaticMeshPartMeta]
+}
+
+private nonisolated struct CookedStaticMeshPartMeta: Decodable {
+    let name: String
+    let transform: [Float]
+    let vertexCount: Int
+    let vertices: Int
+    let submeshes: [CookedStaticMeshSubmeshMeta]
+    let hulls: [CookedStaticMeshHullMeta]
+}
+
+private nonisolated struct CookedStaticMeshSubmeshMeta: Decodable {
+    let start: Int
+    let material: String
+    let indices: Int
+    let indexType: String
+    let indexCount: Int
+}
+
+private nonisolated struct CookedStaticMeshHullMeta: Decodable {
+    let positions: Int
+    let vertexCount: Int
+    let indices: Int
+    let indexCount: Int
+}
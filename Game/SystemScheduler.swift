@@ -0,0 +1,108 @@
+//
+//  SystemScheduler.swift
+//  Game
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+
+/// Component types a fixed-step system reads and writes.
+/// Systems that return this from `access` may run concurrently with any other
+/// declared system they do not conflict with (write/write or read/write).
+public struct ComponentAccess {
+    fileprivate var reads: Set<ObjectIdentifier> = []
+    fileprivate var writes: Set<ObjectIdentifier> = []
+    /// Creates the declared stores up front so workers never insert into World's store table.
+    fileprivate var warmers: [(World) -> Void] = []
+
+    public init() {}
+
+    public func reading<T>(_ type: T.Type) -> ComponentAccess {
+        var next = self
+        next.reads.insert(ObjectIdentifier(type))
+        next.warmers.append { _ = $0.store(T.self) }
+        return next
+    }
+
+    public func writing<T>(_ type: T.Type) -> ComponentAccess {
+        var next = self
+        next.writes.insert(ObjectIdentifier(type))
+        next.warmers.append { _ = $0.store(T.self) }
+        return next
+    }
+
+    fileprivate func conflicts(with other: ComponentAccess) -> Bool {
+        !writes.isDisjoint(with: other.writes)
+            || !writes.isDisjoint(with: other.reads)
+            || !reads.isDisjoint(with: other.writes)
+    }
+}
+
+/// Dependency-ordered batches for one fixed-step phase.
+/// Each system lands one batch after the latest earlier system it conflicts with,
+/// so conflicting pairs keep their declared order and the result stays deterministic.
+/// Systems without declared access act as barriers.
+final class FixedStepSchedule {
+    private let systems: [FixedStepSystem]
+    private let accesses: [ComponentAccess?]
+    private let batches: [[Int]]
+    /// Profiler scope names, resolved once.
+    private let names: [String]
+
+    init(systems: [FixedStepSystem]) {
+        self.systems = systems
+        self.accesses = systems.map { $0.access }
+        self.names = systems.map { String(describing: type(of: $0)) }
+
+        var level = [Int](repeating: 0, count: systems.count)
+        var batches: [[Int]] = []
+        for k in 0..<systems.count {
+            var l = 0
+            for j in 0..<k where FixedStepSchedule.conflicts(accesses[j], accesses[k]) {
+                l = max(l, level[j] + 1)
+            }
+            level[k] = l
+            if l == batches.count {
+                batches.append([])
+            }
+            batches[l].append(k)
+        }
+        self.batches = batches
+    }
+
+    private static func conflicts(_ a: ComponentAccess?, _ b: ComponentAccess?) -> Bool {
+        guard let a, let b else { return true }
+        return a.conflicts(with: b)
+    }
+
+    func prepare(world: World) {
+        for access in accesses {
+            access?.warmers.forEach { $0(world) }
+        }
+    }
+
+    /// Runs every batch; with a profiler each system is timed as its own CPU scope.
+    func run(world: World, dt: Float, parallel: Bool, profiler: FrameProfiler? = nil) {
+        let systems = self.systems
+        let names = self.names
+        let step = { (i: Int) in
+            if let profiler {
+                profiler.measure(names[i]) { systems[i].fixedUpdate(world: world, dt: dt) }
+            } else {
+                systems[i].fixedUpdate(world: world, dt: dt)
+            }
+        }
+        for batch in batches {
+            if !parallel || batch.count == 1 {
+                for i in batch {
+                    step(i)
+                }
+            } else {
+                DispatchQueue.concurrentPerform(iterations: batch.count) { i in
+                    step(batch[i])
+                }
+            }
+        }
+    }
+}
@@ -5,6 +5,7 @@
 //  Created by 伈佊 on 1/2/26.
 //
 
+import Foundation
 import simd
 
 
@@ -14,9 +15,15 @@ public protocol System {
 
 public protocol FixedStepSystem {
     func fixedUpdate(world: World, dt: Float)
+    /// Declared component access; nil means unknown and the system runs exclusively.
+    var access: ComponentAccess? { get }
 }
 
-private func isActive(_ e: Entity, _ active: ActiveChunkComponent?) -> Bool {
+extension FixedStepSystem {
+    public var access: ComponentAccess? { nil }
+}
+
+private nonisolated func isActive(_ e: Entity, _ active: ActiveChunkComponent?) -> Bool {
     active?.activeEntityIDs.contains(e.id) ?? true
 }
 
@@ -49,17 +56,22 @@ public final class TimeSystem: System {
 }
 
 /// Runs fixed-step systems using TimeComponent's accumulator.
+/// Within each phase, systems with declared, non-conflicting access run concurrently.
 public final class FixedStepRunner {
-    private let preFixedSystems: [FixedStepSystem]
-    private let fixedSystems: [FixedStepSystem]
-    private let postFixedSystems: [FixedStepSystem]
+    private let preFixedSchedule: FixedStepSchedule
+    private let fixedSchedule: FixedStepSchedule
+    private let postFixedSchedule: FixedStepSchedule
+    /// Disable to run every phase serially in declaration order (debugging/profiling).
+    public var parallelEnabled: Bool = true
+    /// Times each system as a CPU scope when set.
+    public var profiler: FrameProfiler?
 
     public init(preFixed: [FixedStepSystem] = [],
                 fixed: [FixedStepSystem] = [],
                 postFixed: [FixedStepSystem] = []) {
-        self.preFixedSystems = preFixed
-        self.fixedSystems = fixed
-        self.postFixedSystems = postFixed
+        self.preFixedSchedule = FixedStepSchedule(systems: preFixed)
+        self.fixedSchedule = FixedStepSchedule(systems: fixed)
+        self.postFixedSchedule = FixedStepSchedule(systems: postFixed)
     }
 
     public func update(world: World) {
@@ -70,17 +82,17 @@ public final class FixedStepRunner {
         t.accumulator += t.deltaTime
         let fixedDt = max(t.fixedDelta, 0.0001)
 
+        if t.accumulator >= fixedDt {
+            preFixedSchedule.prepare(world: world)
+            fixedSchedule.prepare(world: world)
+            postFixedSchedule.prepare(world: world)
+        }
+
         var steps = 0
         while t.accumulator >= fixedDt && steps < t.maxSubsteps {
-            for s in preFixedSystems {
-                s.fixedUpdate(world: world, dt: fixedDt)
-            }
-            for s in fixedSystems {
-                s.fixedUpdate(world: world, dt: fixedDt)
-            }
-            for s in postFixedSystems {
-                s.fixedUpdate(world: world, dt: fixedDt)
-            }
+            preFixedSchedule.run(world: world, dt: fixedDt, parallel: parallelEnabled, profiler: profiler)
+            fixedSchedule.run(world: world, dt: fixedDt, parallel: parallelEnabled, profiler: profiler)
+            postFixedSchedule.run(world: world, dt: fixedDt, parallel: parallelEnabled, profiler: profiler)
             t.accumulator -= fixedDt
             steps += 1
         }
@@ -97,8 +109,15 @@ public final class FixedStepRunner {
 public final class SpinSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(SpinComponent.self)
+            .writing(TransformComponent.self)
+            .writing(PhysicsBodyComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
-        let entities = world.query(TransformComponent.self, SpinComponent.self)
+        let entities = world.view(TransformComponent.self, SpinComponent.self)
         let tStore = world.store(TransformComponent.self)
         let sStore = world.store(SpinComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
@@ -122,6 +141,14 @@ public final class SpinSystem: FixedStepSystem {
 public final class KinematicPlatformMotionSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .writing(TransformComponent.self)
+            .writing(PhysicsBodyComponent.self)
+            .writing(KinematicPlatformComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         let entities = world.query(TransformComponent.self,
                                    PhysicsBodyComponent.self,
@@ -153,7 +180,7 @@ public final class KinematicPlatformMotionSystem: FixedStepSystem {
     }
 }
 
-/// Rebuild static collision query from current transforms.
+/// Rebuild static collision query from current transforms; chunked statics stream per chunk.
 public final class CollisionQueryRefreshSystem: FixedStepSystem {
     private let kinematicMoveSystem: KinematicMoveStopSystem
     private let agentSeparationSystem: AgentSeparationSystem?
@@ -171,7 +198,11 @@ public final class CollisionQueryRefreshSystem: FixedStepSystem {
         _ = dt
         let queryService: CollisionQueryService = services.resolve() ?? services.collisionQuery
         let active = world.query(ActiveChunkComponent.self).first.flatMap { world.store(ActiveChunkComponent.self)[$0] }
-        queryService.update(world: world, activeEntityIDs: active?.activeStaticEntityIDs)
+        if let active {
+            queryService.update(world: world, active: active)
+        } else {
+            queryService.update(world: world)
+        }
         guard let query = queryService.query else { return }
         query.resetStats()
         kinematicMoveSystem.setQuery(query)
@@ -183,6 +214,12 @@ public final class CollisionQueryRefreshSystem: FixedStepSystem {
 public final class PhysicsBeginStepSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .writing(PhysicsBodyComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         _ = dt
         let bodies = world.query(PhysicsBodyComponent.self)
@@ -205,6 +242,16 @@ public final class PhysicsBeginStepSystem: FixedStepSystem {
 public final class PhysicsIntentSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(MoveIntentComponent.self)
+            .reading(MovementComponent.self)
+            .reading(CharacterControllerComponent.self)
+            .reading(DodgeActionComponent.self)
+            .writing(PhysicsBodyComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         let bodies = world.query(PhysicsBodyComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
@@ -253,8 +300,14 @@ public final class PhysicsIntentSystem: FixedStepSystem {
 public final class OscillateMoveSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .writing(MoveIntentComponent.self)
+            .writing(OscillateMoveComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
-        let entities = world.query(MoveIntentComponent.self, OscillateMoveComponent.self)
+        let entities = world.view(MoveIntentComponent.self, OscillateMoveComponent.self)
         let mStore = world.store(MoveIntentComponent.self)
         let oStore = world.store(OscillateMoveComponent.self)
 
@@ -276,6 +329,15 @@ public final class OscillateMoveSystem: FixedStepSystem {
 public final class LocomotionProfileSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(PhysicsBodyComponent.self)
+            .reading(CharacterControllerComponent.self)
+            .writing(LocomotionProfileComponent.self)
+            .writing(MotionProfileComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         _ = dt
         let entities = world.query(LocomotionProfileComponent.self,
@@ -425,11 +487,11 @@ private func approachVecD(current: SIMD3<Double>, target: SIMD3<Double>, maxDelt
     return current + delta / len * maxDelta
 }
 
-private func d3(_ v: SIMD3<Float>) -> SIMD3<Double> {
+private nonisolated func d3(_ v: SIMD3<Float>) -> SIMD3<Double> {
     SIMD3<Double>(Double(v.x), Double(v.y), Double(v.z))
 }
 
-private func f3(_ v: SIMD3<Double>) -> SIMD3<Float> {
+private nonisolated func f3(_ v: SIMD3<Double>) -> SIMD3<Float> {
     SIMD3<Float>(Float(v.x), Float(v.y), Float(v.z))
 }
 
@@ -441,6 +503,14 @@ public final class JumpSystem: FixedStepSystem {
         self.jumpSpeed = jumpSpeed
     }
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .writing(PhysicsBodyComponent.self)
+            .writing(MoveIntentComponent.self)
+            .writing(CharacterControllerComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         _ = dt
         let entities = world.query(PhysicsBodyComponent.self, MoveIntentComponent.self, CharacterControllerComponent.self)
@@ -472,6 +542,13 @@ public final class JumpSystem: FixedStepSystem {
 public final class ActionAnimationSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(DodgeActionComponent.self)
+            .writing(ActionAnimationComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         guard dt > 0 else { return }
         let entities = world.query(ActionAnimationComponent.self)
@@ -521,6 +598,15 @@ public final class ActionAnimationSystem: FixedStepSystem {
 public final class DodgeSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(PhysicsBodyComponent.self)
+            .writing(MoveIntentComponent.self)
+            .writing(DodgeActionComponent.self)
+            .writing(ActionAnimationComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         guard dt > 0 else { return }
         let entities = world.query(MoveIntentComponent.self,
@@ -600,6 +686,13 @@ public final class GravitySystem: FixedStepSystem {
         self.gravity = gravity
     }
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(CharacterControllerComponent.self)
+            .writing(PhysicsBodyComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         let bodies = world.query(PhysicsBodyComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
@@ -619,13 +712,13 @@ public final class GravitySystem: FixedStepSystem {
     }
 }
 
-private struct WorldAABB {
+private nonisolated struct WorldAABB {
     var min: SIMD3<Float>
     var max: SIMD3<Float>
 }
 
-private func meshWorldAABB(mesh: ProceduralMeshDescriptor,
-                           transform: TransformComponent) -> WorldAABB? {
+private nonisolated func meshWorldAABB(mesh: ProceduralMeshDescriptor,
+                                       transform: TransformComponent) -> WorldAABB? {
     let positions = mesh.streams.positions
     guard !positions.isEmpty else { return nil }
     let m = transform.modelMatrix
@@ -641,7 +734,7 @@ private func meshWorldAABB(mesh: ProceduralMeshDescriptor,
     return WorldAABB(min: minP, max: maxP)
 }
 
-private struct PlatformCarry {
+private nonisolated struct PlatformCarry {
     static func computeDelta(position: SIMD3<Float>,
                              controller: CharacterControllerComponent,
                              platformEntities: [Entity],
@@ -731,7 +824,7 @@ private struct PlatformCarry {
     }
 }
 
-private struct DepenetrationResolver {
+private nonisolated struct DepenetrationResolver {
     static func resolve(position: inout SIMD3<Float>,
                         body: inout PhysicsBodyComponent,
                         controller: inout CharacterControllerComponent,
@@ -807,7 +900,7 @@ private struct DepenetrationResolver {
     }
 }
 
-private struct GroundContactState {
+private nonisolated struct GroundContactState {
     var grounded: Bool
     var groundedNear: Bool
     var normal: SIMD3<Float>
@@ -816,14 +909,14 @@ private struct GroundContactState {
     var distance: Float
 }
 
-private struct GroundProbeResult {
+private nonisolated struct GroundProbeResult {
     var state: GroundContactState
     var canSnap: Bool
     var nearGround: Bool
     var hit: CapsuleCastHit?
 }
 
-private struct GroundProbe {
+private nonisolated struct GroundProbe {
     static func resolve(position: SIMD3<Float>,
                         body: PhysicsBodyComponent,
                         controller: CharacterControllerComponent,
@@ -942,7 +1035,7 @@ private struct GroundProbe {
     }
 }
 
-private struct GroundSnap {
+private nonisolated struct GroundSnap {
     static func apply(position: inout SIMD3<Float>,
                       body: inout PhysicsBodyComponent,
                       controller: CharacterControllerComponent,
@@ -962,7 +1055,7 @@ private struct GroundSnap {
     }
 }
 
-private struct SlopeFriction {
+private nonisolated struct SlopeFriction {
     static func apply(body: inout PhysicsBodyComponent,
                       controller: inout CharacterControllerComponent,
                       gravity: SIMD3<Float>,
@@ -1020,7 +1113,7 @@ private struct SlopeFriction {
     }
 }
 
-private struct AgentSweepState {
+private nonisolated struct AgentSweepState {
     let entity: Entity
     let position: SIMD3<Float>
     let velocity: SIMD3<Float>
@@ -1028,13 +1121,21 @@ private struct AgentSweepState {
     let halfHeight: Float
 }
 
-private struct CapsuleCapsuleHit {
+/// Solid agents of one step plus a grid over them for sweep candidate gathering.
+private nonisolated struct AgentSweepSet {
+    var states: [AgentSweepState] = []
+    var grid = AgentGrid()
+    /// Largest agent radius plus one step of travel; pads candidate boxes so no pair is missed.
+    var reach: Float = 0
+}
+
+private nonisolated struct CapsuleCapsuleHit {
     let toi: Float
     let normal: SIMD3<Float>
     let other: Entity
 }
 
-private struct VelocityGate {
+private nonisolated struct VelocityGate {
     static func apply(body: inout PhysicsBodyComponent,
                       wasGrounded: Bool,
                       wasGroundedNear: Bool,
@@ -1050,7 +1151,7 @@ private struct VelocityGate {
     }
 }
 
-private struct AgentSweepSolver {
+private nonisolated struct AgentSweepSolver {
     static func bestHit(position: SIMD3<Float>,
                         remaining: SIMD3<Float>,
                         remainingLen: Float,
@@ -1060,14 +1161,20 @@ private struct AgentSweepSolver {
                         selfAgent: AgentCollisionComponent?,
                         selfRadius: Float,
                         halfHeight: Float,
-                        agentStates: [AgentSweepState],
+                        agents: AgentSweepSet,
                         sweep: (SIMD3<Float>, SIMD3<Float>, Float, Float, Entity, SIMD3<Float>, SIMD3<Float>, Float, Float) -> CapsuleCapsuleHit?) -> CapsuleCapsuleHit? {
         guard let selfAgent, selfAgent.isSolid else { return nil }
         var agentHit: CapsuleCapsuleHit?
         let timeScale = baseMoveLen > 1e-6 ? min(remainingLen / baseMoveLen, 1) : 1
         let segmentDt = dt * timeScale
-        for other in agentStates {
-            if other.entity == selfEntity { continue }
+        // Any agent that can touch the sweep starts within this XZ distance of `position`.
+        let reach = remainingLen + selfRadius + agents.reach
+        let lo = SIMD2<Float>(position.x - reach, position.z - reach)
+        let hi = SIMD2<Float>(position.x + reach, position.z + reach)
+        var bestIndex = Int.max
+        agents.grid.forEachCandidate(min: lo, max: hi) { index in
+            let other = agents.states[index]
+            if other.entity == selfEntity { return }
             let otherDelta = other.velocity * segmentDt
             if let hit = sweep(position,
                                remaining,
@@ -1081,8 +1188,11 @@ private struct AgentSweepSolver {
                 let candidate = CapsuleCapsuleHit(toi: hit.toi,
                                                   normal: hit.normal,
                                                   other: other.entity)
-                if agentHit == nil || candidate.toi < agentHit!.toi {
+                // Lowest index wins exact ties, matching a scan in agent order.
+                if agentHit == nil || candidate.toi < agentHit!.toi
+                    || (candidate.toi == agentHit!.toi && index < bestIndex) {
                     agentHit = candidate
+                    bestIndex = index
                 }
             }
         }
@@ -1090,7 +1200,13 @@ private struct AgentSweepSolver {
     }
 }
 
-public protocol ContactCachePolicy {
+/// Per-body contact caching for `KinematicMoveStopSystem`. Policies run off the main actor
+/// when the system solves bodies in parallel.
+public nonisolated protocol ContactCachePolicy {
+    /// True when every piece of per-body state lives in `CharacterControllerComponent`, so a
+    /// copy of the policy behaves like the original. Only stateless policies are solved in
+    /// parallel; the rest always run the serial path so their state sees bodies in order.
+    var isStateless: Bool { get }
     mutating func decay(controller: inout CharacterControllerComponent)
     func cachedNormal(controller: CharacterControllerComponent, triangleIndex: Int) -> SIMD3<Float>?
     mutating func record(controller: inout CharacterControllerComponent,
@@ -1099,9 +1215,15 @@ public protocol ContactCachePolicy {
                          isSideContact: Bool)
 }
 
-public struct DefaultContactCachePolicy: ContactCachePolicy {
+extension ContactCachePolicy {
+    public nonisolated var isStateless: Bool { false }
+}
+
+public nonisolated struct DefaultContactCachePolicy: ContactCachePolicy {
     public init() {}
 
+    public var isStateless: Bool { true }
+
     public mutating func decay(controller: inout CharacterControllerComponent) {
         if controller.sideContactFrames > 0 {
             controller.sideContactFrames -= 1
@@ -1133,7 +1255,9 @@ public struct DefaultContactCachePolicy: ContactCachePolicy {
     }
 }
 
-private struct SideContactOnlyCachePolicy: ContactCachePolicy {
+private nonisolated struct SideContactOnlyCachePolicy: ContactCachePolicy {
+    var isStateless: Bool { true }
+
     mutating func decay(controller: inout CharacterControllerComponent) {
         var policy = DefaultContactCachePolicy()
         policy.decay(controller: &controller)
@@ -1156,7 +1280,7 @@ private struct SideContactOnlyCachePolicy: ContactCachePolicy {
     }
 }
 
-private struct ContactManifoldCache {
+private nonisolated struct ContactManifoldCache {
     static let maxCount: Int = 4
     static let maxFrames: Int = 8
 
@@ -1204,8 +1328,8 @@ private struct ContactManifoldCache {
     }
 }
 
-private struct SlideResolver {
-    struct SlideOptions {
+private nonisolated struct SlideResolver {
+    nonisolated struct SlideOptions {
         let allowHorizontalGroundPass: Bool
         let adjustVelocity: Bool
         let useGroundSnapSkinForStatic: Bool
@@ -1221,7 +1345,7 @@ private struct SlideResolver {
                                                   allowTriangleNormalGroundLike: false)
     }
 
-    enum SlideHit {
+    nonisolated enum SlideHit {
         case staticHit(CapsuleCastHit)
         case agentHit(CapsuleCapsuleHit)
     }
@@ -1375,7 +1499,7 @@ private struct SlideResolver {
     }
 }
 
-private struct HitSelector {
+private nonisolated struct HitSelector {
     static func selectBestHit(staticHit: CapsuleCastHit?,
                               agentHit: CapsuleCapsuleHit?,
                               controller: CharacterControllerComponent) -> SlideResolver.SlideHit? {
@@ -1401,8 +1525,14 @@ private struct HitSelector {
 /// Kinematic capsule sweep: move & slide with ground snap.
 public final class KinematicMoveStopSystem: FixedStepSystem {
     private var query: CollisionQuery?
-    private let gravity: SIMD3<Float>
+    private nonisolated let gravity: SIMD3<Float>
     private var contactCachePolicy: any ContactCachePolicy
+    /// Solve character bodies on worker threads when there are enough of them.
+    public var parallelEnabled: Bool = true
+    /// Minimum bodies per worker before another worker is added.
+    public var parallelBodiesPerWorker: Int = 32
+    /// Reused across steps so gathering agents does not allocate once warmed up.
+    private var agentSweepSet = AgentSweepSet()
 
     public init(gravity: SIMD3<Float> = SIMD3<Float>(0, -98.0, 0),
                 contactCachePolicy: any ContactCachePolicy = DefaultContactCachePolicy()) {
@@ -1414,7 +1544,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         self.query = query
     }
 
-    private func clampInterval(_ start: Float, _ end: Float) -> (Float, Float)? {
+    private nonisolated func clampInterval(_ start: Float, _ end: Float) -> (Float, Float)? {
         let s = max(start, 0)
         let e = min(end, 1)
         if e < s {
@@ -1423,7 +1553,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return (s, e)
     }
 
-    private func intervalGreaterEqual(y0: Float, vy: Float, threshold: Float) -> (Float, Float)? {
+    private nonisolated func intervalGreaterEqual(y0: Float, vy: Float, threshold: Float) -> (Float, Float)? {
         let eps: Float = 1e-6
         if abs(vy) < eps {
             return y0 >= threshold ? (0, 1) : nil
@@ -1435,7 +1565,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return clampInterval(0, t)
     }
 
-    private func intervalLessEqual(y0: Float, vy: Float, threshold: Float) -> (Float, Float)? {
+    private nonisolated func intervalLessEqual(y0: Float, vy: Float, threshold: Float) -> (Float, Float)? {
         let eps: Float = 1e-6
         if abs(vy) < eps {
             return y0 <= threshold ? (0, 1) : nil
@@ -1447,7 +1577,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return clampInterval(t, 1)
     }
 
-    private func earliestRoot(A: Float, B: Float, C: Float, tMin: Float, tMax: Float) -> Float? {
+    private nonisolated func earliestRoot(A: Float, B: Float, C: Float, tMin: Float, tMax: Float) -> Float? {
         let eps: Float = 1e-6
         if abs(A) < eps {
             if abs(B) < eps {
@@ -1471,7 +1601,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return e >= s ? s : nil
     }
 
-    private func capsuleCapsuleSeparationY(_ yRel: Float, halfHeightSum: Float) -> Float {
+    private nonisolated func capsuleCapsuleSeparationY(_ yRel: Float, halfHeightSum: Float) -> Float {
         if yRel > halfHeightSum {
             return yRel - halfHeightSum
         }
@@ -1481,7 +1611,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return 0
     }
 
-    private func capsuleCapsuleHitNormal(rel: SIMD3<Float>, halfHeightSum: Float) -> SIMD3<Float> {
+    private nonisolated func capsuleCapsuleHitNormal(rel: SIMD3<Float>, halfHeightSum: Float) -> SIMD3<Float> {
         let sepY = capsuleCapsuleSeparationY(rel.y, halfHeightSum: halfHeightSum)
         let sep = SIMD3<Float>(rel.x, sepY, rel.z)
         let lenSq = simd_length_squared(sep)
@@ -1496,21 +1626,21 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return SIMD3<Float>(1, 0, 0)
     }
 
-    private func capsuleCapsuleOverlap(rel: SIMD3<Float>, radiusSum: Float, halfHeightSum: Float) -> Bool {
+    private nonisolated func capsuleCapsuleOverlap(rel: SIMD3<Float>, radiusSum: Float, halfHeightSum: Float) -> Bool {
         let sepY = capsuleCapsuleSeparationY(rel.y, halfHeightSum: halfHeightSum)
         let distSq = rel.x * rel.x + rel.z * rel.z + sepY * sepY
         return distSq <= radiusSum * radiusSum
     }
 
-    private func capsuleCapsuleSweep(from: SIMD3<Float>,
-                                     delta: SIMD3<Float>,
-                                     radius: Float,
-                                     halfHeight: Float,
-                                     other: Entity,
-                                     otherPos: SIMD3<Float>,
-                                     otherDelta: SIMD3<Float>,
-                                     otherRadius: Float,
-                                     otherHalfHeight: Float) -> CapsuleCapsuleHit? {
+    private nonisolated func capsuleCapsuleSweep(from: SIMD3<Float>,
+                                                 delta: SIMD3<Float>,
+                                                 radius: Float,
+                                                 halfHeight: Float,
+                                                 other: Entity,
+                                                 otherPos: SIMD3<Float>,
+                                                 otherDelta: SIMD3<Float>,
+                                                 otherRadius: Float,
+                                                 otherHalfHeight: Float) -> CapsuleCapsuleHit? {
         let relStart = from - otherPos
         let relDelta = delta - otherDelta
         let rSum = radius + otherRadius
@@ -1589,38 +1719,43 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         return CapsuleCapsuleHit(toi: toi, normal: n, other: other)
     }
 
-    private func collectAgentStates(bodies: [Entity],
+    private func collectAgentStates(into agents: inout AgentSweepSet,
+                                    bodies: [Entity],
                                     pStore: ComponentStore<PhysicsBodyComponent>,
                                     cStore: ComponentStore<CharacterControllerComponent>,
                                     aStore: ComponentStore<AgentCollisionComponent>,
-                                    active: ActiveChunkComponent?) -> [AgentSweepState] {
-        var agentStates: [AgentSweepState] = []
-        agentStates.reserveCapacity(bodies.count)
+                                    active: ActiveChunkComponent?,
+                                    dt: Float) {
+        agents.states.removeAll(keepingCapacity: true)
+        agents.reach = 0
         for e in bodies {
             if !isActive(e, active) { continue }
             guard let body = pStore[e], let controller = cStore[e] else { continue }
             guard let agent = aStore[e], agent.isSolid else { continue }
             let radius = agent.radiusOverride ?? controller.radius
-            agentStates.append(AgentSweepState(entity: e,
-                                               position: body.positionF,
-                                               velocity: body.linearVelocityF,
-                                               radius: radius,
-                                               halfHeight: controller.halfHeight))
+            let state = AgentSweepState(entity: e,
+                                        position: body.positionF,
+                                        velocity: body.linearVelocityF,
+                                        radius: radius,
+                                        halfHeight: controller.halfHeight)
+            agents.reach = max(agents.reach, radius + simd_length(state.velocity) * dt)
+            agents.states.append(state)
         }
-        return agentStates
+        let states = agents.states
+        agents.grid.rebuild(count: states.count, cellSize: agents.reach * 2) { states[$0].position }
     }
 
-    private func decayContactCache(controller: inout CharacterControllerComponent,
-                                   cachePolicy: inout any ContactCachePolicy) {
+    private nonisolated func decayContactCache(controller: inout CharacterControllerComponent,
+                                               cachePolicy: inout any ContactCachePolicy) {
         cachePolicy.decay(controller: &controller)
     }
 
-    private func applyPlatformDelta(position: inout SIMD3<Float>,
-                                    controller: CharacterControllerComponent,
-                                    platformEntities: [Entity],
-                                    platBodies: ComponentStore<PhysicsBodyComponent>,
-                                    platTransforms: ComponentStore<TransformComponent>,
-                                    platMeshes: ComponentStore<StaticMeshComponent>) {
+    private nonisolated func applyPlatformDelta(position: inout SIMD3<Float>,
+                                                controller: CharacterControllerComponent,
+                                                platformEntities: [Entity],
+                                                platBodies: ComponentStore<PhysicsBodyComponent>,
+                                                platTransforms: ComponentStore<TransformComponent>,
+                                                platMeshes: ComponentStore<StaticMeshComponent>) {
         let platformDelta = PlatformCarry.computeDelta(position: position,
                                                        controller: controller,
                                                        platformEntities: platformEntities,
@@ -1632,13 +1767,13 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         }
     }
 
-    private func applyPreSweepDepenetration(position: inout SIMD3<Float>,
-                                            body: inout PhysicsBodyComponent,
-                                            controller: inout CharacterControllerComponent,
-                                            remaining: inout SIMD3<Float>,
-                                            query: CollisionQuery,
-                                            cachePolicy: inout any ContactCachePolicy,
-                                            entity: Entity) {
+    private nonisolated func applyPreSweepDepenetration(position: inout SIMD3<Float>,
+                                                        body: inout PhysicsBodyComponent,
+                                                        controller: inout CharacterControllerComponent,
+                                                        remaining: inout SIMD3<Float>,
+                                                        query: CollisionQuery,
+                                                        cachePolicy: inout any ContactCachePolicy,
+                                                        entity: Entity) {
         if let depenNormal = DepenetrationResolver.resolve(position: &position,
                                                            body: &body,
                                                            controller: &controller,
@@ -1655,19 +1790,19 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         }
     }
 
-    private func resolveKinematicSweep(entity: Entity,
-                                       position: inout SIMD3<Float>,
-                                       remaining: inout SIMD3<Float>,
-                                       body: inout PhysicsBodyComponent,
-                                       controller: inout CharacterControllerComponent,
-                                       wasGrounded: Bool,
-                                       wasGroundedNear: Bool,
-                                       selfAgent: AgentCollisionComponent?,
-                                       selfRadius: Float,
-                                       agentStates: [AgentSweepState],
-                                       cachePolicy: inout any ContactCachePolicy,
-                                       query: CollisionQuery,
-                                       dt: Float) {
+    private nonisolated func resolveKinematicSweep(entity: Entity,
+                                                   position: inout SIMD3<Float>,
+                                                   remaining: inout SIMD3<Float>,
+                                                   body: inout PhysicsBodyComponent,
+                                                   controller: inout CharacterControllerComponent,
+                                                   wasGrounded: Bool,
+                                                   wasGroundedNear: Bool,
+                                                   selfAgent: AgentCollisionComponent?,
+                                                   selfRadius: Float,
+                                                   agents: AgentSweepSet,
+                                                   cachePolicy: inout any ContactCachePolicy,
+                                                   query: CollisionQuery,
+                                                   dt: Float) {
         let baseMove = body.linearVelocityF * dt
         let baseMoveLen = simd_length(baseMove)
         var lastSlideNormal: SIMD3<Float>? = nil
@@ -1701,7 +1836,7 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
                                                     selfAgent: selfAgent,
                                                     selfRadius: selfRadius,
                                                     halfHeight: controller.halfHeight,
-                                                    agentStates: agentStates,
+                                                    agents: agents,
                                                     sweep: capsuleCapsuleSweep)
 
             if let hit = HitSelector.selectBestHit(staticHit: staticHit,
@@ -1764,13 +1899,13 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         }
     }
 
-    private func resolveGroundContact(position: inout SIMD3<Float>,
-                                      body: inout PhysicsBodyComponent,
-                                      controller: inout CharacterControllerComponent,
-                                      query: CollisionQuery,
-                                      wasGrounded: Bool,
-                                      wasGroundedNear: Bool,
-                                      dt: Float) -> GroundContactState {
+    private nonisolated func resolveGroundContact(position: inout SIMD3<Float>,
+                                                  body: inout PhysicsBodyComponent,
+                                                  controller: inout CharacterControllerComponent,
+                                                  query: CollisionQuery,
+                                                  wasGrounded: Bool,
+                                                  wasGroundedNear: Bool,
+                                                  dt: Float) -> GroundContactState {
         let probe = GroundProbe.resolve(position: position,
                                         body: body,
                                         controller: controller,
@@ -1820,84 +1955,174 @@ public final class KinematicMoveStopSystem: FixedStepSystem {
         cStore[entity] = nextController
     }
 
+    private nonisolated struct MoveInputs {
+        let pStore: ComponentStore<PhysicsBodyComponent>
+        let cStore: ComponentStore<CharacterControllerComponent>
+        let aStore: ComponentStore<AgentCollisionComponent>
+        let platBodies: ComponentStore<PhysicsBodyComponent>
+        let platTransforms: ComponentStore<TransformComponent>
+        let platMeshes: ComponentStore<StaticMeshComponent>
+        let platformEntities: [Entity]
+        let agents: AgentSweepSet
+        let active: ActiveChunkComponent?
+        let dt: Float
+    }
+
+    private nonisolated struct MoveResult {
+        let entity: Entity
+        let position: SIMD3<Float>
+        let body: PhysicsBodyComponent
+        let controller: CharacterControllerComponent
+        let groundState: GroundContactState
+    }
+
+    /// Move one body against the snapshot. Reads only `inputs` and the query, so bodies
+    /// can be solved in any order; the caller applies results. Nonisolated along with its
+    /// helpers: `moveBodiesParallel` calls it from worker threads.
+    private nonisolated func moveBody(_ e: Entity,
+                                      inputs: MoveInputs,
+                                      query: CollisionQuery,
+                                      cachePolicy: inout any ContactCachePolicy) -> MoveResult? {
+        if !isActive(e, inputs.active) { return nil }
+        guard var body = inputs.pStore[e], var controller = inputs.cStore[e] else { return nil }
+        if body.bodyType == .static { return nil }
+        let dt = inputs.dt
+
+        var position = body.positionF
+        decayContactCache(controller: &controller, cachePolicy: &cachePolicy)
+        let selfAgent = inputs.aStore[e]
+        let selfRadius = selfAgent?.radiusOverride ?? controller.radius
+        // Apply platform motion carry/push before character sweep.
+        applyPlatformDelta(position: &position,
+                           controller: controller,
+                           platformEntities: inputs.platformEntities,
+                           platBodies: inputs.platBodies,
+                           platTransforms: inputs.platTransforms,
+                           platMeshes: inputs.platMeshes)
+        let wasGrounded = controller.grounded
+        let wasGroundedNear = controller.groundedNear
+        var remaining = VelocityGate.apply(body: &body,
+                                           wasGrounded: wasGrounded,
+                                           wasGroundedNear: wasGroundedNear,
+                                           dt: dt)
+        applyPreSweepDepenetration(position: &position,
+                                   body: &body,
+                                   controller: &controller,
+                                   remaining: &remaining,
+                                   query: query,
+                                   cachePolicy: &cachePolicy,
+                                   entity: e)
+        resolveKinematicSweep(entity: e,
+                              position: &position,
+                              remaining: &remaining,
+                              body: &body,
+                              controller: &controller,
+                              wasGrounded: wasGrounded,
+                              wasGroundedNear: wasGroundedNear,
+                              selfAgent: selfAgent,
+                              selfRadius: selfRadius,
+                              agents: inputs.agents,
+                              cachePolicy: &cachePolicy,
+                              query: query,
+                              dt: dt)
+
+        let groundState = resolveGroundContact(position: &position,
+                                               body: &body,
+                                               controller: &controller,
+                                               query: query,
+                                               wasGrounded: wasGrounded,
+                                               wasGroundedNear: wasGroundedNear,
+                                               dt: dt)
+        return MoveResult(entity: e,
+                          position: position,
+                          body: body,
+                          controller: controller,
+                          groundState: groundState)
+    }
+
+    /// Solve bodies on worker threads. Each worker gets its own query (private stats)
+    /// and a copy of the contact-cache policy; results are written back in body order.
+    /// Only called for stateless policies, so the worker copies can be dropped and the
+    /// outcome matches the serial path.
+    private func moveBodiesParallel(_ bodies: [Entity],
+                                    inputs: MoveInputs,
+                                    query: CollisionQuery,
+                                    workerCount: Int) -> [MoveResult?] {
+        let workerQueries = (0..<workerCount).map { _ in query.makeWorkerQuery() }
+        let basePolicy = contactCachePolicy
+        var results = [MoveResult?](repeating: nil, count: bodies.count)
+        let chunk = (bodies.count + workerCount - 1) / workerCount
+        results.withUnsafeMutableBufferPointer { out in
+            DispatchQueue.concurrentPerform(iterations: workerCount) { w in
+                let lo = w * chunk
+                let hi = min(lo + chunk, bodies.count)
+                guard lo < hi else { return }
+                var policy = basePolicy
+                let workerQuery = workerQueries[w]
+                for i in lo..<hi {
+                    out[i] = moveBody(bodies[i], inputs: inputs, query: workerQuery, cachePolicy: &policy)
+                }
+            }
+        }
+        query.mergeStats(from: workerQueries)
+        return results
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         guard let query = query else { return }
         let bodies = world.query(PhysicsBodyComponent.self, CharacterControllerComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
         let cStore = world.store(CharacterControllerComponent.self)
         let aStore = world.store(AgentCollisionComponent.self)
-        let platBodies = world.store(PhysicsBodyComponent.self)
-        let platTransforms = world.store(TransformComponent.self)
-        let platMeshes = world.store(StaticMeshComponent.self)
         let platformEntities = world.query(PhysicsBodyComponent.self,
                                            TransformComponent.self,
                                            StaticMeshComponent.self,
                                            KinematicPlatformComponent.self)
         let active = world.query(ActiveChunkComponent.self).first.flatMap { world.store(ActiveChunkComponent.self)[$0] }
-        let agentStates = collectAgentStates(bodies: bodies,
-                                             pStore: pStore,
-                                             cStore: cStore,
-                                             aStore: aStore,
-                                             active: active)
+        collectAgentStates(into: &agentSweepSet,
+                           bodies: bodies,
+                           pStore: pStore,
+                           cStore: cStore,
+                           aStore: aStore,
+                           active: active,
+                           dt: dt)
+        let inputs = MoveInputs(pStore: pStore,
+                                cStore: cStore,
+                                aStore: aStore,
+                                platBodies: world.store(PhysicsBodyComponent.self),
+                                platTransforms: world.store(TransformComponent.self),
+                                platMeshes: world.store(StaticMeshComponent.self),
+                                platformEntities: platformEntities,
+                                agents: agentSweepSet,
+                                active: active,
+                                dt: dt)
+
+        let workerCount = parallelEnabled && contactCachePolicy.isStateless
+            ? min(ProcessInfo.processInfo.activeProcessorCount, bodies.count / max(parallelBodiesPerWorker, 1))
+            : 1
+        if workerCount > 1 {
+            let results = moveBodiesParallel(bodies, inputs: inputs, query: query, workerCount: workerCount)
+            for case let r? in results {
+                writeBack(entity: r.entity,
+                          position: r.position,
+                          body: r.body,
+                          controller: r.controller,
+                          groundState: r.groundState,
+                          pStore: pStore,
+                          cStore: cStore)
+            }
+            return
+        }
+
         for e in bodies {
-            if !isActive(e, active) { continue }
-            guard var body = pStore[e], var controller = cStore[e] else { continue }
-            if body.bodyType == .static { continue }
-
-            var position = body.positionF
-            decayContactCache(controller: &controller, cachePolicy: &contactCachePolicy)
-            let selfAgent = aStore[e]
-            let selfRadius = selfAgent?.radiusOverride ?? controller.radius
-            // Apply platform motion carry/push before character sweep.
-            applyPlatformDelta(position: &position,
-                               controller: controller,
-                               platformEntities: platformEntities,
-                               platBodies: platBodies,
-                               platTransforms: platTransforms,
-                               platMeshes: platMeshes)
-            let wasGrounded = controller.grounded
-            let wasGroundedNear = controller.groundedNear
-            var remaining = VelocityGate.apply(body: &body,
-                                               wasGrounded: wasGrounded,
-                                               wasGroundedNear: wasGroundedNear,
-                                               dt: dt)
-            applyPreSweepDepenetration(position: &position,
-                                       body: &body,
-                                       controller: &controller,
-                                       remaining: &remaining,
-                                       query: query,
-                                       cachePolicy: &contactCachePolicy,
-                                       entity: e)
-            resolveKinematicSweep(entity: e,
-                                  position: &position,
-                                  remaining: &remaining,
-                                  body: &body,
-                                  controller: &controller,
-                                  wasGrounded: wasGrounded,
-                                  wasGroundedNear: wasGroundedNear,
-                                  selfAgent: selfAgent,
-                                  selfRadius: selfRadius,
-                                  agentStates: agentStates,
-                                  cachePolicy: &contactCachePolicy,
-                                  query: query,
-                                  dt: dt)
-
-            let groundState = resolveGroundContact(position: &position,
-                                                   body: &body,
-                                                   controller: &controller,
-                                                   query: query,
-                                                   wasGrounded: wasGrounded,
-                                                   wasGroundedNear: wasGroundedNear,
-                                                   dt: dt)
-
-            writeBack(entity: e,
-                      position: position,
-                      body: body,
-                      controller: controller,
-                      groundState: groundState,
+            guard let r = moveBody(e, inputs: inputs, query: query, cachePolicy: &contactCachePolicy) else { continue }
+            writeBack(entity: r.entity,
+                      position: r.position,
+                      body: r.body,
+                      controller: r.controller,
+                      groundState: r.groundState,
                       pStore: pStore,
                       cStore: cStore)
-
         }
     }
 }
@@ -1914,132 +2139,96 @@ public final class AgentSeparationSystem: FixedStepSystem {
         var controller: CharacterControllerComponent
     }
 
-    private struct AgentSeparationGrid {
-        struct CellCoord: Hashable {
-            let x: Int
-            let z: Int
-        }
-
-        let cellSize: Float
-        private(set) var cells: [CellCoord: [Int]]
-
-        init(cellSize: Float, capacity: Int) {
-            self.cellSize = cellSize
-            self.cells = [:]
-            self.cells.reserveCapacity(capacity)
-        }
-
-        mutating func rebuild(agents: [Agent]) {
-            cells.removeAll(keepingCapacity: true)
-            for i in agents.indices {
-                let c = cellCoord(for: agents[i].position)
-                cells[c, default: []].append(i)
-            }
-        }
-
-        func cellCoord(for pos: SIMD3<Float>) -> CellCoord {
-            let ix = Int(floor(pos.x / cellSize))
-            let iz = Int(floor(pos.z / cellSize))
-            return CellCoord(x: ix, z: iz)
-        }
-    }
-
     private struct AgentSeparationResolver {
         static func resolve(agents: inout [Agent],
-                            grid: AgentSeparationGrid,
+                            grid: AgentGrid,
                             separationMargin: Float,
                             heightMargin: Float,
                             query: CollisionQuery?) {
             for i in agents.indices {
                 let a = agents[i]
-                let cell = grid.cellCoord(for: a.position)
-                for dz in -1...1 {
-                    for dx in -1...1 {
-                        let neighbor = AgentSeparationGrid.CellCoord(x: cell.x + dx, z: cell.z + dz)
-                        guard let list = grid.cells[neighbor] else { continue }
-                        for j in list where j > i {
-                            let b = agents[j]
-                            let aMin = a.position.y - a.halfHeight
-                            let aMax = a.position.y + a.halfHeight
-                            let bMin = b.position.y - b.halfHeight
-                            let bMax = b.position.y + b.halfHeight
-                            let dx = a.position.x - b.position.x
-                            let dz = a.position.z - b.position.z
-                            let distSq = dx * dx + dz * dz
-                            let skinAllowance = min(a.controller.skinWidth, b.controller.skinWidth)
-                            let margin = min(separationMargin, skinAllowance)
-                            let minDist = a.radius + b.radius + margin
-                            let heightSeparated = aMax < bMin - heightMargin || aMin > bMax + heightMargin
-                            if heightSeparated { continue }
-
-                            if distSq >= minDist * minDist {
-                                continue
-                            }
-
-                            let dist = sqrt(max(distSq, 1e-8))
-                            let nx = dx / dist
-                            let nz = dz / dist
-                            let penetration = minDist - dist
-                            let wSum = a.invWeight + b.invWeight
-                            if wSum <= 0 {
-                                continue
-                            }
+                grid.forEachNeighbor(of: a.position) { j in
+                    guard j > i else { return }
+                    let b = agents[j]
+                    let aMin = a.position.y - a.halfHeight
+                    let aMax = a.position.y + a.halfHeight
+                    let bMin = b.position.y - b.halfHeight
+                    let bMax = b.position.y + b.halfHeight
+                    let dx = a.position.x - b.position.x
+                    let dz = a.position.z - b.position.z
+                    let distSq = dx * dx + dz * dz
+                    let skinAllowance = min(a.controller.skinWidth, b.controller.skinWidth)
+                    let margin = min(separationMargin, skinAllowance)
+                    let minDist = a.radius + b.radius + margin
+                    let heightSeparated = aMax < bMin - heightMargin || aMin > bMax + heightMargin
+                    if heightSeparated { return }
+
+                    if distSq >= minDist * minDist {
+                        return
+                    }
 
-                            let corr = penetration / wSum
-                            var moveA = SIMD3<Float>(nx * corr * a.invWeight, 0, nz * corr * a.invWeight)
-                            var moveB = SIMD3<Float>(-nx * corr * b.invWeight, 0, -nz * corr * b.invWeight)
-                            let relV = a.velocity - b.velocity
-                            let vn = relV.x * nx + relV.z * nz
-                            if vn < 0 {
-                                let impulse = -vn
-                                let scaleA = a.invWeight / wSum
-                                let scaleB = b.invWeight / wSum
-                                agents[i].velocity.x += nx * impulse * scaleA
-                                agents[i].velocity.z += nz * impulse * scaleA
-                                agents[j].velocity.x -= nx * impulse * scaleB
-                                agents[j].velocity.z -= nz * impulse * scaleB
-                            }
-                            if let query = query {
-                                let eps: Float = 1e-6
-                                var blockedA = false
-                                var blockedB = false
-                                let lenA = simd_length(moveA)
-                                if lenA > eps,
-                                   let hit = query.capsuleCastBlocking(from: agents[i].position,
-                                                                       delta: moveA,
-                                                                       radius: a.radius,
-                                                                       halfHeight: a.halfHeight,
-                                                                       mask: a.controller.collisionMask),
-                                   hit.toi <= a.controller.skinWidth,
-                                   hit.normal.y < a.controller.minGroundDot {
-                                    blockedA = true
-                                }
-                                let lenB = simd_length(moveB)
-                                if lenB > eps,
-                                   let hit = query.capsuleCastBlocking(from: agents[j].position,
-                                                                       delta: moveB,
-                                                                       radius: b.radius,
-                                                                       halfHeight: b.halfHeight,
-                                                                       mask: b.controller.collisionMask),
-                                   hit.toi <= b.controller.skinWidth,
-                                   hit.normal.y < b.controller.minGroundDot {
-                                    blockedB = true
-                                }
-                                if blockedA && !blockedB {
-                                    moveA = .zero
-                                    moveB = SIMD3<Float>(-nx * penetration, 0, -nz * penetration)
-                                } else if blockedB && !blockedA {
-                                    moveB = .zero
-                                    moveA = SIMD3<Float>(nx * penetration, 0, nz * penetration)
-                                } else if blockedA && blockedB {
-                                    continue
-                                }
-                            }
+                    let dist = sqrt(max(distSq, 1e-8))
+                    let nx = dx / dist
+                    let nz = dz / dist
+                    let penetration = minDist - dist
+                    let wSum = a.invWeight + b.invWeight
+                    if wSum <= 0 {
+                        return
+                    }
 
-                            agents[i].position += moveA
-                            agents[j].position += moveB
+                    let corr = penetration / wSum
+                    var moveA = SIMD3<Float>(nx * corr * a.invWeight, 0, nz * corr * a.invWeight)
+                    var moveB = SIMD3<Float>(-nx * corr * b.invWeight, 0, -nz * corr * b.invWeight)
+                    let relV = a.velocity - b.velocity
+                    let vn = relV.x * nx + relV.z * nz
+                    if vn < 0 {
+                        let impulse = -vn
+                        let scaleA = a.invWeight / wSum
+                        let scaleB = b.invWeight / wSum
+                        agents[i].velocity.x += nx * impulse * scaleA
+                        agents[i].velocity.z += nz * impulse * scaleA
+                        agents[j].velocity.x -= nx * impulse * scaleB
+                        agents[j].velocity.z -= nz * impulse * scaleB
+                    }
+                    if let query = query {
+                        let eps: Float = 1e-6
+                        var blockedA = false
+                        var blockedB = false
+                        let lenA = simd_length(moveA)
+                        if lenA > eps,
+                           let hit = query.capsuleCastBlocking(from: agents[i].position,
+                                                               delta: moveA,
+                                                               radius: a.radius,
+                                                               halfHeight: a.halfHeight,
+                                                               mask: a.controller.collisionMask),
+                           hit.toi <= a.controller.skinWidth,
+                           hit.normal.y < a.controller.minGroundDot {
+                            blockedA = true
+                        }
+                        let lenB = simd_length(moveB)
+                        if lenB > eps,
+                           let hit = query.capsuleCastBlocking(from: agents[j].position,
+                                                               delta: moveB,
+                                                               radius: b.radius,
+                                                               halfHeight: b.halfHeight,
+                                                               mask: b.controller.collisionMask),
+                           hit.toi <= b.controller.skinWidth,
+                           hit.normal.y < b.controller.minGroundDot {
+                            blockedB = true
+                        }
+                        if blockedA && !blockedB {
+                            moveA = .zero
+                            moveB = SIMD3<Float>(-nx * penetration, 0, -nz * penetration)
+                        } else if blockedB && !blockedA {
+                            moveB = .zero
+                            moveA = SIMD3<Float>(nx * penetration, 0, nz * penetration)
+                        } else if blockedA && blockedB {
+                            return
                         }
                     }
+
+                    agents[i].position += moveA
+                    agents[j].position += moveB
                 }
             }
         }
@@ -2126,6 +2315,8 @@ public final class AgentSeparationSystem: FixedStepSystem {
     public var separationMargin: Float
     public var heightMargin: Float
     private var query: CollisionQuery?
+    /// Reused across steps so rebuilding it does not allocate once warmed up.
+    private var grid = AgentGrid()
 
     public init(iterations: Int = 2,
                 separationMargin: Float = 0.2,
@@ -2181,10 +2372,9 @@ public final class AgentSeparationSystem: FixedStepSystem {
         guard agents.count > 1 else { return }
 
         let cellSize = max(maxRadius * 2 + separationMargin, 0.001)
-        var grid = AgentSeparationGrid(cellSize: cellSize, capacity: agents.count * 2)
 
         for _ in 0..<iterations {
-            grid.rebuild(agents: agents)
+            grid.rebuild(count: agents.count, cellSize: cellSize) { agents[$0].position }
             AgentSeparationResolver.resolve(agents: &agents,
                                             grid: grid,
                                             separationMargin: separationMargin,
@@ -2213,6 +2403,14 @@ public final class AgentSeparationSystem: FixedStepSystem {
 public final class PhysicsIntegrateSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(CharacterControllerComponent.self)
+            .reading(KinematicPlatformComponent.self)
+            .writing(PhysicsBodyComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         let bodies = world.query(PhysicsBodyComponent.self)
         let pStore = world.store(PhysicsBodyComponent.self)
@@ -2249,6 +2447,13 @@ public final class PhysicsIntegrateSystem: FixedStepSystem {
 public final class PhysicsWritebackSystem: FixedStepSystem {
     public init() {}
 
+    public var access: ComponentAccess? {
+        ComponentAccess()
+            .reading(ActiveChunkComponent.self)
+            .reading(PhysicsBodyComponent.self)
+            .writing(TransformComponent.self)
+    }
+
     public func fixedUpdate(world: World, dt: Float) {
         _ = dt
         let bodies = world.query(PhysicsBodyComponent.self)
@@ -2412,18 +2617,73 @@ public final class ActiveChunkSystem: FixedStepSystem {
 
 /// Extract RenderItems from ECS.
 /// This does NOT bump scene revision; it's per-frame derived output.
+///
+/// Retained mode (the default) keeps `items` across frames. The entity sets are re-queried
+/// and re-sorted only when a render, skinned-mesh, transform or pose component is added or
+/// removed, or a render component is rewritten; that bumps `changes.structureVersion`.
+/// Otherwise an item is refreshed only when its inputs moved: the write stamps of its
+/// transform, physics body, world position or follow target (full matrix), the
+/// interpolation alpha for moving bodies, the camera origin (translation only for the
+/// rest), or its pose revision and LOD (palette).
 public final class RenderExtractSystem {
+    /// When false, every frame runs the full query-and-sort extraction.
+    public var retained: Bool = true
+    public private(set) var items: [RenderItem] = []
+    public private(set) var changes = RenderItemChanges()
+
+    /// Where an item is placed before the camera offset.
+    private enum Placement {
+        /// Moving body: the whole matrix depends on the interpolation alpha.
+        case interpolated
+        /// Settled chunk-space position, offset from the camera in Double.
+        case world(SIMD3<Double>)
+        /// Plain transform translation, offset from the camera in Float.
+        case local(SIMD3<Float>)
+    }
+
+    /// One extracted entity and the items it produced.
+    private struct Record {
+        let entity: Entity
+        let firstItem: Int
+        let itemCount: Int
+        let skinned: Bool
+        let invBind: [matrix_float4x4]?
+        /// Stamps of the target's transform, physics body and world position, and of the
+        /// entity's follow component.
+        var stamps: SIMD4<UInt64>
+        var placement: Placement
+        /// Model matrix without its translation.
+        var basis: matrix_float4x4
+        var poseRevision: UInt32
+        var lod: AnimationLOD
+    }
+
+    /// Stores and per-frame values the matrix helpers read.
+    private struct Frame {
+        let tStore: ComponentStore<TransformComponent>
+        let pStore: ComponentStore<PhysicsBodyComponent>
+        let wStore: ComponentStore<WorldPositionComponent>
+        let followStore: ComponentStore<FollowTargetComponent>
+        let alpha: Float
+        let cameraWorld: SIMD3<Double>
+        let cameraWorldFloat: SIMD3<Float>
+    }
+
+    private struct Resolved {
+        let matrix: matrix_float4x4
+        let placement: Placement
+        let basis: matrix_float4x4
+    }
+
+    private var records: [Record] = []
+    private var signature: [UInt64] = []
+    private var lastAlpha: Float = -1
+    private var lastCameraWorld: SIMD3<Double>?
+
     public init() {}
 
+    @discardableResult
     public func extract(world: World, camera: Camera) -> [RenderItem] {
-        let tStore = world.store(TransformComponent.self)
-        let rStore = world.store(RenderComponent.self)
-        let skStore = world.store(SkinnedMeshComponent.self)
-        let skGroupStore = world.store(SkinnedMeshGroupComponent.self)
-        let poseStore = world.store(PoseComponent.self)
-        let followStore = world.store(FollowTargetComponent.self)
-        let pStore = world.store(PhysicsBodyComponent.self)
-        let wStore = world.store(WorldPositionComponent.self)
         let timeStore = world.store(TimeComponent.self)
         let alpha: Float = {
             guard let e = world.query(TimeComponent.self).first,
@@ -2435,51 +2695,92 @@ public final class RenderExtractSystem {
             return min(max(a, 0), 1)
         }()
         let cameraWorld = WorldPosition.toWorld(chunk: camera.worldChunk, local: camera.worldLocal)
-        let cameraWorldFloat = SIMD3<Float>(Float(cameraWorld.x),
-                                            Float(cameraWorld.y),
-                                            Float(cameraWorld.z))
-
-        func interpolatedModelMatrix(for e: Entity) -> matrix_float4x4? {
-            if let follow = followStore[e] {
-                return interpolatedModelMatrix(forTarget: follow.target)
-            }
-            return interpolatedModelMatrix(forTarget: e)
+        let frame = Frame(tStore: world.store(TransformComponent.self),
+                          pStore: world.store(PhysicsBodyComponent.self),
+                          wStore: world.store(WorldPositionComponent.self),
+                          followStore: world.store(FollowTargetComponent.self),
+                          alpha: alpha,
+                          cameraWorld: cameraWorld,
+                          cameraWorldFloat: SIMD3<Float>(Float(cameraWorld.x),
+                                                         Float(cameraWorld.y),
+                                                         Float(cameraWorld.z)))
+
+        let current = structureSignature(world: world)
+        if !retained || current != signature {
+            signature = current
+            rebuild(world: world, frame: frame)
+        } else {
+            refresh(world: world, frame: frame)
         }
+        lastAlpha = alpha
+        lastCameraWorld = cameraWorld
+        return items
+    }
 
-        func interpolatedModelMatrix(forTarget e: Entity) -> matrix_float4x4? {
-            guard let t = tStore[e] else { return nil }
-            let rot: simd_quatf = {
-                if let p = pStore[e] {
-                    return simd_slerp(p.prevRotation, p.rotation, alpha)
-                }
-                return t.rotation
-            }()
-            if let w = wStore[e] {
-                let prevWorld = WorldPosition.toWorld(chunk: w.prevChunk, local: w.prevLocal)
-                let currWorld = WorldPosition.toWorld(chunk: w.chunk, local: w.local)
-                let interpWorld = prevWorld + (currWorld - prevWorld) * Double(alpha)
-                let renderPos = interpWorld - cameraWorld
-                let interp = TransformComponent(translation: SIMD3<Float>(Float(renderPos.x),
-                                                                          Float(renderPos.y),
-                                                                          Float(renderPos.z)),
-                                                rotation: rot,
-                                                scale: t.scale)
-                return interp.modelMatrix
-            }
-            if let p = pStore[e] {
-                let interpWorld = p.prevPosition + (p.position - p.prevPosition) * Double(alpha)
-                let renderPos = interpWorld - cameraWorld
-                let interp = TransformComponent(translation: SIMD3<Float>(Float(renderPos.x),
-                                                                          Float(renderPos.y),
-                                                                          Float(renderPos.z)),
-                                                rotation: rot,
-                                                scale: t.scale)
-                return interp.modelMatrix
-            }
-            var renderT = t
-            renderT.translation -= cameraWorldFloat
-            return renderT.modelMatrix
+    /// Versions whose change invalidates the item list. Render components are only written
+    /// when added or swapped, so any write to them counts as structural; removals bump only
+    /// `structureVersion`, so that is part of the signature too (e.g. the placeholder removed
+    /// when a streamed asset fails).
+    private func structureSignature(world: World) -> [UInt64] {
+        let rStore = world.store(RenderComponent.self)
+        let skStore = world.store(SkinnedMeshComponent.self)
+        let skGroupStore = world.store(SkinnedMeshGroupComponent.self)
+        return [world.store(TransformComponent.self).structureVersion,
+                world.store(PoseComponent.self).structureVersion,
+                rStore.writeVersion,
+                rStore.structureVersion,
+                skStore.writeVersion,
+                skStore.structureVersion,
+                skGroupStore.writeVersion,
+                skGroupStore.structureVersion]
+    }
+
+    private func stamps(entity: Entity, target: Entity, frame: Frame) -> SIMD4<UInt64> {
+        SIMD4<UInt64>(frame.tStore.stamp(target),
+                      frame.pStore.stamp(target),
+                      frame.wStore.stamp(target),
+                      frame.followStore.stamp(entity))
+    }
+
+    private func renderTarget(of e: Entity, frame: Frame) -> Entity {
+        frame.followStore[e]?.target ?? e
+    }
+
+    private func resolve(_ e: Entity, frame: Frame) -> Resolved? {
+        guard let t = frame.tStore[e] else { return nil }
+        let p = frame.pStore[e]
+        let rot = p.map { simd_slerp($0.prevRotation, $0.rotation, frame.alpha) } ?? t.rotation
+        let renderPos: SIMD3<Float>
+        let placement: Placement
+        if let w = frame.wStore[e] {
+            let prevWorld = WorldPosition.toWorld(chunk: w.prevChunk, local: w.prevLocal)
+            let currWorld = WorldPosition.toWorld(chunk: w.chunk, local: w.local)
+            let interpWorld = prevWorld + (currWorld - prevWorld) * Double(frame.alpha)
+            let r = interpWorld - frame.cameraWorld
+            renderPos = SIMD3<Float>(Float(r.x), Float(r.y), Float(r.z))
+            placement = p != nil || prevWorld != currWorld ? .interpolated : .world(currWorld)
+        } else if let p {
+            let interpWorld = p.prevPosition + (p.position - p.prevPosition) * Double(frame.alpha)
+            let r = interpWorld - frame.cameraWorld
+            renderPos = SIMD3<Float>(Float(r.x), Float(r.y), Float(r.z))
+            placement = .interpolated
+        } else {
+            renderPos = t.translation - frame.cameraWorldFloat
+            placement = .local(t.translation)
         }
+        let basis = TransformComponent(translation: .zero, rotation: rot, scale: t.scale).modelMatrix
+        var matrix = basis
+        matrix.columns.3 = SIMD4<Float>(renderPos, 1)
+        return Resolved(matrix: matrix, placement: placement, basis: basis)
+    }
+
+    /// Full extraction: queries, stable ordering and fresh records.
+    private func rebuild(world: World, frame: Frame) {
+        let rStore = world.store(RenderComponent.self)
+        let skStore = world.store(SkinnedMeshComponent.self)
+        let skGroupStore = world.store(SkinnedMeshGroupComponent.self)
+        let poseStore = world.store(PoseComponent.self)
+        let lodStore = world.store(AnimationLODComponent.self)
 
         // ✅ Stable ordering for deterministic draw-call order (picking/debug/sorting friendly)
         let skinnedEntities = world
@@ -2497,51 +2798,147 @@ public final class RenderExtractSystem {
             .query(TransformComponent.self, RenderComponent.self)
             .sorted { $0.id < $1.id }
 
-        var items: [RenderItem] = []
+        items.removeAll(keepingCapacity: true)
         items.reserveCapacity(entities.count + skinnedEntities.count + skinnedGroupEntities.count)
+        records.removeAll(keepingCapacity: true)
+
+        func record(_ e: Entity, resolved: Resolved, firstItem: Int, skinned: Bool,
+                    invBind: [matrix_float4x4]?, pose: PoseComponent?, lod: AnimationLOD) {
+            let target = renderTarget(of: e, frame: frame)
+            records.append(Record(entity: e,
+                                  firstItem: firstItem,
+                                  itemCount: items.count - firstItem,
+                                  skinned: skinned,
+                                  invBind: invBind,
+                                  stamps: stamps(entity: e, target: target, frame: frame),
+                                  placement: resolved.placement,
+                                  basis: resolved.basis,
+                                  poseRevision: pose?.revision ?? 0,
+                                  lod: lod))
+        }
 
         for e in skinnedEntities {
             guard let sk = skStore[e], let pose = poseStore[e] else { continue }
-            guard let modelMatrix = interpolatedModelMatrix(for: e) else { continue }
-            let palette: [matrix_float4x4]
-            if let invBind = sk.mesh.invBindModel, invBind.count == pose.model.count {
-                palette = zip(pose.model, invBind).map { simd_mul($0, $1) }
-            } else {
-                palette = pose.palette
-            }
+            guard let resolved = resolve(renderTarget(of: e, frame: frame), frame: frame) else { continue }
+            let lod = lodStore[e]?.level ?? .full
+            let palette = SkinningPalette.resolve(entity: e,
+                                                  pose: pose,
+                                                  invBind: sk.mesh.invBindModel,
+                                                  lod: lod)
+            let first = items.count
             items.append(RenderItem(mesh: nil,
                                     skinnedMesh: sk.mesh,
                                     skinningPalette: palette,
                                     material: sk.material,
-                                    modelMatrix: modelMatrix))
+                                    modelMatrix: resolved.matrix))
+            record(e, resolved: resolved, firstItem: first, skinned: true,
+                   invBind: sk.mesh.invBindModel, pose: pose, lod: lod)
         }
 
         for e in skinnedGroupEntities {
             guard let sk = skGroupStore[e], let pose = poseStore[e] else { continue }
-            guard let modelMatrix = interpolatedModelMatrix(for: e) else { continue }
-            let palette: [matrix_float4x4] = {
-                if let invBind = sk.meshes.first?.invBindModel, invBind.count == pose.model.count {
-                    return zip(pose.model, invBind).map { simd_mul($0, $1) }
-                }
-                return pose.palette
-            }()
+            guard let resolved = resolve(renderTarget(of: e, frame: frame), frame: frame) else { continue }
+            let lod = lodStore[e]?.level ?? .full
+            let invBind = sk.meshes.first?.invBindModel
+            let palette = SkinningPalette.resolve(entity: e,
+                                                  pose: pose,
+                                                  invBind: invBind,
+                                                  lod: lod)
             let count = min(sk.meshes.count, sk.materials.count)
             if count == 0 { continue }
+            let first = items.count
             for i in 0..<count {
                 items.append(RenderItem(mesh: nil,
                                         skinnedMesh: sk.meshes[i],
                                         skinningPalette: palette,
                                         material: sk.materials[i],
-                                        modelMatrix: modelMatrix))
+                                        modelMatrix: resolved.matrix))
             }
+            record(e, resolved: resolved, firstItem: first, skinned: true,
+                   invBind: invBind, pose: pose, lod: lod)
         }
 
         for e in entities {
             if skinnedSet.contains(e) { continue }
             guard let r = rStore[e] else { continue }
-            guard let modelMatrix = interpolatedModelMatrix(for: e) else { continue }
-            items.append(RenderItem(mesh: r.mesh, material: r.material, modelMatrix: modelMatrix))
+            guard let resolved = resolve(renderTarget(of: e, frame: frame), frame: frame) else { continue }
+            let first = items.count
+            items.append(RenderItem(mesh: r.mesh, material: r.material, modelMatrix: resolved.matrix))
+            record(e, resolved: resolved, firstItem: first, skinned: false,
+                   invBind: nil, pose: nil, lod: .full)
         }
-        return items
+
+        changes = RenderItemChanges(structureVersion: changes.structureVersion &+ 1)
+    }
+
+    /// Retained update: touches only the items whose inputs changed.
+    private func refresh(world: World, frame: Frame) {
+        let poseStore = world.store(PoseComponent.self)
+        let lodStore = world.store(AnimationLODComponent.self)
+        let cameraMoved = frame.cameraWorld != lastCameraWorld
+        let alphaChanged = frame.alpha != lastAlpha
+        var transformed: [Int] = []
+        var posed: [Int] = []
+
+        for r in records.indices {
+            var record = records[r]
+            let target = renderTarget(of: record.entity, frame: frame)
+            let current = stamps(entity: record.entity, target: target, frame: frame)
+            var matrix: matrix_float4x4?
+            if current != record.stamps {
+                if let resolved = resolve(target, frame: frame) {
+                    record.stamps = current
+                    record.placement = resolved.placement
+                    record.basis = resolved.basis
+                    matrix = resolved.matrix
+                }
+            } else {
+                switch record.placement {
+                case .interpolated:
+                    if alphaChanged || cameraMoved {
+                        matrix = resolve(target, frame: frame)?.matrix
+                    }
+                case .world(let position):
+                    if cameraMoved {
+                        let p = position - frame.cameraWorld
+                        matrix = record.basis
+                        matrix?.columns.3 = SIMD4<Float>(Float(p.x), Float(p.y), Float(p.z), 1)
+                    }
+                case .local(let translation):
+                    if cameraMoved {
+                        matrix = record.basis
+                        matrix?.columns.3 = SIMD4<Float>(translation - frame.cameraWorldFloat, 1)
+                    }
+                }
+            }
+            let range = record.firstItem..<(record.firstItem + record.itemCount)
+            if let matrix {
+                for i in range {
+                    items[i].modelMatrix = matrix
+                }
+                transformed.append(contentsOf: range)
+            }
+
+            if record.skinned, let pose = poseStore[record.entity] {
+                let lod = lodStore[record.entity]?.level ?? .full
+                if pose.revision != record.poseRevision || lod != record.lod {
+                    let palette = SkinningPalette.resolve(entity: record.entity,
+                                                          pose: pose,
+                                                          invBind: record.invBind,
+                                                          lod: lod)
+                    for i in range {
+                        items[i].skinningPalette = palette
+                    }
+                    posed.append(contentsOf: range)
+                    record.poseRevision = pose.revision
+                    record.lod = lod
+                }
+            }
+            records[r] = record
+        }
+
+        changes = RenderItemChanges(structureVersion: changes.structureVersion,
+                                    transformed: transformed,
+                                    posed: posed)
     }
 }
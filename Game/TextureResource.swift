@@ -5,9 +5,12 @@
 //  Created by 伈佊 on 1/2/26.
 //
 
+import Foundation
 import Metal
 
-public final class TextureResource {
+/// Immutable once created, and Metal textures may be shared between threads, so asset
+/// loads build these off the main thread.
+public nonisolated final class TextureResource: @unchecked Sendable {
     public let texture: MTLTexture
 
     public init(texture: MTLTexture, label: String = "Texture") {
@@ -34,7 +37,7 @@ public final class TextureResource {
         let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: pixelFormat,
                                                             width: w,
                                                             height: h,
-                                                            mipmapped: false)
+                                                            mipmapped: source.mipmapped)
         desc.usage = [.shaderRead]
         // Keep it simple & always CPU-updatable for now:
         desc.storageMode = .shared
@@ -47,4 +50,53 @@ public final class TextureResource {
             self.texture.replace(region: region, mipmapLevel: 0, withBytes: raw.baseAddress!, bytesPerRow: w * 4)
         }
     }
+
+    /// Queues the mip chains of every mipmapped texture in `resources` for the next frame
+    /// (`encodePendingMipmaps`); level 0 is already complete on return.
+    public static func generateMipmaps(_ resources: [TextureResource]) {
+        PendingMipmaps.shared.add(resources.lazy.map(\.texture).filter { $0.mipmapLevelCount > 1 })
+    }
+
+    /// Fills every queued mip chain from its level 0 with one blit at the start of
+    /// `commandBuffer`. Encoded on the queue that then samples the textures, so the chains
+    /// are complete before any later pass reads them without the build path waiting on
+    /// the GPU or creating a queue per material.
+    public static func encodePendingMipmaps(commandBuffer: MTLCommandBuffer) {
+        let textures = PendingMipmaps.shared.take()
+        guard !textures.isEmpty, let blit = commandBuffer.makeBlitCommandEncoder() else { return }
+        blit.label = "TextureResource.Mipmaps"
+        for texture in textures {
+            blit.generateMipmaps(for: texture)
+        }
+        blit.endEncoding()
+    }
+}
+
+/// Textures whose mip chains wait for `TextureResource.encodePendingMipmaps`. Filled from
+/// scene builds and background asset loads alike, so every material created between two
+/// frames shares one blit. One per process because `MaterialFactory` has no renderer to
+/// hand them to; whichever renderer encodes first takes them all.
+///
+/// Unchecked Sendable: `lock` guards `textures`, the only mutable state. A texture is only
+/// used again by the blit, after `take` has removed it under the lock, so `MTLTexture`
+/// itself not being Sendable is never observable.
+private nonisolated final class PendingMipmaps: @unchecked Sendable {
+    static let shared = PendingMipmaps()
+
+    private let lock = NSLock()
+    private var textures: [MTLTexture] = []
+
+    func add<S: Sequence>(_ pending: S) where S.Element == MTLTexture {
+        lock.lock()
+        textures.append(contentsOf: pending)
+        lock.unlock()
+    }
+
+    func take() -> [MTLTexture] {
+        lock.lock()
+        defer { lock.unlock() }
+        let taken = textures
+        textures.removeAll()
+        return taken
+    }
 }
@@ -7,58 +7,72 @@
 
 import Metal
 
-struct UniformAllocation {
+struct UniformAllocation<T> {
     let buffer: MTLBuffer
     let offset: Int
-    let pointer: UnsafeMutablePointer<Uniforms>
+    let pointer: UnsafeMutablePointer<T>
+    let count: Int
     let frameIndex: Int
 }
 
-/// Per-frame ring + per-draw linear allocator:
-/// buffer layout: [frame0 draw0..drawN] [frame1 draw0..drawN] ...
+/// Per-frame ring of linear allocators: one shared buffer per frame slot, reset by
+/// `beginFrame`. Each allocation starts on a `uniformAllocationAlignment` boundary. A slot
+/// that runs out mid-frame moves to a buffer twice as large; draws already encoded keep the
+/// old one (encoders retain their bound buffers), so there is no per-frame draw limit.
 final class UniformRingBuffer {
-    let buffer: MTLBuffer
-    private let alignedSize: Int
-    private let maxFrames: Int
-    private let maxDrawsPerFrame: Int
+    private let device: MTLDevice
+    private var buffers: [MTLBuffer]
+    private var cursor: Int = 0
 
     private(set) var frameIndex: Int = 0
-    private var drawIndex: Int = 0
+
+    /// The current slot's buffer.
+    var buffer: MTLBuffer {
+        buffers[frameIndex]
+    }
 
     init?(device: MTLDevice,
           maxFramesInFlight: Int,
-          maxDrawsPerFrame: Int = 256,
-          alignedUniformSize: Int = alignedUniformsSize) {
-
-        self.alignedSize = alignedUniformSize
-        self.maxFrames = maxFramesInFlight
-        self.maxDrawsPerFrame = maxDrawsPerFrame
-
-        let totalSize = alignedSize * maxFrames * maxDrawsPerFrame
-        guard let buf = device.makeBuffer(length: totalSize, options: [.storageModeShared]) else {
-            return nil
+          initialBytesPerFrame: Int = 64 * 1024) {
+        self.device = device
+        var buffers: [MTLBuffer] = []
+        for _ in 0..<maxFramesInFlight {
+            guard let buf = device.makeBuffer(length: initialBytesPerFrame, options: [.storageModeShared]) else {
+                return nil
+            }
+            buf.label = "UniformBuffer"
+            buffers.append(buf)
         }
-        buf.label = "UniformBuffer"
-        self.buffer = buf
+        self.buffers = buffers
     }
 
-    /// Call once per frame before encoding draw calls.
-    func beginFrame() -> Int {
-        frameIndex = (frameIndex + 1) % maxFrames
-        drawIndex = 0
+    /// Call once per frame before encoding draw calls, with the `FrameSync.slot` whose
+    /// previous frame has already been waited for.
+    func beginFrame(slot: Int) -> Int {
+        frameIndex = slot % buffers.count
+        cursor = 0
         return frameIndex
     }
 
-    /// Allocate one Uniforms slot for one draw call.
-    func allocate() -> UniformAllocation {
-        precondition(drawIndex < maxDrawsPerFrame, "Exceeded maxDrawsPerFrame=\(maxDrawsPerFrame)")
-
-        let base = (frameIndex * maxDrawsPerFrame + drawIndex) * alignedSize
-        drawIndex += 1
-
-        let ptr = UnsafeMutableRawPointer(buffer.contents() + base)
-            .bindMemory(to: Uniforms.self, capacity: 1)
+    /// Allocates `count` contiguous values of `T` for this frame; nil only if a larger
+    /// buffer could not be created.
+    func allocate<T>(_ type: T.Type, count: Int = 1) -> UniformAllocation<T>? {
+        let length = max(count, 1) * MemoryLayout<T>.stride
+        var offset = (cursor + uniformAllocationAlignment - 1) & -uniformAllocationAlignment
+        if offset + length > buffers[frameIndex].length {
+            let grown = max(buffers[frameIndex].length * 2, length + uniformAllocationAlignment)
+            guard let buf = device.makeBuffer(length: grown, options: [.storageModeShared]) else {
+                print("UniformRingBuffer: unable to grow to \(grown) bytes")
+                return nil
+            }
+            buf.label = "UniformBuffer"
+            buffers[frameIndex] = buf
+            offset = 0
+        }
+        cursor = offset + length
 
-        return UniformAllocation(buffer: buffer, offset: base, pointer: ptr, frameIndex: frameIndex)
+        let target = buffers[frameIndex]
+        let ptr = (target.contents() + offset).bindMemory(to: type, capacity: max(count, 1))
+        return UniformAllocation(buffer: target, offset: offset, pointer: ptr, count: count, frameIndex: frameIndex)
     }
 }
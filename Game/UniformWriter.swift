@@ -10,29 +10,26 @@ import simd
 func writeUniforms(_ ptr: UnsafeMutablePointer<Uniforms>,
                    projection: matrix_float4x4,
                    view: matrix_float4x4,
-                   model: matrix_float4x4,
-                   baseColorFactor: SIMD3<Float>,
-                   baseAlpha: Float,
-                   emissiveFactor: SIMD3<Float>,
-                   unlit: Bool,
-                   normalScale: Float,
-                   occlusionStrength: Float,
-                   exposure: Float,
-                   toneMapEnabled: Bool,
                    cameraPosition: SIMD3<Float>,
                    worldOrigin: SIMD3<Float>) {
 
     ptr[0].projectionMatrix = projection
     ptr[0].viewMatrix = view
-    ptr[0].modelMatrix = model
-    ptr[0].baseColorFactor = baseColorFactor
-    ptr[0].baseAlpha = baseAlpha
-    ptr[0].emissiveFactor = emissiveFactor
-    ptr[0].unlit = unlit ? 1.0 : 0.0
-    ptr[0].normalScale = normalScale
-    ptr[0].occlusionStrength = occlusionStrength
-    ptr[0].exposure = exposure
-    ptr[0].toneMapEnabled = toneMapEnabled ? 1.0 : 0.0
     ptr[0].cameraPosition = cameraPosition
     ptr[0].worldOrigin = worldOrigin
 }
+
+func writeDrawInstance(_ ptr: UnsafeMutablePointer<DrawInstance>,
+                       model: matrix_float4x4,
+                       material: Material) {
+
+    ptr[0].modelMatrix = model
+    ptr[0].baseColorFactor = material.baseColorFactor
+    ptr[0].baseAlpha = material.alpha
+    ptr[0].emissiveFactor = material.emissiveFactor
+    ptr[0].unlit = material.unlit ? 1.0 : 0.0
+    ptr[0].normalScale = material.normalScale
+    ptr[0].occlusionStrength = material.occlusionStrength
+    ptr[0].exposure = material.exposure
+    ptr[0].toneMapEnabled = material.toneMapped ? 1.0 : 0.0
+}
@@ -9,7 +9,7 @@ import Metal
 import simd
 
 /// Procedural-friendly CPU vertex layout (one buffer: position+normal+uv)
-public struct VertexPNUT {
+public nonisolated struct VertexPNUT: Sendable {
     public var position: SIMD3<Float>
     public var normal: SIMD3<Float>
     public var uv: SIMD2<Float>
@@ -9,68 +9,216 @@ import Foundation
 
 // MARK: - ComponentStore
 
-public final class ComponentStore<T> {
-    // Using Dictionary keeps it simple; can be replaced by sparse-set later.
-    fileprivate var data: [Entity: T] = [:]
+/// Type-erased store surface so World can remove and filter without knowing T.
+nonisolated protocol AnyComponentStore: AnyObject {
+    var count: Int { get }
+    var entities: [Entity] { get }
+    func contains(_ e: Entity) -> Bool
+    func remove(_ e: Entity)
+}
+
+/// Sparse-set storage: components are packed in a dense array next to their owning
+/// entities, `sparse` maps entity id -> dense slot (-1 = absent). Removal swaps the
+/// last element into the hole, so dense order is not stable across removals.
+///
+/// Every write stamps its slot with the bumped `writeVersion`, so consumers that keep
+/// derived data (RenderExtractSystem) can tell which entities changed since they looked.
+///
+/// Not synchronized: worker threads may read a store (KinematicMoveStopSystem's parallel
+/// solve) only while its owner blocks and nothing writes to it.
+public nonisolated final class ComponentStore<T>: AnyComponentStore {
+    private var sparse: [Int32] = []
+    /// Dense owners, index-aligned with `components`.
+    public private(set) var entities: [Entity] = []
+    /// Dense component payloads, index-aligned with `entities`.
+    public private(set) var components: [T] = []
+    /// Dense write stamps, index-aligned with `entities`.
+    private var stamps: [UInt64] = []
+    /// Bumped when an entity gains or loses this component.
+    public private(set) var structureVersion: UInt64 = 0
+    /// Bumped on every write, including inserts and `forEach`.
+    public private(set) var writeVersion: UInt64 = 0
+
+    public init() {}
+
+    public var count: Int { entities.count }
+
+    @inline(__always)
+    private func slot(_ e: Entity) -> Int? {
+        let id = Int(e.id)
+        guard id < sparse.count else { return nil }
+        let s = sparse[id]
+        return s >= 0 ? Int(s) : nil
+    }
+
+    /// `writeVersion` as of the last write to `e`'s component, or 0 when `e` has none.
+    @inline(__always)
+    public func stamp(_ e: Entity) -> UInt64 {
+        guard let i = slot(e) else { return 0 }
+        return stamps[i]
+    }
 
     public subscript(_ e: Entity) -> T? {
-        get { data[e] }
-        set { data[e] = newValue }
+        get {
+            guard let i = slot(e) else { return nil }
+            return components[i]
+        }
+        set {
+            if let value = newValue {
+                insert(e, value)
+            } else {
+                remove(e)
+            }
+        }
     }
 
     public func remove(_ e: Entity) {
-        data.removeValue(forKey: e)
+        guard let i = slot(e) else { return }
+        let last = entities.count - 1
+        if i != last {
+            let moved = entities[last]
+            entities[i] = moved
+            components.swapAt(i, last)
+            stamps.swapAt(i, last)
+            sparse[Int(moved.id)] = Int32(i)
+        }
+        entities.removeLast()
+        components.removeLast()
+        stamps.removeLast()
+        sparse[Int(e.id)] = -1
+        structureVersion &+= 1
     }
 
     public func contains(_ e: Entity) -> Bool {
-        data[e] != nil
+        slot(e) != nil
+    }
+
+    public func reserveCapacity(_ n: Int) {
+        entities.reserveCapacity(n)
+        components.reserveCapacity(n)
+        stamps.reserveCapacity(n)
     }
 
-    public var entities: Dictionary<Entity, T>.Keys { data.keys }
+    /// Visit every component in dense order and mutate it in place.
+    /// `body` must not add/remove components of this type or read this store.
+    /// Every component counts as written.
+    public func forEach(_ body: (Entity, inout T) throws -> Void) rethrows {
+        let owners = entities
+        writeVersion &+= 1
+        let version = writeVersion
+        for i in stamps.indices {
+            stamps[i] = version
+        }
+        try components.withUnsafeMutableBufferPointer { comps in
+            for i in 0..<comps.count {
+                try body(owners[i], &comps[i])
+            }
+        }
+    }
+
+    private func insert(_ e: Entity, _ value: T) {
+        let id = Int(e.id)
+        if id >= sparse.count {
+            let newCount = max(id + 1, sparse.count * 2)
+            sparse.append(contentsOf: repeatElement(-1, count: newCount - sparse.count))
+        }
+        let s = sparse[id]
+        writeVersion &+= 1
+        if s >= 0 {
+            components[Int(s)] = value
+            stamps[Int(s)] = writeVersion
+        } else {
+            sparse[id] = Int32(entities.count)
+            entities.append(e)
+            components.append(value)
+            stamps.append(writeVersion)
+            structureVersion &+= 1
+        }
+    }
+}
+
+// MARK: - QueryView
+
+/// Lazily intersects component stores. Iterates the smallest store's dense entity
+/// list and filters by membership in the others; building a view and iterating it do
+/// not allocate (the driver list is shared copy-on-write, the filters are stored inline).
+/// Writing existing components while iterating is fine; structural changes are
+/// tolerated (the driver list is a snapshot) but newly added entities are not visited.
+public struct QueryView: Sequence {
+    fileprivate let driver: [Entity]
+    fileprivate let filter0: AnyComponentStore?
+    fileprivate let filter1: AnyComponentStore?
+    fileprivate let filter2: AnyComponentStore?
+    fileprivate let world: World
+
+    public struct Iterator: IteratorProtocol {
+        fileprivate let view: QueryView
+        fileprivate var index: Int = 0
+
+        public mutating func next() -> Entity? {
+            while index < view.driver.count {
+                let e = view.driver[index]
+                index += 1
+                if !view.world.isAlive(e) { continue }
+                if let f = view.filter0, !f.contains(e) { continue }
+                if let f = view.filter1, !f.contains(e) { continue }
+                if let f = view.filter2, !f.contains(e) { continue }
+                return e
+            }
+            return nil
+        }
+    }
+
+    public func makeIterator() -> Iterator {
+        Iterator(view: self)
+    }
 }
 
 // MARK: - World
 
 public final class World {
     private var nextID: UInt32 = 1
-    private var alive: Set<Entity> = []
+    /// Alive flags indexed by entity id.
+    private var alive: [Bool] = []
 
     // Stores by component type
-    private var stores: [ObjectIdentifier: Any] = [:]
-    private var removers: [ObjectIdentifier: (Entity) -> Void] = [:]
+    private var stores: [ObjectIdentifier: AnyComponentStore] = [:]
 
     public init() {}
 
     public func createEntity() -> Entity {
         let e = Entity(nextID)
         nextID &+= 1
-        alive.insert(e)
+        let id = Int(e.id)
+        if id >= alive.count {
+            alive.append(contentsOf: repeatElement(false, count: max(id + 1, alive.count * 2) - alive.count))
+        }
+        alive[id] = true
         return e
     }
 
     public func destroyEntity(_ e: Entity) {
-        guard alive.remove(e) != nil else { return }
-        // Remove from all component stores via type-erased removers.
-        for remover in removers.values {
-            remover(e)
+        guard isAlive(e) else { return }
+        alive[Int(e.id)] = false
+        // Remove from all component stores via the type-erased surface.
+        for s in stores.values {
+            s.remove(e)
         }
     }
 
     public func isAlive(_ e: Entity) -> Bool {
-        alive.contains(e)
+        let id = Int(e.id)
+        return id < alive.count && alive[id]
     }
 
     // Get typed store
     public func store<T>(_ type: T.Type) -> ComponentStore<T> {
         let key = ObjectIdentifier(type)
-        if let existing = stores[key] as? ComponentStore<T> {
-            return existing
+        if let existing = stores[key] {
+            return unsafeDowncast(existing, to: ComponentStore<T>.self)
         }
         let created = ComponentStore<T>()
         stores[key] = created
-        removers[key] = { [weak created] entity in
-            created?.remove(entity)
-        }
         return created
     }
 
@@ -93,41 +241,70 @@ public final class World {
         store(T.self)[e] = component
     }
 
+    // MARK: - Views
+
+    /// Drives from the smallest of the stores and filters by the rest.
+    private func makeView(_ a: AnyComponentStore,
+                          _ b: AnyComponentStore,
+                          _ c: AnyComponentStore? = nil,
+                          _ d: AnyComponentStore? = nil) -> QueryView {
+        var driver = a
+        var f0 = b
+        var f1 = c
+        var f2 = d
+        if f0.count < driver.count {
+            swap(&driver, &f0)
+        }
+        if let s = f1, s.count < driver.count {
+            f1 = driver
+            driver = s
+        }
+        if let s = f2, s.count < driver.count {
+            f2 = driver
+            driver = s
+        }
+        return QueryView(driver: driver.entities, filter0: f0, filter1: f1, filter2: f2, world: self)
+    }
+
+    /// Allocation-free iteration over entities that have component A
+    public func view<A>(_ a: A.Type) -> QueryView {
+        QueryView(driver: store(A.self).entities, filter0: nil, filter1: nil, filter2: nil, world: self)
+    }
+
+    /// Allocation-free iteration over entities that have components A and B
+    public func view<A, B>(_ a: A.Type, _ b: B.Type) -> QueryView {
+        makeView(store(A.self), store(B.self))
+    }
+
+    /// Allocation-free iteration over entities that have components A, B, C
+    public func view<A, B, C>(_ a: A.Type, _ b: B.Type, _ c: C.Type) -> QueryView {
+        makeView(store(A.self), store(B.self), store(C.self))
+    }
+
+    /// Allocation-free iteration over entities that have components A, B, C, D
+    public func view<A, B, C, D>(_ a: A.Type, _ b: B.Type, _ c: C.Type, _ d: D.Type) -> QueryView {
+        makeView(store(A.self), store(B.self), store(C.self), store(D.self))
+    }
+
     // MARK: - Queries
 
     /// Query entities that have component A
     public func query<A>(_ a: A.Type) -> [Entity] {
-        let sa = store(A.self)
-        return sa.data.keys.filter { isAlive($0) }
+        Array(view(A.self))
     }
 
     /// Query entities that have both components A and B
     public func query<A, B>(_ a: A.Type, _ b: B.Type) -> [Entity] {
-        let sa = store(A.self)
-        let sb = store(B.self)
-
-        // Iterate smaller set
-        let aCount = sa.data.count
-        let bCount = sb.data.count
-
-        if aCount <= bCount {
-            return sa.data.keys.filter { sb.contains($0) && isAlive($0) }
-        } else {
-            return sb.data.keys.filter { sa.contains($0) && isAlive($0) }
-        }
+        Array(view(A.self, B.self))
     }
 
     /// Query entities that have components A, B, C
     public func query<A, B, C>(_ a: A.Type, _ b: B.Type, _ c: C.Type) -> [Entity] {
-        let ab = query(A.self, B.self)
-        let sc = store(C.self)
-        return ab.filter { sc.contains($0) && isAlive($0) }
+        Array(view(A.self, B.self, C.self))
     }
 
     /// Query entities that have components A, B, C, D
     public func query<A, B, C, D>(_ a: A.Type, _ b: B.Type, _ c: C.Type, _ d: D.Type) -> [Entity] {
-        let abc = query(A.self, B.self, C.self)
-        let sd = store(D.self)
-        return abc.filter { sd.contains($0) && isAlive($0) }
+        Array(view(A.self, B.self, C.self, D.self))
     }
 }
@@ -0,0 +1,386 @@
+//
+//  BenchmarkHarness.swift
+//  GameTests
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Foundation
+import Metal
+import simd
+import Testing
+@testable import Game
+
+/// SplitMix64: the same seed gives the same sequence on every machine and run.
+struct SeededGenerator: RandomNumberGenerator {
+    private var state: UInt64
+
+    init(seed: UInt64) {
+        self.state = seed
+    }
+
+    mutating func next() -> UInt64 {
+        state &+= 0x9E37_79B9_7F4A_7C15
+        var z = state
+        z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+        z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+        return z ^ (z >> 31)
+    }
+}
+
+/// Recorded-style controller input: the left stick holds a heading and magnitude for a
+/// while (walk, run or rest), the camera stick drifts, and jump or dodge is tapped now
+/// and then. Generated from a seed so every run replays the same stream.
+enum InputScript {
+    static func make(seed: UInt64, steps: Int) -> [InputFrame] {
+        var rng = SeededGenerator(seed: seed)
+        var frames: [InputFrame] = []
+        frames.reserveCapacity(steps)
+        var hold = 0
+        var left = SIMD2<Float>.zero
+        var right = SIMD2<Float>.zero
+        var tap = 0
+        var tapJump = false
+        while frames.count < steps {
+            if hold == 0 {
+                hold = Int.random(in: 30...120, using: &rng)
+                let heading = Float.random(in: 0..<(2 * .pi), using: &rng)
+                let magnitude: Float = [0, 0.5, 1][Int.random(in: 0..<3, using: &rng)]
+                left = SIMD2<Float>(cosf(heading), sinf(heading)) * magnitude
+                right = SIMD2<Float>(Float.random(in: -0.6...0.6, using: &rng), 0)
+                if Int.random(in: 0..<4, using: &rng) == 0 {
+                    tap = 6
+                    tapJump = Bool.random(using: &rng)
+                }
+            }
+            hold -= 1
+            var frame = InputFrame(leftStick: left, rightStick: right)
+            if tap > 0 {
+                frame.jump = tapJump
+                frame.dodge = !tapJump
+                tap -= 1
+            }
+            frames.append(frame)
+        }
+        return frames
+    }
+}
+
+/// Milliseconds per iteration of one benchmark.
+struct BenchmarkResult {
+    let name: String
+    let samples: [Double]
+
+    var median: Double {
+        percentile(0.5)
+    }
+
+    var p95: Double {
+        percentile(0.95)
+    }
+
+    private func percentile(_ p: Double) -> Double {
+        guard !samples.isEmpty else { return 0 }
+        let sorted = samples.sorted()
+        let rank = Int((Double(sorted.count - 1) * p).rounded(.toNearestOrAwayFromZero))
+        return sorted[rank]
+    }
+}
+
+@MainActor
+enum Benchmark {
+    /// Times `body` `iterations` times after `warmup` untimed runs. `setUp` and `tearDown`
+    /// run untimed around every run, for resetting state the body consumes.
+    static func measure(_ name: String,
+                        warmup: Int = 3,
+                        iterations: Int = 20,
+                        setUp: () -> Void = {},
+                        tearDown: () -> Void = {},
+                        _ body: () -> Void) -> BenchmarkResult {
+        for _ in 0..<warmup {
+            setUp()
+            body()
+            tearDown()
+        }
+        var samples: [Double] = []
+        samples.reserveCapacity(iterations)
+        for _ in 0..<iterations {
+            setUp()
+            let start = DispatchTime.now().uptimeNanoseconds
+            body()
+            let end = DispatchTime.now().uptimeNanoseconds
+            tearDown()
+            samples.append(Double(end &- start) / 1_000_000)
+        }
+        return BenchmarkResult(name: name, samples: samples)
+    }
+
+    /// Keeps a benchmarked result alive so the work producing it is not optimized away.
+    @inline(never)
+    static func consume<T>(_ value: T) {
+        withExtendedLifetime(value) {}
+    }
+
+    /// GPU time of each of `iterations` command buffers that `encode` fills, after `warmup`.
+    static func measureGPU(_ name: String,
+                           queue: MTLCommandQueue,
+                           warmup: Int = 3,
+                           iterations: Int = 20,
+                           _ encode: (MTLCommandBuffer, Int) -> Void) -> BenchmarkResult {
+        var samples: [Double] = []
+        samples.reserveCapacity(iterations)
+        for i in 0..<(warmup + iterations) {
+            guard let commandBuffer = queue.makeCommandBuffer() else { break }
+            encode(commandBuffer, i)
+            commandBuffer.commit()
+            commandBuffer.waitUntilCompleted()
+            guard i >= warmup, commandBuffer.status == .completed else { continue }
+            samples.append((commandBuffer.gpuEndTime - commandBuffer.gpuStartTime) * 1000)
+        }
+        return BenchmarkResult(name: name, samples: samples)
+    }
+}
+
+/// Stored medians from `PerfBaselines.json`. A result fails when its median exceeds the
+/// baseline by more than the tolerance, or when it has no baseline. Baselines only apply
+/// to the device and build configuration they were recorded with; elsewhere the
+/// benchmarks are skipped (`isEnabled`) unless `PERF_BASELINE_RECORD` is set, or
+/// `PERF_BASELINE_REQUIRED` (or `CI`) is, in which case they run and every result without
+/// a matching baseline fails, so a perf job cannot pass by skipping. Every run
+/// writes its own medians to `PERF_BASELINE_OUTPUT` (default: PerfBaselines.json in the
+/// temporary directory), in the same format, so a recording run on the reference machine
+/// can be checked in as the new file.
+@MainActor
+final class PerfBaselines {
+    struct Entry: Codable {
+        var milliseconds: Double
+        /// Overrides the file's tolerance for noisy benchmarks.
+        var tolerance: Double?
+    }
+
+    struct File: Codable {
+        var device: String
+        var configuration: String
+        /// Allowed relative slowdown of the median, e.g. 0.25 for 25%.
+        var tolerance: Double
+        var benchmarks: [String: Entry]
+    }
+
+    static let shared = PerfBaselines()
+
+    /// Measure and write results without checking them, to record new baselines.
+    nonisolated static var isRecording: Bool {
+        ProcessInfo.processInfo.environment["PERF_BASELINE_RECORD"] != nil
+    }
+
+    /// Run and fail on missing or mismatched baselines instead of skipping; set on CI.
+    nonisolated static var isRequired: Bool {
+        let environment = ProcessInfo.processInfo.environment
+        return environment["PERF_BASELINE_REQUIRED"] != nil || environment["CI"] != nil
+    }
+
+    /// Whether the benchmarks run: the stored baselines match this device and configuration,
+    /// or a recording or a required run was requested.
+    nonisolated static var isEnabled: Bool {
+        guard !isRecording, !isRequired else { return true }
+        guard let stored = loadStored() else { return false }
+        return stored.device == deviceName && stored.configuration == configuration
+    }
+
+    nonisolated static var deviceName: String {
+        MTLCreateSystemDefaultDevice()?.name ?? "unknown"
+    }
+
+    nonisolated private static func loadStored() -> File? {
+        let url = Bundle(for: BundleToken.self).url(forResource: "PerfBaselines", withExtension: "json")
+        return url.flatMap { try? Data(contentsOf: $0) }.flatMap { try? JSONDecoder().decode(File.self, from: $0) }
+    }
+
+    nonisolated static var configuration: String {
+        #if DEBUG
+        return "Debug"
+        #else
+        return "Release"
+        #endif
+    }
+
+    private let stored: File?
+    private var measured: File
+    private let outputURL: URL
+
+    private init() {
+        let device = PerfBaselines.deviceName
+        let stored = PerfBaselines.loadStored()
+        if stored == nil {
+            print("PerfBaselines: PerfBaselines.json missing or unreadable; recording only")
+        }
+        self.stored = stored
+        self.measured = File(device: device,
+                             configuration: PerfBaselines.configuration,
+                             tolerance: stored?.tolerance ?? 0.25,
+                             benchmarks: [:])
+        if let path = ProcessInfo.processInfo.environment["PERF_BASELINE_OUTPUT"] {
+            self.outputURL = URL(fileURLWithPath: path)
+        } else {
+            self.outputURL = FileManager.default.temporaryDirectory.appendingPathComponent("PerfBaselines.json")
+        }
+    }
+
+    /// Prints `result`, records it and, unless recording, expects it within its baseline.
+    func check(_ result: BenchmarkResult, sourceLocation: SourceLocation = #_sourceLocation) {
+        #expect(!result.samples.isEmpty, "\(result.name) produced no samples", sourceLocation: sourceLocation)
+        guard !result.samples.isEmpty else { return }
+        measured.benchmarks[result.name] = Entry(milliseconds: result.median,
+                                                 tolerance: stored?.benchmarks[result.name]?.tolerance)
+        write()
+
+        let summary = String(format: "%@: median %.3f ms, p95 %.3f ms", result.name, result.median, result.p95)
+        if PerfBaselines.isRecording {
+            print("[perf]", summary, "(recording)")
+            return
+        }
+        guard let stored else {
+            print("[perf]", summary, "(no baselines)")
+            Issue.record("\(result.name): PerfBaselines.json is missing or unreadable", sourceLocation: sourceLocation)
+            return
+        }
+        guard stored.device == measured.device, stored.configuration == measured.configuration else {
+            print("[perf]", summary, "(baselines are for another device)")
+            Issue.record("\(result.name): baselines are for \(stored.device) (\(stored.configuration)), not \(measured.device) (\(measured.configuration)); run on the reference device or record with PERF_BASELINE_RECORD=1",
+                         sourceLocation: sourceLocation)
+            return
+        }
+        guard let baseline = stored.benchmarks[result.name] else {
+            print("[perf]", summary, "(no baseline)")
+            Issue.record("\(result.name) has no baseline for \(measured.device) (\(measured.configuration)); record one with PERF_BASELINE_RECORD=1",
+                         sourceLocation: sourceLocation)
+            return
+        }
+        let limit = baseline.milliseconds * (1 + (baseline.tolerance ?? stored.tolerance))
+        print("[perf]", summary, String(format: "(baseline %.3f ms, limit %.3f ms)", baseline.milliseconds, limit))
+        #expect(result.median <= limit,
+                "\(result.name) regressed: median \(result.median) ms > \(limit) ms",
+                sourceLocation: sourceLocation)
+    }
+
+    private func write() {
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        do {
+            try encoder.encode(measured).write(to: outputURL, options: .atomic)
+        } catch {
+            print("PerfBaselines: unable to write:", outputURL.path, error)
+        }
+    }
+}
+
+private final class BundleToken {}
+
+/// `DemoScene` without a view: built once, stepped one fixed step per update from a
+/// replayed input stream with streamed assets and collision chunks built synchronously,
+/// so the same stream always produces the same world.
+@MainActor
+final class HeadlessScene {
+    /// One update advances exactly one fixed step (`TimeComponent.fixedDelta`).
+    static let stepDT: Float = 1.0 / 60.0
+
+    let device: MTLDevice
+    let scene = DemoScene()
+
+    init(device: MTLDevice, viewport: SIMD2<Float> = SIMD2<Float>(1280, 720)) {
+        self.device = device
+        scene.synchronousAssetLoads = true
+        scene.synchronousCollisionChunks = true
+        scene.build(context: SceneContext(device: device))
+        scene.viewportDidChange(size: viewport)
+        scene.camera.updateProjection(width: viewport.x, height: viewport.y)
+    }
+
+    var world: World {
+        scene.simulationWorld
+    }
+
+    /// Replays `frames`, one update each.
+    func run(_ frames: [InputFrame]) {
+        scene.playInput(frames)
+        for _ in frames.indices {
+            scene.update(dt: HeadlessScene.stepDT)
+        }
+        scene.playInput(nil)
+    }
+
+    /// FNV-1a over every physics body's position and velocity, in entity order.
+    func stateDigest() -> UInt64 {
+        let store = world.store(PhysicsBodyComponent.self)
+        var hash: UInt64 = 0xCBF2_9CE4_8422_2325
+        func mix(_ value: UInt64) {
+            hash = (hash ^ value) &* 0x0000_0100_0000_01B3
+        }
+        for e in world.query(PhysicsBodyComponent.self) {
+            guard let body = store[e] else { continue }
+            mix(UInt64(e.id))
+            for i in 0..<3 {
+                mix(body.position[i].bitPattern)
+                mix(body.linearVelocity[i].bitPattern)
+            }
+        }
+        return hash
+    }
+}
+
+/// Static collision worlds for the collision and agent benchmarks.
+@MainActor
+enum BenchmarkWorlds {
+    /// Rolling heightfield of `cells`² quads (two triangles each) spanning `size` metres.
+    static func terrain(cells: Int, size: Float) -> ProceduralMeshDescriptor {
+        let n = cells + 1
+        var positions: [SIMD3<Float>] = []
+        var normals: [SIMD3<Float>] = []
+        positions.reserveCapacity(n * n)
+        normals.reserveCapacity(n * n)
+        for z in 0..<n {
+            for x in 0..<n {
+                let px = (Float(x) / Float(cells) - 0.5) * size
+                let pz = (Float(z) / Float(cells) - 0.5) * size
+                let y = 2 * sinf(px * 0.15) * cosf(pz * 0.11) + 0.5 * sinf(px * 0.7 + pz * 0.4)
+                positions.append(SIMD3<Float>(px, y, pz))
+                normals.append(SIMD3<Float>(0, 1, 0))
+            }
+        }
+        var indices: [UInt32] = []
+        indices.reserveCapacity(cells * cells * 6)
+        for z in 0..<cells {
+            for x in 0..<cells {
+                let i = UInt32(z * n + x)
+                let row = UInt32(n)
+                indices += [i, i + row, i + 1, i + 1, i + row, i + row + 1]
+            }
+        }
+        return ProceduralMeshDescriptor(topology: .triangles,
+                                        streams: VertexStreams(positions: positions, normals: normals),
+                                        indices32: indices,
+                                        name: "BenchmarkTerrain")
+    }
+
+    /// A world holding the terrain plus a grid of static boxes on it.
+    static func collisionWorld(terrainCells: Int = 256, size: Float = 200, boxes: Int = 8) -> World {
+        let world = World()
+        let ground = world.createEntity()
+        world.add(ground, TransformComponent())
+        world.add(ground, StaticMeshComponent(mesh: terrain(cells: terrainCells, size: size)))
+
+        let box = ProceduralMeshes.box(BoxParams(size: 3))
+        let spacing = size / Float(boxes)
+        for z in 0..<boxes {
+            for x in 0..<boxes {
+                let e = world.createEntity()
+                let position = SIMD3<Float>((Float(x) + 0.5) * spacing - size * 0.5,
+                                            2,
+                                            (Float(z) + 0.5) * spacing - size * 0.5)
+                world.add(e, TransformComponent(translation: position))
+                world.add(e, StaticMeshComponent(mesh: box))
+            }
+        }
+        return world
+    }
+}
@@ -5,13 +5,84 @@
 //  Created by 伈佊 on 1/2/26.
 //
 
+import Foundation
+import Metal
+import simd
 import Testing
 @testable import Game
 
+@MainActor
 struct GameTests {
 
-    @Test func example() async throws {
-        // Write your test here and use APIs like `#expect(...)` to check expected conditions.
+    @Test func inputScriptIsSeeded() {
+        #expect(InputScript.make(seed: 7, steps: 300) == InputScript.make(seed: 7, steps: 300))
+        #expect(InputScript.make(seed: 7, steps: 300) != InputScript.make(seed: 8, steps: 300))
+    }
+
+    @Test func recordedInputReplays() throws {
+        let device = try #require(MTLCreateSystemDefaultDevice())
+        let frames = InputScript.make(seed: 1, steps: 240)
+
+        let recorder = HeadlessScene(device: device)
+        recorder.scene.startInputRecording()
+        recorder.run(frames)
+        let recorded = recorder.scene.stopInputRecording()
+        #expect(recorded == frames)
+
+        let replay = HeadlessScene(device: device)
+        replay.run(recorded)
+        #expect(replay.stateDigest() == recorder.stateDigest())
+    }
+
+    @Test func simulationIsDeterministic() throws {
+        let device = try #require(MTLCreateSystemDefaultDevice())
+        let frames = InputScript.make(seed: 42, steps: 600)
+
+        let first = HeadlessScene(device: device)
+        first.run(frames)
+        let second = HeadlessScene(device: device)
+        second.run(frames)
+        #expect(first.stateDigest() == second.stateDigest())
+    }
+
+    @Test func compiledMotionProfileMatchesSeries() throws {
+        // Order-3 curves on most lanes, a short (truncated) curve and missing lanes that
+        // fall back to the defaults.
+        let json = """
+        {"version": 1, "name": "test", "duration": 1, "order": 3, "sample_fps": 60,
+         "bones": {
+           "hips": {"translation": {"x": [0.1, 0.3, -0.2, 0.05, 0.1, -0.02, 0.04], "y": [1.0, 0.02, 0.01]},
+                    "rotation": {"x": [2, 10, -4, 3, 1.5, -0.5, 0.8], "z": [0, -6, 2, 1, 0.4, 0.2, -0.3]}},
+           "spine": {"translation": {},
+                     "rotation": {"y": [5, 3, 1, -2, 0.5, 0.25, 0.1]}}
+         }}
+        """
+        let profile = try JSONDecoder().decode(MotionProfile.self, from: Data(json.utf8))
+        let rest = SIMD3<Float>(0.5, 0.9, -0.1)
+        let names = ["hips", "spine", "missing"]
+        for resolution in [0, CompiledMotionProfile.defaultLUTResolution] {
+            let compiled = CompiledMotionProfile(profile, lutResolution: resolution)
+            // Linear interpolation of a 128-step LUT stays within about a hundredth of a
+            // unit (degrees for rotation) of these curves; the series itself only rounds.
+            let tolerance: Float = resolution == 0 ? 1e-4 : 0.05
+            let slots = compiled.slots(for: names)
+            for (i, name) in names.enumerated() {
+                for step in 0...500 {
+                    let phase = Float(step) / 500
+                    let (t, r) = compiled.sample(slot: slots[i], phase: phase, restTranslation: rest)
+                    let expectedT = profile.bones[name].map {
+                        MotionProfileEvaluator.evaluateChannel($0.translation, phase: phase, order: profile.order, defaultValue: rest)
+                    } ?? rest
+                    let expectedR = profile.bones[name].map {
+                        MotionProfileEvaluator.evaluateChannel($0.rotation, phase: phase, order: profile.order, defaultValue: .zero)
+                    } ?? .zero
+                    #expect(simd_reduce_max(simd_abs(t - expectedT)) <= tolerance, "\(name) translation at \(phase), LUT \(resolution)")
+                    #expect(simd_reduce_max(simd_abs(r - expectedR)) <= tolerance, "\(name) rotation at \(phase), LUT \(resolution)")
+                }
+            }
+        }
+        // The decoded profile keeps one compiled evaluator rather than recompiling per access.
+        #expect(profile.evaluator === profile.evaluator)
     }
 
 }
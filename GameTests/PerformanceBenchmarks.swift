@@ -0,0 +1,235 @@
+//
+//  PerformanceBenchmarks.swift
+//  GameTests
+//
+//  Created by 伈佊 on 1/2/26.
+//
+
+import Metal
+import simd
+import Testing
+@testable import Game
+
+/// Timed runs of the hot paths, each checked against `PerfBaselines.json`. Serialized so
+/// benchmarks do not compete for cores or the GPU; skipped, and reported as such, where no
+/// baselines were recorded for this device and configuration, except on CI
+/// (`PERF_BASELINE_REQUIRED`), where that fails instead.
+@MainActor
+@Suite(.serialized,
+       .enabled(if: PerfBaselines.isEnabled,
+                "No PerfBaselines.json entries for this device/configuration; set PERF_BASELINE_RECORD=1 to record them or PERF_BASELINE_REQUIRED=1 to fail"))
+struct PerformanceBenchmarks {
+    private static let seed: UInt64 = 0x5EED
+    private let device: MTLDevice
+
+    init() throws {
+        device = try #require(MTLCreateSystemDefaultDevice())
+    }
+
+    // MARK: - Simulation
+
+    @Test func simulationStep() {
+        let headless = HeadlessScene(device: device)
+        headless.run(InputScript.make(seed: PerformanceBenchmarks.seed, steps: 120))
+        headless.scene.playInput(InputScript.make(seed: PerformanceBenchmarks.seed + 1, steps: 660))
+        let result = Benchmark.measure("Simulation step", warmup: 60, iterations: 600) {
+            headless.scene.update(dt: HeadlessScene.stepDT)
+        }
+        PerfBaselines.shared.check(result)
+    }
+
+    // MARK: - Collision
+
+    @Test func staticTriMeshBuild() {
+        let world = BenchmarkWorlds.collisionWorld()
+        let result = Benchmark.measure("StaticTriMesh build", iterations: 10) {
+            Benchmark.consume(StaticTriMesh(world: world))
+        }
+        PerfBaselines.shared.check(result)
+    }
+
+    @Test func staticTriMeshQueries() {
+        let world = BenchmarkWorlds.collisionWorld()
+        var mesh = StaticTriMesh(world: world)
+        var rng = SeededGenerator(seed: PerformanceBenchmarks.seed)
+
+        let rays = (0..<4096).map { _ in
+            RayQuery(origin: SIMD3<Float>(Float.random(in: -90...90, using: &rng),
+                                          20,
+                                          Float.random(in: -90...90, using: &rng)),
+                     direction: simd_normalize(SIMD3<Float>(Float.random(in: -0.5...0.5, using: &rng),
+                                                            -1,
+                                                            Float.random(in: -0.5...0.5, using: &rng))),
+                     maxDistance: 100)
+        }
+        let sweeps = (0..<1024).map { _ in
+            CapsuleSweepQuery(from: SIMD3<Float>(Float.random(in: -90...90, using: &rng),
+                                                 6,
+                                                 Float.random(in: -90...90, using: &rng)),
+                              delta: SIMD3<Float>(Float.random(in: -4...4, using: &rng),
+                                                  -8,
+                                                  Float.random(in: -4...4, using: &rng)),
+                              radius: 1,
+                              halfHeight: 1)
+        }
+        #expect(mesh.raycastBatch(rays).contains { $0 != nil })
+
+        let raycasts = Benchmark.measure("StaticTriMesh raycastBatch 4096") {
+            Benchmark.consume(mesh.raycastBatch(rays))
+        }
+        PerfBaselines.shared.check(raycasts)
+        let capsuleCasts = Benchmark.measure("StaticTriMesh capsuleCastBatch 1024") {
+            Benchmark.consume(mesh.capsuleCastBatch(sweeps))
+        }
+        PerfBaselines.shared.check(capsuleCasts)
+    }
+
+    @Test func agentSeparation() {
+        let world = World()
+        let ground = world.createEntity()
+        world.add(ground, TransformComponent())
+        world.add(ground, StaticMeshComponent(mesh: ProceduralMeshes.plane(PlaneParams(size: 200))))
+
+        // A crowd packed tighter than the capsules allow, so every step has overlaps to resolve.
+        var rng = SeededGenerator(seed: PerformanceBenchmarks.seed)
+        let side = 24
+        var agents: [(entity: Entity, body: PhysicsBodyComponent)] = []
+        for z in 0..<side {
+            for x in 0..<side {
+                let e = world.createEntity()
+                let position = SIMD3<Float>((Float(x) - Float(side) * 0.5) * 1.6 + Float.random(in: -0.3...0.3, using: &rng),
+                                            2.05,
+                                            (Float(z) - Float(side) * 0.5) * 1.6 + Float.random(in: -0.3...0.3, using: &rng))
+                let body = PhysicsBodyComponent(position: position)
+                world.add(e, body)
+                world.add(e, CharacterControllerComponent(radius: 1.0, halfHeight: 1.0))
+                world.add(e, AgentCollisionComponent(massWeight: Float.random(in: 1...4, using: &rng)))
+                agents.append((e, body))
+            }
+        }
+
+        let system = AgentSeparationSystem()
+        system.setQuery(CollisionQuery(world: world))
+        let pStore = world.store(PhysicsBodyComponent.self)
+        let result = Benchmark.measure("AgentSeparationSystem \(side * side) agents",
+                                       setUp: {
+                                           for agent in agents {
+                                               pStore[agent.entity] = agent.body
+                                           }
+                                       }) {
+            system.fixedUpdate(world: world, dt: HeadlessScene.stepDT)
+        }
+        PerfBaselines.shared.check(result)
+    }
+
+    // MARK: - Animation
+
+    @Test func poseStack() {
+        let world = World()
+        let player = CharacterFactory.makePlayer(world: world,
+                                                 device: device,
+                                                 inputSystem: InputSystem(camera: Camera()),
+                                                 groundY: 0)
+        // Clones of the player's pose inputs; the pose stack reads nothing per entity beyond these.
+        let count = 64
+        for i in 1..<count {
+            let e = world.createEntity()
+            copy(SkeletonComponent.self, from: player, to: e, in: world)
+            copy(PoseComponent.self, from: player, to: e, in: world)
+            copy(MotionProfileComponent.self, from: player, to: e, in: world)
+            copy(LocomotionProfileComponent.self, from: player, to: e, in: world)
+            copy(ActionAnimationComponent.self, from: player, to: e, in: world)
+            copy(CharacterControllerComponent.self, from: player, to: e, in: world)
+            world.add(e, TransformComponent(translation: SIMD3<Float>(Float(i) * 4, 0, 0)))
+        }
+
+        let system = PoseStackSystem()
+        let result = Benchmark.measure("PoseStackSystem \(count) characters", warmup: 10, iterations: 120) {
+            system.fixedUpdate(world: world, dt: HeadlessScene.stepDT)
+        }
+        PerfBaselines.shared.check(result)
+    }
+
+    private func copy<T>(_ type: T.Type, from source: Entity, to target: Entity, in world: World) {
+        if let component = world.get(source, type) {
+            world.add(target, component)
+        }
+    }
+
+    // MARK: - Ray tracing
+
+    @Test func rtGeometryCacheBuild() throws {
+        let queue = try #require(device.makeCommandQueue())
+        let headless = HeadlessScene(device: device)
+        headless.run(InputScript.make(seed: PerformanceBenchmarks.seed, steps: 120))
+        headless.scene.playInput(InputScript.make(seed: PerformanceBenchmarks.seed + 1, steps: 400))
+
+        for useChanges in [true, false] {
+            let cache = RTGeometryCache(device: device)
+            var commandBuffer: MTLCommandBuffer?
+            var frame = 0
+            let name = useChanges ? "RTGeometryCache.build change set" : "RTGeometryCache.build rekey"
+            let result = Benchmark.measure(name,
+                                           warmup: 10,
+                                           iterations: 120,
+                                           setUp: {
+                                               headless.scene.update(dt: HeadlessScene.stepDT)
+                                               commandBuffer = queue.makeCommandBuffer()
+                                           },
+                                           tearDown: {
+                                               commandBuffer?.commit()
+                                               commandBuffer?.waitUntilCompleted()
+                                               frame += 1
+                                           }) {
+                guard let commandBuffer else { return }
+                Benchmark.consume(cache.build(items: headless.scene.renderItems,
+                                              changes: useChanges ? headless.scene.renderChanges : nil,
+                                              frameSlot: frame % maxBuffersInFlight,
+                                              commandBuffer: commandBuffer))
+            }
+            PerfBaselines.shared.check(result)
+        }
+    }
+
+    /// GPU time of the trace alone: the scene (geometry, skinning, BLAS/TLAS) is encoded
+    /// into a separate command buffer ahead of the timed one.
+    @Test(arguments: [640, 1280, 1920], [false, true])
+    func rayTraceKernel(width: Int, wavefront: Bool) throws {
+        let height = width * 9 / 16
+        let queue = try #require(device.makeCommandQueue())
+        let rt = try #require(RayTracingRenderer(device: device))
+        let headless = HeadlessScene(device: device, viewport: SIMD2<Float>(Float(width), Float(height)))
+        headless.run(InputScript.make(seed: PerformanceBenchmarks.seed, steps: 120))
+
+        let desc = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .rgba16Float,
+                                                            width: width,
+                                                            height: height,
+                                                            mipmapped: false)
+        desc.usage = [.shaderRead, .shaderWrite]
+        desc.storageMode = .private
+        let output = try #require(device.makeTexture(descriptor: desc))
+
+        let scene = headless.scene
+        let name = "RT trace \(width)x\(height)\(wavefront ? " wavefront" : "")"
+        let result = Benchmark.measureGPU(name, queue: queue) { commandBuffer, frame in
+            let input = RayTracingFrameInput(items: scene.renderItems,
+                                             changes: scene.renderChanges,
+                                             lights: scene.directionalLights,
+                                             camera: scene.camera,
+                                             projection: scene.camera.projection,
+                                             viewMatrix: scene.camera.view,
+                                             outputTexture: output,
+                                             frameSlot: frame % maxBuffersInFlight,
+                                             temporal: false,
+                                             traceScale: 1,
+                                             wavefront: wavefront,
+                                             alphaFunctions: false)
+            if let sceneBuffer = queue.makeCommandBuffer() {
+                rt.encodeScene(commandBuffer: sceneBuffer, input: input)
+                sceneBuffer.commit()
+            }
+            rt.encodeTrace(commandBuffer: commandBuffer, input: input)
+        }
+        PerfBaselines.shared.check(result)
+    }
+}
@@ -0,0 +1,276 @@
+import json
+import math
+import os
+import struct
+import sys
+from array import array
+
+MAGIC = b"GBIN"
+VERSION = 1
+HEADER_SIZE = 16
+CHUNK_ENTRY_SIZE = 16
+DATA_ALIGNMENT = 16
+# Largest Apple GPU page size; chunks wrapped with makeBuffer(bytesNoCopy:) start and end here.
+GPU_ALIGNMENT = 16384
+VERTEX_PNUT_STRIDE = 64
+
+
+def _usage():
+    raise SystemExit("Usage: python3 cook_assets.py <input.static.json|input.skinned.json> [output.bin]")
+
+
+def _parse_args():
+    argv = sys.argv[1:]
+    if not argv or len(argv) > 2:
+        _usage()
+    input_path = argv[0]
+    if len(argv) == 2:
+        output_path = argv[1]
+    else:
+        root, _ = os.path.splitext(input_path)
+        output_path = root + ".bin"
+    return input_path, output_path
+
+
+def _align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+class ChunkWriter:
+    """Collects chunks and writes the container read by Game/MappedAsset.swift."""
+
+    def __init__(self):
+        self.chunks = [None]  # Chunk 0 is the metadata, filled in by write().
+
+    def add(self, data, gpu=False):
+        self.chunks.append((bytes(data), gpu))
+        return len(self.chunks) - 1
+
+    def write(self, path, meta):
+        meta_bytes = json.dumps(meta, separators=(",", ":")).encode("utf-8")
+        self.chunks[0] = (meta_bytes, False)
+
+        offset = HEADER_SIZE + CHUNK_ENTRY_SIZE * len(self.chunks)
+        layout = []
+        for data, gpu in self.chunks:
+            offset = _align(offset, GPU_ALIGNMENT if gpu else DATA_ALIGNMENT)
+            layout.append((offset, len(data)))
+            offset += len(data)
+            if gpu:
+                # Pad to the page end so the wrapped buffer never spans the next chunk.
+                offset = _align(offset, GPU_ALIGNMENT)
+        file_length = _align(offset, GPU_ALIGNMENT)
+
+        out = bytearray(file_length)
+        struct.pack_into("<4sIII", out, 0, MAGIC, VERSION, len(self.chunks), 0)
+        for i, (chunk_offset, length) in enumerate(layout):
+            struct.pack_into("<QQ", out, HEADER_SIZE + i * CHUNK_ENTRY_SIZE, chunk_offset, length)
+            out[chunk_offset:chunk_offset + length] = self.chunks[i][0]
+
+        os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(out)
+        return file_length
+
+
+def _floats(values):
+    data = array("f", values)
+    if sys.byteorder != "little":
+        data.byteswap()
+    return data.tobytes()
+
+
+def _uints(values, typecode):
+    data = array(typecode, values)
+    if sys.byteorder != "little":
+        data.byteswap()
+    return data.tobytes()
+
+
+def _vec3_padded(flat):
+    """float3 stream laid out like [SIMD3<Float>] (16-byte stride)."""
+    out = []
+    for i in range(0, len(flat), 3):
+        out.extend((flat[i], flat[i + 1], flat[i + 2], 0.0))
+    return _floats(out)
+
+
+def _normalize(v):
+    length = math.sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2])
+    if length == 0.0:
+        return (0.0, 0.0, 0.0)
+    return (v[0] / length, v[1] / length, v[2] / length)
+
+
+def _tangents(positions, normals, uvs, indices):
+    """Same construction as MeshTangents.compute, over every triangle of the mesh."""
+    v_count = len(positions) // 3
+    tan1 = [[0.0, 0.0, 0.0] for _ in range(v_count)]
+    tan2 = [[0.0, 0.0, 0.0] for _ in range(v_count)]
+    for t in range(0, len(indices) - 2, 3):
+        i0, i1, i2 = indices[t], indices[t + 1], indices[t + 2]
+        p0 = positions[i0 * 3:i0 * 3 + 3]
+        p1 = positions[i1 * 3:i1 * 3 + 3]
+        p2 = positions[i2 * 3:i2 * 3 + 3]
+        uv0 = uvs[i0 * 2:i0 * 2 + 2]
+        uv1 = uvs[i1 * 2:i1 * 2 + 2]
+        uv2 = uvs[i2 * 2:i2 * 2 + 2]
+        dp1 = [p1[k] - p0[k] for k in range(3)]
+        dp2 = [p2[k] - p0[k] for k in range(3)]
+        duv1 = (uv1[0] - uv0[0], uv1[1] - uv0[1])
+        duv2 = (uv2[0] - uv0[0], uv2[1] - uv0[1])
+        denom = duv1[0] * duv2[1] - duv1[1] * duv2[0]
+        if abs(denom) < 1e-6:
+            continue
+        r = 1.0 / denom
+        tt = [(dp1[k] * duv2[1] - dp2[k] * duv1[1]) * r for k in range(3)]
+        bb = [(dp2[k] * duv1[0] - dp1[k] * duv2[0]) * r for k in range(3)]
+        for i in (i0, i1, i2):
+            for k in range(3):
+                tan1[i][k] += tt[k]
+                tan2[i][k] += bb[k]
+
+    tangents = []
+    for i in range(v_count):
+        n = _normalize(normals[i * 3:i * 3 + 3])
+        t = tan1[i]
+        if t[0] * t[0] + t[1] * t[1] + t[2] * t[2] < 1e-8:
+            tangents.append((1.0, 0.0, 0.0, 1.0))
+            continue
+        d = n[0] * t[0] + n[1] * t[1] + n[2] * t[2]
+        t = _normalize((t[0] - n[0] * d, t[1] - n[1] * d, t[2] - n[2] * d))
+        b = tan2[i]
+        c = (n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0])
+        w = -1.0 if c[0] * b[0] + c[1] * b[1] + c[2] * b[2] < 0.0 else 1.0
+        tangents.append((t[0], t[1], t[2], w))
+    return tangents
+
+
+def _vertex_pnut(positions, normals, uvs, tangents):
+    """Interleaved VertexPNUT: position(16) normal(16) uv(8) pad(8) tangent(16)."""
+    out = []
+    for i in range(len(positions) // 3):
+        out.extend((positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 0.0))
+        out.extend((normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2], 0.0))
+        out.extend((uvs[i * 2], uvs[i * 2 + 1], 0.0, 0.0))
+        out.extend(tangents[i])
+    return _floats(out)
+
+
+def _cook_static(doc, writer):
+    parts = []
+    for entry in doc.get("meshes", []):
+        name = entry["name"]
+        mesh = entry["mesh"]
+        positions = mesh["positions"]
+        indices = mesh["indices"]
+        v_count = len(positions) // 3
+        if v_count == 0 or len(positions) != v_count * 3 or not indices:
+            print(f"Skipping mesh with invalid positions or indices: {name}")
+            continue
+        normals = mesh.get("normals") or []
+        uvs = mesh.get("uvs") or []
+        if len(normals) != v_count * 3:
+            if normals:
+                print(f"normals count mismatch for mesh: {name}")
+            normals = [0.0, 1.0, 0.0] * v_count
+        if len(uvs) != v_count * 2:
+            if uvs:
+                print(f"uvs count mismatch for mesh: {name}")
+            uvs = [0.0, 0.0] * v_count
+
+        tangents = _tangents(positions, normals, uvs, indices)
+        vertices = writer.add(_vertex_pnut(positions, normals, uvs, tangents), gpu=True)
+
+        submeshes = mesh.get("submeshes") or [{"start": 0, "count": len(indices), "material": "Default"}]
+        cooked_submeshes = []
+        for sub in submeshes:
+            start = max(sub["start"], 0)
+            end = min(start + sub["count"], len(indices))
+            if start >= end:
+                continue
+            sliced = indices[start:end]
+            index_type = "uint16" if max(sliced) <= 0xFFFF else "uint32"
+            chunk = writer.add(_uints(sliced, "H" if index_type == "uint16" else "I"), gpu=True)
+            cooked_submeshes.append({
+                "start": start,
+                "material": sub["material"],
+                "indices": chunk,
+                "indexType": index_type,
+                "indexCount": len(sliced),
+            })
+
+        hulls = []
+        for hull in entry.get("collisionHulls") or []:
+            hull_positions = hull["positions"]
+            hull_count = len(hull_positions) // 3
+            if hull_count == 0 or len(hull_positions) != hull_count * 3 or not hull["indices"]:
+                continue
+            hulls.append({
+                "positions": writer.add(_vec3_padded(hull_positions)),
+                "vertexCount": hull_count,
+                "indices": writer.add(_uints(hull["indices"], "I")),
+                "indexCount": len(hull["indices"]),
+            })
+
+        parts.append({
+            "name": name,
+            "transform": entry.get("transform") or [],
+            "vertexCount": v_count,
+            "vertices": vertices,
+            "submeshes": cooked_submeshes,
+            "hulls": hulls,
+        })
+        print(f"  {name}: verts={v_count} submeshes={len(cooked_submeshes)} hulls={len(hulls)}")
+
+    return {"kind": "static", "version": VERSION, "vertexStride": VERTEX_PNUT_STRIDE, "parts": parts}
+
+
+def _cook_skinned(doc, writer):
+    mesh = doc["mesh"]
+    positions = mesh["positions"]
+    v_count = len(positions) // 3
+    if (v_count == 0
+            or len(positions) != v_count * 3
+            or len(mesh["normals"]) != v_count * 3
+            or len(mesh["uvs"]) != v_count * 2
+            or len(mesh["joints"]) != v_count * 4
+            or len(mesh["weights"]) != v_count * 4):
+        raise SystemExit("Skinned mesh attribute counts do not match.")
+    print(f"  skinned: verts={v_count} bones={len(doc['skin']['bones'])}")
+    return {
+        "kind": "skinned",
+        "version": VERSION,
+        "vertexCount": v_count,
+        "positions": writer.add(_vec3_padded(positions)),
+        "normals": writer.add(_vec3_padded(mesh["normals"])),
+        "uvs": writer.add(_floats(mesh["uvs"])),
+        "joints": writer.add(_uints(mesh["joints"], "H")),
+        "weights": writer.add(_floats(mesh["weights"])),
+        "indices": writer.add(_uints(mesh["indices"], "I")),
+        "indexCount": len(mesh["indices"]),
+        "submeshes": mesh.get("submeshes") or [],
+        "bones": doc["skin"]["bones"],
+    }
+
+
+def main():
+    input_path, output_path = _parse_args()
+    with open(input_path, "r", encoding="utf-8") as f:
+        doc = json.load(f)
+
+    writer = ChunkWriter()
+    print(f"Cooking {input_path}")
+    if "meshes" in doc:
+        meta = _cook_static(doc, writer)
+    elif "skin" in doc:
+        meta = _cook_skinned(doc, writer)
+    else:
+        raise SystemExit("Unrecognized asset: expected a static (meshes) or skinned (skin) json export.")
+
+    length = writer.write(output_path, meta)
+    print(f"Wrote {output_path} ({length} bytes, {len(writer.chunks)} chunks)")
+
+
+if __name__ == "__main__":
+    main()